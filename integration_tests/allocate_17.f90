@@ -0,0 +1,57 @@
+program allocate_17
+    implicit none
+    real :: x(5), big(20000)
+    real, allocatable :: kept(:)
+    integer :: i
+
+    do i = 1, size(x)
+        x(i) = i
+    end do
+    if( abs(local_sum(x, size(x)) - 30.0) > 1e-6 ) error stop
+    big = 1.0
+    ! The automatic array of `local_sum` is above --stack-arrays-limit
+    if( abs(local_sum(big, size(big)) - 40000.0) > 1e-2 ) error stop
+
+    call fill(kept, 4)
+    if( size(kept) /= 4 ) error stop
+    if( abs(sum(kept) - 10.0) > 1e-6 ) error stop
+
+contains
+
+    real function local_sum(a, n) result(r)
+        real, intent(in) :: a(:)
+        integer, intent(in) :: n
+        ! Does not escape and only depends on `n`, it is promoted
+        real, allocatable :: work(:)
+        ! Its allocation status is queried, it stays on the heap
+        real, allocatable :: other(:)
+        integer :: k
+        allocate(work(n))
+        ! Filled by elements, an assignment to the whole array could
+        ! reallocate it
+        do k = 1, n
+            work(k) = 2.0 * a(k)
+        end do
+        if( .not. allocated(other) ) allocate(other(size(a)))
+        other = work
+        r = sum(other)
+        deallocate(work)
+    end function
+
+    subroutine fill(b, n)
+        real, allocatable, intent(out) :: b(:)
+        integer, intent(in) :: n
+        ! Moved to the dummy argument, it stays on the heap
+        real, allocatable :: t(:)
+        integer :: j
+        allocate(t(n))
+        do j = 1, n
+            t(j) = j
+        end do
+        ! move_alloc is lowered to the assignment `b = t`, which needs `b`
+        ! allocated unless --realloc-lhs is given
+        allocate(b(n))
+        call move_alloc(t, b)
+    end subroutine
+
+end program allocate_17
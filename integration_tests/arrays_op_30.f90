@@ -0,0 +1,62 @@
+program arrays_op_30
+    implicit none
+    integer, parameter :: n = 10
+    real :: a(n), b(n), c(n), d(n), u(n)
+    real :: x(n, n), y(n, n), z(n, n)
+    integer :: i, j
+
+    do i = 1, n
+        a(i) = i
+    end do
+
+    ! Consecutive elementwise assignments sharing arrays
+    b = a + 1.0
+    c = b * 2.0
+    d = c - b
+    do i = 1, n
+        if( abs(b(i) - (i + 1.0)) > 1e-6 ) error stop
+        if( abs(c(i) - 2.0 * (i + 1.0)) > 1e-6 ) error stop
+        if( abs(d(i) - (i + 1.0)) > 1e-6 ) error stop
+    end do
+
+    ! The second assignment reads b shifted, it must see all of the first one
+    b = a * 3.0
+    c(1:n-1) = b(2:n)
+    do i = 1, n - 1
+        if( abs(c(i) - 3.0 * (i + 1)) > 1e-6 ) error stop
+    end do
+
+    ! Stencil reading ahead of the updated section
+    u = a
+    u(1:n-1) = u(2:n) + u(1:n-1)
+    do i = 1, n - 1
+        if( abs(u(i) - (2.0 * i + 1.0)) > 1e-6 ) error stop
+    end do
+    if( abs(u(n) - n) > 1e-6 ) error stop
+
+    ! Stencil reading behind the updated section needs the old values
+    u = a
+    u(2:n) = u(1:n-1) + u(2:n)
+    do i = 2, n
+        if( abs(u(i) - (2.0 * i - 1.0)) > 1e-6 ) error stop
+    end do
+    if( abs(u(1) - 1.0) > 1e-6 ) error stop
+
+    ! Two dimensional nests
+    do j = 1, n
+        do i = 1, n
+            x(i, j) = i + 10 * j
+        end do
+    end do
+    y = x * 2.0
+    z = y + x
+    y = z - x
+    do j = 1, n
+        do i = 1, n
+            if( abs(z(i, j) - 3.0 * x(i, j)) > 1e-6 ) error stop
+            if( abs(y(i, j) - 2.0 * x(i, j)) > 1e-6 ) error stop
+        end do
+    end do
+
+    print *, sum(c), sum(d), sum(u), sum(z)
+end program arrays_op_30
@@ -0,0 +1,69 @@
+program arrays_op_31
+    implicit none
+    integer, parameter :: n = 8
+    real :: u(n), v(n), w(n)
+    real, allocatable :: x(:)
+    integer :: i, step, m
+
+    do i = 1, n
+        u(i) = i
+        v(i) = 2 * i
+    end do
+
+    ! The temporaries of both stencils have the same shape in every step
+    do step = 1, 3
+        u(2:n) = u(1:n-1) + u(2:n)
+        v(2:n) = v(1:n-1) - v(2:n)
+    end do
+    w = [(real(i), i = 1, n)]
+    call check_steps(u, v, w)
+
+    ! The shape of the temporary changes with the outer loop
+    do m = 2, n
+        w = 0.0
+        do step = 1, 2
+            w(2:m) = w(1:m-1) + 1.0
+        end do
+        do i = 2, m
+            if( abs(w(i) - min(i - 1, 2)) > 1e-6 ) error stop
+        end do
+    end do
+
+    ! A loop that does not run must not evaluate the shape of an
+    ! unallocated array
+    m = 0
+    do step = 1, m
+        x(2:size(x)) = x(1:size(x)-1)
+    end do
+    if( allocated(x) ) error stop
+
+    allocate(x(n))
+    x = 1.0
+    do step = 1, n - 1
+        x(2:size(x)) = x(1:size(x)-1) + x(2:size(x))
+    end do
+    if( abs(x(n) - 2.0 ** (n - 1)) > 1e-3 ) error stop
+
+    print *, sum(u), sum(v), sum(x)
+
+contains
+
+    subroutine check_steps(u, v, w)
+        real, intent(in) :: u(:), v(:), w(:)
+        real :: eu(size(w)), ev(size(w))
+        integer :: i, step
+        eu = w
+        ev = 2 * w
+        do step = 1, 3
+            do i = size(w), 2, -1
+                eu(i) = eu(i - 1) + eu(i)
+                ev(i) = ev(i - 1) - ev(i)
+            end do
+        end do
+        do i = 1, size(w)
+            if( abs(u(i) - eu(i)) > 1e-3 ) error stop
+            if( abs(v(i) - ev(i)) > 1e-3 ) error stop
+        end do
+    end subroutine
+
+end program arrays_op_31
@@ -0,0 +1,196 @@
+program case_08
+    implicit none
+    integer :: i, s
+    integer(8) :: k
+
+    ! Dense labels: a switch
+    s = 0
+    do i = -2, 12
+        s = s + dense(i)
+    end do
+    print *, s
+    if (s /= 271) error stop
+
+    ! Sparse labels and open ranges: a binary search
+    if (sparse(-100) /= 1) error stop
+    if (sparse(-10) /= 1) error stop
+    if (sparse(-9) /= 0) error stop
+    if (sparse(3) /= 2) error stop
+    if (sparse(17) /= 3) error stop
+    if (sparse(100) /= 4) error stop
+    if (sparse(250) /= 4) error stop
+    if (sparse(1000) /= 5) error stop
+    if (sparse(1001) /= 0) error stop
+    if (sparse(4096) /= 6) error stop
+    if (sparse(70000) /= 7) error stop
+    if (sparse(99999) /= 8) error stop
+    if (sparse(100000) /= 9) error stop
+    if (sparse(huge(i)) /= 9) error stop
+    if (sparse(5) /= 0) error stop
+
+    k = 3000000000_8
+    select case (k + 1)
+        case (1:10)
+            error stop
+        case (2999999999_8:3000000001_8)
+            print *, "large"
+        case default
+            error stop
+    end select
+
+    if (keyword("do") /= 3) error stop
+    if (keyword("end") /= 4) error stop
+    if (keyword("end  ") /= 4) error stop
+    if (keyword("if") /= 6) error stop
+    if (keyword("integer") /= 7) error stop
+    if (keyword("print") /= 9) error stop
+    if (keyword("while") /= 10) error stop
+    if (keyword("case") /= 1) error stop
+    if (keyword("call") /= 1) error stop
+    if (keyword("contains") /= 2) error stop
+    if (keyword("zzz") /= 0) error stop
+    if (keyword("e") /= 0) error stop
+    if (keyword("") /= 0) error stop
+
+    ! Blank padding sorts "a" after "a" // achar(9)
+    if (control("a" // achar(9)) /= 1) error stop
+    if (control("a") /= 2) error stop
+    if (control("a ") /= 2) error stop
+    if (control("a" // achar(31)) /= 3) error stop
+    if (control("b") /= 4) error stop
+    if (control("c" // achar(1)) /= 5) error stop
+    if (control("c") /= 6) error stop
+    if (control("d") /= 7) error stop
+    if (control("e") /= 0) error stop
+
+    ! `exit` of the enclosing loop from a case
+    s = 0
+    do i = 1, 10
+        select case (i)
+            case (1)
+                s = s + 1
+            case (2)
+                s = s + 2
+            case (3)
+                s = s + 3
+            case (4)
+                exit
+            case default
+                s = s + 100
+        end select
+    end do
+    print *, s
+    if (s /= 6) error stop
+
+contains
+
+    integer function dense(i) result(r)
+        integer, intent(in) :: i
+        r = 0
+        select case (i)
+            case (0)
+                r = 1
+            case (1)
+                r = 2
+            case (2, 3)
+                r = 4
+            case (4:6)
+                r = 8
+            case (7)
+                r = 16
+            case (8)
+                ! Nested `select case`
+                select case (mod(i, 3))
+                    case (0)
+                        r = -1
+                    case (1)
+                        r = -2
+                    case (2)
+                        r = 32
+                end select
+            case (9)
+                r = 64
+            case (10)
+                r = 128
+            case default
+                r = -1
+        end select
+    end function
+
+    integer function sparse(i) result(r)
+        integer, intent(in) :: i
+        select case (i)
+            case (:-10)
+                r = 1
+            case (1, 3)
+                r = 2
+            case (17)
+                r = 3
+            case (100:250)
+                r = 4
+            case (1000)
+                r = 5
+            case (4096)
+                r = 6
+            case (70000)
+                r = 7
+            case (99999)
+                r = 8
+            case (100000:)
+                r = 9
+            case default
+                r = 0
+        end select
+    end function
+
+    integer function keyword(s) result(r)
+        character(len=*), intent(in) :: s
+        select case (s)
+            case ("call", "case")
+                r = 1
+            case ("contains")
+                r = 2
+            case ("do")
+                r = 3
+            case ("end")
+                r = 4
+            case ("function")
+                r = 5
+            case ("if")
+                r = 6
+            case ("integer")
+                r = 7
+            case ("module")
+                r = 8
+            case ("print")
+                r = 9
+            case ("while")
+                r = 10
+            case default
+                r = 0
+        end select
+    end function
+
+    integer function control(s) result(r)
+        character(len=*), intent(in) :: s
+        select case (s)
+            case ("a" // achar(9))
+                r = 1
+            case ("a")
+                r = 2
+            case ("a" // achar(31))
+                r = 3
+            case ("b")
+                r = 4
+            case ("c" // achar(1))
+                r = 5
+            case ("c")
+                r = 6
+            case ("d")
+                r = 7
+            case default
+                r = 0
+        end select
+    end function
+
+end program
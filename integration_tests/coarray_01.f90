@@ -0,0 +1,64 @@
+program coarray_01
+    implicit none
+    integer :: counter[*]
+    real(8) :: x(4)[*]
+    real(8) :: s(4)
+    integer :: me, n, i, total
+    complex :: z
+    logical :: first
+
+    me = this_image()
+    n = num_images()
+    if (me < 1 .or. me > n) error stop
+
+    counter = me
+    x = [(real(me*i, 8), i = 1, 4)]
+    sync all
+
+    ! Read the coarrays of other images
+    if (counter[mod(me, n) + 1] /= mod(me, n) + 1) error stop
+    s = x(:)[1]
+    if (abs(s(4) - 4) > 1e-12_8) error stop
+    if (abs(x(2)[n] - 2*n) > 1e-12_8) error stop
+    sync all
+
+    ! Write to the coarray of the last image
+    if (me == 1) counter[n] = 100
+    sync all
+    if (me == n .and. counter /= 100) error stop
+
+    total = me
+    call co_sum(total)
+    if (total /= n*(n + 1)/2) error stop
+    total = me
+    call co_max(total, result_image=1)
+    if (me == 1 .and. total /= n) error stop
+    total = me
+    call co_min(total)
+    if (total /= 1) error stop
+
+    s = me
+    call co_sum(s)
+    if (any(abs(s - n*(n + 1)/2) > 1e-12_8)) error stop
+    z = cmplx(me, -me)
+    call co_sum(z)
+    if (abs(real(z) - n*(n + 1)/2) > 1e-5 .or. abs(aimag(z) + n*(n + 1)/2) > 1e-5) error stop
+
+    first = me == 1
+    call co_broadcast(first, source_image=1)
+    if (.not. first) error stop
+    s = 0
+    if (me == n) s = [1, 2, 3, 4]
+    call co_broadcast(s, n)
+    if (abs(s(3) - 3) > 1e-12_8) error stop
+
+    if (me == 1) then
+        sync images(*)
+    else
+        sync images(1)
+    end if
+    call random_init(.false., .true.)
+    call random_number(s)
+    if (any(s < 0 .or. s >= 1)) error stop
+    print *, me, n, total
+end program
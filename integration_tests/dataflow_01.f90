@@ -0,0 +1,134 @@
+module dataflow_01_mod
+    implicit none
+
+contains
+
+    integer function linear_index(i, j, n) result(k)
+        integer, intent(in) :: i, j, n
+        k = (j - 1)*n + i
+    end function
+
+    subroutine stencil(a, b, n, scale)
+        integer, intent(in) :: n
+        real, intent(in) :: scale
+        real, intent(inout) :: a(n*n)
+        real, intent(in) :: b(n*n)
+        integer :: i, j
+        do j = 2, n - 1
+            do i = 2, n - 1
+                a((j - 1)*n + i) = b((j - 1)*n + i) * (2.0 * scale) &
+                    + b((j - 1)*n + i - 1) + b((j - 1)*n + i + 1)
+            end do
+        end do
+    end subroutine
+
+    integer function classify(x) result(r)
+        integer, intent(in) :: x
+        integer :: lo, hi, mid
+        lo = 10
+        hi = lo * 2
+        mid = (lo + hi) / 2
+        if (x < lo) then
+            r = 1
+        else if (x < mid) then
+            r = 2
+        else if (x <= hi) then
+            r = 3
+        else
+            r = 4
+        end if
+    end function
+
+end module
+
+program dataflow_01
+    use dataflow_01_mod
+    implicit none
+    integer, parameter :: n = 6
+    real :: a(n*n), b(n*n)
+    integer :: i, j, k, m, s, t, flag
+    logical :: debug
+
+    ! Constants that only survive the join because one branch is dead
+    debug = .false.
+    m = 4
+    if (debug) then
+        m = 5
+    end if
+    k = m * 3
+    if (k /= 12) error stop
+
+    ! A loop that never runs must not clobber the constant
+    t = 7
+    do while (m > 10)
+        t = t + 1
+        m = m - 1
+    end do
+    if (t /= 7) error stop
+
+    ! Values that are only constant on the first iteration
+    s = 0
+    flag = 1
+    do i = 1, 5
+        s = s + flag
+        flag = flag + 1
+    end do
+    if (s /= 15) error stop
+    if (flag /= 6) error stop
+
+    ! Repeated index arithmetic, with a redefinition in between
+    do j = 1, n
+        do i = 1, n
+            b(linear_index(i, j, n)) = real(i + 10*j)
+        end do
+    end do
+    a = 0.0
+    call stencil(a, b, n, 0.5)
+    do j = 2, n - 1
+        do i = 2, n - 1
+            k = (j - 1)*n + i
+            if (abs(a(k) - (b(k) + b(k - 1) + b(k + 1))) > 1e-5) error stop
+        end do
+    end do
+    i = 2
+    k = i*n + 1
+    i = i + 1
+    if (k == i*n + 1) error stop
+    if (i*n + 1 /= 19) error stop
+
+    ! Exit and cycle leave values that differ from the loop head
+    s = 0
+    t = 0
+    do i = 1, 10
+        t = i
+        if (mod(i, 2) == 0) cycle
+        s = s + i
+        if (i > 6) exit
+    end do
+    if (s /= 16) error stop
+    if (t /= 7) error stop
+
+    ! Invariant operands defined before the loop, variant ones inside it
+    m = 3
+    s = 0
+    do i = 1, 4
+        s = s + m*n + i
+        if (i == 2) m = m + 1
+    end do
+    if (s /= 18 + 18 + 24 + 24 + 10) error stop
+
+    do i = 1, 25
+        select case (classify(i))
+            case (1)
+                if (i >= 10) error stop
+            case (2)
+                if (i < 10 .or. i >= 15) error stop
+            case (3)
+                if (i < 15 .or. i > 20) error stop
+            case default
+                if (i <= 20) error stop
+        end select
+    end do
+
+    print *, sum(a), s, k
+end program
@@ -0,0 +1,34 @@
+program doconcurrentloop_03
+    implicit none
+    integer, parameter :: n = 20000
+    integer :: i, j
+    real(8) :: a(n), b(n), s
+    integer :: grid(100, 50)
+
+    do i = 1, n
+        b(i) = i
+    end do
+
+    do concurrent (i = 1:n)
+        a(i) = 2 * b(i) + square(b(i))
+    end do
+    if (abs(a(n) - (2.0d0 * n + real(n, 8)**2)) > 1d-6) error stop
+
+    s = sum(a)
+    print *, s
+    if (abs(s - 2667266690000.0d0) > 1d-3) error stop
+
+    do concurrent (i = 1:100, j = 1:50)
+        grid(i, j) = i * 1000 + j
+    end do
+    if (grid(37, 41) /= 37041) error stop
+    if (sum(grid) /= 50 * 5050 * 1000 + 100 * 1275) error stop
+
+contains
+
+    pure real(8) function square(x) result(r)
+        real(8), intent(in) :: x
+        r = x * x
+    end function
+
+end program
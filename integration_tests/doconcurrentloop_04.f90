@@ -0,0 +1,39 @@
+program doconcurrentloop_04
+    ! A STREAM like triad on arrays large enough to be first touched on the
+    ! thread pool when LFORTRAN_FIRST_TOUCH is set
+    implicit none
+    integer, parameter :: n = 1000000
+    real(8), allocatable :: a(:), b(:), c(:)
+    real(8) :: q
+    integer :: i, k
+
+    allocate(a(n), b(n), c(n))
+    do concurrent (i = 1:n)
+        a(i) = 1
+        b(i) = 2
+        c(i) = 0
+    end do
+
+    q = 3
+    do k = 1, 3
+        do concurrent (i = 1:n)
+            c(i) = a(i)
+        end do
+        do concurrent (i = 1:n)
+            b(i) = q*c(i)
+        end do
+        do concurrent (i = 1:n)
+            c(i) = a(i) + b(i)
+        end do
+        do concurrent (i = 1:n)
+            a(i) = b(i) + q*c(i)
+        end do
+    end do
+
+    print *, a(1), b(n), c(n/2)
+    if (abs(a(1) - 3375) > 1e-9_8) error stop
+    if (abs(b(n) - 675) > 1e-9_8) error stop
+    if (abs(c(n/2) - 900) > 1e-9_8) error stop
+    if (abs(sum(a) - 3375._8*n) > 1e-3_8) error stop
+    deallocate(a, b, c)
+end program
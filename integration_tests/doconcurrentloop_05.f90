@@ -0,0 +1,61 @@
+program doconcurrentloop_05
+    ! Bounds that refer to the arrays of the loop and empty stepped ranges on
+    ! the thread pool
+    implicit none
+    integer :: a(10), b(7, 5), i, j, n
+    real(8), allocatable :: x(:)
+
+    a = 0
+    do concurrent (i = 1:size(a))
+        a(i) = i
+    end do
+    print *, sum(a)
+    if (sum(a) /= 55) error stop
+
+    b = 0
+    do concurrent (i = lbound(b, 1):ubound(b, 1):2, j = 1:size(b, 2))
+        b(i, j) = i + 10*j
+    end do
+    print *, sum(b)
+    if (sum(b) /= 16*5 + 4*150) error stop
+
+    allocate(x(100))
+    call scale(x, 2.0_8)
+    print *, sum(x)
+    if (abs(sum(x) - 200) > 1e-12_8) error stop
+
+    n = 0
+    a = 0
+    do concurrent (i = 1:n:2, j = 1:3)
+        a(j) = 1
+    end do
+    print *, sum(a)
+    if (sum(a) /= 0) error stop
+
+    do concurrent (i = 3:2:4, j = 1:2)
+        a(j) = 1
+    end do
+    print *, sum(a)
+    if (sum(a) /= 0) error stop
+
+    do concurrent (i = 5:1:1)
+        a(i) = 1
+    end do
+    do concurrent (i = 1:5:-1)
+        a(i) = 1
+    end do
+    print *, sum(a)
+    if (sum(a) /= 0) error stop
+
+contains
+
+    subroutine scale(y, q)
+    real(8), intent(out) :: y(:)
+    real(8), intent(in) :: q
+    integer :: k
+    do concurrent (k = 1:size(y))
+        y(k) = q
+    end do
+    end subroutine
+
+end program
@@ -0,0 +1,51 @@
+module elemental_vector_01_mod
+implicit none
+
+contains
+
+    elemental real(8) function gauss(x) result(r)
+        real(8), intent(in) :: x
+        r = exp(-x*x/2) / sqrt(2*3.14159265358979d0)
+    end function
+
+end module
+
+program elemental_vector_01
+use elemental_vector_01_mod
+implicit none
+
+integer, parameter :: n = 1000
+real(8) :: x(n), y(n), z(n)
+real :: xs(n), ys(n)
+integer :: i
+
+do i = 1, n
+    x(i) = (i - n/2) * 0.01d0
+    xs(i) = real(x(i))
+end do
+
+y = sin(x)**2 + cos(x)**2
+print *, sum(y)
+if (abs(sum(y) - n) > 1d-9) error stop
+
+y = log(exp(x))
+if (maxval(abs(y - x)) > 1d-12) error stop
+
+z = tanh(x) - (exp(2*x) - 1) / (exp(2*x) + 1)
+if (maxval(abs(z)) > 1d-12) error stop
+
+z = erf(x) + erf(-x)
+if (maxval(abs(z)) > 1d-15) error stop
+if (abs(erf(x(600)) - 0.8427007929497149d0) > 1d-15) error stop
+
+ys = sin(xs) - sin(real(x))
+if (maxval(abs(ys)) > 1e-6) error stop
+ys = tanh(xs) + tanh(-xs)
+if (maxval(abs(ys)) > 1e-6) error stop
+
+z = gauss(x)
+print *, sum(z) * 0.01d0
+if (abs(sum(z) * 0.01d0 - 1) > 1d-6) error stop
+if (abs(z(n/2) - 1 / sqrt(2*3.14159265358979d0)) > 1d-12) error stop
+
+end program
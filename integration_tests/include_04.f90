@@ -0,0 +1,21 @@
+program include_04
+! The same include file is used twice, the second time it comes from the
+! include cache (see `--cache-dir`)
+implicit none
+
+include 'i.inc'
+print *, i
+if (i /= 4) error stop
+call sub()
+
+contains
+
+    subroutine sub()
+    include 'i.inc'
+    integer :: x(i)
+    x = i
+    print *, sum(x)
+    if (sum(x) /= 16) error stop
+    end subroutine
+
+end program include_04
@@ -0,0 +1,96 @@
+module inline_01_mod
+implicit none
+
+type :: point
+    real :: x, y
+end type
+
+contains
+
+    real function get_x(p) result(r)
+        type(point), intent(in) :: p
+        r = p%x
+    end function
+
+    subroutine set_x(p, v)
+        type(point), intent(inout) :: p
+        real, intent(in) :: v
+        p%x = v
+    end subroutine
+
+    integer function clamp(i, lo, hi) result(r)
+        integer, intent(in) :: i, lo, hi
+        r = i
+        if (r < lo) r = lo
+        if (r > hi) r = hi
+    end function
+
+    subroutine accumulate(s, v)
+        real, intent(inout) :: s
+        real, intent(in) :: v
+        s = s + v
+    end subroutine
+
+    subroutine split(n, q, r)
+        integer, intent(in) :: n
+        integer, intent(out) :: q, r
+        q = n / 3
+        r = n - 3*q
+    end subroutine
+
+    recursive integer function fib(n) result(r)
+        integer, intent(in) :: n
+        if (n < 2) then
+            r = n
+        else
+            r = fib(n - 1) + fib(n - 2)
+        end if
+    end function
+
+    integer function counter() result(r)
+        integer, save :: calls = 0
+        calls = calls + 1
+        r = calls
+    end function
+
+end module
+
+program inline_01
+use inline_01_mod
+implicit none
+type(point) :: p
+real :: s
+integer :: i, q, r, total
+
+p%x = 1.0
+p%y = 2.0
+s = 0.0
+do i = 1, 100
+    call set_x(p, real(i))
+    call accumulate(s, get_x(p))
+end do
+print *, s, get_x(p)
+if (abs(s - 5050.0) > 1e-3) error stop
+if (abs(get_x(p) - 100.0) > 1e-6) error stop
+
+total = 0
+do i = -5, 15
+    total = total + clamp(i, 0, 10)
+end do
+print *, total
+if (total /= 105) error stop
+
+call split(17, q, r)
+print *, q, r
+if (q /= 5 .or. r /= 2) error stop
+
+print *, fib(15)
+if (fib(15) /= 610) error stop
+
+total = 0
+do i = 1, 3
+    total = total + counter()
+end do
+print *, total
+if (total /= 6) error stop
+end program
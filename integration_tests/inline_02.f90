@@ -0,0 +1,47 @@
+module inline_02_mod
+implicit none
+
+type :: box
+    integer :: n
+end type
+
+integer :: module_counter = 0
+
+contains
+
+    subroutine bump(k)
+        integer :: k
+        k = k + 1
+    end subroutine
+
+    integer function bump_and_get(k) result(r)
+        integer :: k
+        k = k + 10
+        r = k
+    end function
+
+end module
+
+program inline_02
+use inline_02_mod
+implicit none
+integer :: a(3), i, v
+type(box) :: b
+
+a = 0
+b%n = 0
+do i = 1, 3
+    call bump(a(i))
+    call bump(a(2))
+    call bump(b%n)
+    call bump(module_counter)
+end do
+print *, a, b%n, module_counter
+if (any(a /= [1, 4, 1])) error stop
+if (b%n /= 3) error stop
+if (module_counter /= 3) error stop
+
+v = bump_and_get(a(1))
+print *, v, a(1)
+if (v /= 11 .or. a(1) /= 11) error stop
+end program
@@ -0,0 +1,60 @@
+program loop_interchange_01
+implicit none
+integer, parameter :: n = 37, m = 29
+real :: a(0:n+1, 0:m+1), b(n, m), t(m, n), c(n, m), r(n, n)
+integer :: g(n, m)
+integer :: i, j, k, p, q
+
+do j = 0, m + 1
+    do i = 0, n + 1
+        a(i, j) = real(mod(3*i + 7*j, 11))
+    end do
+end do
+
+! Row-first stencil: the nest is interchanged so that `i` runs innermost
+do i = 1, n
+    do j = 1, m
+        b(i, j) = a(i - 1, j) + a(i + 1, j) + a(i, j - 1) + a(i, j + 1) - 4.0*a(i, j)
+    end do
+end do
+if (abs(sum(abs(b)) - 15026.0) > 1e-2) error stop
+if (abs(b(5, 7) - (-22.0)) > 1e-6) error stop
+
+! Transpose: both orders walk one array with a stride, only tiling helps
+do i = 1, n
+    do j = 1, m
+        t(j, i) = b(i, j)
+    end do
+end do
+if (any(t /= transpose(b))) error stop
+
+! g(i, j) depends on g(i + 1, j - 1): interchanging would read elements
+! before they are written
+g = 1
+do i = 1, n - 1
+    do j = 2, m
+        g(i, j) = g(i + 1, j - 1) + 1
+    end do
+end do
+if (g(1, m) /= 2) error stop
+if (sum(g) /= 2081) error stop
+
+! The loop variables are printed after the nest, so it must stay as is
+do p = 1, n
+    do q = 1, m
+        c(p, q) = real(p) * real(q)
+    end do
+end do
+print *, p, q
+if (p /= n + 1 .or. q /= m + 1) error stop
+
+r = matmul(b, transpose(c))
+k = 0
+do j = 1, n
+    do i = 1, n
+        if (abs(r(i, j) - sum(b(i, :) * c(j, :))) > 1e-2) k = k + 1
+    end do
+end do
+if (k /= 0) error stop
+print *, sum(abs(b)), sum(abs(t)), sum(g)
+end program
@@ -0,0 +1,61 @@
+module nested_vars_02_mod
+implicit none
+contains
+    ! Each activation of `triangle` owns its own `total`, so the internal
+    ! procedures must not share it between recursive calls.
+    recursive function triangle(n) result(r)
+        integer, intent(in) :: n
+        integer :: r
+        integer :: total
+        total = 0
+        call add(n)
+        if (n > 1) then
+            call add(triangle(n - 1))
+        end if
+        call check_positive()
+        r = total
+    contains
+        subroutine add(k)
+            integer, intent(in) :: k
+            total = total + k
+        end subroutine
+
+        subroutine check_positive()
+            if (get_total() <= 0) error stop
+        end subroutine
+
+        integer function get_total()
+            get_total = total
+        end function
+    end function
+end module
+
+program nested_vars_02
+use nested_vars_02_mod, only: triangle
+implicit none
+integer :: i, s
+real(8) :: x
+s = 0
+x = 1.0d0
+do i = 1, 10
+    call accumulate(i)
+end do
+print *, triangle(10), s, x
+if (triangle(10) /= 55) error stop
+if (s /= 55) error stop
+if (abs(x - 3628800.0d0) > 1d-6) error stop
+
+contains
+
+    subroutine accumulate(k)
+        integer, intent(in) :: k
+        s = s + k
+        call scale(real(k, 8))
+    end subroutine
+
+    subroutine scale(f)
+        real(8), intent(in) :: f
+        x = x * f
+    end subroutine
+
+end program
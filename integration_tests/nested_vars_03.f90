@@ -0,0 +1,55 @@
+module nested_vars_03_mod
+implicit none
+contains
+    ! `add` captures a scalar here, so it gets the host variable as an
+    ! extra argument
+    recursive function triangle(n) result(r)
+        integer, intent(in) :: n
+        integer :: r
+        integer :: total
+        total = 0
+        call add(n)
+        if (n > 1) then
+            call add(triangle(n - 1))
+        end if
+        r = get()
+    contains
+        subroutine add(k)
+            integer, intent(in) :: k
+            total = total + k
+        end subroutine
+
+        integer function get()
+            get = total
+        end function
+    end function
+
+    ! while the `add` of this host captures an array and goes through the
+    ! global context instead
+    integer function histogram(n) result(r)
+        integer, intent(in) :: n
+        integer :: bins(0:4), i
+        bins = 0
+        do i = 1, n
+            call add(mod(i, 5))
+        end do
+        r = get()
+    contains
+        subroutine add(k)
+            integer, intent(in) :: k
+            bins(k) = bins(k) + 1
+        end subroutine
+
+        integer function get()
+            get = bins(0) * 1000 + bins(1)
+        end function
+    end function
+end module
+
+program nested_vars_03
+use nested_vars_03_mod, only: triangle, histogram
+implicit none
+print *, triangle(10), histogram(12)
+if (triangle(10) /= 55) error stop
+if (histogram(12) /= 2003) error stop
+end program
@@ -0,0 +1,82 @@
+program openmp_44
+    use omp_lib
+    implicit none
+    integer, parameter :: n = 1000
+    integer :: i, chunk
+    integer :: row_len(n)
+    real(8) :: work(n), total
+
+    ! Triangular work per row, so that a block partition is unbalanced
+    do i = 1, n
+        row_len(i) = i
+    end do
+
+    chunk = 7
+    work = 0
+    !$omp parallel do schedule(dynamic, chunk) shared(work, row_len) private(i)
+    do i = 1, n
+        work(i) = triangle(row_len(i))
+    end do
+    !$omp end parallel do
+    call check(work, "dynamic")
+
+    work = 0
+    !$omp parallel do schedule(guided) shared(work, row_len) private(i)
+    do i = 1, n
+        work(i) = triangle(row_len(i))
+    end do
+    !$omp end parallel do
+    call check(work, "guided")
+
+    work = 0
+    !$omp parallel do schedule(static, 16) shared(work, row_len) private(i)
+    do i = 1, n
+        work(i) = triangle(row_len(i))
+    end do
+    !$omp end parallel do
+    call check(work, "static")
+
+    work = 0
+    !$omp parallel do schedule(runtime) shared(work, row_len) private(i)
+    do i = 1, n
+        work(i) = triangle(row_len(i))
+    end do
+    !$omp end parallel do
+    call check(work, "runtime")
+
+    ! Default chunk of 1, the reductions are tested by openmp_45
+    work = 0
+    !$omp parallel do schedule(dynamic) shared(work) private(i)
+    do i = 1, n
+        work(i) = i
+    end do
+    !$omp end parallel do
+    total = sum(work)
+    print *, total
+    if (abs(total - 500500.0d0) > 1d-8) error stop
+
+contains
+
+    pure real(8) function triangle(m) result(r)
+        integer, intent(in) :: m
+        integer :: k
+        r = 0
+        do k = 1, m
+            r = r + k
+        end do
+    end function
+
+    subroutine check(w, kind)
+        real(8), intent(in) :: w(:)
+        character(len=*), intent(in) :: kind
+        integer :: j
+        do j = 1, size(w)
+            if (abs(w(j) - real(j, 8) * (j + 1) / 2) > 1d-8) then
+                print *, kind, j, w(j)
+                error stop
+            end if
+        end do
+        print *, kind, " ok"
+    end subroutine
+
+end program
@@ -0,0 +1,52 @@
+program openmp_45
+    use omp_lib
+    implicit none
+    integer, parameter :: n = 10000
+    integer :: i, imax, imin
+    integer(8) :: isum
+    real(8) :: dsum, dmax
+    real :: hist(8)
+
+    isum = 0
+    dsum = 0
+    !$omp parallel do reduction(+:isum, dsum) private(i)
+    do i = 1, n
+        isum = isum + i
+        dsum = dsum + 0.5d0 * i
+    end do
+    !$omp end parallel do
+    print *, isum, dsum
+    if (isum /= 50005000_8) error stop
+    if (abs(dsum - 25002500.0d0) > 1d-6) error stop
+
+    imax = 0
+    dmax = -huge(dmax)
+    !$omp parallel do reduction(max:imax, dmax) private(i)
+    do i = 1, n
+        imax = max(imax, mod(i * 7, 1013) - 500)
+        dmax = max(dmax, -real(i, 8))
+    end do
+    !$omp end parallel do
+    print *, imax, dmax
+    if (imax /= 512) error stop
+    if (abs(dmax + 1.0d0) > 1d-12) error stop
+
+    imin = 0
+    !$omp parallel do reduction(min:imin) private(i)
+    do i = 1, n
+        imin = min(imin, mod(i * 7, 1013) - 500)
+    end do
+    !$omp end parallel do
+    print *, imin
+    if (imin /= -500) error stop
+
+    hist = 0
+    !$omp parallel do reduction(+:hist) private(i)
+    do i = 1, n
+        hist(mod(i, 8) + 1) = hist(mod(i, 8) + 1) + 1
+    end do
+    !$omp end parallel do
+    print *, hist
+    if (any(abs(hist - 1250) > 1e-6)) error stop
+
+end program
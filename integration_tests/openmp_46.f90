@@ -0,0 +1,81 @@
+program openmp_46
+    use omp_lib
+    implicit none
+    integer :: i, j, k, n, s
+    integer(8) :: total
+    integer :: c(3)
+    integer :: visits(0:9, -2:4, 3:17)
+
+    ! Every point of a collapsed 3D space is visited exactly once
+    visits = 0
+    !$omp parallel do collapse(3) shared(visits) private(i, j, k)
+    do i = 0, 9
+        do j = -2, 4
+            do k = 3, 17
+                visits(i, j, k) = visits(i, j, k) + 1
+            end do
+        end do
+    end do
+    !$omp end parallel do
+    print *, sum(visits)
+    if (any(visits /= 1)) error stop
+
+    ! Dynamic chunks start in the middle of the inner dimensions
+    total = 0
+    !$omp parallel do collapse(3) schedule(dynamic, 13) reduction(+:total) private(i, j, k)
+    do i = 1, 10
+        do j = 1, 7
+            do k = 1, 15
+                total = total + i * 10000 + j * 100 + k
+            end do
+        end do
+    end do
+    !$omp end parallel do
+    print *, total
+    if (total /= 58178400_8) error stop
+
+    ! Empty stepped ranges are not run at all
+    n = 0
+    c = 0
+    do concurrent (i = 1:n:2, j = 1:3)
+        c(j) = c(j) + 1
+    end do
+    do concurrent (i = 3:2:4, j = 1:2)
+        c(j) = c(j) + 1
+    end do
+    print *, sum(c)
+    if (sum(c) /= 0) error stop
+
+    s = 0
+    !$omp parallel do reduction(+:s)
+    do i = 1, 0, 2
+        s = s + 1
+    end do
+    !$omp end parallel do
+    print *, s
+    if (s /= 0) error stop
+
+    s = 0
+    !$omp parallel do collapse(2) reduction(+:s) private(i, j)
+    do i = 1, n, 2
+        do j = 1, 3
+            s = s + 1
+        end do
+    end do
+    !$omp end parallel do
+    print *, s
+    if (s /= 0) error stop
+
+    ! while negative steps still count every point
+    s = 0
+    !$omp parallel do collapse(2) reduction(+:s) private(i, j)
+    do i = 10, 1, -3
+        do j = 7, 2, -2
+            s = s + i * j
+        end do
+    end do
+    !$omp end parallel do
+    print *, s
+    if (s /= 22 * 15) error stop
+
+end program
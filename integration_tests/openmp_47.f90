@@ -0,0 +1,87 @@
+module openmp_47_mod
+    implicit none
+    integer, parameter :: tree_size = 1023
+    integer :: tree(tree_size)
+
+contains
+
+    recursive function fib(n) result(r)
+        integer, intent(in) :: n
+        integer(8) :: r, x, y
+        if (n < 2) then
+            r = n
+        else if (n < 15) then
+            r = fib(n - 1) + fib(n - 2)
+        else
+            !$omp task shared(x)
+            x = fib(n - 1)
+            !$omp end task
+            !$omp task shared(y)
+            y = fib(n - 2)
+            !$omp end task
+            !$omp taskwait
+            r = x + y
+        end if
+    end function
+
+    ! Sums the subtree of `node` of the binary tree stored in `tree`
+    recursive function tree_sum(node) result(total)
+        integer, intent(in) :: node
+        integer(8) :: total, left, right
+        if (node > tree_size) then
+            total = 0
+            return
+        end if
+        !$omp task shared(left)
+        left = tree_sum(2 * node)
+        !$omp end task
+        !$omp task shared(right)
+        right = tree_sum(2 * node + 1)
+        !$omp end task
+        !$omp taskwait
+        total = tree(node) + left + right
+    end function
+
+end module
+
+program openmp_47
+    use openmp_47_mod
+    implicit none
+    integer :: i
+    integer(8) :: total
+    integer(8) :: squares(1000)
+    integer :: counts(8)
+
+    total = fib(25)
+    print *, total
+    if (total /= 75025) error stop
+
+    do i = 1, tree_size
+        tree(i) = i
+    end do
+    total = tree_sum(1)
+    print *, total
+    if (total /= 523776) error stop
+
+    ! Every iteration of a taskloop runs exactly once
+    squares = 0
+    !$omp taskloop grainsize(64) shared(squares)
+    do i = 1, 1000
+        squares(i) = squares(i) + int(i, 8) * i
+    end do
+    !$omp end taskloop
+    print *, sum(squares)
+    if (sum(squares) /= 333833500_8) error stop
+
+    ! A taskgroup waits for all of its tasks
+    counts = 0
+    !$omp taskgroup
+    do i = 1, 8
+        !$omp task firstprivate(i) shared(counts)
+        counts(i) = counts(i) + i
+        !$omp end task
+    end do
+    !$omp end taskgroup
+    print *, counts
+    if (any(counts /= [(i, i = 1, 8)])) error stop
+end program
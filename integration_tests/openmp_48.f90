@@ -0,0 +1,64 @@
+module openmp_48_mod
+    implicit none
+
+contains
+
+    real(8) function axpy(a, x, y)
+        real(8), intent(in) :: a, x, y
+        !$omp declare simd(axpy) uniform(a)
+        axpy = a*x + y
+    end function
+
+end module
+
+program openmp_48
+    use openmp_48_mod
+    implicit none
+    integer, parameter :: n = 1000
+    real(8), allocatable :: x(:), y(:), z(:)
+    real(8) :: total
+    integer :: i
+
+    allocate(x(n), y(n), z(n))
+    do concurrent (i = 1:n)
+        x(i) = i
+        y(i) = 2*i
+    end do
+
+    !$omp simd aligned(x, y, z: 16)
+    do i = 1, n
+        z(i) = x(i) + y(i)
+    end do
+    !$omp end simd
+    if (abs(z(n) - 3*n) > 1e-12_8) error stop
+    if (abs(sum(z) - 1501500._8) > 1e-8_8) error stop
+
+    ! z(i) depends on z(i - 4), only 4 iterations may run at once
+    !$omp simd safelen(4)
+    do i = 5, n
+        z(i) = z(i - 4) + 1
+    end do
+    if (abs(z(9) - 5) > 1e-12_8) error stop
+    if (abs(z(n) - 12 - (n - 4)/4) > 1e-12_8) error stop
+
+    total = 0
+    !$omp simd simdlen(4) reduction(+:total)
+    do i = 1, n
+        total = total + axpy(2._8, x(i), y(i))
+    end do
+    print *, total
+    if (abs(total - 4*500500._8) > 1e-8_8) error stop
+
+    !$omp parallel do simd simdlen(8) shared(x, y, z)
+    do i = 1, n
+        z(i) = axpy(3._8, x(i), -y(i))
+    end do
+    !$omp end parallel do simd
+    if (abs(sum(z) - 500500._8) > 1e-8_8) error stop
+
+    do concurrent (i = 1:n)
+        z(i) = x(i)*y(i)
+    end do
+    print *, z(n)
+    if (abs(z(n) - 2._8*n*n) > 1e-6_8) error stop
+end program
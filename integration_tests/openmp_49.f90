@@ -0,0 +1,40 @@
+program openmp_49
+    ! Calls into the runtime library from several threads: random numbers
+    ! and formatted I/O on one unit per thread
+    use omp_lib
+    implicit none
+    integer, parameter :: n = 8, m = 200
+    real :: x(m, n)
+    integer :: i, j, u, v, total
+    character(len=32) :: name
+
+    x = -1
+    !$omp parallel do private(i, j, u, name)
+    do i = 1, n
+        call random_number(x(:, i))
+        write(name, '(a,i0,a)') "openmp_49_", i, ".txt"
+        open(newunit=u, file=name, status="replace", action="write")
+        do j = 1, m
+            write(u, '(i0)') i * j
+        end do
+        close(u)
+    end do
+    !$omp end parallel do
+
+    print *, minval(x), maxval(x)
+    if (minval(x) < 0 .or. maxval(x) >= 1) error stop
+
+    total = 0
+    do i = 1, n
+        write(name, '(a,i0,a)') "openmp_49_", i, ".txt"
+        open(newunit=u, file=name, status="old", action="read")
+        do j = 1, m
+            read(u, *) v
+            if (v /= i * j) error stop
+            total = total + v
+        end do
+        close(u, status="delete")
+    end do
+    print *, total
+    if (total /= (n * (n + 1) / 2) * (m * (m + 1) / 2)) error stop
+end program
@@ -0,0 +1,86 @@
+program parallel_reduction_01
+    implicit none
+    ! n is the smallest size that is reduced on the thread pool, the
+    ! arrays are allocatable and filled without stack temporaries
+    integer, parameter :: n = 2**18, k = 512
+    integer :: i, j
+    integer, allocatable :: a(:), b(:, :)
+    integer(8), allocatable :: a8(:)
+    real, allocatable :: x(:)
+    real(8), allocatable :: y(:), z(:, :)
+    logical, allocatable :: m(:)
+
+    allocate(a(n), b(k, k), a8(n), x(n), y(n), z(k, k), m(n))
+    do i = 1, n
+        a(i) = mod(i, 1001) - 500
+        a8(i) = i
+        x(i) = 1
+        y(i) = i
+        m(i) = mod(i, 7) == 0
+    end do
+    do j = 1, k
+        do i = 1, k
+            b(i, j) = a(i + k*(j - 1))
+            z(i, j) = y(i + k*(j - 1))
+        end do
+    end do
+
+    print *, sum(a), sum(a8), sum(x), sum(y)
+    if (sum(a) /= sum_loop(a)) error stop
+    if (sum(a8) /= 34359869440_8) error stop
+    if (abs(sum(x) - 262144.0) > 0.5) error stop
+    if (abs(sum(y) - 34359869440._8) > 1e-3_8) error stop
+    if (sum(b) /= sum(a)) error stop
+    if (abs(sum(z) - sum(y)) > 1e-3_8) error stop
+
+    ! non-contiguous sections take the generated loops
+    if (sum(a8(1::2)) /= 17179869184_8) error stop
+    if (abs(sum(z(1:k - 1:2, :)) - sum(y(1:n:2))) > 1e-3_8) error stop
+
+    ! dim= and mask= variants
+    if (sum(sum(b, dim=1)) /= sum(a)) error stop
+    if (sum(b(:, 3), mask=b(:, 3) > 0) /= sum_loop(max(b(:, 3), 0))) error stop
+    if (sum(a8, mask=m) /= 4908627675_8) error stop
+
+    print *, maxval(a), minval(a), maxval(y), minval(y)
+    if (maxval(a) /= 500 .or. minval(a) /= -500) error stop
+    if (maxval(a8) /= n .or. minval(a8) /= 1) error stop
+    if (maxval(y) /= n .or. minval(y) /= 1) error stop
+    if (maxval(z) /= n .or. minval(z) /= 1) error stop
+    if (maxval(maxval(b, dim=1)) /= 500 .or. minval(minval(b, dim=2)) /= -500) error stop
+    if (maxval(a, mask=a < 0) /= -1) error stop
+
+    a = 1
+    a(n/2) = 2
+    a(n) = 3
+    x(17) = 2
+    print *, product(a), product(x)
+    if (product(a) /= 6) error stop
+    if (abs(product(x) - 2) > 1e-6) error stop
+    if (product(a(1:n - 1)) /= 2) error stop
+
+    print *, count(m), any(m), all(m)
+    if (count(m) /= n/7) error stop
+    if (count(m(::2)) /= 18725) error stop
+    if (.not. any(m) .or. all(m)) error stop
+    m = .false.
+    if (any(m) .or. count(m) /= 0) error stop
+    m(n) = .true.
+    if (.not. any(m)) error stop
+    m = .true.
+    if (.not. all(m) .or. count(m, kind=8) /= n) error stop
+    m(1) = .false.
+    if (all(m)) error stop
+
+contains
+
+    integer function sum_loop(v) result(r)
+        integer, intent(in) :: v(:)
+        integer :: j
+        r = 0
+        do j = 1, size(v)
+            r = r + v(j)
+        end do
+    end function
+
+end program
@@ -102,7 +102,8 @@ def single_test(test: Dict, verbose: bool, no_llvm: bool, skip_run_with_dbg: boo
                         "class_constructor", "implied_do_loops",
                         "pass_array_by_data", "init_expr", "where",
                         "nested_vars", "insert_deallocate", "openmp",
-                        "array_struct_temporary"] and
+                        "array_struct_temporary",
+                        "promote_allocatable_to_nonallocatable"] and
                 _pass not in optimization_passes):
                 raise Exception(f"Unknown pass: {_pass}")
     if update_reference:
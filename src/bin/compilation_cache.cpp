@@ -0,0 +1,372 @@
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <bin/compilation_cache.h>
+#include <lfortran/parser/include_cache.h>
+#include <libasr/config.h>
+#include <libasr/stacktrace.h>
+#include <libasr/string_utils.h>
+
+namespace LCompilers {
+
+namespace {
+
+using LFortran::IncludeCache;
+
+// Maximum number of results kept per manifest (per source file and options)
+const size_t max_results = 16;
+
+const std::string manifest_magic = std::string("LFortran compilation cache ")
+    + LFORTRAN_VERSION;
+
+bool write_file_atomic(const std::string &filename, const std::string &data) {
+    std::string tmp_filename = filename + "." + get_unique_ID() + ".tmp";
+    {
+        std::ofstream out(tmp_filename, std::ios::out | std::ios::binary);
+        if (!out.is_open()) return false;
+        out.write(data.data(), data.size());
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp_filename, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_filename, filename, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_filename, ec);
+        return false;
+    }
+    return true;
+}
+
+bool copy_file_atomic(const std::filesystem::path &from,
+        const std::filesystem::path &to) {
+    std::string data;
+    if (!read_file(from.string(), data)) return false;
+    return write_file_atomic(to.string(), data);
+}
+
+// The content hash of a dependency, empty if it cannot be read. A collision
+// would reuse a stale result, so a cryptographic hash is used.
+std::string hash_file(const std::string &filename) {
+    std::string data;
+    if (!read_file(filename, data)) return "";
+    return sha256_hex(data);
+}
+
+// Identifies the compiler executable, so that rebuilding the compiler
+// invalidates the cache even if the version did not change
+std::string executable_key() {
+    std::error_code ec;
+    std::filesystem::path exe = std::filesystem::canonical(
+        binary_executable_path, ec);
+    if (ec) return "";
+    uint64_t size = std::filesystem::file_size(exe, ec);
+    if (ec) return "";
+    auto mtime = std::filesystem::last_write_time(exe, ec);
+    if (ec) return "";
+    return exe.string() + ":" + std::to_string(size) + ":"
+        + std::to_string(mtime.time_since_epoch().count());
+}
+
+struct ManifestResult {
+    std::string id;
+    // (filename, content hash)
+    std::vector<std::pair<std::string, std::string>> deps;
+};
+
+// Reads the results of the manifest, which must have been written for `key`
+// (the directory of a manifest is named after a hash of the key only)
+bool read_manifest(const std::string &filename, const std::string &key,
+        std::vector<ManifestResult> &results) {
+    std::string data;
+    if (!read_file(filename, data)) return false;
+    std::vector<std::string> v;
+    if (!IncludeCache::deserialize_strings(data, v)) return false;
+    // magic, key, nresults, (id, ndeps, (filename, hash) * ndeps) * nresults
+    if (v.size() < 3 || v[0] != manifest_magic || v[1] != key) return false;
+    try {
+        size_t pos = 2;
+        size_t nresults = std::stoull(v[pos++]);
+        for (size_t i = 0; i < nresults; i++) {
+            if (pos + 2 > v.size()) return false;
+            ManifestResult r;
+            r.id = v[pos++];
+            size_t ndeps = std::stoull(v[pos++]);
+            if (pos + 2*ndeps > v.size()) return false;
+            for (size_t j = 0; j < ndeps; j++) {
+                r.deps.push_back({v[pos], v[pos+1]});
+                pos += 2;
+            }
+            results.push_back(std::move(r));
+        }
+        if (pos != v.size()) return false;
+    } catch (const std::exception &) {
+        // A corrupted manifest is a cache miss
+        results.clear();
+        return false;
+    }
+    return true;
+}
+
+bool write_manifest(const std::string &filename, const std::string &key,
+        const std::vector<ManifestResult> &results) {
+    std::vector<std::string> v = {manifest_magic, key,
+        std::to_string(results.size())};
+    for (auto &r : results) {
+        v.push_back(r.id);
+        v.push_back(std::to_string(r.deps.size()));
+        for (auto &dep : r.deps) {
+            v.push_back(dep.first);
+            v.push_back(dep.second);
+        }
+    }
+    std::string data;
+    IncludeCache::serialize_strings(v, data);
+    return write_file_atomic(filename, data);
+}
+
+std::string stats_filename(const std::string &cache_dir) {
+    return join_paths({cache_dir, "obj", "stats"});
+}
+
+// Serializes the updates of the statistics file and of the manifests between
+// concurrent compiler invocations. Creating a directory is atomic on all
+// platforms; a lock left behind by a killed process is broken once it is
+// older than `stale_after`.
+class StatsLock
+{
+public:
+    explicit StatsLock(const std::string &cache_dir)
+        : lock_dir(join_paths({cache_dir, "obj", "stats.lock"})) {
+        const auto stale_after = std::chrono::seconds(10);
+        for (int attempt = 0; attempt < 2000; attempt++) {
+            std::error_code ec;
+            if (std::filesystem::create_directory(lock_dir, ec)) {
+                locked = true;
+                return;
+            }
+            auto mtime = std::filesystem::last_write_time(lock_dir, ec);
+            if (!ec && std::filesystem::file_time_type::clock::now() - mtime
+                    > stale_after) {
+                std::filesystem::remove(lock_dir, ec);
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    ~StatsLock() {
+        if (locked) {
+            std::error_code ec;
+            std::filesystem::remove(lock_dir, ec);
+        }
+    }
+
+    bool owns_lock() const { return locked; }
+
+private:
+    std::string lock_dir;
+    bool locked = false;
+};
+
+} // namespace
+
+std::string compiler_options_key(const CompilerOptions &co) {
+    // All the options given on the command line, plus the settings that do
+    // not come from it
+    std::vector<std::string> v = co.command_line_options;
+    v.push_back("runtime_library_dir=" + co.po.runtime_library_dir);
+    v.push_back("openmp_lib_dir=" + co.openmp_lib_dir);
+    v.push_back("platform=" + pf2s(co.platform));
+    std::string key;
+    IncludeCache::serialize_strings(v, key);
+    return key;
+}
+
+std::vector<std::filesystem::path> get_saved_mod_files(
+        const ASR::TranslationUnit_t &u, const CompilerOptions &compiler_options)
+{
+    std::vector<std::filesystem::path> files;
+    for (auto &item : u.m_symtab->get_scope()) {
+        if (!ASR::is_a<ASR::Module_t>(*item.second)) continue;
+        ASR::Module_t *m = ASR::down_cast<ASR::Module_t>(item.second);
+        if (m->m_loaded_from_mod) continue;
+        files.push_back(compiler_options.po.mod_files_dir
+            / (std::string(m->m_name) + ".mod"));
+    }
+    return files;
+}
+
+CompilationCache::CompilationCache(const std::string &cache_dir,
+        const std::string &source, const std::string &infile,
+        const CompilerOptions &compiler_options, const std::string &extra_key)
+{
+    IncludeCache::serialize_strings({manifest_magic, executable_key(),
+        compiler_options_key(compiler_options), extra_key, infile, source},
+        key);
+    std::string hash = fnv1a_hash_hex(key);
+    manifest_dir = join_paths({cache_dir, "obj", hash});
+    manifest_filename = join_paths({manifest_dir, "manifest"});
+}
+
+bool CompilationCache::lookup(const std::string &outfile,
+        const std::filesystem::path &mod_files_dir, std::string &diagnostics)
+{
+    std::vector<ManifestResult> results;
+    read_manifest(manifest_filename, key, results);
+    for (auto &r : results) {
+        bool valid = true;
+        for (auto &dep : r.deps) {
+            if (hash_file(dep.first) != dep.second) {
+                valid = false;
+                break;
+            }
+        }
+        if (!valid) continue;
+        std::filesystem::path result_dir = std::filesystem::path(manifest_dir)
+            / r.id;
+        std::string files;
+        if (!read_file((result_dir / "files").string(), files)) continue;
+        std::vector<std::string> mod_files;
+        if (!IncludeCache::deserialize_strings(files, mod_files)) continue;
+        std::string diag;
+        if (!read_file((result_dir / "diagnostics").string(), diag)) continue;
+        if (!copy_file_atomic(result_dir / "object.o", outfile)) continue;
+        bool ok = true;
+        for (auto &mod : mod_files) {
+            if (!copy_file_atomic(result_dir / mod, mod_files_dir / mod)) {
+                ok = false;
+                break;
+            }
+        }
+        if (!ok) continue;
+        diagnostics = std::move(diag);
+        update_stats(1, 0, 0);
+        return true;
+    }
+    update_stats(0, 1, 0);
+    return false;
+}
+
+void CompilationCache::store(const std::string &outfile,
+        const std::vector<std::filesystem::path> &mod_files,
+        const std::vector<std::pair<std::string, std::string>> &dependencies,
+        const std::string &diagnostics)
+{
+    ManifestResult r;
+    for (auto &dep : dependencies) {
+        // Do not cache results that depend on files of unknown content
+        if (dep.second.empty()) return;
+        r.deps.push_back(dep);
+    }
+    r.id = get_unique_ID();
+
+    // Populate the result directory under a temporary name and rename it, so
+    // that it is only visible when complete
+    std::error_code ec;
+    std::filesystem::path result_dir = std::filesystem::path(manifest_dir)
+        / r.id;
+    std::filesystem::path tmp_dir = std::filesystem::path(manifest_dir)
+        / (r.id + ".tmp");
+    std::filesystem::create_directories(tmp_dir, ec);
+    if (ec) return;
+    bool ok = copy_file_atomic(outfile, tmp_dir / "object.o")
+        && write_file_atomic((tmp_dir / "diagnostics").string(), diagnostics);
+    std::vector<std::string> mod_names;
+    for (auto &mod : mod_files) {
+        if (!ok) break;
+        std::string name = mod.filename().string();
+        ok = copy_file_atomic(mod, tmp_dir / name);
+        mod_names.push_back(name);
+    }
+    if (ok) {
+        std::string files;
+        IncludeCache::serialize_strings(mod_names, files);
+        ok = write_file_atomic((tmp_dir / "files").string(), files);
+    }
+    if (ok) {
+        std::filesystem::rename(tmp_dir, result_dir, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        std::filesystem::remove_all(tmp_dir, ec);
+        return;
+    }
+
+    {
+        // Without the lock a concurrent store could drop this result from
+        // the manifest, or keep one that is being removed
+        StatsLock lock(std::filesystem::path(manifest_dir).parent_path()
+            .parent_path().string());
+        if (!lock.owns_lock()) {
+            std::filesystem::remove_all(result_dir, ec);
+            return;
+        }
+        // Newest results first; the oldest results are dropped
+        std::vector<ManifestResult> results;
+        read_manifest(manifest_filename, key, results);
+        results.insert(results.begin(), std::move(r));
+        while (results.size() > max_results) {
+            std::filesystem::remove_all(std::filesystem::path(manifest_dir)
+                / results.back().id, ec);
+            results.pop_back();
+        }
+        write_manifest(manifest_filename, key, results);
+    }
+    update_stats(0, 0, 1);
+}
+
+CompilationCache::Stats CompilationCache::get_stats(const std::string &cache_dir)
+{
+    Stats stats;
+    std::string data;
+    if (!read_file(stats_filename(cache_dir), data)) return stats;
+    std::istringstream in(data);
+    uint64_t hits, misses, stores;
+    if (in >> hits >> misses >> stores) {
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.stores = stores;
+    }
+    return stats;
+}
+
+std::string CompilationCache::format_stats(const std::string &cache_dir)
+{
+    Stats stats = get_stats(cache_dir);
+    uint64_t total = stats.hits + stats.misses;
+    std::string hit_rate = total > 0
+        ? std::to_string(100 * stats.hits / total) + "%" : "-";
+    return "Compilation cache (" + cache_dir + "):\n"
+        "  hits:     " + std::to_string(stats.hits) + "\n"
+        "  misses:   " + std::to_string(stats.misses) + "\n"
+        "  stores:   " + std::to_string(stats.stores) + "\n"
+        "  hit rate: " + hit_rate + "\n";
+}
+
+void CompilationCache::update_stats(uint64_t hits, uint64_t misses,
+        uint64_t stores) const
+{
+    std::string cache_dir = std::filesystem::path(manifest_dir)
+        .parent_path().parent_path().string();
+    std::error_code ec;
+    std::filesystem::create_directories(join_paths({cache_dir, "obj"}), ec);
+    StatsLock lock(cache_dir);
+    // Statistics are not essential, they are not updated if the lock cannot
+    // be taken
+    if (!lock.owns_lock()) return;
+    Stats stats = get_stats(cache_dir);
+    stats.hits += hits;
+    stats.misses += misses;
+    stats.stores += stores;
+    write_file_atomic(stats_filename(cache_dir), std::to_string(stats.hits)
+        + " " + std::to_string(stats.misses) + " "
+        + std::to_string(stats.stores) + "\n");
+}
+
+} // namespace LCompilers
@@ -0,0 +1,82 @@
+#ifndef LFORTRAN_BIN_COMPILATION_CACHE_H
+#define LFORTRAN_BIN_COMPILATION_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <libasr/asr.h>
+#include <libasr/utils.h>
+
+namespace LCompilers {
+
+/*
+ * Persistent on-disk cache of compilation results (the object file, the
+ * generated .mod files and the printed diagnostics), similar to ccache.
+ *
+ * A lookup is done in two steps. The source code, the input filename, the
+ * compiler (version and executable) and the command line options form a key
+ * that determines a manifest in `<cache_dir>/obj`. The manifest stores the
+ * key, which must match, and lists all the results compiled so far from this
+ * source, each together with the SHA-256 of the files it depended on: the
+ * include files and the loaded .mod files, hashed when the compilation read
+ * them, so that a file changed meanwhile invalidates the result. The first
+ * result whose
+ * dependencies are all unchanged is a hit and the whole compilation pipeline
+ * is skipped.
+ *
+ * All files are written to a temporary file first and then renamed, so that
+ * parallel compiler invocations can share the cache directory.
+ */
+class CompilationCache
+{
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+    };
+
+    CompilationCache(const std::string &cache_dir, const std::string &source,
+        const std::string &infile, const CompilerOptions &compiler_options,
+        const std::string &extra_key);
+
+    // On a hit, copies the object file to `outfile`, the .mod files to
+    // `mod_files_dir`, sets `diagnostics` to the diagnostics printed by the
+    // original compilation and returns true
+    bool lookup(const std::string &outfile,
+        const std::filesystem::path &mod_files_dir, std::string &diagnostics);
+
+    // Stores the result of a successful compilation; `dependencies` are the
+    // files (other than the source) the result depends on, each with the
+    // SHA-256 of the content the compilation read (empty if unknown)
+    void store(const std::string &outfile,
+        const std::vector<std::filesystem::path> &mod_files,
+        const std::vector<std::pair<std::string, std::string>> &dependencies,
+        const std::string &diagnostics);
+
+    // Statistics of the whole cache directory (updated by every lookup and
+    // store under a lock shared by concurrent compiler invocations)
+    static Stats get_stats(const std::string &cache_dir);
+    static std::string format_stats(const std::string &cache_dir);
+
+private:
+    std::string key;
+    std::string manifest_dir;
+    std::string manifest_filename;
+
+    void update_stats(uint64_t hits, uint64_t misses, uint64_t stores) const;
+};
+
+// Returns the options of the compilation as a string: everything given on the
+// command line, so that new options are part of the key automatically
+std::string compiler_options_key(const CompilerOptions &compiler_options);
+
+// The .mod files written by `save_mod_files` for `u`
+std::vector<std::filesystem::path> get_saved_mod_files(
+    const ASR::TranslationUnit_t &u, const CompilerOptions &compiler_options);
+
+} // namespace LCompilers
+
+#endif // LFORTRAN_BIN_COMPILATION_CACHE_H
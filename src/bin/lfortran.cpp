@@ -12,6 +12,7 @@
 #include <libasr/stacktrace.h>
 #include <lfortran/parser/parser.h>
 #include <lfortran/parser/preprocessor.h>
+#include <lfortran/parser/include_cache.h>
 #include <lfortran/pickle.h>
 #include <libasr/pickle.h>
 #include <lfortran/semantics/ast_to_asr.h>
@@ -25,6 +26,7 @@
 #include <lfortran/fortran_evaluator.h>
 #include <libasr/codegen/evaluator.h>
 #include <libasr/pass/pass_manager.h>
+#include <libasr/profiler.h>
 #include <libasr/pass/replace_do_loops.h>
 #include <libasr/pass/replace_for_all.h>
 #include <libasr/pass/wrap_global_stmts.h>
@@ -55,6 +57,7 @@
 #include <cpp-terminal/terminal.h>
 #include <cpp-terminal/prompt0.h>
 
+#include <bin/compilation_cache.h>
 #include <bin/lfortran_accessor.h>
 #include <bin/lfortran_command_line_parser.h>
 #include <bin/lsp_cli.h>
@@ -681,7 +684,9 @@ int python_wrapper(const std::string &infile, std::string array_order,
     compiler_options.po.always_run = true;
     compiler_options.po.run_fun = "f";
 
+    diagnostics.diagnostics.clear();
     pass_manager.apply_passes(al, asr, compiler_options.po, diagnostics);
+    std::cerr << diagnostics.render(lm, compiler_options);
     if (compiler_options.po.tree) {
         std::cout << LCompilers::pickle_tree(*asr,
             compiler_options.use_colors) << std::endl;
@@ -986,26 +991,46 @@ int emit_asm(const std::string &infile, CompilerOptions &compiler_options)
     }
 }
 
-int compile_src_to_object_file(const std::string &infile,
+// The phases of compile_src_to_object_file(), each timed as a region of the
+// Profiler
+int compile_src_to_object_file_phases(const std::string &infile,
         const std::string &outfile,
-        bool time_report,
         bool assembly,
         CompilerOptions &compiler_options,
-        LCompilers::PassManager& lpm)
+        LCompilers::PassManager& lpm,
+        bool &cache_used)
 {
-    int time_file_read=0;
-    int time_src_to_asr=0;
-    int time_save_mod=0;
-    int time_opt=0;
-    int time_asr_to_llvm=0;
-    int time_llvm_to_bin=0;
+    std::string input;
+    {
+        LCompilers::ProfileRegion profile_region("File reading", "phase");
+        input = read_file(infile);
+    }
 
-    auto t1 = std::chrono::high_resolution_clock::now();
-    std::string input = read_file(infile);
-    auto t2 = std::chrono::high_resolution_clock::now();
-    time_file_read = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    // The compilation cache stores object files only; assembly output and
+    // the extra objects of GPU offloading are always compiled
+    std::unique_ptr<LCompilers::CompilationCache> cache;
+    std::string cached_diagnostics;
+    if (!compiler_options.cache_dir.empty() && !assembly
+            && !compiler_options.po.enable_gpu_offloading) {
+        LCompilers::ProfileRegion profile_region("Compilation cache lookup",
+            "phase");
+        cache_used = true;
+        cache = std::make_unique<LCompilers::CompilationCache>(
+            compiler_options.cache_dir, input, infile, compiler_options,
+            lpm.get_user_passes_key());
+        if (cache->lookup(outfile, compiler_options.po.mod_files_dir,
+                cached_diagnostics)) {
+            std::cerr << cached_diagnostics;
+            return 0;
+        }
+    }
+    // The .mod files are hashed as they are loaded, reset by
+    // compile_src_to_object_file()
+    std::vector<std::pair<std::string, std::string>> mod_file_deps;
+    if (cache) compiler_options.po.loaded_mod_files = &mod_file_deps;
 
     LCompilers::FortranEvaluator fe(compiler_options);
+    LCompilers::ProfileAllocator profile_allocator(fe.get_al());
     LCompilers::ASR::TranslationUnit_t* asr;
 
 
@@ -1019,13 +1044,16 @@ int compile_src_to_object_file(const std::string &infile,
         lm.file_ends.push_back(input.size());
     }
     LCompilers::diag::Diagnostics diagnostics;
-    t1 = std::chrono::high_resolution_clock::now();
-    LCompilers::Result<LCompilers::ASR::TranslationUnit_t*>
-        result = fe.get_asr2(input, lm, diagnostics);
-    t2 = std::chrono::high_resolution_clock::now();
-    time_src_to_asr = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    LCompilers::LFortran::IncludeCache::Recorder include_recorder;
+    LCompilers::Result<LCompilers::ASR::TranslationUnit_t*> result = [&]() {
+        LCompilers::ProfileRegion profile_region("Src -> ASR", "phase");
+        return fe.get_asr2(input, lm, diagnostics);
+    }();
+    std::vector<LCompilers::LFortran::IncludeCache::Dependency> include_deps
+        = include_recorder.finish();
     bool has_error_w_cc = compiler_options.continue_compilation && diagnostics.has_error();
-    std::cerr << diagnostics.render(lm, compiler_options);
+    cached_diagnostics = diagnostics.render(lm, compiler_options);
+    std::cerr << cached_diagnostics;
     if (result.ok) {
         asr = result.result;
     } else {
@@ -1033,12 +1061,21 @@ int compile_src_to_object_file(const std::string &infile,
         return 1;
     }
 
+    // Stores the result in the compilation cache, called once the object
+    // file is written
+    auto store_in_cache = [&]() {
+        if (!cache || has_error_w_cc) return;
+        std::vector<std::pair<std::string, std::string>> deps = mod_file_deps;
+        for (auto &dep : include_deps) deps.push_back({dep.filename, dep.hash});
+        cache->store(outfile,
+            LCompilers::get_saved_mod_files(*asr, compiler_options), deps,
+            cached_diagnostics);
+    };
+
     // Save .mod files
     {
-        t1 = std::chrono::high_resolution_clock::now();
+        LCompilers::ProfileRegion profile_region("ASR -> mod", "phase");
         int err = save_mod_files(*asr, compiler_options, lm);
-        t2 = std::chrono::high_resolution_clock::now();
-        time_save_mod = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
         if (err) return err;
     }
 
@@ -1050,6 +1087,7 @@ int compile_src_to_object_file(const std::string &infile,
         // Create an empty object file (things will be actually
         // compiled and linked when the main program is present):
         e.create_empty_object_file(outfile);
+        store_in_cache();
         return 0;
     }
 
@@ -1068,12 +1106,15 @@ int compile_src_to_object_file(const std::string &infile,
         return 1;
 #endif
     }
-    t1 = std::chrono::high_resolution_clock::now();
-    LCompilers::Result<std::unique_ptr<LCompilers::LLVMModule>>
-        res = fe.get_llvm3(*asr, lpm, diagnostics, infile);
-    t2 = std::chrono::high_resolution_clock::now();
-    time_asr_to_llvm = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    std::cerr << diagnostics.render(lm, compiler_options);
+    LCompilers::Result<std::unique_ptr<LCompilers::LLVMModule>> res = [&]() {
+        LCompilers::ProfileRegion profile_region("ASR -> LLVM", "phase");
+        return fe.get_llvm3(*asr, lpm, diagnostics, infile);
+    }();
+    {
+        std::string rendered = diagnostics.render(lm, compiler_options);
+        std::cerr << rendered;
+        cached_diagnostics += rendered;
+    }
     if (res.ok) {
         m = std::move(res.result);
     } else {
@@ -1082,20 +1123,17 @@ int compile_src_to_object_file(const std::string &infile,
     }
 
     if (compiler_options.po.fast) {
-        t1 = std::chrono::high_resolution_clock::now();
-        e.opt(*m->m_m);
-        t2 = std::chrono::high_resolution_clock::now();
-        time_opt = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+        LCompilers::ProfileRegion profile_region("LLVM opt", "phase");
+        e.opt(*m->m_m, compiler_options.vector_library);
     }
 
     // LLVM -> Machine code (saves to an object file)
     if (assembly) {
+        LCompilers::ProfileRegion profile_region("LLVM -> ASM", "phase");
         e.save_asm_file(*(m->m_m), outfile);
     } else {
-        t1 = std::chrono::high_resolution_clock::now();
+        LCompilers::ProfileRegion profile_region("LLVM -> BIN", "phase");
         e.save_object_file(*(m->m_m), outfile);
-        t2 = std::chrono::high_resolution_clock::now();
-        time_llvm_to_bin = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
     }
 
     if(compiler_options.po.enable_gpu_offloading) {
@@ -1124,23 +1162,45 @@ int compile_src_to_object_file(const std::string &infile,
 #endif
     }
 
+    store_in_cache();
+
+    return has_error_w_cc;
+}
+
+int compile_src_to_object_file(const std::string &infile,
+        const std::string &outfile,
+        bool time_report,
+        bool assembly,
+        CompilerOptions &compiler_options,
+        LCompilers::PassManager& lpm)
+{
+    bool cache_used = false;
+    size_t first_event = LCompilers::Profiler::get().mark();
+    int err;
+    {
+        LCompilers::ProfileRegion profile_region(infile, "file");
+        err = compile_src_to_object_file_phases(infile, outfile, assembly,
+            compiler_options, lpm, cache_used);
+        compiler_options.po.loaded_mod_files = nullptr;
+    }
+
     if (time_report) {
-        std::cout << "Allocator usage of last chunk (MB): "
-            << fe.get_al().size_current() / (1024. * 1024) << std::endl;
-        std::cout << "Allocator chunks: " << fe.get_al().num_chunks() << std::endl;
-        std::cout << std::endl;
-        std::cout << "Time report:" << std::endl;
-        std::cout << "File reading:" << std::setw(5) << time_file_read << " ms" << std::endl;
-        std::cout << "Src -> ASR:  " << std::setw(5) << time_src_to_asr << " ms" << std::endl;
-        std::cout << "ASR -> mod:  " << std::setw(5) << time_save_mod << " ms" << std::endl;
-        std::cout << "ASR -> LLVM: " << std::setw(5) << time_asr_to_llvm << " ms" << std::endl;
-        std::cout << "LLVM opt:    " << std::setw(5) << time_opt << " ms" << std::endl;
-        std::cout << "LLVM -> BIN: " << std::setw(5) << time_llvm_to_bin << " ms" << std::endl;
-        int total = time_file_read + time_src_to_asr + time_save_mod + time_asr_to_llvm + time_opt + time_llvm_to_bin;
-        std::cout << "Total:       " << std::setw(5) << total << " ms" << std::endl;
+        LCompilers::Profiler &profiler = LCompilers::Profiler::get();
+        if (compiler_options.time_report_format == "text") {
+            std::cout << "Include cache hits/misses: "
+                << LCompilers::LFortran::IncludeCache::get().hits() << "/"
+                << LCompilers::LFortran::IncludeCache::get().misses() << std::endl;
+            if (cache_used) {
+                std::cout << LCompilers::CompilationCache::format_stats(
+                    compiler_options.cache_dir);
+            }
+            std::cout << std::endl;
+        }
+        std::cout << profiler.report(compiler_options.time_report_format,
+            first_event);
     }
 
-    return has_error_w_cc;
+    return err;
 }
 
 int compile_llvm_to_object_file(const std::string& infile,
@@ -1712,6 +1772,7 @@ int link_executable(const std::vector<std::string> &infiles,
     There are probably simpler ways.
     */
 
+    LCompilers::ProfileRegion profile_region("link " + outfile, "link");
     auto t1 = std::chrono::high_resolution_clock::now();
 #ifdef HAVE_LFORTRAN_LLVM
     std::string t = (compiler_options.target == "") ? LCompilers::LLVMEvaluator::get_default_target_triple() : compiler_options.target;
@@ -1848,6 +1909,9 @@ int link_executable(const std::vector<std::string> &infiles,
                 compile_cmd += extra_linker_flags;
             }
             compile_cmd += " -l" + runtime_lib + " -lm";
+            if (compiler_options.po.auto_parallel || compiler_options.po.parallel_intrinsics) {
+                compile_cmd += " -lpthread";
+            }
             if (compiler_options.openmp) {
                 std::string openmp_shared_library = compiler_options.openmp_lib_dir;
                 std::string omp_cmd =  " -L" + openmp_shared_library + " -Wl,-rpath," + openmp_shared_library + " -lomp";
@@ -2244,6 +2308,26 @@ int main_app(int argc, char *argv[]) {
 #endif
     }
 
+    if (opts.time_report) {
+        LCompilers::Profiler::get().enable();
+    }
+    std::unique_ptr<LCompilers::ProfileTraceFile> trace_file;
+    if (!opts.trace_out.empty()) {
+        trace_file = std::make_unique<LCompilers::ProfileTraceFile>(
+            opts.trace_out);
+        LCompilers::Profiler::get().set_thread_name("lfortran");
+    }
+
+    if (opts.cache_stats) {
+        if (compiler_options.cache_dir.empty()) {
+            std::cerr << "The --cache-stats option requires --cache-dir" << std::endl;
+            return 1;
+        }
+        std::cout << LCompilers::CompilationCache::format_stats(
+            compiler_options.cache_dir);
+        return 0;
+    }
+
     if(opts.static_link && opts.shared_link) {
         std::cerr << "Options '--static' and '--shared' cannot be used together" << std::endl;
         return 1;
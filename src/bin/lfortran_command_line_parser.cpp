@@ -1,3 +1,5 @@
+#include <set>
+
 #include <libasr/exception.h>
 #include <libasr/string_utils.h>
 
@@ -85,6 +87,8 @@ namespace LCompilers::CommandLineInterface {
         app.add_flag("--show-stacktrace", compiler_options.show_stacktrace, "Show internal stacktrace on compiler errors");
         app.add_flag("--symtab-only", compiler_options.symtab_only, "Only create symbol tables in ASR (skip executable stmt)");
         app.add_flag("--time-report", opts.time_report, "Show compilation time report");
+        app.add_option("--time-report-format", compiler_options.time_report_format, "Format of the compilation time report")->check(CLI::IsMember({"text", "json", "chrome"}));
+        app.add_option("--trace-out", opts.trace_out, "Write a Chrome trace (Trace Event Format) of the compilation to the given file");
         app.add_flag("--static", opts.static_link, "Create a static executable");
         app.add_flag("--shared", opts.shared_link, "Create a shared executable");
         app.add_flag("--logical-casting", compiler_options.logical_casting, "Allow logical casting");
@@ -95,6 +99,9 @@ namespace LCompilers::CommandLineInterface {
         app.add_option("--backend", opts.arg_backend, "Select a backend (llvm, c, cpp, x86, wasm, fortran, mlir)")->capture_default_str();
         app.add_flag("--openmp", compiler_options.openmp, "Enable openmp");
         app.add_flag("--openmp-lib-dir", compiler_options.openmp_lib_dir, "Pass path to openmp library")->capture_default_str();
+        app.add_flag("--auto-parallel", compiler_options.po.auto_parallel, "Run `do concurrent` loops on the LFortran runtime thread pool");
+        app.add_flag("--parallel-intrinsics", compiler_options.po.parallel_intrinsics, "Split large whole array reductions (sum, product, maxval, minval, count, any, all) over the LFortran runtime thread pool");
+        app.add_flag("--numa-report", compiler_options.numa_report, "Print the thread binding and the page placement of large arrays when the program exits");
         app.add_flag("--lookup-name", compiler_options.lookup_name, "Lookup a name specified by --line & --column in the ASR");
         app.add_flag("--rename-symbol", compiler_options.rename_symbol, "Returns list of locations where symbol specified by --line & --column appears in the ASR");
         app.add_option("--line", compiler_options.line, "Line number for --lookup-name")->capture_default_str();
@@ -108,6 +115,7 @@ namespace LCompilers::CommandLineInterface {
         app.add_flag("--linker", opts.linker, "Specify the linker to be used, available options: clang or gcc")->capture_default_str();
         app.add_flag("--linker-path", opts.linker_path, "Use the linker from this path")->capture_default_str();
         app.add_option("--target", compiler_options.target, "Generate code for the given target")->capture_default_str();
+        app.add_option("--vector-library", compiler_options.vector_library, "Vector math library for the loop vectorizer to call for elemental math intrinsics (with --fast)")->check(CLI::IsMember({"none", "libmvec", "svml"}))->capture_default_str();
         app.add_flag("--print-targets", opts.print_targets, "Print the registered targets");
         app.add_flag("--implicit-typing", compiler_options.implicit_typing, "Allow implicit typing");
         app.add_flag("--implicit-interface", compiler_options.implicit_interface, "Allow implicit interface");
@@ -129,6 +137,12 @@ namespace LCompilers::CommandLineInterface {
         app.add_flag("--legacy-array-sections", compiler_options.legacy_array_sections, "Enables passing array items as sections if required");
         app.add_flag("--ignore-pragma", compiler_options.ignore_pragma, "Ignores all the pragmas");
         app.add_flag("--stack-arrays", compiler_options.stack_arrays, "Allocate memory for arrays on stack");
+        app.add_option("--stack-arrays-limit", compiler_options.po.stack_arrays_limit, "Largest automatic array in bytes that --fast allocates on stack")->capture_default_str();
+        app.add_flag("--array-storage-report", compiler_options.po.array_storage_report, "Print whether each local array is allocated on stack or heap (with --fast)");
+        app.add_option("--tile-size", compiler_options.po.tile_size, "Tile the two innermost loops of perfect loop nests by this many iterations (with --fast, 0 disables)")->capture_default_str();
+        app.add_flag("--loop-transform-report", compiler_options.po.loop_transform_report, "Print the loop nests that are interchanged or tiled (with --fast)");
+        app.add_option("--cache-dir", compiler_options.cache_dir, "Directory to cache compilation results (object and .mod files) and preprocessed include files in");
+        app.add_flag("--cache-stats", opts.cache_stats, "Print the statistics of the compilation cache in --cache-dir");
         app.add_flag("--wasm-html", compiler_options.wasm_html, "Generate HTML file using emscripten for LLVM->WASM");
         app.add_option("--emcc-embed", compiler_options.emcc_embed, "Embed a given file/directory using emscripten for LLVM->WASM");
         app.add_flag("--mlir-gpu-offloading", compiler_options.po.enable_gpu_offloading, "Enables gpu offloading using MLIR backend");
@@ -179,6 +193,24 @@ namespace LCompilers::CommandLineInterface {
             app.parse(args);
         }
 
+        // The compilation cache is keyed by all the options given, so that
+        // it needs no update when an option is added. The source and output
+        // files and the options that only report on the compilation are
+        // keyed separately or do not change the result.
+        const std::set<std::string> options_outside_cache_key = {"-o",
+            "--cache-dir", "--cache-stats", "--time-report",
+            "--time-report-format", "--trace-out"};
+        for (const CLI::Option *opt : app.get_options()) {
+            if (opt->get_positional() || opt->count() == 0
+                    || options_outside_cache_key.count(opt->get_name())) {
+                continue;
+            }
+            compiler_options.command_line_options.push_back(opt->get_name());
+            for (const std::string &value : opt->results()) {
+                compiler_options.command_line_options.push_back(value);
+            }
+        }
+
         if (opts.arg_standard == "" || opts.arg_standard == "lf") {
             // The default LFortran behavior, do nothing
         } else if (opts.arg_standard == "f23") {
@@ -214,6 +246,7 @@ namespace LCompilers::CommandLineInterface {
         compiler_options.prescan = !opts.arg_no_prescan;
         // set openmp in pass options
         compiler_options.po.openmp = compiler_options.openmp;
+        compiler_options.po.stack_arrays = compiler_options.stack_arrays;
 
         for (auto &f_flag : opts.f_flags) {
             if (f_flag == "PIC") {
@@ -50,6 +50,7 @@ namespace LCompilers::CommandLineInterface {
         bool show_julia = false;
         bool show_fortran = false;
         bool time_report = false;
+        std::string trace_out;
         bool static_link = false;
         bool shared_link = false;
         std::string skip_pass;
@@ -58,6 +59,7 @@ namespace LCompilers::CommandLineInterface {
         std::string linker{""};
         std::string linker_path{""};
         bool print_targets = false;
+        bool cache_stats = false;
         bool fixed_form_infer = false;
         bool cpp = false;
         bool cpp_infer = false;
@@ -14,9 +14,11 @@
 #include <lfortran/semantics/ast_to_asr.h>
 #include <lfortran/parser/parser.h>
 #include <lfortran/parser/preprocessor.h>
+#include <lfortran/parser/include_cache.h>
 #include <lfortran/pickle.h>
 #include <libasr/pickle.h>
 #include <libasr/utils.h>
+#include <libasr/profiler.h>
 #include <libasr/asr_lookup_name.h>
 
 
@@ -48,6 +50,10 @@ FortranEvaluator::FortranEvaluator(CompilerOptions compiler_options)
 #endif
     symbol_table{nullptr}
 {
+    if (!compiler_options.cache_dir.empty()) {
+        LFortran::IncludeCache::get().set_cache_dir(
+            join_paths({compiler_options.cache_dir, "include"}));
+    }
 }
 
 FortranEvaluator::~FortranEvaluator() = default;
@@ -200,10 +206,11 @@ Result<LFortran::AST::TranslationUnit_t*> FortranEvaluator::get_ast2(
     std::string tmp;
     if (compiler_options.c_preprocessor) {
         // Preprocessor
+        ProfileRegion profile_region("C preprocessor", "phase");
         LFortran::CPreprocessor cpp(compiler_options);
         Result<std::string> res = cpp.run(code_orig, lm, cpp.macro_definitions, diagnostics);
         if (res.ok) {
-            tmp = res.result;
+            tmp = std::move(res.result);
         } else {
             LCOMPILERS_ASSERT(diagnostics.has_error())
             return res.error;
@@ -211,6 +218,7 @@ Result<LFortran::AST::TranslationUnit_t*> FortranEvaluator::get_ast2(
         code = &tmp;
     }
     if (compiler_options.prescan || compiler_options.fixed_form) {
+        ProfileRegion profile_region("prescan", "phase");
         std::vector<std::filesystem::path> include_dirs;
         include_dirs.push_back(parent_path(lm.files.back().in_filename));
         include_dirs.insert(include_dirs.end(),
@@ -219,8 +227,12 @@ Result<LFortran::AST::TranslationUnit_t*> FortranEvaluator::get_ast2(
         tmp = LFortran::prescan(*code, lm, compiler_options.fixed_form, include_dirs);
         code = &tmp;
     }
+    // The parser keeps its own copy of the code, hand over the intermediate
+    // (preprocessed or prescanned) one instead of copying it
     Result<LFortran::AST::TranslationUnit_t*>
-        res = LFortran::parse(al, *code, diagnostics, compiler_options);
+        res = (code == &tmp)
+            ? LFortran::parse(al, std::move(tmp), diagnostics, compiler_options)
+            : LFortran::parse(al, *code, diagnostics, compiler_options);
     if (res.ok) {
         return res.result;
     } else {
@@ -388,7 +400,7 @@ Result<std::unique_ptr<LLVMModule>> FortranEvaluator::get_llvm3(
     }
 
     if (compiler_options.po.fast) {
-        e->opt(*m->m_m);
+        e->opt(*m->m_m, compiler_options.vector_library);
     }
 
     return m;
@@ -0,0 +1,230 @@
+#include <filesystem>
+#include <fstream>
+
+#include <lfortran/parser/include_cache.h>
+#include <libasr/assert.h>
+#include <libasr/config.h>
+#include <libasr/string_utils.h>
+#include <libasr/utils.h>
+
+namespace LCompilers::LFortran {
+
+namespace {
+
+// The dependencies of the entries that are being produced by this thread, one
+// list per active Recorder (nested includes produce nested entries)
+thread_local std::vector<std::vector<IncludeCache::Dependency>> recording;
+
+void record_dependencies(const std::vector<IncludeCache::Dependency> &deps) {
+    for (auto &r : recording) {
+        r.insert(r.end(), deps.begin(), deps.end());
+    }
+}
+
+bool get_dependency(const std::string &filename, IncludeCache::Dependency &dep) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(filename, ec);
+    if (ec) return false;
+    auto mtime = std::filesystem::last_write_time(filename, ec);
+    if (ec) return false;
+    dep.filename = filename;
+    dep.mtime = mtime.time_since_epoch().count();
+    dep.size = size;
+    return true;
+}
+
+std::string make_key(const std::string &kind, const std::string &filename,
+        const std::string &context) {
+    std::string key;
+    IncludeCache::serialize_strings({kind, filename, context}, key);
+    return key;
+}
+
+const std::string disk_magic = std::string("LFortran include cache ")
+    + LFORTRAN_VERSION;
+
+} // namespace
+
+IncludeCache &IncludeCache::get() {
+    static IncludeCache cache;
+    return cache;
+}
+
+void IncludeCache::set_cache_dir(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cache_dir = dir;
+    if (!cache_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(cache_dir, ec);
+    }
+}
+
+void IncludeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    n_hits = 0;
+    n_misses = 0;
+}
+
+IncludeCache::Recorder::Recorder() : active{true} {
+    recording.emplace_back();
+}
+
+IncludeCache::Recorder::~Recorder() {
+    if (active) recording.pop_back();
+}
+
+std::vector<IncludeCache::Dependency> IncludeCache::Recorder::finish() {
+    LCOMPILERS_ASSERT(active && !recording.empty());
+    std::vector<Dependency> deps = std::move(recording.back());
+    recording.pop_back();
+    active = false;
+    return deps;
+}
+
+bool IncludeCache::read_file(const std::string &filename, std::string &text) {
+    Dependency dep;
+    if (!get_dependency(filename, dep)) return false;
+    if (!LCompilers::read_file(filename, text)) return false;
+    if (!recording.empty()) dep.hash = sha256_hex(text);
+    record_dependencies({dep});
+    return true;
+}
+
+bool IncludeCache::is_valid(const Entry &entry) const {
+    for (auto &dep : entry.deps) {
+        Dependency current;
+        if (!get_dependency(dep.filename, current)) return false;
+        if (current.mtime != dep.mtime || current.size != dep.size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IncludeCache::lookup(const std::string &kind, const std::string &filename,
+        const std::string &context, std::string &text, std::string &state) {
+    std::string key = make_key(kind, filename, context);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end() && !is_valid(it->second)) {
+        entries.erase(it);
+        it = entries.end();
+    }
+    if (it == entries.end() && !cache_dir.empty()) {
+        Entry entry;
+        if (load_from_disk(key, entry) && is_valid(entry)) {
+            it = entries.insert({key, std::move(entry)}).first;
+        }
+    }
+    if (it == entries.end()) {
+        n_misses++;
+        return false;
+    }
+    n_hits++;
+    text.append(it->second.text);
+    state = it->second.state;
+    // The including entries depend on the files of this one as well
+    record_dependencies(it->second.deps);
+    return true;
+}
+
+void IncludeCache::insert(const std::string &kind, const std::string &filename,
+        const std::string &context, std::string text, std::string state,
+        std::vector<Dependency> &&deps) {
+    Entry entry;
+    entry.text = std::move(text);
+    entry.state = std::move(state);
+    entry.deps = std::move(deps);
+    std::string key = make_key(kind, filename, context);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!cache_dir.empty()) save_to_disk(key, entry);
+    entries[key] = std::move(entry);
+}
+
+std::string IncludeCache::disk_filename(const std::string &key) const {
+    return join_paths({cache_dir, fnv1a_hash_hex(key) + ".inc"});
+}
+
+bool IncludeCache::load_from_disk(const std::string &key, Entry &entry) const {
+    std::string data;
+    if (!LCompilers::read_file(disk_filename(key), data)) return false;
+    std::vector<std::string> v;
+    if (!deserialize_strings(data, v)) return false;
+    // magic, key, state, text, ndeps, (filename, mtime, size, hash) * ndeps
+    if (v.size() < 5 || v[0] != disk_magic || v[1] != key) return false;
+    try {
+        size_t ndeps = std::stoull(v[4]);
+        if (v.size() != 5 + 4*ndeps) return false;
+        entry.deps.clear();
+        for (size_t i = 0; i < ndeps; i++) {
+            Dependency dep;
+            dep.filename = v[5 + 4*i];
+            dep.mtime = std::stoll(v[5 + 4*i + 1]);
+            dep.size = std::stoull(v[5 + 4*i + 2]);
+            dep.hash = v[5 + 4*i + 3];
+            entry.deps.push_back(dep);
+        }
+    } catch (const std::exception &) {
+        // A corrupted entry is a cache miss
+        return false;
+    }
+    entry.state = std::move(v[2]);
+    entry.text = std::move(v[3]);
+    return true;
+}
+
+void IncludeCache::save_to_disk(const std::string &key, const Entry &entry) const {
+    std::vector<std::string> v = {disk_magic, key, entry.state, entry.text,
+        std::to_string(entry.deps.size())};
+    for (auto &dep : entry.deps) {
+        v.push_back(dep.filename);
+        v.push_back(std::to_string(dep.mtime));
+        v.push_back(std::to_string(dep.size));
+        v.push_back(dep.hash);
+    }
+    std::string data;
+    serialize_strings(v, data);
+    // Write to a temporary file and rename it, so that concurrent compiler
+    // invocations never see a partially written entry
+    std::string filename = disk_filename(key);
+    std::string tmp_filename = filename + "." + get_unique_ID() + ".tmp";
+    {
+        std::ofstream out(tmp_filename, std::ios::out | std::ios::binary);
+        if (!out.is_open()) return;
+        out.write(data.data(), data.size());
+        if (!out) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_filename, filename, ec);
+    if (ec) std::filesystem::remove(tmp_filename, ec);
+}
+
+void IncludeCache::serialize_strings(const std::vector<std::string> &v,
+        std::string &out) {
+    for (auto &s : v) {
+        out += std::to_string(s.size());
+        out += ':';
+        out += s;
+    }
+}
+
+bool IncludeCache::deserialize_strings(const std::string &s,
+        std::vector<std::string> &v) {
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t colon = s.find(':', pos);
+        if (colon == std::string::npos || colon == pos) return false;
+        size_t n = 0;
+        for (size_t i = pos; i < colon; i++) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            n = 10*n + (s[i] - '0');
+        }
+        if (colon + 1 + n > s.size()) return false;
+        v.push_back(s.substr(colon + 1, n));
+        pos = colon + 1 + n;
+    }
+    return true;
+}
+
+} // namespace LCompilers::LFortran
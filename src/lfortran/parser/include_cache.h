@@ -0,0 +1,101 @@
+#ifndef LFORTRAN_SRC_PARSER_INCLUDE_CACHE_H
+#define LFORTRAN_SRC_PARSER_INCLUDE_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LCompilers::LFortran {
+
+/*
+ * Cache of include files after they were prescanned or C preprocessed.
+ *
+ * An entry is keyed by the kind of processing (`prescan`, `cpp`), the
+ * resolved path of the include file and a `context` string that contains
+ * everything else the processed text depends on (fixed form, include
+ * directories, macro definitions, ...). An entry stays valid as long as none
+ * of the files read while producing it (the include file itself and all its
+ * nested includes) changed its size or modification time.
+ *
+ * The cache lives for the whole process, so it is shared by all files compiled
+ * in one invocation and by all requests of the language server. If a cache
+ * directory is set, entries are also written to disk and reused by later
+ * invocations of the compiler.
+ */
+class IncludeCache
+{
+public:
+    struct Dependency {
+        std::string filename;
+        int64_t mtime;
+        uint64_t size;
+        std::string hash; // SHA-256 of the content that was read
+    };
+
+    struct Entry {
+        std::string text;  // The processed text of the include file
+        std::string state; // Processor state after the include (macros)
+        std::vector<Dependency> deps;
+    };
+
+    // The process-wide cache
+    static IncludeCache &get();
+
+    // Enables the on-disk cache in `dir` (disabled if empty)
+    void set_cache_dir(const std::string &dir);
+
+    // Returns true, appends the cached text to `text` and sets `state` if a
+    // valid entry exists
+    bool lookup(const std::string &kind, const std::string &filename,
+        const std::string &context, std::string &text, std::string &state);
+
+    // Collects the dependencies of an entry while it is being produced: all
+    // files read using `read_file` (also by nested includes) and the
+    // dependencies of all nested cache hits during the lifetime of the
+    // recorder
+    class Recorder {
+    public:
+        Recorder();
+        ~Recorder();
+        std::vector<Dependency> finish();
+    private:
+        bool active;
+    };
+
+    void insert(const std::string &kind, const std::string &filename,
+        const std::string &context, std::string text, std::string state,
+        std::vector<Dependency> &&deps);
+
+    // Reads the file and records it as a dependency of the entries that are
+    // currently being produced
+    bool read_file(const std::string &filename, std::string &text);
+
+    void clear();
+
+    uint64_t hits() const { return n_hits; }
+    uint64_t misses() const { return n_misses; }
+
+    // Length-prefixed serialization of a list of strings, used for the
+    // context and state strings
+    static void serialize_strings(const std::vector<std::string> &v,
+        std::string &out);
+    static bool deserialize_strings(const std::string &s,
+        std::vector<std::string> &v);
+
+private:
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    std::string cache_dir;
+    uint64_t n_hits = 0, n_misses = 0;
+
+    bool is_valid(const Entry &entry) const;
+    std::string disk_filename(const std::string &key) const;
+    bool load_from_disk(const std::string &key, Entry &entry) const;
+    void save_to_disk(const std::string &key, const Entry &entry) const;
+};
+
+} // namespace LCompilers::LFortran
+
+#endif // LFORTRAN_SRC_PARSER_INCLUDE_CACHE_H
@@ -4,7 +4,9 @@
 
 #include <lfortran/parser/parser.h>
 #include <lfortran/parser/parser.tab.hh>
+#include <lfortran/parser/include_cache.h>
 #include <libasr/diagnostics.h>
+#include <libasr/profiler.h>
 #include <libasr/string_utils.h>
 #include <lfortran/parser/parser_exception.h>
 #include <lfortran/parser/fixedform_tokenizer.h>
@@ -215,9 +217,18 @@ void fix_program_without_program_line(Allocator &al, AST::TranslationUnit_t &ast
 Result<AST::TranslationUnit_t*> parse(Allocator &al, const std::string &s,
         diag::Diagnostics &diagnostics, const CompilerOptions &co)
 {
+    return parse(al, std::string(s), diagnostics, co);
+}
+
+Result<AST::TranslationUnit_t*> parse(Allocator &al, std::string &&s,
+        diag::Diagnostics &diagnostics, const CompilerOptions &co)
+{
+    // In free form the tokenizer is driven by the parser, so this region
+    // includes tokenizing; fixed form is tokenized upfront in its own region
+    ProfileRegion profile_region("parse", "phase");
     Parser p(al, diagnostics, co.fixed_form, co.continue_compilation);
     try {
-        if (!p.parse(s)) {
+        if (!p.parse(std::move(s))) {
             if (!co.continue_compilation) {
                 return Error();
             }
@@ -257,7 +268,14 @@ Result<AST::TranslationUnit_t*> parse(Allocator &al, const std::string &s,
 
 bool Parser::parse(const std::string &input)
 {
-    inp = input;
+    return parse(std::string(input));
+}
+
+bool Parser::parse(std::string &&input)
+{
+    // Take ownership of the (possibly prescanned) source instead of copying
+    // it, the tokenizer works directly on `inp`
+    inp = std::move(input);
     if (inp.size() > 0) {
         if (inp[inp.size()-1] != '\n') inp.append("\n");
     } else {
@@ -276,7 +294,10 @@ bool Parser::parse(const std::string &input)
         }
     } else {
         f_tokenizer.set_string(inp);
-        if (!f_tokenizer.tokenize_input(diag, m_a)) return false;
+        {
+            ProfileRegion profile_region("tokenize", "phase");
+            if (!f_tokenizer.tokenize_input(diag, m_a)) return false;
+        }
         if (yyparse(*this) == 0) {
             if (diag.has_error())
                 return false;
@@ -616,37 +637,53 @@ void process_include(std::string& out, const std::string& s,
     include_filename = include_filename.substr(1, include_filename.size() - 2);
 
     bool file_found = false;
-    std::string include = "";
     if (is_relative_path(include_filename)) {
         for (auto &path:include_dirs) {
             std::string filepath = join_paths({path.generic_string(), include_filename});
-            file_found = read_file(filepath, include);
+            file_found = std::filesystem::is_regular_file(filepath);
             if (file_found) {
                 include_filename = filepath;
                 break;
             }
         }
     } else {
-        file_found = read_file(include_filename, include);
+        file_found = std::filesystem::is_regular_file(include_filename);
     }
 
-    if (!file_found) {
-        throw LCompilersException("Include file '" + include_filename
-            + "' not found. If an include path "
-            "is available, please use the `-I` option to specify it.");
-    }
+    std::string include = "";
+    IncludeCache &cache = IncludeCache::get();
+    // The prescanned include only depends on the form and on where nested
+    // includes are searched for
+    std::vector<std::string> context = {fixed_form ? "fixed" : "free"};
+    for (auto &path:include_dirs) context.push_back(path.generic_string());
+    std::string context_str;
+    IncludeCache::serialize_strings(context, context_str);
+    std::string state;
+    if (!file_found || !cache.lookup("prescan", include_filename,
+            context_str, out, state)) {
+        IncludeCache::Recorder recorder;
+        if (!file_found || !cache.read_file(include_filename, include)) {
+            throw LCompilersException("Include file '" + include_filename
+                + "' not found. If an include path "
+                "is available, please use the `-I` option to specify it.");
+        }
 
-    LocationManager lm_tmp;
-    {
-        LocationManager::FileLocations fl;
-        fl.in_filename = include_filename;
-        lm_tmp.files.push_back(fl);
+        LocationManager lm_tmp;
+        {
+            LocationManager::FileLocations fl;
+            fl.in_filename = include_filename;
+            lm_tmp.files.push_back(fl);
+        }
+        // Prescan the include directly at the end of `out`, so that the
+        // included text is not copied once more
+        size_t out_start = out.size();
+        prescan(out, include, lm_tmp, fixed_form, include_dirs);
+        cache.insert("prescan", include_filename, context_str,
+            out.substr(out_start), "", recorder.finish());
     }
-    include = prescan(include, lm_tmp, fixed_form, include_dirs);
 
     // Possible it goes here
     // lm.files.back().out_start.push_back(out.size());
-    out += include;
     while (pos < s.size() && s[pos] != '\n') pos++;
     lm.files.back().out_start.push_back(out.size());
     lm.files.back().in_start.push_back(pos);
@@ -679,13 +716,27 @@ The prescan phase includes:
 std::string prescan(const std::string &s, LocationManager &lm,
         bool fixed_form, std::vector<std::filesystem::path> &include_dirs)
 {
+    std::string out;
+    // The prescanned code is never longer than the input (except for include
+    // files), reserve it once, including the final '\n' appended by the parser
+    out.reserve(s.size() + 1);
+    prescan(out, s, lm, fixed_form, include_dirs);
+    return out;
+}
+
+void prescan(std::string &out, const std::string &s, LocationManager &lm,
+        bool fixed_form, std::vector<std::filesystem::path> &include_dirs)
+{
+    // The code is appended to `out`, which can already contain the code of
+    // the file that includes `s`; the interval starts are positions in `out`
+    const size_t out_offset = out.size();
+    out.reserve(out_offset + s.size() + 1);
     if (fixed_form) {
         // `pos` is the position in the original code `s`
         // `out` is the final code (outcome)
         lm.get_newlines(s, lm.files.back().in_newlines);
-        lm.files.back().out_start.push_back(0);
+        lm.files.back().out_start.push_back(out.size());
         lm.files.back().in_start.push_back(0);
-        std::string out;
         size_t pos = 0;
         /* Note:
          * This is a fixed-form prescanner, which:
@@ -745,7 +796,7 @@ std::string prescan(const std::string &s, LocationManager &lm,
                 }
                 case LineType::Continuation : {
                     // Append from column 7 to previous line
-                    out = out.substr(0, out.size()-1); // Remove the last '\n'
+                    if (out.size() > out_offset) out.pop_back(); // Remove the last '\n'
                     pos += 6;
                     lm.files.back().out_start.push_back(out.size());
                     lm.files.back().in_start.push_back(pos);
@@ -754,7 +805,7 @@ std::string prescan(const std::string &s, LocationManager &lm,
                 }
                 case LineType::ContinuationTab : {
                     // Append from column 3 to previous line
-                    out = out.substr(0, out.size()-1); // Remove the last '\n'
+                    if (out.size() > out_offset) out.pop_back(); // Remove the last '\n'
                     pos += 2;
                     lm.files.back().out_start.push_back(out.size());
                     lm.files.back().in_start.push_back(pos);
@@ -780,13 +831,11 @@ std::string prescan(const std::string &s, LocationManager &lm,
         }
         lm.files.back().in_start.push_back(pos);
         lm.files.back().out_start.push_back(out.size());
-        return out;
     } else {
          // `pos` is the position in the original code `s`
         // `out` is the final code (outcome)
-        lm.files.back().out_start.push_back(0);
+        lm.files.back().out_start.push_back(out.size());
         lm.files.back().in_start.push_back(0);
-        std::string out;
         size_t pos = 0;
         bool in_comment = false, newline = true;
         // keeps track of whether we're in a string or not
@@ -847,7 +896,6 @@ std::string prescan(const std::string &s, LocationManager &lm,
         // file has it
         lm.files.back().in_start.push_back(pos);
         lm.files.back().out_start.push_back(out.size());
-        return out;
     }
 }
 
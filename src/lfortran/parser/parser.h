@@ -32,6 +32,7 @@ public:
     }
 
     bool parse(const std::string &input);
+    bool parse(std::string &&input);
     void handle_yyerror(const Location &loc, const std::string &msg);
 };
 
@@ -41,6 +42,12 @@ Result<AST::TranslationUnit_t*> parse(Allocator &al,
     diag::Diagnostics &diagnostics,
     const CompilerOptions &co);
 
+// Same as above, but takes ownership of `s` instead of copying it
+Result<AST::TranslationUnit_t*> parse(Allocator &al,
+    std::string &&s,
+    diag::Diagnostics &diagnostics,
+    const CompilerOptions &co);
+
 // Tokenizes the `input` and return a list of tokens
 Result<std::vector<int>> tokens(Allocator &al, const std::string &input,
         diag::Diagnostics &diagnostics,
@@ -55,6 +62,10 @@ std::string token2text(const int token);
 std::string prescan(const std::string &s, LocationManager &lm,
         bool fixed_form, std::vector<std::filesystem::path> &include_dirs);
 
+// Appends the prescanned `s` to `out`
+void prescan(std::string &out, const std::string &s, LocationManager &lm,
+        bool fixed_form, std::vector<std::filesystem::path> &include_dirs);
+
 } // namespace LCompilers::LFortran
 
 #endif
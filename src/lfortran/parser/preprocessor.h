@@ -19,7 +19,55 @@ struct CPPMacro {
     std::string expansion;
 };
 
-typedef std::map<std::string, CPPMacro> cpp_symtab;
+/*
+ * The macro definitions of the preprocessor.
+ *
+ * All changes go through `define` and `undef`, which keep an order
+ * independent hash of the whole table up to date. The include cache keys
+ * preprocessed include files by this hash, so that a lookup does not need to
+ * serialize the table. While a change log is open, the names of all changed
+ * macros are logged as well, so that only the macros changed by an include
+ * file have to be cached and restored.
+ *
+ * `__FILE__` and `__LINE__` are set per file, they are left out of the hash
+ * and of the change log so that an include is shared by all includers.
+ */
+class cpp_symtab
+{
+public:
+    typedef std::map<std::string, CPPMacro>::const_iterator const_iterator;
+
+    const_iterator begin() const { return macros.begin(); }
+    const_iterator end() const { return macros.end(); }
+    const_iterator find(const std::string &name) const {
+        return macros.find(name);
+    }
+    const CPPMacro &at(const std::string &name) const {
+        return macros.at(name);
+    }
+    size_t size() const { return macros.size(); }
+
+    void define(const std::string &name, const CPPMacro &macro);
+    void undef(const std::string &name);
+
+    // The hash of all the definitions, as hexadecimal digits
+    std::string hash() const;
+
+    // Opens a change log and returns its start, `changes_since` returns the
+    // names changed since then, `close_log` closes it
+    size_t open_log();
+    std::vector<std::string> changes_since(size_t start) const;
+    void close_log();
+
+private:
+    std::map<std::string, CPPMacro> macros;
+    // Sum of the 128-bit hashes of all definitions
+    uint64_t hash_lo = 0, hash_hi = 0;
+    std::vector<std::string> log;
+    size_t open_logs = 0;
+
+    void add_hash(const std::string &name, const CPPMacro &macro, bool add);
+};
 
 class CPreprocessor
 {
@@ -40,6 +88,13 @@ public:
     }
 };
 
+// Used to cache the macros changed by an include file: `names` are defined
+// or undefined as in `macro_definitions`. Returns false for corrupted data,
+// without changing `macro_definitions`.
+std::string serialize_macros(const cpp_symtab &macro_definitions,
+    const std::vector<std::string> &names);
+bool deserialize_macros(const std::string &s, cpp_symtab &macro_definitions);
+
 std::string function_like_macro_expansion(
             std::vector<std::string> &def_args,
             std::string &expansion,
@@ -8,6 +8,7 @@
 #include <libasr/asr_utils.h>
 #include <libasr/asr_verify.h>
 #include <libasr/exception.h>
+#include <libasr/profiler.h>
 #include <lfortran/semantics/asr_implicit_cast_rules.h>
 #include <lfortran/semantics/ast_common_visitor.h>
 #include <lfortran/semantics/ast_to_asr.h>
@@ -37,6 +38,33 @@ public:
     std::vector<ASR::symbol_t*> do_loop_variables;
     std::map<ASR::asr_t*, std::pair<const AST::stmt_t*,int64_t>> print_statements;
     std::vector<ASR::DoConcurrentLoop_t *> omp_constructs;
+    // `task` and `taskgroup` constructs whose end was not reached yet, their
+    // statements are the ones added to `body` from `start` on
+    struct OMPTaskRegion {
+        std::string construct;
+        Vec<ASR::stmt_t*>* body;
+        size_t start;
+        Vec<ASR::expr_t*> shared, firstprivate;
+    };
+    std::vector<OMPTaskRegion> omp_task_regions;
+    // `taskloop` constructs waiting for their `do` loop
+    struct OMPTaskloop {
+        Vec<ASR::stmt_t*>* body;
+        size_t start;
+        Vec<ASR::expr_t*> shared, firstprivate;
+        ASR::expr_t *grainsize, *num_tasks;
+        bool nogroup;
+    };
+    std::vector<OMPTaskloop> omp_taskloops;
+    // `simd` constructs waiting for their `do` loop
+    struct OMPSimdLoop {
+        Vec<ASR::stmt_t*>* body;
+        size_t start;
+        ASR::loop_hint_t* hint;
+    };
+    std::vector<OMPSimdLoop> omp_simd_loops;
+    // Coarrays of the main program and their extents (empty for scalars)
+    std::map<ASR::symbol_t*, std::vector<int64_t>> coarray_shapes;
 
     BodyVisitor(Allocator &al, ASR::asr_t *unit, diag::Diagnostics &diagnostics,
         CompilerOptions &compiler_options,
@@ -1969,6 +1997,172 @@ public:
     }
 
 
+    ASR::expr_t* coarray_shape(ASR::symbol_t *sym, const Location &loc) {
+        const std::vector<int64_t> &extents = coarray_shapes[sym];
+        if (extents.empty()) return nullptr;
+        ASRUtils::ASRBuilder b(al, loc);
+        std::vector<ASR::expr_t*> shape;
+        for (int64_t extent: extents) shape.push_back(b.i32(extent));
+        return b.ArrayConstant(shape, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), false);
+    }
+
+    // Associates the coarrays of the main program with their storage. Every
+    // image registers them in the same order, so that a coarray has the same
+    // offset in the coarray heap of each image.
+    void register_coarrays(const AST::Program_t &x, Vec<ASR::stmt_t*> &body) {
+        ASRUtils::ASRBuilder b(al, x.base.base.loc);
+        for (size_t i = 0; i < x.n_decl; i++) {
+            if (!AST::is_a<AST::Declaration_t>(*x.m_decl[i])) continue;
+            AST::Declaration_t *decl = AST::down_cast<AST::Declaration_t>(x.m_decl[i]);
+            AST::dimension_t *attr_dims = nullptr;
+            size_t n_attr_dims = 0;
+            bool attr_codim = false;
+            for (size_t j = 0; j < decl->n_attributes; j++) {
+                if (AST::is_a<AST::AttrDimension_t>(*decl->m_attributes[j])) {
+                    AST::AttrDimension_t *ad = AST::down_cast<AST::AttrDimension_t>(decl->m_attributes[j]);
+                    attr_dims = ad->m_dim;
+                    n_attr_dims = ad->n_dim;
+                } else if (AST::is_a<AST::AttrCodimension_t>(*decl->m_attributes[j])) {
+                    attr_codim = true;
+                }
+            }
+            for (size_t j = 0; j < decl->n_syms; j++) {
+                AST::var_sym_t &s = decl->m_syms[j];
+                if (s.n_codim == 0 && !attr_codim) continue;
+                if (s.m_initializer) {
+                    diag.add(Diagnostic("Initialization of coarrays is not supported yet",
+                        Level::Error, Stage::Semantic, {Label("", {s.loc})}));
+                    throw SemanticAbort();
+                }
+                ASR::symbol_t *sym = current_scope->get_symbol(to_lower(s.m_name));
+                LCOMPILERS_ASSERT(sym && ASR::is_a<ASR::Variable_t>(*sym));
+                ASR::ttype_t *type = ASRUtils::symbol_type(sym);
+                ASR::ttype_t *el_type = ASRUtils::type_get_past_array(
+                    ASRUtils::type_get_past_pointer(type));
+                int64_t bytes = ASRUtils::extract_kind_from_ttype_t(el_type);
+                if (ASRUtils::is_complex(*el_type)) bytes *= 2;
+                AST::dimension_t *dims = s.n_dim > 0 ? s.m_dim : attr_dims;
+                size_t n_dims = s.n_dim > 0 ? s.n_dim : n_attr_dims;
+                std::vector<int64_t> &extents = coarray_shapes[sym];
+                for (size_t k = 0; k < n_dims; k++) {
+                    // create_coarray_type checked that the extents are constant
+                    this->visit_expr(*dims[k].m_end);
+                    int64_t extent = -1;
+                    ASRUtils::extract_value(ASRUtils::expr_value(ASRUtils::EXPR(tmp)), extent);
+                    extents.push_back(extent);
+                    bytes *= extent;
+                }
+                Vec<ASR::expr_t*> args;
+                args.reserve(al, 1);
+                args.push_back(al, b.i64(bytes));
+                ASR::expr_t *storage = ASRUtils::EXPR(ASR::make_IntrinsicImpureFunction_t(al,
+                    s.loc, static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::CoarrayAllocate),
+                    args.p, args.n, 0, ASRUtils::TYPE(ASR::make_CPtr_t(al, s.loc)), nullptr));
+                body.push_back(al, ASRUtils::STMT(ASR::make_CPtrToPointer_t(al, s.loc, storage,
+                    ASRUtils::EXPR(ASR::make_Var_t(al, s.loc, sym)), coarray_shape(sym, s.loc), nullptr)));
+            }
+        }
+        tmp = nullptr;
+    }
+
+    // `x[image]` becomes a pointer to `x` in the coarray heap of `image`
+    void visit_CoarrayRef(const AST::CoarrayRef_t &x) {
+        const Location &loc = x.base.base.loc;
+        std::string name = to_lower(x.m_name);
+        ASR::symbol_t *sym = current_scope->resolve_symbol(name);
+        if (sym == nullptr || coarray_shapes.find(sym) == coarray_shapes.end()) {
+            diag.add(Diagnostic("Only coarrays declared in the main program can be coindexed",
+                Level::Error, Stage::Semantic, {Label("", {loc})}));
+            throw SemanticAbort();
+        }
+        if (x.n_member > 0 || x.n_fnkw > 0 || x.n_cokw > 0 || x.n_coargs != 1 ||
+                x.m_coargs[0].m_start || x.m_coargs[0].m_step || !x.m_coargs[0].m_end) {
+            diag.add(Diagnostic("Only coindexed objects of the form `x[image]` or "
+                "`x(...)[image]` are supported",
+                Level::Error, Stage::Semantic, {Label("", {loc})}));
+            throw SemanticAbort();
+        }
+        ASRUtils::ASRBuilder b(al, loc);
+        this->visit_expr(*x.m_coargs[0].m_end);
+        ASR::expr_t *image = ASRUtils::EXPR(tmp);
+        if (!ASRUtils::is_integer(*ASRUtils::expr_type(image))) {
+            diag.add(Diagnostic("The image index must be an integer",
+                Level::Error, Stage::Semantic, {Label("", {image->base.loc})}));
+            throw SemanticAbort();
+        }
+        if (ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(image)) != 4) {
+            image = b.i2i_t(image, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)));
+        }
+        ASR::ttype_t *type = ASRUtils::symbol_type(sym);
+        std::string remote_name = current_scope->get_unique_name("__libasr_coindexed_" + name);
+        ASR::symbol_t *remote_sym = ASR::down_cast<ASR::symbol_t>(ASRUtils::make_Variable_t_util(
+            al, loc, current_scope, s2c(al, remote_name), nullptr, 0, ASR::intentType::Local,
+            nullptr, nullptr, ASR::storage_typeType::Default, ASRUtils::duplicate_type(al, type),
+            nullptr, ASR::abiType::Source, ASR::accessType::Public, ASR::presenceType::Required,
+            false));
+        current_scope->add_symbol(remote_name, remote_sym);
+        ASR::ttype_t *cptr_type = ASRUtils::TYPE(ASR::make_CPtr_t(al, loc));
+        Vec<ASR::expr_t*> args;
+        args.reserve(al, 2);
+        args.push_back(al, ASRUtils::EXPR(ASR::make_PointerToCPtr_t(al, loc,
+            ASRUtils::EXPR(ASR::make_Var_t(al, loc, sym)), cptr_type, nullptr)));
+        args.push_back(al, image);
+        ASR::expr_t *remote = ASRUtils::EXPR(ASR::make_IntrinsicImpureFunction_t(al, loc,
+            static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::CoarrayRemote),
+            args.p, args.n, 0, cptr_type, nullptr));
+        current_body->push_back(al, ASRUtils::STMT(ASR::make_CPtrToPointer_t(al, loc, remote,
+            ASRUtils::EXPR(ASR::make_Var_t(al, loc, remote_sym)), coarray_shape(sym, loc), nullptr)));
+        if (x.n_args == 0) {
+            tmp = ASR::make_Var_t(al, loc, remote_sym);
+        } else {
+            tmp = create_ArrayRef(loc, x.m_args, x.n_args, nullptr, 0, nullptr,
+                remote_sym, remote_sym);
+        }
+    }
+
+    ASR::expr_t* sync_stat(AST::event_attribute_t **stat, size_t n_stat) {
+        for (size_t i = 0; i < n_stat; i++) {
+            if (AST::is_a<AST::AttrStat_t>(*stat[i])) {
+                AST::AttrStat_t *a = AST::down_cast<AST::AttrStat_t>(stat[i]);
+                ASR::symbol_t *sym = current_scope->resolve_symbol(to_lower(a->m_variable));
+                if (sym == nullptr || !ASR::is_a<ASR::Variable_t>(*sym) ||
+                        !ASRUtils::is_integer(*ASRUtils::symbol_type(sym))) {
+                    diag.add(Diagnostic("The `stat` variable must be an integer variable",
+                        Level::Error, Stage::Semantic, {Label("", {stat[i]->base.loc})}));
+                    throw SemanticAbort();
+                }
+                return ASRUtils::EXPR(ASR::make_Var_t(al, stat[i]->base.loc, sym));
+            }
+        }
+        return nullptr;
+    }
+
+    void visit_SyncAll(const AST::SyncAll_t &x) {
+        Vec<ASR::expr_t*> args;
+        args.reserve(al, 1);
+        ASR::expr_t *stat = sync_stat(x.m_stat, x.n_stat);
+        if (stat) args.push_back(al, stat);
+        tmp = ASRUtils::SyncAll::create_SyncAll(
+            al, x.base.base.loc, args, diag);
+    }
+
+    void visit_SyncImages(const AST::SyncImages_t &x) {
+        Vec<ASR::expr_t*> args;
+        args.reserve(al, 2);
+        ASR::expr_t *image_set = nullptr;
+        if (x.m_image_set) {
+            this->visit_expr(*x.m_image_set);
+            image_set = ASRUtils::EXPR(tmp);
+        }
+        args.push_back(al, image_set);
+        args.push_back(al, sync_stat(x.m_stat, x.n_stat));
+        tmp = ASRUtils::SyncImages::create_SyncImages(
+            al, x.base.base.loc, args, diag);
+        if (tmp == nullptr) {
+            throw SemanticAbort();
+        }
+    }
+
     void visit_Program(const AST::Program_t &x) {
         SymbolTable *old_scope = current_scope;
         ASR::symbol_t *t = current_scope->get_symbol(to_lower(x.m_name));
@@ -1983,6 +2177,7 @@ public:
 
         Vec<ASR::stmt_t*> body;
         body.reserve(al, x.n_body);
+        register_coarrays(x, body);
         if (data_structure.size()>0) {
             for(auto it: data_structure) {
                 body.push_back(al, it);
@@ -3227,6 +3422,9 @@ public:
                     ASRUtils::create_intrinsic_subroutine create_func =
                         ASRUtils::IntrinsicImpureSubroutineRegistry::get_create_subroutine(var_name);
                     tmp = create_func(al, x.base.base.loc, args, diag);
+                    if (tmp == nullptr) {
+                        throw SemanticAbort();
+                    }
                     return tmp;
                 }
             }
@@ -4058,7 +4256,7 @@ public:
         body.reserve(al, x.n_body);
         transform_stmts(body, x.n_body, x.m_body);
         tmp = ASR::make_WhileLoop_t(al, x.base.base.loc, x.m_stmt_name, test, body.p,
-                body.size(), nullptr, 0);
+                body.size(), nullptr, 0, nullptr);
         all_loops_blocks_nesting -= 1;
     }
 
@@ -4150,7 +4348,16 @@ public:
         head.m_increment = increment;
         if (head.m_v != nullptr) {
             head.loc = head.m_v->base.loc;
-            if (loop_nesting - 1 == pragma_nesting_level && !omp_constructs.empty()) {
+            if (!omp_simd_loops.empty() && omp_simd_loops.back().body == current_body
+                    && omp_simd_loops.back().start == current_body->size()) {
+                Vec<ASR::do_loop_head_t> simd_head;
+                simd_head.reserve(al, 1);
+                simd_head.push_back(al, head);
+                tmp = ASR::make_DoConcurrentLoop_t(al, x.base.base.loc, simd_head.p,
+                    simd_head.size(), nullptr, 0, nullptr, 0, nullptr, 0, body.p, body.size(),
+                    ASR::schedule_typeType::ScheduleStatic, nullptr, omp_simd_loops.back().hint);
+                omp_simd_loops.pop_back();
+            } else if (loop_nesting - 1 == pragma_nesting_level && !omp_constructs.empty()) {
                 ASR::DoConcurrentLoop_t* do_concurrent = omp_constructs.back();
                 Vec<ASR::do_loop_head_t> do_concurrent_head;
                 do_concurrent_head.reserve(al, 1);
@@ -4166,6 +4373,10 @@ public:
                 do_concurrent->m_head = do_concurrent_head.p;
                 do_concurrent->n_head = do_concurrent_head.size();
                 tmp = (ASR::asr_t*) do_concurrent;
+            } else if (!omp_taskloops.empty() && omp_taskloops.back().body == current_body
+                    && omp_taskloops.back().start == current_body->size()) {
+                tmp = make_omp_taskloop(omp_taskloops.back(), head, body, x.base.base.loc);
+                omp_taskloops.pop_back();
             } else if (openmp_collapse == true && !omp_constructs.empty() && collapse_value > loop_nesting - static_cast<int>(omp_constructs.size()) - pragma_nesting_level) {
                 collapse_value--;
                 do_loop_heads_for_collapse.push_back(al, head);
@@ -4192,7 +4403,7 @@ public:
                 = ASRUtils::TYPE(ASR::make_Logical_t(al, x.base.base.loc, compiler_options.po.default_integer_kind));
             ASR::expr_t* cond = ASRUtils::EXPR(
                 ASR::make_LogicalConstant_t(al, x.base.base.loc, true, cond_type));
-            tmp = ASR::make_WhileLoop_t(al, x.base.base.loc, x.m_stmt_name, cond, body.p, body.size(), nullptr, 0);
+            tmp = ASR::make_WhileLoop_t(al, x.base.base.loc, x.m_stmt_name, cond, body.p, body.size(), nullptr, 0, nullptr);
         }
         loop_nesting -= 1;
         all_loops_blocks_nesting -= 1;
@@ -4305,8 +4516,12 @@ public:
                 }
             }
         }
+        // the iterations of a `do concurrent` are independent, the backend
+        // can vectorize the loop without checking its memory accesses
+        ASR::loop_hint_t *hint = ASR::down_cast<ASR::loop_hint_t>(ASR::make_LoopHint_t(
+            al, x.base.base.loc, true, false, 0, nullptr, 0, false));
         tmp = ASR::make_DoConcurrentLoop_t(al, x.base.base.loc, heads.p, heads.n, shared_expr.p, shared_expr.n, local_expr.p, local_expr.n, reductions.p, reductions.n, body.p,
-                body.size());
+                body.size(), ASR::schedule_typeType::ScheduleStatic, nullptr, hint);
         all_loops_blocks_nesting -= 1;
     }
 
@@ -4589,13 +4804,355 @@ public:
 
     }
 
+    // An integer literal or an integer variable in a clause, like the chunk
+    // size of `schedule` or the value of `grainsize`
+    ASR::expr_t* omp_integer_argument(std::string arg, const std::string &what,
+            const Location &loc) {
+        arg.erase(0, arg.find_first_not_of(" "));
+        arg.erase(arg.find_last_not_of(" ") + 1);
+        arg = to_lower(arg);
+        if (!arg.empty() && arg.find_first_not_of("0123456789") == std::string::npos) {
+            ASR::ttype_t* int_type = ASRUtils::TYPE(ASR::make_Integer_t(al, loc,
+                compiler_options.po.default_integer_kind));
+            return ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc,
+                std::stoll(arg), int_type, ASR::integerbozType::Decimal));
+        }
+        ASR::symbol_t *sym = current_scope->resolve_symbol(arg);
+        if (!sym || !ASR::is_a<ASR::Variable_t>(*ASRUtils::symbol_get_past_external(sym)) ||
+                !ASRUtils::is_integer(*ASRUtils::symbol_type(sym))) {
+            diag.add(Diagnostic(
+                "The " + what + " `" + arg
+                + "` must be an integer literal or an integer variable",
+                Level::Error, Stage::Semantic, {
+                    Label("",{loc})
+                }));
+            throw SemanticAbort();
+        }
+        return ASRUtils::EXPR(ASR::make_Var_t(al, loc, sym));
+    }
+
+    // Reads the clauses of the tasking constructs, `private` variables are
+    // handled as `firstprivate` ones
+    void omp_task_clauses(const AST::Pragma_t &x, const std::string &construct,
+            Vec<ASR::expr_t*> &shared, Vec<ASR::expr_t*> &firstprivate,
+            ASR::expr_t* &grainsize, ASR::expr_t* &num_tasks, bool &nogroup) {
+        Location loc = x.base.base.loc;
+        shared.reserve(al, 1); firstprivate.reserve(al, 1);
+        grainsize = nullptr; num_tasks = nullptr; nogroup = false;
+        for (size_t i = 0; i < x.n_clauses; i++) {
+            std::string clause = AST::down_cast<AST::String_t>(
+                x.m_clauses[i])->m_s;
+            std::string clause_name = to_lower(clause.substr(0, clause.find('(')));
+            clause_name.erase(clause_name.find_last_not_of(" ") + 1);
+            bool is_task = construct == "task" || construct == "taskloop";
+            bool is_taskloop = construct == "taskloop";
+            if (!(is_task && (clause_name == "shared" || clause_name == "firstprivate"
+                        || clause_name == "private" || clause_name == "untied"
+                        || clause_name == "mergeable"))
+                    && !(is_taskloop && (clause_name == "grainsize"
+                        || clause_name == "num_tasks" || clause_name == "nogroup"))) {
+                diag.add(Diagnostic(
+                    "The clause " + clause_name + " is not supported yet"
+                    " in the " + construct + " construct",
+                    Level::Error, Stage::Semantic, {
+                        Label("",{loc})
+                    }));
+                throw SemanticAbort();
+            }
+            // tasks are never tied to the thread that started them
+            if (clause_name == "untied" || clause_name == "mergeable") {
+                continue;
+            }
+            if (clause_name == "nogroup") {
+                nogroup = true;
+                continue;
+            }
+            std::string list = clause.substr(clause.find('(') + 1);
+            list = list.substr(0, list.rfind(')'));
+            if (clause_name == "grainsize") {
+                grainsize = omp_integer_argument(list, "grain size", loc);
+                continue;
+            }
+            if (clause_name == "num_tasks") {
+                num_tasks = omp_integer_argument(list, "number of tasks", loc);
+                continue;
+            }
+            for (auto &s: LCompilers::string_split(list, ",", false)) {
+                s.erase(0, s.find_first_not_of(" "));
+                s.erase(s.find_last_not_of(" ") + 1);
+                ASR::symbol_t *sym = current_scope->resolve_symbol(to_lower(s));
+                if (!sym) {
+                    diag.add(Diagnostic(
+                        "The clause variable `"+ s
+                        +"` is not declared",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                if (!ASR::is_a<ASR::Variable_t>(*ASRUtils::symbol_get_past_external(sym))) {
+                    diag.add(Diagnostic(
+                        "Only a variable is supported"
+                        " in the clause for now",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                ASR::expr_t *v = ASRUtils::EXPR(ASR::make_Var_t(al, loc, sym));
+                // the data block of a task only holds copies of scalars, the
+                // other variables are reached through their address
+                ASR::ttype_t* type = ASRUtils::symbol_type(sym);
+                if (clause_name != "shared" && (ASRUtils::is_array(type) ||
+                        ASRUtils::is_allocatable(type) || ASRUtils::is_pointer(type) ||
+                        !(ASRUtils::is_integer(*type) || ASRUtils::is_real(*type) ||
+                        ASRUtils::is_complex(*type) || ASRUtils::is_logical(*type)))) {
+                    diag.add(Diagnostic(
+                        "Only integer, real, complex or logical scalars are"
+                        " supported in the " + clause_name + " clause of the "
+                        + construct + " construct for now",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                if (clause_name == "shared") {
+                    shared.push_back(al, v);
+                } else {
+                    firstprivate.push_back(al, v);
+                }
+            }
+        }
+    }
+
+    // The statements between `task` (or `taskgroup`) and its end become the
+    // body of the construct
+    void end_omp_task_region(const std::string &construct, const Location &loc) {
+        if (omp_task_regions.empty() || omp_task_regions.back().construct != construct
+                || omp_task_regions.back().body != current_body) {
+            diag.add(Diagnostic(
+                "`end " + construct + "` does not close a " + construct
+                + " construct of the same block",
+                Level::Error, Stage::Semantic, {
+                    Label("",{loc})
+                }));
+            throw SemanticAbort();
+        }
+        OMPTaskRegion &region = omp_task_regions.back();
+        Vec<ASR::stmt_t*> body;
+        body.reserve(al, current_body->size() - region.start);
+        for (size_t i = region.start; i < current_body->size(); i++) {
+            body.push_back(al, current_body->p[i]);
+        }
+        current_body->n = region.start;
+        if (construct == "task") {
+            tmp = ASR::make_OMPTask_t(al, loc, body.p, body.size(),
+                region.shared.p, region.shared.size(),
+                region.firstprivate.p, region.firstprivate.size());
+        } else {
+            tmp = ASR::make_OMPTaskgroup_t(al, loc, body.p, body.size());
+        }
+        omp_task_regions.pop_back();
+    }
+
+    bool inside_omp_task() {
+        for (auto &region: omp_task_regions) {
+            if (region.construct == "task") return true;
+        }
+        return false;
+    }
+
+    /*
+        `!$omp taskloop grainsize(g)` is split into tasks of g iterations:
+
+        taskgroup
+            do lo = start, end, g
+                task firstprivate(lo, i)
+                    do i = lo, min(lo + g - 1, end)
+                        ...
+                    end do
+                end task
+            end do
+        end taskgroup
+
+        Without `grainsize`, the loop is cut into `num_tasks` tasks, 64 by
+        default.
+    */
+    ASR::asr_t* make_omp_taskloop(OMPTaskloop &taskloop, ASR::do_loop_head_t head,
+            Vec<ASR::stmt_t*> &body, const Location &loc) {
+        if (head.m_increment) {
+            ASR::expr_t* step = ASRUtils::expr_value(head.m_increment);
+            int64_t step_value = 0;
+            if (!step || !ASRUtils::extract_value(step, step_value) || step_value != 1) {
+                diag.add(Diagnostic(
+                    "Only loops with a unit step are supported"
+                    " in the taskloop construct for now",
+                    Level::Error, Stage::Semantic, {
+                        Label("",{loc})
+                    }));
+                throw SemanticAbort();
+            }
+        }
+        ASRUtils::ASRBuilder b(al, loc);
+        ASRUtils::ExprStmtDuplicator duplicator(al);
+        ASR::ttype_t* int_type = ASRUtils::expr_type(head.m_v);
+        auto cast = [&](ASR::expr_t* e) -> ASR::expr_t* {
+            e = duplicator.duplicate_expr(e);
+            if (ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(e))
+                    == ASRUtils::extract_kind_from_ttype_t(int_type)) {
+                return e;
+            }
+            return b.i2i_t(e, int_type);
+        };
+        ASR::expr_t* one = b.i_t(1, int_type);
+        auto grain = [&]() -> ASR::expr_t* {
+            if (taskloop.grainsize) {
+                return cast(taskloop.grainsize);
+            }
+            // ceiling(trip_count / num_tasks), at least 1
+            ASR::expr_t* n_tasks = taskloop.num_tasks ? cast(taskloop.num_tasks)
+                : b.i_t(64, int_type);
+            ASR::expr_t* trip_count = b.Add(b.Sub(cast(head.m_end), cast(head.m_start)), one);
+            return b.Max(b.Div(b.Sub(b.Add(trip_count, n_tasks), one), n_tasks), one);
+        };
+
+        ASR::expr_t* lo = b.Variable(current_scope,
+            current_scope->get_unique_name("omp_taskloop_lo"),
+            ASRUtils::duplicate_type(al, int_type), ASR::intentType::Local);
+        ASR::do_loop_head_t inner_head;
+        inner_head.loc = head.loc;
+        inner_head.m_v = head.m_v;
+        inner_head.m_start = lo;
+        inner_head.m_end = b.Min(b.Sub(b.Add(lo, grain()), one), cast(head.m_end));
+        inner_head.m_increment = nullptr;
+        Vec<ASR::stmt_t*> task_body; task_body.reserve(al, 1);
+        task_body.push_back(al, ASRUtils::STMT(ASR::make_DoLoop_t(al, loc, nullptr,
+            inner_head, body.p, body.size(), nullptr, 0)));
+
+        taskloop.firstprivate.push_back(al, lo);
+        taskloop.firstprivate.push_back(al, duplicator.duplicate_expr(head.m_v));
+        Vec<ASR::stmt_t*> chunks; chunks.reserve(al, 1);
+        chunks.push_back(al, ASRUtils::STMT(ASR::make_OMPTask_t(al, loc,
+            task_body.p, task_body.size(), taskloop.shared.p, taskloop.shared.size(),
+            taskloop.firstprivate.p, taskloop.firstprivate.size())));
+
+        ASR::do_loop_head_t outer_head;
+        outer_head.loc = head.loc;
+        outer_head.m_v = lo;
+        outer_head.m_start = head.m_start;
+        outer_head.m_end = head.m_end;
+        outer_head.m_increment = grain();
+        ASR::asr_t* loop = ASR::make_DoLoop_t(al, loc, nullptr, outer_head,
+            chunks.p, chunks.size(), nullptr, 0);
+        if (taskloop.nogroup) {
+            return loop;
+        }
+        Vec<ASR::stmt_t*> group_body; group_body.reserve(al, 1);
+        group_body.push_back(al, ASRUtils::STMT(loop));
+        return ASR::make_OMPTaskgroup_t(al, loc, group_body.p, group_body.size());
+    }
+
+    // Reads a `simdlen`, `safelen` or `aligned` clause, returns false for
+    // any other clause
+    bool omp_simd_clause(const std::string &clause_name, std::string list,
+            int64_t &simdlen, int64_t &safelen, Vec<ASR::aligned_expr_t> &aligned,
+            const Location &loc) {
+        if (clause_name == "simdlen" || clause_name == "safelen") {
+            list.erase(0, list.find_first_not_of(" "));
+            list.erase(list.find_last_not_of(" ") + 1);
+            if (list.empty() || list.find_first_not_of("0123456789") != std::string::npos
+                    || std::stoll(list) <= 0) {
+                diag.add(Diagnostic(
+                    "The argument of " + clause_name
+                    + " must be a positive integer literal",
+                    Level::Error, Stage::Semantic, {
+                        Label("",{loc})
+                    }));
+                throw SemanticAbort();
+            }
+            (clause_name == "simdlen" ? simdlen : safelen) = std::stoll(list);
+            return true;
+        }
+        if (clause_name != "aligned") {
+            return false;
+        }
+        // aligned(a, b[:alignment]), the alignment defaults to the one of
+        // the SSE vectors
+        int64_t alignment = 16;
+        size_t colon = list.rfind(':');
+        if (colon != std::string::npos) {
+            std::string value = list.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" "));
+            value.erase(value.find_last_not_of(" ") + 1);
+            if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos
+                    || std::stoll(value) <= 0
+                    || (std::stoll(value) & (std::stoll(value) - 1)) != 0) {
+                diag.add(Diagnostic(
+                    "The alignment of the aligned clause must be"
+                    " a power of two integer literal",
+                    Level::Error, Stage::Semantic, {
+                        Label("",{loc})
+                    }));
+                throw SemanticAbort();
+            }
+            alignment = std::stoll(value);
+            list = list.substr(0, colon);
+        }
+        for (auto &name: LCompilers::string_split(list, ",", false)) {
+            name.erase(0, name.find_first_not_of(" "));
+            name.erase(name.find_last_not_of(" ") + 1);
+            ASR::symbol_t *sym = current_scope->resolve_symbol(to_lower(name));
+            if (!sym || !ASR::is_a<ASR::Variable_t>(*ASRUtils::symbol_get_past_external(sym))
+                    || !ASRUtils::is_array(ASRUtils::symbol_type(sym))) {
+                diag.add(Diagnostic(
+                    "Only arrays are supported in the aligned clause for now",
+                    Level::Error, Stage::Semantic, {
+                        Label("",{loc})
+                    }));
+                throw SemanticAbort();
+            }
+            ASR::aligned_expr_t a; a.loc = loc;
+            a.m_arg = ASRUtils::EXPR(ASR::make_Var_t(al, loc, sym));
+            a.m_alignment = alignment;
+            aligned.push_back(al, a);
+        }
+        return true;
+    }
+
+    // The vectorization hint of a `simd` loop. Without `safelen` its
+    // iterations are independent, with it only `safelen` consecutive
+    // iterations may run at once.
+    ASR::loop_hint_t* make_omp_loop_hint(int64_t simdlen, int64_t safelen,
+            Vec<ASR::aligned_expr_t> &aligned, bool simd_only, const Location &loc) {
+        if (simdlen > 0 && safelen > 0 && simdlen > safelen) {
+            diag.add(Diagnostic(
+                "The simdlen must not be larger than the safelen",
+                Level::Error, Stage::Semantic, {
+                    Label("",{loc})
+                }));
+            throw SemanticAbort();
+        }
+        return ASR::down_cast<ASR::loop_hint_t>(ASR::make_LoopHint_t(al, loc,
+            safelen == 0, true, simdlen > 0 ? simdlen : safelen,
+            aligned.p, aligned.size(), simd_only));
+    }
+
     void visit_Pragma(const AST::Pragma_t &x) {
         if ( !compiler_options.openmp ) {
             return;
         }
         Location loc = x.base.base.loc;
         if (x.m_type == AST::OMPPragma) {
+            std::string construct = to_lower(x.m_construct_name);
             if (x.m_end) {
+                if (construct == "task" || construct == "taskgroup") {
+                    end_omp_task_region(construct, loc);
+                    return;
+                }
+                if (construct == "taskloop" || construct == "simd") {
+                    // the loop was already turned into the construct
+                    return;
+                }
                 if (LCompilers::startswith(x.m_construct_name, "parallel")) {
                     omp_constructs.pop_back();
                     if (collapse_value > 0) {
@@ -4609,6 +5166,14 @@ public:
             }
 
             if ( LCompilers::startswith(x.m_construct_name, "parallel") ) {
+                if (inside_omp_task()) {
+                    diag.add(Diagnostic(
+                        "Parallel loops inside a task construct are not supported yet",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
                 pragma_nesting_level = loop_nesting;
                 std::string name = x.m_construct_name;
                 if (name != "parallel") {
@@ -4626,11 +5191,26 @@ public:
 
                 Vec<ASR::expr_t *> m_local, m_shared; Vec<ASR::reduction_expr_t> m_reduction;
                 m_local.reserve(al, 1); m_shared.reserve(al, 1); m_reduction.reserve(al, 1);
+                ASR::schedule_typeType m_schedule = ASR::schedule_typeType::ScheduleStatic;
+                ASR::expr_t* m_chunk = nullptr;
+                bool simd = false;
+                int64_t simdlen = 0, safelen = 0;
+                Vec<ASR::aligned_expr_t> aligned; aligned.reserve(al, 1);
                 for (size_t i = 0; i < x.n_clauses; i++) {
                     std::string clause = AST::down_cast<AST::String_t>(
                         x.m_clauses[i])->m_s;
                     std::string clause_name = clause.substr(0, clause.find('('));
-                    if (clause_name != "private" && clause_name != "shared" && clause_name != "reduction" && clause_name != "collapse") {
+                    if (clause_name == "simd") {
+                        simd = true;
+                        continue;
+                    }
+                    if (omp_simd_clause(clause_name, clause.substr(clause.find('(') + 1,
+                            clause.size() - clause_name.size() - 2),
+                            simdlen, safelen, aligned, loc)) {
+                        continue;
+                    }
+                    if (clause_name != "private" && clause_name != "shared" && clause_name != "reduction" && clause_name != "collapse"
+                            && clause_name != "schedule") {
                         diag.add(Diagnostic(
                             "The clause "+ clause_name
                             +" is not supported yet",
@@ -4648,6 +5228,48 @@ public:
                         do_loop_heads_for_collapse.reserve(al, collapse_value);do_loop_bodies_for_collapse={};
                         continue;
                     }
+                    if (clause_name == "schedule") {
+                        // schedule(kind[, chunk]), the chunk is an integer
+                        // literal or an integer variable
+                        std::vector<std::string> args = LCompilers::string_split(list, ",", false);
+                        for (auto &arg: args) {
+                            arg.erase(0, arg.find_first_not_of(" "));
+                            arg.erase(arg.find_last_not_of(" ") + 1);
+                            arg = to_lower(arg);
+                        }
+                        std::string kind = args.empty() ? "" : args[0];
+                        if (kind == "static") {
+                            m_schedule = ASR::schedule_typeType::ScheduleStatic;
+                        } else if (kind == "dynamic") {
+                            m_schedule = ASR::schedule_typeType::ScheduleDynamic;
+                        } else if (kind == "guided") {
+                            m_schedule = ASR::schedule_typeType::ScheduleGuided;
+                        } else if (kind == "runtime") {
+                            m_schedule = ASR::schedule_typeType::ScheduleRuntime;
+                        } else if (kind == "auto") {
+                            m_schedule = ASR::schedule_typeType::ScheduleAuto;
+                        } else {
+                            diag.add(Diagnostic(
+                                "The schedule kind `" + kind
+                                + "` is not supported",
+                                Level::Error, Stage::Semantic, {
+                                    Label("",{loc})
+                                }));
+                            throw SemanticAbort();
+                        }
+                        if (args.size() > 2 || (args.size() == 2 && (kind == "runtime" || kind == "auto"))) {
+                            diag.add(Diagnostic(
+                                "Invalid chunk size in the schedule clause",
+                                Level::Error, Stage::Semantic, {
+                                    Label("",{loc})
+                                }));
+                            throw SemanticAbort();
+                        }
+                        if (args.size() == 2) {
+                            m_chunk = omp_integer_argument(args[1], "chunk size", loc);
+                        }
+                        continue;
+                    }
                     if (clause_name == "reduction") {
                         std::string reduction_op = list.substr(0, list.find(':'));
                         if ( reduction_op == "+" ) {
@@ -4670,6 +5292,15 @@ public:
                             throw SemanticAbort();
                         }
                         list = list.substr(list.find(':')+1);
+                        // `reduction(+:a(:))` reduces the whole array `a`
+                        std::string names;
+                        int depth = 0;
+                        for (char c: list) {
+                            if (c == '(') depth++;
+                            else if (c == ')') depth--;
+                            else if (depth == 0) names += c;
+                        }
+                        list = names;
                     }
                     for (auto &s: LCompilers::string_split(list, ",", false)) {
                         s.erase(0, s.find_first_not_of(" "));
@@ -4704,16 +5335,103 @@ public:
                         }
                     }
                 }
+                if (!simd && (simdlen > 0 || safelen > 0 || aligned.size() > 0)) {
+                    diag.add(Diagnostic(
+                        "The simdlen, safelen and aligned clauses"
+                        " require the `parallel do simd` construct",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                ASR::loop_hint_t* hint = simd
+                    ? make_omp_loop_hint(simdlen, safelen, aligned, false, loc) : nullptr;
                 Vec<ASR::do_loop_head_t> heads;
                 heads.reserve(al,1);
                 ASR::do_loop_head_t head{};
                 heads.push_back(al, head);
                 omp_constructs.push_back(ASR::down_cast2<ASR::DoConcurrentLoop_t>(
                 ASR::make_DoConcurrentLoop_t(al,loc, heads.p, heads.n, m_shared.p,
-                m_shared.n, m_local.p, m_local.n, m_reduction.p, m_reduction.n, nullptr, 0)));
+                m_shared.n, m_local.p, m_local.n, m_reduction.p, m_reduction.n, nullptr, 0,
+                m_schedule, m_chunk, hint)));
 
             } else if ( to_lower(x.m_construct_name) == "do" ) {
                 // pass
+            } else if ( construct == "simd" ) {
+                // the loop runs on a single thread, `private`, `lastprivate`
+                // and `reduction` variables need no copies
+                int64_t simdlen = 0, safelen = 0;
+                Vec<ASR::aligned_expr_t> aligned; aligned.reserve(al, 1);
+                for (size_t i = 0; i < x.n_clauses; i++) {
+                    std::string clause = AST::down_cast<AST::String_t>(
+                        x.m_clauses[i])->m_s;
+                    std::string clause_name = to_lower(clause.substr(0, clause.find('(')));
+                    clause_name.erase(clause_name.find_last_not_of(" ") + 1);
+                    std::string list = clause.substr(clause.find('(') + 1);
+                    list = list.substr(0, list.rfind(')'));
+                    if (omp_simd_clause(clause_name, list, simdlen, safelen, aligned, loc)
+                            || clause_name == "private" || clause_name == "lastprivate"
+                            || clause_name == "reduction") {
+                        continue;
+                    }
+                    diag.add(Diagnostic(
+                        "The clause " + clause_name + " is not supported yet"
+                        " in the simd construct",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                omp_simd_loops.push_back({current_body, current_body->size(),
+                    make_omp_loop_hint(simdlen, safelen, aligned, true, loc)});
+            } else if ( construct == "declare" && x.n_clauses > 0 && LCompilers::startswith(to_lower(
+                    AST::down_cast<AST::String_t>(x.m_clauses[0])->m_s), "simd") ) {
+                // LLVM does not create the vector variants of a procedure,
+                // it is inlined into the simd loops that call it instead
+                ASR::asr_t* owner = current_scope->asr_owner;
+                if (!ASR::is_a<ASR::symbol_t>(*owner) ||
+                        !ASR::is_a<ASR::Function_t>(*ASR::down_cast<ASR::symbol_t>(owner))) {
+                    diag.add(Diagnostic(
+                        "The declare simd construct must appear in a procedure",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                ASRUtils::get_FunctionType(ASR::down_cast<ASR::Function_t>(
+                    ASR::down_cast<ASR::symbol_t>(owner)))->m_inline = true;
+            } else if ( construct == "task" || construct == "taskgroup"
+                    || construct == "taskloop" ) {
+                if (construct != "taskgroup" && inside_omp_task()) {
+                    diag.add(Diagnostic(
+                        "Nested task constructs are not supported yet",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                Vec<ASR::expr_t*> shared, firstprivate;
+                ASR::expr_t *grainsize, *num_tasks;
+                bool nogroup;
+                omp_task_clauses(x, construct, shared, firstprivate,
+                    grainsize, num_tasks, nogroup);
+                if (construct == "taskloop") {
+                    omp_taskloops.push_back({current_body, current_body->size(),
+                        shared, firstprivate, grainsize, num_tasks, nogroup});
+                } else {
+                    omp_task_regions.push_back({construct, current_body,
+                        current_body->size(), shared, firstprivate});
+                }
+            } else if ( construct == "taskwait" ) {
+                if (x.n_clauses > 0) {
+                    diag.add(Diagnostic(
+                        "The taskwait construct does not take clauses",
+                        Level::Error, Stage::Semantic, {
+                            Label("",{loc})
+                        }));
+                    throw SemanticAbort();
+                }
+                tmp = ASR::make_OMPTaskwait_t(al, loc);
             } else {
                 diag.add(Diagnostic(
                     "The construct "+ std::string(x.m_construct_name)
@@ -4769,6 +5487,7 @@ Result<ASR::TranslationUnit_t*> body_visitor(Allocator &al,
         std::vector<ASR::stmt_t*> &data_structure,
         LCompilers::LocationManager &lm)
 {
+    ProfileRegion profile_region("body_visitor", "phase");
     BodyVisitor b(al, unit, diagnostics, compiler_options, implicit_mapping,
         common_variables_hash, external_procedures_mapping,
         explicit_intrinsic_procedures_mapping,
@@ -1121,6 +1121,10 @@ public:
         {"dshiftl", IntrinsicSignature({"i", "j", "shift"}, 3, 3)},
         {"dshiftr", IntrinsicSignature({"i", "j", "shift"}, 3, 3)},
         {"random_init", IntrinsicSignature({"repeatable", "image"}, 2, 2)},
+        {"co_sum", IntrinsicSignature({"a", "result_image", "stat", "errmsg"}, 1, 4)},
+        {"co_max", IntrinsicSignature({"a", "result_image", "stat", "errmsg"}, 1, 4)},
+        {"co_min", IntrinsicSignature({"a", "result_image", "stat", "errmsg"}, 1, 4)},
+        {"co_broadcast", IntrinsicSignature({"a", "source_image", "stat", "errmsg"}, 2, 4)},
         {"random_seed", IntrinsicSignature({"size", "put", "get"}, 0, 3)},
         {"get_command", IntrinsicSignature({"command", "length", "status"}, 0, 3)},
         {"get_command_argument", IntrinsicSignature({"number", "value", "length", "status"}, 1, 4)},
@@ -3245,6 +3249,8 @@ public:
                     s.m_initializer = assgnd_storage[sym].second;
                 }
                 bool is_pointer = false;
+                AST::codimension_t *codims = s.m_codim;
+                size_t n_codims = s.n_codim;
                 if (current_scope->get_symbol(sym) !=
                         nullptr) {
                     if (current_scope->parent != nullptr && !is_external) {
@@ -3398,6 +3404,13 @@ public:
                             process_dims(al, dims, ad->m_dim, ad->n_dim, is_compile_time, is_char_type,
                                 (s_intent == ASRUtils::intent_in || s_intent == ASRUtils::intent_out ||
                                 s_intent == ASRUtils::intent_inout) || is_argument);
+                        } else if (AST::is_a<AST::AttrCodimension_t>(*a)) {
+                            AST::AttrCodimension_t *ac =
+                                AST::down_cast<AST::AttrCodimension_t>(a);
+                            if (n_codims == 0) {
+                                codims = ac->m_codim;
+                                n_codims = ac->n_codim;
+                            }
                         } else {
                             diag.add(Diagnostic(
                                 "Attribute type not implemented yet",
@@ -3469,6 +3482,10 @@ public:
                 type = determine_type(x.base.base.loc, sym, x.m_vartype, is_pointer,
                     is_allocatable, dims, type_declaration, s_abi,
                     (s_intent != ASRUtils::intent_local) || is_argument, is_dimension_star);
+                if (n_codims > 0) {
+                    type = create_coarray_type(s.loc, codims, n_codims, type,
+                        is_allocatable || is_pointer || storage_type == ASR::storage_typeType::Parameter);
+                }
                 if ( is_attr_external ) create_external_function(sym, x.m_syms[i].loc, type);
                 if ( current_scope->get_symbol( sym ) != nullptr && ( is_external && !is_attr_external ) ) {
                     /*
@@ -7287,10 +7304,66 @@ public:
         }
     }
 
+    // A coarray lives in the coarray heap of its image. It becomes a pointer,
+    // BodyVisitor::register_coarrays associates it with its storage at the
+    // start of the main program.
+    ASR::ttype_t* create_coarray_type(const Location &loc, AST::codimension_t *codims,
+            size_t n_codims, ASR::ttype_t *type, bool is_dynamic) {
+        if (in_module || in_Subroutine || is_derived_type || is_dynamic) {
+            diag.add(Diagnostic(
+                "Only coarrays declared in the main program without the "
+                "allocatable, pointer or parameter attribute are supported",
+                Level::Error, Stage::Semantic, {Label("", {loc})}));
+            throw SemanticAbort();
+        }
+        if (n_codims != 1 || codims[0].m_start != nullptr ||
+                codims[0].m_end_star != AST::codimension_typeType::CodimensionStar) {
+            diag.add(Diagnostic(
+                "Only coarrays with codimension [*] are supported",
+                Level::Error, Stage::Semantic, {Label("", {loc})}));
+            throw SemanticAbort();
+        }
+        ASR::ttype_t *el_type = ASRUtils::type_get_past_array(type);
+        if (!ASRUtils::is_integer(*el_type) && !ASRUtils::is_real(*el_type) &&
+                !ASRUtils::is_complex(*el_type) && !ASRUtils::is_logical(*el_type)) {
+            diag.add(Diagnostic(
+                "Only coarrays of integer, real, complex or logical type are supported",
+                Level::Error, Stage::Semantic, {Label("", {loc})}));
+            throw SemanticAbort();
+        }
+        if (ASRUtils::is_array(type)) {
+            ASR::dimension_t *m_dims = nullptr;
+            size_t n_dims = ASRUtils::extract_dimensions_from_ttype(type, m_dims);
+            Vec<ASR::dimension_t> deferred_dims;
+            deferred_dims.reserve(al, n_dims);
+            for (size_t i = 0; i < n_dims; i++) {
+                int64_t start = -1, length = -1;
+                if (!m_dims[i].m_start || !m_dims[i].m_length ||
+                        !ASRUtils::extract_value(ASRUtils::expr_value(m_dims[i].m_start), start) ||
+                        !ASRUtils::extract_value(ASRUtils::expr_value(m_dims[i].m_length), length) ||
+                        start != 1) {
+                    diag.add(Diagnostic(
+                        "Only coarrays with constant dimensions and lower bounds 1 are supported",
+                        Level::Error, Stage::Semantic, {Label("", {loc})}));
+                    throw SemanticAbort();
+                }
+                ASR::dimension_t dim;
+                dim.loc = loc;
+                dim.m_start = nullptr;
+                dim.m_length = nullptr;
+                deferred_dims.push_back(al, dim);
+            }
+            type = ASRUtils::make_Array_t_util(al, loc, el_type, deferred_dims.p,
+                deferred_dims.size(), ASR::abiType::Source, false,
+                ASR::array_physical_typeType::DescriptorArray, false, false);
+        }
+        return ASRUtils::TYPE(ASR::make_Pointer_t(al, loc, type));
+    }
+
     void is_coarray_or_atomic(std::string intrinsic_name, const Location& loc){
         std::vector<std::string> coarray_intrinsics, atomic_intrinsics;
-        coarray_intrinsics = {"co_broadcast", "co_max", "co_min", "co_reduce", "co_sum", "lcobound", "ucobound", "failed_images",
-            "image_status", "get_team", "image_index", "num_images", "stopped_images", "team_number", "this_image", "coshape", "corank",
+        coarray_intrinsics = {"co_reduce", "lcobound", "ucobound", "failed_images",
+            "image_status", "get_team", "image_index", "stopped_images", "team_number", "coshape", "corank",
             "event_query"};
         atomic_intrinsics = {"atomic_add", "atomic_and", "atomic_cas", "atomic_define", "atomic_fetch_add", "atomic_fetch_and",
             "atomic_fetch_or", "atomic_fetch_xor", "atomic_or", "atomic_ref", "atomic_xor"};
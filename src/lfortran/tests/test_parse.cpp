@@ -3,10 +3,14 @@
 #include <iostream>
 #include <sstream>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <string>
 
 #include <lfortran/parser/parser.h>
 #include <lfortran/parser/parser.tab.hh>
+#include <lfortran/parser/preprocessor.h>
+#include <lfortran/parser/include_cache.h>
 #include <libasr/bigint.h>
 
 using LCompilers::LFortran::parse;
@@ -1395,3 +1399,95 @@ TEST_CASE("Errors") {
     CHECK(diagnostics.diagnostics[0].labels[0].spans[0].loc.last == 2);
     diagnostics.diagnostics.clear();
 }
+
+// Preprocesses `input` with a new preprocessor, as a new compiler invocation
+// would
+static std::string cpp_run(const std::string &input,
+    const std::string &filename="main.f90")
+{
+    LCompilers::CompilerOptions co;
+    LCompilers::LFortran::CPreprocessor cpp(co);
+    LCompilers::LocationManager lm;
+    {
+        LCompilers::LocationManager::FileLocations fl;
+        fl.in_filename = filename;
+        lm.files.push_back(fl);
+        lm.file_ends.push_back(input.size());
+    }
+    LCompilers::diag::Diagnostics diagnostics;
+    Result<std::string> res = cpp.run(input, lm, cpp.macro_definitions,
+        diagnostics);
+    REQUIRE(res.ok);
+    return res.result;
+}
+
+TEST_CASE("Include cache") {
+    using LCompilers::LFortran::IncludeCache;
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path()
+        / ("lfortran_include_cache_" + LCompilers::get_unique_ID());
+    fs::path cache_dir = dir / "include";
+    fs::create_directories(dir);
+    {
+        std::ofstream out(dir / "n.h");
+        out << "#define N 4\nx = N\nf = __FILE__\n";
+    }
+    std::string input = "#include \"" + (dir / "n.h").generic_string()
+        + "\"\ny = N\nz = __FILE__\n";
+    IncludeCache &cache = IncludeCache::get();
+    cache.clear();
+    cache.set_cache_dir(cache_dir.string());
+
+    // The first invocation stores one entry on disk
+    std::string expected = cpp_run(input);
+    CHECK(expected.find("x = 4") != std::string::npos);
+    CHECK(expected.find("y = 4") != std::string::npos);
+    CHECK(expected.find("f = \"" + (dir / "n.h").generic_string() + "\"")
+        != std::string::npos);
+    CHECK(expected.find("z = \"main.f90\"") != std::string::npos);
+    CHECK(cache.hits() == 0);
+    CHECK(cache.misses() == 1);
+    std::vector<fs::path> entries;
+    for (auto &e : fs::directory_iterator(cache_dir)) {
+        entries.push_back(e.path());
+    }
+    REQUIRE(entries.size() == 1);
+
+    // A second invocation (nothing in memory) reuses it, including the
+    // macros defined by the include
+    cache.clear();
+    CHECK(cpp_run(input) == expected);
+    CHECK(cache.hits() == 1);
+    CHECK(cache.misses() == 0);
+
+    // Another includer reuses it too, `__FILE__` is not part of the key
+    cache.clear();
+    std::string other = cpp_run(input, "other.f90");
+    CHECK(cache.hits() == 1);
+    CHECK(cache.misses() == 0);
+    CHECK(other.find("x = 4") != std::string::npos);
+    CHECK(other.find("y = 4") != std::string::npos);
+    CHECK(other.find("f = \"" + (dir / "n.h").generic_string() + "\"")
+        != std::string::npos);
+    CHECK(other.find("z = \"other.f90\"") != std::string::npos);
+
+    // A corrupted macro state is a miss, the include is preprocessed again
+    {
+        std::string data;
+        REQUIRE(LCompilers::read_file(entries[0].string(), data));
+        std::vector<std::string> v;
+        REQUIRE(IncludeCache::deserialize_strings(data, v));
+        REQUIRE(v.size() > 2);
+        v[2] = "1:N";
+        data.clear();
+        IncludeCache::serialize_strings(v, data);
+        std::ofstream out(entries[0], std::ios::binary);
+        out << data;
+    }
+    cache.clear();
+    CHECK(cpp_run(input) == expected);
+
+    cache.set_cache_dir("");
+    cache.clear();
+    fs::remove_all(dir);
+}
@@ -21,6 +21,8 @@ class Allocator
     size_t current_pos;
     size_t size;
     std::vector<void*> blocks;
+    // Bytes handed out from the chunks before the current one
+    size_t size_previous_chunks = 0;
 public:
     Allocator(size_t s) {
         s += ALIGNMENT;
@@ -74,6 +76,8 @@ public:
     }
 
     void *new_chunk(size_t s) {
+        // `alloc` has already advanced past the end of the current chunk
+        size_previous_chunks += current_pos - align(s) - (size_t)start;
         size_t snew = std::max(s+ALIGNMENT, 2*size);
         start = malloc(snew);
         blocks.push_back(start);
@@ -123,6 +127,13 @@ public:
     size_t num_chunks() {
         return blocks.size();
     }
+
+    // The high-water mark of the memory handed out so far, in bytes. Memory
+    // is never returned to the allocator, so this only grows and the peak of
+    // a phase is the difference of the marks at its end and start.
+    size_t high_water_mark() {
+        return size_previous_chunks + size_current();
+    }
 };
 
 #endif
@@ -272,6 +272,8 @@ class ASTNodeVisitor(ASDLVisitor):
         self.emit(    "n->base.base.loc = a_loc;", 2)
         for line in lines:
             self.emit(line, 2)
+        if subs["mod"] == "asr" and base in ["stmt", "expr"]:
+            self.emit(    "if (node_created) node_created(n->base.base);", 2)
         self.emit(    "return (%(mod)s_t*)n;" % subs, 2)
         self.emit("}", 1)
         self.emit("")
@@ -10,6 +10,8 @@ std::string lcompilers_commandline_options;
 
 namespace LCompilers  {
 
+thread_local void (*ASR::node_created)(const ASR::asr_t &x) = nullptr;
+
 template< typename T >
 std::string hexify(T i)
 {
@@ -13,6 +13,30 @@ namespace ASR {
     struct asr_t;
     struct stmt_t;
     struct symbol_t;
+
+    // Called with every statement and expression that is created by this
+    // thread while it is set, use NodeCreatedHook to set it
+    extern thread_local void (*node_created)(const asr_t &x);
+
+    // Sets `node_created` while it is alive and restores the previous hook
+    // when destroyed, so that hooks can be nested
+    class NodeCreatedHook {
+    public:
+        explicit NodeCreatedHook(void (*hook)(const asr_t &x))
+            : previous(node_created) {
+            node_created = hook;
+        }
+
+        ~NodeCreatedHook() {
+            node_created = previous;
+        }
+
+        NodeCreatedHook(const NodeCreatedHook &) = delete;
+        NodeCreatedHook &operator=(const NodeCreatedHook &) = delete;
+
+    private:
+        void (*previous)(const asr_t &x);
+    };
 }
 
 struct SymbolTable {
@@ -458,6 +458,12 @@ ASR::TranslationUnit_t* find_and_load_module(Allocator &al, const std::string &m
         std::string modfile;
         std::filesystem::path full_path = path / filename;
         if (read_file(full_path.string(), modfile)) {
+            // The hash of what was loaded, the file may change before the
+            // compilation ends
+            if (pass_options.loaded_mod_files && !intrinsic) {
+                pass_options.loaded_mod_files->push_back(
+                    {full_path.string(), sha256_hex(modfile)});
+            }
             ASR::TranslationUnit_t *asr = load_modfile(al, modfile, false, symtab, lm);
             if (intrinsic) {
                 set_intrinsic(asr);
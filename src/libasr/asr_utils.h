@@ -6474,6 +6474,42 @@ class RemoveArrayProcessingNodeVisitor: public ASR::CallReplacerOnExpressionsVis
 
 };
 
+// Finds an `exit` of a loop that encloses the visited statements, which a
+// C `switch` around them would capture
+class LoopExitFinder: public ASR::BaseWalkVisitor<LoopExitFinder> {
+
+    public:
+
+        bool has_exit = false;
+        size_t loop_depth = 0;
+
+        void visit_Exit(const ASR::Exit_t& x) {
+            if( loop_depth == 0 || x.m_stmt_name ) {
+                has_exit = true;
+            }
+        }
+
+        void visit_DoLoop(const ASR::DoLoop_t& x) {
+            loop_depth++;
+            ASR::BaseWalkVisitor<LoopExitFinder>::visit_DoLoop(x);
+            loop_depth--;
+        }
+
+        void visit_WhileLoop(const ASR::WhileLoop_t& x) {
+            loop_depth++;
+            ASR::BaseWalkVisitor<LoopExitFinder>::visit_WhileLoop(x);
+            loop_depth--;
+        }
+};
+
+static inline bool has_loop_exit(ASR::stmt_t** m_body, size_t n_body) {
+    LoopExitFinder finder;
+    for( size_t i = 0; i < n_body && !finder.has_exit; i++ ) {
+        finder.visit_stmt(*m_body[i]);
+    }
+    return finder.has_exit;
+}
+
 } // namespace ASRUtils
 
 } // namespace LCompilers
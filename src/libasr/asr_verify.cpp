@@ -60,6 +60,9 @@ public:
     VerifyVisitor(bool check_external, diag::Diagnostics &diagnostics) : check_external{check_external},
         diagnostics{diagnostics}, symbol_visited{false} {}
 
+    // The functions that are not verified
+    const std::set<const ASR::symbol_t*> *unchanged = nullptr;
+
     // Requires the condition `cond` to be true. Raise an exception otherwise.
     #define require(cond, error_msg) ASRUtils::require_impl((cond), (error_msg), x.base.base.loc, diagnostics);
     #define require_with_loc(cond, error_msg, loc) ASRUtils::require_impl((cond), (error_msg), loc, diagnostics);
@@ -424,6 +427,9 @@ public:
     }
 
     void visit_Function(const Function_t &x) {
+        if (unchanged && unchanged->find(&x.base) != unchanged->end()) {
+            return;
+        }
         if (ASRUtils::get_FunctionType(&x)->m_abi == abiType::Interactive) {
             require(x.n_body == 0,
             "The Function::n_body should be 0 if abi set to Interactive");
@@ -1292,4 +1298,18 @@ bool asr_verify(const ASR::TranslationUnit_t &unit, bool check_external,
     return true;
 }
 
+bool asr_verify(const ASR::TranslationUnit_t &unit, bool check_external,
+            diag::Diagnostics &diagnostics,
+            const std::set<const ASR::symbol_t*> &unchanged) {
+    ASR::VerifyVisitor v(check_external, diagnostics);
+    v.unchanged = &unchanged;
+    try {
+        v.visit_TranslationUnit(unit);
+    } catch (const ASRUtils::VerifyAbort &) {
+        LCOMPILERS_ASSERT(diagnostics.has_error())
+        return false;
+    }
+    return true;
+}
+
 } // namespace LCompilers
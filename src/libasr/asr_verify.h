@@ -1,6 +1,8 @@
 #ifndef LFORTRAN_ASR_VERIFY_H
 #define LFORTRAN_ASR_VERIFY_H
 
+#include <set>
+
 #include <libasr/asr.h>
 
 namespace LCompilers {
@@ -38,6 +40,12 @@ namespace LCompilers {
     bool asr_verify(const ASR::TranslationUnit_t &unit,
         bool check_external, diag::Diagnostics &diagnostics);
 
+    // Same, but does not verify the functions in `unchanged` (nor the
+    // symbols nested in them), e.g. the ones a pass did not change
+    bool asr_verify(const ASR::TranslationUnit_t &unit,
+        bool check_external, diag::Diagnostics &diagnostics,
+        const std::set<const ASR::symbol_t*> &unchanged);
+
 } // namespace LCompilers
 
 #endif // LFORTRAN_ASR_VERIFY_H
@@ -24,6 +24,7 @@
 #include <libasr/pass/unused_functions.h>
 #include <libasr/pass/intrinsic_function_registry.h>
 #include <libasr/pass/intrinsic_subroutine_registry.h>
+#include <libasr/pass/replace_select_case.h>
 
 
 #include <map>
@@ -2722,8 +2723,76 @@ PyMODINIT_FUNC PyInit_lpython_module_)" + fn_name + R"((void) {
         src = out;
     }
 
+    // Emits a `switch` for a `select case` on constant integer labels, unless
+    // a case exits an enclosing loop, which `break` cannot do from a `switch`
+    bool visit_Select_as_switch(const ASR::Select_t& x)
+    {
+        std::map<int64_t, std::pair<int64_t, size_t>> ranges;
+        if (!get_select_case_switch_values(x, ranges) ||
+                ASRUtils::has_loop_exit(x.m_default, x.n_default)) {
+            return false;
+        }
+        std::vector<std::vector<int64_t>> case_values(x.n_body);
+        for (auto &range: ranges) {
+            for (int64_t value = range.first; ; value++) {
+                case_values[range.second.second].push_back(value);
+                if (value == range.second.first) break;
+            }
+        }
+        std::vector<std::pair<ASR::stmt_t**, size_t>> bodies;
+        for (size_t i = 0; i < x.n_body; i++) {
+            if (ASR::is_a<ASR::CaseStmt_t>(*x.m_body[i])) {
+                ASR::CaseStmt_t* case_stmt = ASR::down_cast<ASR::CaseStmt_t>(x.m_body[i]);
+                bodies.push_back({case_stmt->m_body, case_stmt->n_body});
+            } else {
+                ASR::CaseStmt_Range_t* case_range = ASR::down_cast<ASR::CaseStmt_Range_t>(x.m_body[i]);
+                bodies.push_back({case_range->m_body, case_range->n_body});
+            }
+            if (ASRUtils::has_loop_exit(bodies[i].first, bodies[i].second)) {
+                return false;
+            }
+        }
+        std::string indent(indentation_level * indentation_spaces, ' ');
+        this->visit_expr(*x.m_test);
+        std::string out = indent + "switch (" + src + ") {\n";
+        for (size_t i = 0; i < x.n_body; i++) {
+            if (case_values[i].empty()) {
+                continue;
+            }
+            for (int64_t value: case_values[i]) {
+                out += indent + "case " + std::to_string(value) + ":\n";
+            }
+            out += indent + "{\n";
+            indentation_level += 1;
+            for (size_t j = 0; j < bodies[i].second; j++) {
+                this->visit_stmt(*bodies[i].first[j]);
+                out += src;
+            }
+            out += indent + std::string(indentation_spaces, ' ') + "break;\n";
+            indentation_level -= 1;
+            out += indent + "}\n";
+        }
+        if (x.n_default) {
+            out += indent + "default:\n" + indent + "{\n";
+            indentation_level += 1;
+            for (size_t i = 0; i < x.n_default; i++) {
+                this->visit_stmt(*x.m_default[i]);
+                out += src;
+            }
+            out += indent + std::string(indentation_spaces, ' ') + "break;\n";
+            indentation_level -= 1;
+            out += indent + "}\n";
+        }
+        out += indent + "}\n";
+        src = check_tmp_buffer() + out;
+        return true;
+    }
+
     void visit_Select(const ASR::Select_t& x)
     {
+        if (visit_Select_as_switch(x)) {
+            return;
+        }
         std::string indent(indentation_level * indentation_spaces, ' ');
         this->visit_expr(*x.m_test);
         std::string var = std::move(src);
@@ -1350,6 +1350,28 @@ public:
 
     void visit_IntrinsicImpureSubroutine( const ASR::IntrinsicImpureSubroutine_t &x ) {
         std::string out;
+        if (x.m_sub_intrinsic_id == static_cast<int64_t>(ASRUtils::IntrinsicImpureSubroutines::SyncAll) ||
+                x.m_sub_intrinsic_id == static_cast<int64_t>(ASRUtils::IntrinsicImpureSubroutines::SyncImages)) {
+            bool sync_all = x.m_sub_intrinsic_id == static_cast<int64_t>(ASRUtils::IntrinsicImpureSubroutines::SyncAll);
+            out = sync_all ? "sync all" : "sync images";
+            size_t i = 0;
+            std::string args;
+            if (!sync_all) {
+                if (x.m_overload_id == 0) {
+                    visit_expr(*x.m_args[i++]);
+                    args = src;
+                } else {
+                    args = "*";
+                }
+            }
+            if (i < x.n_args) {
+                visit_expr(*x.m_args[i]);
+                args += std::string(args.empty() ? "" : ", ") + "stat=" + src;
+            }
+            if (!args.empty()) out += "(" + args + ")";
+            src = indent + out + "\n";
+            return;
+        }
         out = "call ";
         switch ( x.m_sub_intrinsic_id ) {
             SET_INTRINSIC_SUBROUTINE_NAME(RandomNumber, "random_number");
@@ -1362,6 +1384,10 @@ public:
             SET_INTRINSIC_SUBROUTINE_NAME(Srand, "srand");
             SET_INTRINSIC_SUBROUTINE_NAME(SystemClock, "system_clock");
             SET_INTRINSIC_SUBROUTINE_NAME(DateAndTime, "date_and_time");
+            SET_INTRINSIC_SUBROUTINE_NAME(CoSum, "co_sum");
+            SET_INTRINSIC_SUBROUTINE_NAME(CoMax, "co_max");
+            SET_INTRINSIC_SUBROUTINE_NAME(CoMin, "co_min");
+            SET_INTRINSIC_SUBROUTINE_NAME(CoBroadcast, "co_broadcast");
             default : {
                 throw LCompilersException("IntrinsicImpureSubroutine: `"
                     + ASRUtils::get_intrinsic_name(x.m_sub_intrinsic_id)
@@ -44,10 +44,12 @@
 #include <libasr/codegen/asr_to_llvm.h>
 #include <libasr/pass/pass_manager.h>
 #include <libasr/exception.h>
+#include <libasr/profiler.h>
 #include <libasr/asr_utils.h>
 #include <libasr/codegen/llvm_utils.h>
 #include <libasr/codegen/llvm_array_utils.h>
 #include <libasr/pass/intrinsic_function_registry.h>
+#include <libasr/pass/intrinsic_subroutine_registry.h>
 
 namespace LCompilers {
 
@@ -290,8 +292,142 @@ public:
         builder->SetInsertPoint(bb);
     }
 
+    // Whether `ptr` addresses a different location in every iteration of a
+    // loop, like an array element indexed by the loop variable, or a local
+    // scalar that is promoted to a register before the loop is vectorized
+    bool is_per_iteration_address(llvm::Value* ptr) {
+        ptr = ptr->stripPointerCasts();
+        if (llvm::isa<llvm::AllocaInst>(ptr)) {
+            return true;
+        }
+        llvm::GetElementPtrInst* gep = llvm::dyn_cast<llvm::GetElementPtrInst>(ptr);
+        if (!gep) {
+            return false;
+        }
+        for (auto idx = gep->idx_begin(); idx != gep->idx_end(); idx++) {
+            if (!llvm::isa<llvm::Constant>(*idx)) {
+                return true;
+            }
+        }
+        return is_per_iteration_address(gep->getPointerOperand());
+    }
+
+    /*
+        Attaches the loop hint to the branch that closes the loop:
+
+        br label %loop.head, !llvm.loop !0
+        !0 = distinct !{!0, !1, !2}
+        !1 = !{!"llvm.loop.parallel_accesses", !3}
+        !2 = !{!"llvm.loop.vectorize.width", i32 8}
+
+        The memory accesses of the loop body, from `first_block` on, are put
+        in the access group !3 of independent loops. A store to a location
+        shared by all the iterations, like a module variable, leaves the
+        loop to the dependence analysis of LLVM.
+    */
+    void set_loop_hint(ASR::loop_hint_t* loop_hint, llvm::BasicBlock* first_block,
+            llvm::Instruction* latch) {
+        ASR::LoopHint_t* hint = ASR::down_cast<ASR::LoopHint_t>(loop_hint);
+        std::vector<llvm::Metadata*> loop_properties = {nullptr};
+        if (hint->m_independent) {
+            std::vector<llvm::Instruction*> accesses;
+            bool independent = true;
+            for (auto bb = first_block->getIterator(); ; bb++) {
+                for (llvm::Instruction &inst: *bb) {
+                    if (!inst.mayReadOrWriteMemory()) {
+                        continue;
+                    }
+                    llvm::StoreInst* store = llvm::dyn_cast<llvm::StoreInst>(&inst);
+                    if (store && !is_per_iteration_address(store->getPointerOperand())) {
+                        independent = false;
+                    }
+                    accesses.push_back(&inst);
+                }
+                if (&*bb == latch->getParent()) {
+                    break;
+                }
+            }
+            if (independent) {
+                llvm::MDNode* access_group = llvm::MDNode::getDistinct(context, {});
+                for (llvm::Instruction* inst: accesses) {
+                    // an access of a nested loop also belongs to its groups
+                    llvm::MDNode* groups = inst->getMetadata(llvm::LLVMContext::MD_access_group);
+                    if (groups) {
+                        std::vector<llvm::Metadata*> all_groups;
+                        if (groups->getNumOperands() == 0) {
+                            all_groups.push_back(groups);
+                        } else {
+                            all_groups.insert(all_groups.end(), groups->op_begin(), groups->op_end());
+                        }
+                        all_groups.push_back(access_group);
+                        groups = llvm::MDNode::get(context, all_groups);
+                    } else {
+                        groups = access_group;
+                    }
+                    inst->setMetadata(llvm::LLVMContext::MD_access_group, groups);
+                }
+                loop_properties.push_back(llvm::MDNode::get(context, {
+                    llvm::MDString::get(context, "llvm.loop.parallel_accesses"), access_group}));
+            }
+        }
+        if (hint->m_vectorize) {
+            loop_properties.push_back(llvm::MDNode::get(context, {
+                llvm::MDString::get(context, "llvm.loop.vectorize.enable"),
+                llvm::ConstantAsMetadata::get(builder->getTrue())}));
+        }
+        if (hint->m_vectorize_width > 0) {
+            loop_properties.push_back(llvm::MDNode::get(context, {
+                llvm::MDString::get(context, "llvm.loop.vectorize.width"),
+                llvm::ConstantAsMetadata::get(builder->getInt32(hint->m_vectorize_width))}));
+        }
+        if (loop_properties.size() == 1) {
+            return;
+        }
+        llvm::MDNode* loop_id = llvm::MDNode::getDistinct(context, loop_properties);
+        loop_id->replaceOperandWith(0, loop_id);
+        latch->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+    }
+
+    // The arrays of the `aligned` clause start at a multiple of the
+    // alignment, which lets the vectorizer use aligned loads and stores
+    void create_alignment_assumptions(ASR::loop_hint_t* loop_hint) {
+        ASR::LoopHint_t* hint = ASR::down_cast<ASR::LoopHint_t>(loop_hint);
+        for (size_t i = 0; i < hint->n_aligned; i++) {
+            ASR::expr_t* arg = hint->m_aligned[i].m_arg;
+            ASR::ttype_t* type = ASRUtils::expr_type(arg);
+            int64_t ptr_loads_copy = ptr_loads;
+            ptr_loads = 2 - LLVM::is_llvm_pointer(*type);
+            this->visit_expr_wrapper(arg, false);
+            ptr_loads = ptr_loads_copy;
+            llvm::Value* data = tmp;
+            switch (ASRUtils::extract_physical_type(type)) {
+                case ASR::array_physical_typeType::DescriptorArray: {
+                    llvm::Value* descriptor = tmp;
+                    llvm::Type* data_type = llvm_utils->get_type_from_ttype_t_util(
+                        ASRUtils::extract_type(type), module.get());
+                    data = llvm_utils->CreateLoad2(data_type->getPointerTo(),
+                        arr_descr->get_pointer_to_data(descriptor));
+                    data = llvm_utils->create_ptr_gep2(data_type, data,
+                        arr_descr->get_offset(descriptor));
+                    break;
+                }
+                case ASR::array_physical_typeType::FixedSizeArray:
+                case ASR::array_physical_typeType::PointerToDataArray:
+                case ASR::array_physical_typeType::UnboundedPointerToDataArray: {
+                    break;
+                }
+                default: {
+                    continue;
+                }
+            }
+            builder->CreateAlignmentAssumption(module->getDataLayout(), data,
+                hint->m_aligned[i].m_alignment);
+        }
+    }
+
     template <typename Cond, typename Body>
-    void create_loop(char *name, Cond condition, Body loop_body) {
+    void create_loop(char *name, Cond condition, Body loop_body,
+            ASR::loop_hint_t* hint=nullptr) {
 
         std::string loop_name;
         if (name) {
@@ -322,7 +458,10 @@ public:
         // body
         start_new_block(loopbody); {
             loop_body();
-            builder->CreateBr(loophead);
+            llvm::Instruction* latch = builder->CreateBr(loophead);
+            if (hint) {
+                set_loop_hint(hint, loopbody, latch);
+            }
         }
 
         // end
@@ -1857,6 +1996,34 @@ public:
         tmp = builder->CreateFSub(exp, one);
     }
 
+    void generate_math_intrinsic(ASR::expr_t* m_arg, llvm::Intrinsic::ID id) {
+        this->visit_expr_wrapper(m_arg, true);
+        llvm::Value *item = tmp;
+        tmp = builder->CreateUnaryIntrinsic(id, item);
+    }
+
+    // Math functions without an LLVM intrinsic call the C library directly
+    // (`tanhf` or `tanh`). The declaration does not access memory, so the loop
+    // vectorizer can replace the call by its vector variant from
+    // `--vector-library`.
+    void generate_libm_call(ASR::expr_t* m_arg, const std::string& name) {
+        this->visit_expr_wrapper(m_arg, true);
+        llvm::Value *item = tmp;
+        llvm::Type *type = item->getType();
+        std::string func_name = type->isFloatTy() ? name + "f" : name;
+        llvm::Function *fn = module->getFunction(func_name);
+        if (!fn) {
+            llvm::FunctionType *function_type = llvm::FunctionType::get(
+                    type, {type}, false);
+            fn = llvm::Function::Create(function_type,
+                    llvm::Function::ExternalLinkage, func_name,
+                    module.get());
+            fn->setDoesNotAccessMemory();
+            fn->setDoesNotThrow();
+        }
+        tmp = builder->CreateCall(fn, {item});
+    }
+
     void generate_ListReverse(ASR::expr_t* m_arg) {
         ASR::ttype_t* asr_el_type = ASRUtils::get_contained_type(ASRUtils::expr_type(m_arg));
         int64_t ptr_loads_copy = ptr_loads;
@@ -2085,6 +2252,26 @@ public:
             case ASRUtils::IntrinsicElementalFunctions::CommandArgumentCount: {
                 break;
             }
+            case ASRUtils::IntrinsicElementalFunctions::Sin: {
+                generate_math_intrinsic(x.m_args[0], llvm::Intrinsic::sin);
+                break ;
+            }
+            case ASRUtils::IntrinsicElementalFunctions::Cos: {
+                generate_math_intrinsic(x.m_args[0], llvm::Intrinsic::cos);
+                break ;
+            }
+            case ASRUtils::IntrinsicElementalFunctions::Log: {
+                generate_math_intrinsic(x.m_args[0], llvm::Intrinsic::log);
+                break ;
+            }
+            case ASRUtils::IntrinsicElementalFunctions::Tanh: {
+                generate_libm_call(x.m_args[0], "tanh");
+                break ;
+            }
+            case ASRUtils::IntrinsicElementalFunctions::Erf: {
+                generate_libm_call(x.m_args[0], "erf");
+                break ;
+            }
             case ASRUtils::IntrinsicElementalFunctions::Expm1: {
                 switch (x.m_overload_id) {
                     case 0: {
@@ -2158,6 +2345,34 @@ public:
             } case ASRUtils::IntrinsicImpureFunctions::Allocated : {
                 handle_allocated(x.m_args[0]);
                 break ;
+            } case ASRUtils::IntrinsicImpureFunctions::ThisImage : {
+                tmp = builder->CreateCall(get_caf_function("_lfortran_caf_this_image",
+                    llvm::Type::getInt32Ty(context), {}), {});
+                break ;
+            } case ASRUtils::IntrinsicImpureFunctions::NumImages : {
+                tmp = builder->CreateCall(get_caf_function("_lfortran_caf_num_images",
+                    llvm::Type::getInt32Ty(context), {}), {});
+                break ;
+            } case ASRUtils::IntrinsicImpureFunctions::CoarrayAllocate : {
+                this->visit_expr_wrapper(x.m_args[0], true);
+                llvm::Value *size = tmp;
+                tmp = builder->CreateCall(get_caf_function("_lfortran_caf_register",
+                    llvm::Type::getInt8Ty(context)->getPointerTo(),
+                    {llvm::Type::getInt64Ty(context)}), {size});
+                tmp = builder->CreateBitCast(tmp, llvm::Type::getVoidTy(context)->getPointerTo());
+                break ;
+            } case ASRUtils::IntrinsicImpureFunctions::CoarrayRemote : {
+                this->visit_expr_wrapper(x.m_args[0], true);
+                llvm::Value *local = builder->CreateBitCast(tmp,
+                    llvm::Type::getInt8Ty(context)->getPointerTo());
+                this->visit_expr_wrapper(x.m_args[1], true);
+                llvm::Value *image = tmp;
+                tmp = builder->CreateCall(get_caf_function("_lfortran_caf_remote",
+                    llvm::Type::getInt8Ty(context)->getPointerTo(),
+                    {llvm::Type::getInt8Ty(context)->getPointerTo(),
+                     llvm::Type::getInt32Ty(context)}), {local, image});
+                tmp = builder->CreateBitCast(tmp, llvm::Type::getVoidTy(context)->getPointerTo());
+                break ;
             } default: {
                 throw CodeGenError( ASRUtils::get_impure_intrinsic_name(x.m_impure_intrinsic_id) +
                         " is not implemented by LLVM backend.", x.base.base.loc);
@@ -2165,6 +2380,153 @@ public:
         }
     }
 
+    llvm::Function* get_caf_function(const std::string &name, llvm::Type *return_type,
+            const std::vector<llvm::Type*> &args) {
+        llvm::Function *fn = module->getFunction(name);
+        if (!fn) {
+            llvm::FunctionType *function_type = llvm::FunctionType::get(
+                return_type, args, false);
+            fn = llvm::Function::Create(function_type,
+                llvm::Function::ExternalLinkage, name, *module);
+        }
+        return fn;
+    }
+
+    // Address of the first element of `x` as an i8*, and its number of elements
+    std::pair<llvm::Value*, llvm::Value*> get_caf_data(ASR::expr_t *x) {
+        ASR::ttype_t *type = ASRUtils::expr_type(x);
+        int64_t ptr_loads_copy = ptr_loads;
+        ptr_loads = 0;
+        llvm::Value *data = nullptr, *count = nullptr;
+        if (ASRUtils::is_array(type)) {
+            const Location &loc = x->base.loc;
+            ASRUtils::ASRBuilder b(al, loc);
+            int n_dims = ASRUtils::extract_n_dims_from_ttype(type);
+            Vec<ASR::array_index_t> idx;
+            idx.reserve(al, n_dims);
+            for (int i = 0; i < n_dims; i++) {
+                ASR::array_index_t ai;
+                ai.loc = loc;
+                ai.m_left = nullptr;
+                ai.m_right = b.ArrayLBound(x, i + 1);
+                ai.m_step = nullptr;
+                idx.push_back(al, ai);
+            }
+            ASR::ttype_t *el_type = ASRUtils::type_get_past_array(
+                ASRUtils::type_get_past_allocatable(ASRUtils::type_get_past_pointer(type)));
+            this->visit_expr(*ASRUtils::EXPR(ASR::make_ArrayItem_t(al, loc, x, idx.p, idx.n,
+                el_type, ASR::arraystorageType::ColMajor, nullptr)));
+            data = tmp;
+            ptr_loads = 2;
+            this->visit_expr_wrapper(b.ArraySize(x, nullptr,
+                ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 8))), true);
+            // The size of a fixed size array is folded to a constant of
+            // the default integer kind
+            count = builder->CreateSExtOrTrunc(tmp, llvm::Type::getInt64Ty(context));
+        } else {
+            this->visit_expr(*x);
+            data = GetPointerCPtrUtil(tmp, x);
+            count = llvm::ConstantInt::get(context, llvm::APInt(64, 1));
+        }
+        ptr_loads = ptr_loads_copy;
+        return {builder->CreateBitCast(data, llvm::Type::getInt8Ty(context)->getPointerTo()), count};
+    }
+
+    void set_caf_stat(ASR::expr_t *stat) {
+        int64_t ptr_loads_copy = ptr_loads;
+        ptr_loads = 0;
+        this->visit_expr(*stat);
+        ptr_loads = ptr_loads_copy;
+        llvm::Type *stat_type = llvm_utils->get_type_from_ttype_t_util(
+            ASRUtils::expr_type(stat), module.get());
+        builder->CreateStore(llvm::ConstantInt::get(stat_type, 0), tmp);
+    }
+
+    void visit_IntrinsicImpureSubroutine(const ASR::IntrinsicImpureSubroutine_t &x) {
+        llvm::Type *i8_ptr = llvm::Type::getInt8Ty(context)->getPointerTo();
+        llvm::Type *i32 = llvm::Type::getInt32Ty(context);
+        llvm::Type *i64 = llvm::Type::getInt64Ty(context);
+        llvm::Type *void_type = llvm::Type::getVoidTy(context);
+        ASR::expr_t *stat = nullptr;
+        switch (static_cast<ASRUtils::IntrinsicImpureSubroutines>(x.m_sub_intrinsic_id)) {
+            case ASRUtils::IntrinsicImpureSubroutines::CoSum :
+            case ASRUtils::IntrinsicImpureSubroutines::CoMax :
+            case ASRUtils::IntrinsicImpureSubroutines::CoMin :
+            case ASRUtils::IntrinsicImpureSubroutines::CoBroadcast : {
+                std::pair<llvm::Value*, llvm::Value*> data = get_caf_data(x.m_args[0]);
+                llvm::Value *count = data.second;
+                this->visit_expr_wrapper(x.m_args[1], true);
+                llvm::Value *image = builder->CreateSExtOrTrunc(tmp, i32);
+                if (x.n_args > 2) stat = x.m_args[2];
+                ASR::ttype_t *el_type = ASRUtils::type_get_past_array(ASRUtils::type_get_past_allocatable(
+                    ASRUtils::type_get_past_pointer(ASRUtils::expr_type(x.m_args[0]))));
+                std::string name;
+                if (x.m_sub_intrinsic_id == static_cast<int64_t>(ASRUtils::IntrinsicImpureSubroutines::CoBroadcast)) {
+                    llvm::DataLayout data_layout(module->getDataLayout());
+                    uint64_t el_size = data_layout.getTypeAllocSize(
+                        llvm_utils->get_type_from_ttype_t_util(el_type, module.get()));
+                    count = builder->CreateMul(count, llvm::ConstantInt::get(i64, el_size));
+                    name = "_lfortran_caf_co_broadcast";
+                } else {
+                    name = ASRUtils::IntrinsicImpureSubroutineRegistry::get_intrinsic_subroutine_name(
+                        x.m_sub_intrinsic_id);
+                    int kind = ASRUtils::extract_kind_from_ttype_t(el_type);
+                    if (ASRUtils::is_integer(*el_type)) {
+                        name = "_lfortran_caf_" + name + "_i" + std::to_string(8 * kind);
+                    } else {
+                        // A complex sum is the sum of its real and imaginary parts
+                        if (ASRUtils::is_complex(*el_type)) {
+                            count = builder->CreateMul(count, llvm::ConstantInt::get(i64, 2));
+                        }
+                        name = "_lfortran_caf_" + name + "_r" + std::to_string(8 * kind);
+                    }
+                }
+                builder->CreateCall(get_caf_function(name, void_type, {i8_ptr, i64, i32}),
+                    {data.first, count, image});
+                break;
+            }
+            case ASRUtils::IntrinsicImpureSubroutines::SyncAll : {
+                if (x.n_args > 0) stat = x.m_args[0];
+                builder->CreateCall(get_caf_function("_lfortran_caf_sync_all", void_type, {}), {});
+                break;
+            }
+            case ASRUtils::IntrinsicImpureSubroutines::SyncImages : {
+                llvm::Value *images = llvm::ConstantPointerNull::get(
+                    llvm::cast<llvm::PointerType>(i8_ptr));
+                llvm::Value *count = llvm::ConstantInt::get(i64, -1, true);
+                if (x.m_overload_id == 0) {
+                    ASR::expr_t *image_set = x.m_args[0];
+                    if (ASRUtils::is_array(ASRUtils::expr_type(image_set)) ||
+                            ASR::is_a<ASR::Var_t>(*image_set)) {
+                        std::pair<llvm::Value*, llvm::Value*> data = get_caf_data(image_set);
+                        images = data.first;
+                        count = data.second;
+                    } else {
+                        this->visit_expr_wrapper(image_set, true);
+                        llvm::Value *image = llvm_utils->CreateAlloca(*builder, i32);
+                        builder->CreateStore(tmp, image);
+                        images = builder->CreateBitCast(image, i8_ptr);
+                        count = llvm::ConstantInt::get(i64, 1);
+                    }
+                    if (x.n_args > 1) stat = x.m_args[1];
+                } else if (x.n_args > 0) {
+                    stat = x.m_args[0];
+                }
+                builder->CreateCall(get_caf_function("_lfortran_caf_sync_images", void_type,
+                    {i8_ptr, i64}), {images, count});
+                break;
+            }
+            default: {
+                throw CodeGenError("IntrinsicImpureSubroutine: `" +
+                    ASRUtils::get_intrinsic_subroutine_name(x.m_sub_intrinsic_id) +
+                    "` is not implemented by LLVM backend.", x.base.base.loc);
+            }
+        }
+        // Images do not fail in the shared memory runtime, it stops the
+        // program instead
+        if (stat) set_caf_stat(stat);
+    }
+
     void visit_TypeInquiry(const ASR::TypeInquiry_t &x) {
         this->visit_expr(*x.m_value);
     }
@@ -3409,6 +3771,16 @@ public:
             }
             builder->CreateCall(fn, args);
         }
+        if (compiler_options.numa_report) {
+            llvm::Function *fn = module->getFunction("_lfortran_numa_report_enable");
+            if (!fn) {
+                llvm::FunctionType *function_type = llvm::FunctionType::get(
+                    llvm::Type::getVoidTy(context), {}, false);
+                fn = llvm::Function::Create(function_type,
+                    llvm::Function::ExternalLinkage, "_lfortran_numa_report_enable", *module);
+            }
+            builder->CreateCall(fn, {});
+        }
         for(to_be_allocated_array array : allocatable_array_details){
                     fill_array_details_(array.pointer_to_array_type, array.array_type, nullptr, array.n_dims,
                 true, true, false, array.var_type);
@@ -3800,6 +4172,34 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
         }
     }
 
+    /*
+    * Returns storage for `size` bytes of an automatic array, on the stack
+    * if it is at most --stack-arrays-limit bytes and on the heap otherwise.
+    * The heap pointer, null for stack storage, is freed when the procedure
+    * returns.
+    */
+    llvm::Value* allocate_bounded_stack_array(llvm::Value* size) {
+        llvm::Type* i8_type = llvm::Type::getInt8Ty(context);
+        llvm::Type* i8_ptr_type = i8_type->getPointerTo();
+        llvm::Value* zero = llvm::ConstantInt::get(context, llvm::APInt(32, 0));
+        // Negative sizes compare as huge unsigned ones and go to the heap
+        llvm::Value* is_small = builder->CreateICmpULE(size, llvm::ConstantInt::get(
+            context, llvm::APInt(32, compiler_options.po.stack_arrays_limit)));
+        llvm::AllocaInst* stack_data = llvm_utils->CreateAlloca(*builder, i8_type,
+            builder->CreateSelect(is_small, size, zero));
+        stack_data->setAlignment(llvm::Align(16));
+        llvm::Value* heap_data_ptr = llvm_utils->CreateAlloca(i8_ptr_type);
+        builder->CreateStore(llvm::ConstantPointerNull::get(
+            static_cast<llvm::PointerType*>(i8_ptr_type)), heap_data_ptr);
+        llvm_utils->create_if_else(is_small, []() {}, [&]() {
+            builder->CreateStore(LLVMArrUtils::lfortran_malloc(
+                context, *module, *builder, size), heap_data_ptr);
+        });
+        llvm::Value* heap_data = llvm_utils->CreateLoad2(i8_ptr_type, heap_data_ptr);
+        heap_arrays.push_back(heap_data);
+        return builder->CreateSelect(is_small, stack_data, heap_data);
+    }
+
     template<typename T>
     void process_Variable(ASR::symbol_t* var_sym, T& x, uint32_t &debug_arg_count) {
         llvm::Value *target_var = nullptr;
@@ -3901,9 +4301,15 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
                 uint64_t size = data_layout.getTypeAllocSize(type);
                 array_size = builder->CreateMul(array_size,
                     llvm::ConstantInt::get(context, llvm::APInt(32, size)));
-                llvm::Value* ptr_i8 = LLVMArrUtils::lfortran_malloc(
-                    context, *module, *builder, array_size);
-                heap_arrays.push_back(ptr_i8);
+                llvm::Value* ptr_i8 = nullptr;
+                if( compiler_options.po.fast && compiler_options.po.stack_arrays_limit > 0 &&
+                    x.class_type != ASR::symbolType::Block ) {
+                    ptr_i8 = allocate_bounded_stack_array(array_size);
+                } else {
+                    ptr_i8 = LLVMArrUtils::lfortran_malloc(
+                        context, *module, *builder, array_size);
+                    heap_arrays.push_back(ptr_i8);
+                }
                 ptr = builder->CreateBitCast(ptr_i8, type->getPointerTo());
             } else {
                 if (v->m_storage == ASR::storage_typeType::Save) {
@@ -4194,6 +4600,7 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
     }
 
     void visit_Function(const ASR::Function_t &x) {
+        ProfileRegion profile_region(x.m_name, "procedure");
         loop_head.clear();
         loop_head_names.clear();
         loop_or_block_end.clear();
@@ -4273,10 +4680,37 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
             } else {
                 fn_name = mangle_prefix + sym_name;
             }
+            // Internal procedures of different hosts may share their name
+            // (and, once the static chain is appended, not their signature),
+            // so a clash is resolved with the name of the host
+            ASR::asr_t* host = x.m_symtab->parent->asr_owner;
+            if (ASRUtils::get_FunctionType(x)->m_deftype == ASR::deftypeType::Implementation &&
+                    ASR::is_a<ASR::symbol_t>(*host) &&
+                    ASR::is_a<ASR::Function_t>(*ASR::down_cast<ASR::symbol_t>(host)) &&
+                    llvm_symtab_fn_names.find(fn_name) != llvm_symtab_fn_names.end()) {
+                fn_name = mangle_prefix + ASRUtils::symbol_name(ASR::down_cast<ASR::symbol_t>(host))
+                    + "_" + sym_name;
+            }
             if (llvm_symtab_fn_names.find(fn_name) == llvm_symtab_fn_names.end()) {
                 llvm_symtab_fn_names[fn_name] = h;
                 F = llvm::Function::Create(function_type,
                     llvm::Function::ExternalLinkage, fn_name, module.get());
+                // An elemental procedure is called once per element from the
+                // loops generated by array_op, inlining it lets the loop
+                // vectorizer widen its body instead of calling it per element
+                if (compiler_options.po.fast &&
+                        ASRUtils::get_FunctionType(x)->m_elemental &&
+                        ASRUtils::get_FunctionType(x)->m_deftype ==
+                            ASR::deftypeType::Implementation) {
+                    F->addFnAttr(llvm::Attribute::InlineHint);
+                }
+                // `!$omp declare simd` procedures are inlined into the simd
+                // loops instead of getting vector variants
+                if (ASRUtils::get_FunctionType(x)->m_inline &&
+                        ASRUtils::get_FunctionType(x)->m_deftype ==
+                            ASR::deftypeType::Implementation) {
+                    F->addFnAttr(llvm::Attribute::InlineHint);
+                }
 
                 // Add Debugging information to the LLVM function F
                 if (compiler_options.emit_debug_info) {
@@ -4663,11 +5097,22 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
             llvm_cptr = builder->CreateBitCast(llvm_cptr, llvm_fptr_data_type->getPointerTo());
             builder->CreateStore(llvm_cptr, fptr_data);
             llvm::Value* prod = llvm::ConstantInt::get(context, llvm::APInt(32, 1));
+            // The lower bounds are constants from `lower=`, or the bounds
+            // of an array that the OpenMP pass passes to an outlined function
             ASR::ArrayConstant_t* lower_bounds = nullptr;
+            llvm::Value* lower_bounds_data = nullptr;
             if( x.m_lower_bounds ) {
-                LCOMPILERS_ASSERT(ASR::is_a<ASR::ArrayConstant_t>(*x.m_lower_bounds));
-                lower_bounds = ASR::down_cast<ASR::ArrayConstant_t>(x.m_lower_bounds);
-                LCOMPILERS_ASSERT(fptr_rank == ASRUtils::get_fixed_size_of_array(lower_bounds->m_type));
+                if( ASR::is_a<ASR::ArrayConstant_t>(*x.m_lower_bounds) ) {
+                    lower_bounds = ASR::down_cast<ASR::ArrayConstant_t>(x.m_lower_bounds);
+                    LCOMPILERS_ASSERT(fptr_rank == ASRUtils::get_fixed_size_of_array(lower_bounds->m_type));
+                } else {
+                    this->visit_expr(*x.m_lower_bounds);
+                    lower_bounds_data = tmp;
+                    if( ASRUtils::extract_physical_type(ASRUtils::expr_type(x.m_lower_bounds)) ==
+                        ASR::array_physical_typeType::DescriptorArray ) {
+                        lower_bounds_data = llvm_utils->CreateLoad(arr_descr->get_pointer_to_data(lower_bounds_data));
+                    }
+                }
             }
             for( int i = 0; i < fptr_rank; i++ ) {
                 llvm::Value* curr_dim = llvm::ConstantInt::get(context, llvm::APInt(32, i));
@@ -4684,18 +5129,27 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
                     this->visit_expr_wrapper(ASRUtils::fetch_ArrayConstant_value(al, lower_bounds, i), true);
                     ptr_loads = ptr_loads_copy;
                     new_lb = tmp;
+                } else if( lower_bounds_data ) {
+                    if( ASRUtils::extract_physical_type(ASRUtils::expr_type(x.m_lower_bounds)) ==
+                        ASR::array_physical_typeType::FixedSizeArray ) {
+                        new_lb = llvm_utils->CreateLoad2(llvm::Type::getInt32Ty(context),
+                            llvm_utils->create_gep(lower_bounds_data, i));
+                    } else {
+                        new_lb = llvm_utils->CreateLoad2(llvm::Type::getInt32Ty(context),
+                            llvm_utils->create_ptr_gep(lower_bounds_data, i));
+                    }
                 }
-                llvm::Value* new_ub = nullptr;
+                // shape holds the extents, which do not depend on the lower bounds
+                llvm::Value* new_size = nullptr;
                 if( ASRUtils::extract_physical_type(asr_shape_type) == ASR::array_physical_typeType::DescriptorArray ||
                     ASRUtils::extract_physical_type(asr_shape_type) == ASR::array_physical_typeType::PointerToDataArray ) {
-                    new_ub = shape_data ? llvm_utils->CreateLoad2(
+                    new_size = shape_data ? llvm_utils->CreateLoad2(
                         llvm::Type::getInt32Ty(context), llvm_utils->create_ptr_gep(shape_data, i)) : i32_one;
                 } else if( ASRUtils::extract_physical_type(asr_shape_type) == ASR::array_physical_typeType::FixedSizeArray ) {
-                    new_ub = shape_data ? llvm_utils->CreateLoad2(
+                    new_size = shape_data ? llvm_utils->CreateLoad2(
                         llvm::Type::getInt32Ty(context), llvm_utils->create_gep(shape_data, i)) : i32_one;
                 }
                 builder->CreateStore(new_lb, desi_lb);
-                llvm::Value* new_size = builder->CreateAdd(builder->CreateSub(new_ub, new_lb), i32_one);
                 builder->CreateStore(new_size, desi_size);
                 prod = builder->CreateMul(prod, new_size);
             }
@@ -4704,6 +5158,10 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
             ptr_loads = 1 - reduce_loads;
             this->visit_expr(*cptr);
             llvm::Value* llvm_cptr = tmp;
+            if (ASR::is_a<ASR::StructInstanceMember_t>(*cptr)) {
+                // `type(c_ptr)` requires an extra load here, as for arrays above
+                llvm_cptr = llvm_utils->CreateLoad(llvm_cptr);
+            }
             ptr_loads = 0;
             this->visit_expr(*fptr);
             llvm::Value* llvm_fptr = tmp;
@@ -6288,6 +6746,77 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
         strings_to_be_deallocated.p = strings_to_be_deallocated_copy;
     }
 
+    void visit_Select(const ASR::Select_t &x) {
+        // The select_case pass leaves only the `select case` with constant
+        // integer labels, LLVM lowers the `switch` to a jump table or a
+        // binary search
+        std::map<int64_t, std::pair<int64_t, size_t>> ranges;
+        if (!get_select_case_switch_values(x, ranges)) {
+            if (x.m_enable_fall_through) {
+                // Lowering the fall through needs new local variables, which
+                // only the select_case pass can declare
+                throw CodeGenError("select case with fall through must be "
+                    "lowered by the select_case pass", x.base.base.loc);
+            }
+            // Reached if the pass did not run first, lower it like the pass
+            Vec<ASR::stmt_t*> body = replace_selectcase(al, x);
+            for (size_t i = 0; i < body.size(); i++) {
+                this->visit_stmt(*body[i]);
+            }
+            return;
+        }
+        llvm::Value **strings_to_be_deallocated_copy = strings_to_be_deallocated.p;
+        size_t n = strings_to_be_deallocated.n;
+        strings_to_be_deallocated.reserve(al, 1);
+        this->visit_expr_wrapper(x.m_test, true);
+        llvm::IntegerType *test_type = llvm::cast<llvm::IntegerType>(tmp->getType());
+        llvm::Function *fn = builder->GetInsertBlock()->getParent();
+        llvm::BasicBlock *defaultBB = llvm::BasicBlock::Create(context, "select.default");
+        llvm::BasicBlock *mergeBB = llvm::BasicBlock::Create(context, "select.end");
+        llvm::SwitchInst *switch_inst = builder->CreateSwitch(tmp, defaultBB,
+            ranges.size());
+        std::vector<llvm::BasicBlock*> caseBBs(x.n_body);
+        for (size_t i = 0; i < x.n_body; i++) {
+            caseBBs[i] = llvm::BasicBlock::Create(context, "select.case", fn);
+        }
+        for (auto &range: ranges) {
+            for (int64_t value = range.first; ; value++) {
+                switch_inst->addCase(llvm::ConstantInt::get(test_type, value,
+                    true), caseBBs[range.second.second]);
+                if (value == range.second.first) break;
+            }
+        }
+        for (size_t i = 0; i < x.n_body; i++) {
+            builder->SetInsertPoint(caseBBs[i]);
+            ASR::stmt_t **m_body;
+            size_t n_body;
+            if (ASR::is_a<ASR::CaseStmt_t>(*x.m_body[i])) {
+                ASR::CaseStmt_t *case_stmt = ASR::down_cast<ASR::CaseStmt_t>(x.m_body[i]);
+                m_body = case_stmt->m_body;
+                n_body = case_stmt->n_body;
+            } else {
+                ASR::CaseStmt_Range_t *case_range = ASR::down_cast<ASR::CaseStmt_Range_t>(x.m_body[i]);
+                m_body = case_range->m_body;
+                n_body = case_range->n_body;
+            }
+            for (size_t j = 0; j < n_body; j++) {
+                this->visit_stmt(*m_body[j]);
+            }
+            call_lcompilers_free_strings();
+            builder->CreateBr(mergeBB);
+        }
+        start_new_block(defaultBB); {
+            for (size_t i = 0; i < x.n_default; i++) {
+                this->visit_stmt(*x.m_default[i]);
+            }
+            call_lcompilers_free_strings();
+        }
+        start_new_block(mergeBB);
+        strings_to_be_deallocated.reserve(al, n);
+        strings_to_be_deallocated.n = n;
+        strings_to_be_deallocated.p = strings_to_be_deallocated_copy;
+    }
+
     void visit_IfExp(const ASR::IfExp_t &x) {
         // IfExp(expr test, expr body, expr orelse, ttype type, expr? value)
         this->visit_expr_wrapper(x.m_test, true);
@@ -6312,6 +6841,9 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
         llvm::Value **strings_to_be_deallocated_copy = strings_to_be_deallocated.p;
         size_t n = strings_to_be_deallocated.n;
         strings_to_be_deallocated.reserve(al, 1);
+        if (x.m_hint) {
+            create_alignment_assumptions(x.m_hint);
+        }
         create_loop(x.m_name, [=]() {
             this->visit_expr_wrapper(x.m_test, true);
             call_lcompilers_free_strings();
@@ -6321,7 +6853,7 @@ ptr_type[ptr_member] = llvm_utils->get_type_from_ttype_t_util(
                 this->visit_stmt(*x.m_body[i]);
             }
             call_lcompilers_free_strings();
-        });
+        }, x.m_hint);
         strings_to_be_deallocated.reserve(al, n);
         strings_to_be_deallocated.n = n;
         strings_to_be_deallocated.p = strings_to_be_deallocated_copy;
@@ -10795,17 +11327,35 @@ Result<std::unique_ptr<LLVMModule>> asr_to_llvm(ASR::TranslationUnit_t &asr,
                     ASRUtils::IntrinsicElementalFunctions::FMA));
     skip_optimization_func_instantiation.push_back(static_cast<int64_t>(
                     ASRUtils::IntrinsicElementalFunctions::SignFromValue));
+    if (co.po.fast) {
+        // Generated inline as `llvm.sin` etc., which the loop vectorizer
+        // widens, instead of as calls to the `_lfortran_dsin` wrappers
+        for (ASRUtils::IntrinsicElementalFunctions id : {
+                ASRUtils::IntrinsicElementalFunctions::Sin,
+                ASRUtils::IntrinsicElementalFunctions::Cos,
+                ASRUtils::IntrinsicElementalFunctions::Log,
+                ASRUtils::IntrinsicElementalFunctions::Tanh,
+                ASRUtils::IntrinsicElementalFunctions::Erf}) {
+            skip_optimization_func_instantiation.push_back(
+                static_cast<int64_t>(id));
+        }
+    }
 
     co.po.run_fun = run_fn;
     co.po.always_run = false;
     co.po.skip_optimization_func_instantiation = skip_optimization_func_instantiation;
+    co.po.select_case_to_switch = true;
     pass_manager.rtlib = co.rtlib;
-    pass_manager.apply_passes(al, &asr, co.po, diagnostics);
+    {
+        ProfileRegion profile_region("ASR passes", "phase");
+        pass_manager.apply_passes(al, &asr, co.po, diagnostics);
+    }
 
     // Uncomment for debugging the ASR after the transformation
     // std::cout << LCompilers::pickle(asr, true, false, false) << std::endl;
 
     try {
+        ProfileRegion profile_region("ASR -> LLVM IR", "phase");
         v.visit_asr((ASR::asr_t&)asr);
     } catch (const CodeGenError &e) {
         Error error;
@@ -10818,6 +11368,7 @@ Result<std::unique_ptr<LLVMModule>> asr_to_llvm(ASR::TranslationUnit_t &asr,
     }
     std::string msg;
     llvm::raw_string_ostream err(msg);
+    ProfileRegion profile_region("LLVM verify", "phase");
     if (llvm::verifyModule(*v.module, &err)) {
         std::string buf;
         llvm::raw_string_ostream os(buf);
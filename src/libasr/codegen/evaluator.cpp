@@ -68,6 +68,7 @@
 #include <libasr/codegen/asr_to_llvm.h>
 #include <libasr/codegen/asr_to_cpp.h>
 #include <libasr/exception.h>
+#include <libasr/profiler.h>
 #include <libasr/asr.h>
 #include <libasr/string_utils.h>
 
@@ -396,16 +397,64 @@ void LLVMEvaluator::create_empty_object_file(const std::string &filename) {
     save_object_file(*module, filename);
 }
 
-void LLVMEvaluator::opt(llvm::Module &m) {
+// Registers the vector variants of the math functions provided by
+// `vector_library`, so that the loop vectorizer can replace a call to `sin`
+// (or `llvm.sin`) in a loop by a call to its vector variant.
+static llvm::TargetLibraryInfoImpl get_target_library_info(
+        const llvm::Triple &triple, const std::string &vector_library) {
+    llvm::TargetLibraryInfoImpl TLII(triple);
+    llvm::TargetLibraryInfoImpl::VectorLibrary lib;
+    if (vector_library == "none") {
+        lib = llvm::TargetLibraryInfoImpl::NoLibrary;
+    } else if (vector_library == "libmvec") {
+        lib = llvm::TargetLibraryInfoImpl::LIBMVEC_X86;
+    } else if (vector_library == "svml") {
+        lib = llvm::TargetLibraryInfoImpl::SVML;
+    } else {
+        throw LCompilersException("Unknown vector library '"
+            + vector_library + "'");
+    }
+#if LLVM_VERSION_MAJOR >= 16
+    TLII.addVectorizableFunctionsFromVecLib(lib, triple);
+#else
+    TLII.addVectorizableFunctionsFromVecLib(lib);
+#endif
+    return TLII;
+}
+
+void LLVMEvaluator::opt(llvm::Module &m, const std::string &vector_library) {
     m.setTargetTriple(target_triple);
     m.setDataLayout(TM->createDataLayout());
+    llvm::TargetLibraryInfoImpl TLII = get_target_library_info(
+        TM->getTargetTriple(), vector_library);
 
 #if LLVM_VERSION_MAJOR >= 17
     llvm::LoopAnalysisManager LAM;
     llvm::FunctionAnalysisManager FAM;
     llvm::CGSCCAnalysisManager CGAM;
     llvm::ModuleAnalysisManager MAM;
-    llvm::PassBuilder PB = llvm::PassBuilder(TM);
+    llvm::PassInstrumentationCallbacks PIC;
+    if (Profiler::get().is_enabled()) {
+        // Time every LLVM pass (including the pass adaptors, so the regions
+        // nest like the pipeline)
+        PIC.registerBeforeNonSkippedPassCallback(
+            [](llvm::StringRef pass, llvm::Any) {
+                Profiler::get().begin(std::string_view(pass.data(),
+                    pass.size()), "llvm_pass");
+            });
+        PIC.registerAfterPassCallback(
+            [](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses &) {
+                Profiler::get().end();
+            });
+        PIC.registerAfterPassInvalidatedCallback(
+            [](llvm::StringRef, const llvm::PreservedAnalyses &) {
+                Profiler::get().end();
+            });
+    }
+    llvm::PassBuilder PB = llvm::PassBuilder(TM, llvm::PipelineTuningOptions(),
+        std::nullopt, &PIC);
+    // Registered before the defaults, which then keep it
+    FAM.registerPass([&] { return llvm::TargetLibraryAnalysis(TLII); });
     PB.registerModuleAnalyses(MAM);
     PB.registerCGSCCAnalyses(CGAM);
     PB.registerFunctionAnalyses(FAM);
@@ -416,7 +465,7 @@ void LLVMEvaluator::opt(llvm::Module &m) {
     
 #else
     llvm::legacy::PassManager mpm;
-    mpm.add(new llvm::TargetLibraryInfoWrapperPass(TM->getTargetTriple()));
+    mpm.add(new llvm::TargetLibraryInfoWrapperPass(TLII));
     mpm.add(llvm::createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
     llvm::legacy::FunctionPassManager fpm(&m);
     fpm.add(llvm::createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
@@ -430,15 +479,28 @@ void LLVMEvaluator::opt(llvm::Module &m) {
     builder.DisableUnrollLoops = false;
     builder.LoopVectorize = true;
     builder.SLPVectorize = true;
+    // Owned by the builder, the function passes get their own copy of it
+    builder.LibraryInfo = new llvm::TargetLibraryInfoImpl(TLII);
     builder.populateFunctionPassManager(fpm);
     builder.populateModulePassManager(mpm);
-    fpm.doInitialization();
-    for (llvm::Function &func : m) {
-        fpm.run(func);
+    // The legacy pass manager has no per-pass callbacks, the function passes
+    // are timed per function instead
+    {
+        ProfileRegion profile_region("LLVM function passes", "llvm_pass");
+        fpm.doInitialization();
+        for (llvm::Function &func : m) {
+            llvm::StringRef name = func.getName();
+            ProfileRegion function_region(std::string_view(name.data(),
+                name.size()), "procedure");
+            fpm.run(func);
+        }
+        fpm.doFinalization();
     }
-    fpm.doFinalization();
     mpm.add(llvm::createVerifierPass());
-    mpm.run(m);
+    {
+        ProfileRegion profile_region("LLVM module passes", "llvm_pass");
+        mpm.run(m);
+    }
 #endif
 }
 
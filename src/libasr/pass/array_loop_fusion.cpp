@@ -0,0 +1,813 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_verify.h>
+#include <libasr/pass/array_loop_fusion.h>
+#include <libasr/pass/pass_utils.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+
+namespace LCompilers {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+This ASR pass fuses the loop nests that the array_op pass generates for
+consecutive array assignments, so that the arrays are streamed through
+memory once. It runs only with --fast.
+
+Converts (with `b` and `c` declared with the same shape):
+
+    i_a = lbound(a, 1)
+    do i_b = lbound(b, 1), ubound(b, 1)
+        b(i_b) = a(i_a) + 1.0
+        i_a = i_a + 1
+    end do
+    i_b1 = lbound(b, 1)
+    do i_c = lbound(c, 1), ubound(c, 1)
+        c(i_c) = b(i_b1) * 2.0
+        i_b1 = i_b1 + 1
+    end do
+
+to:
+
+    i_a = lbound(a, 1)
+    i_b1 = lbound(b, 1)
+    do i_b = lbound(b, 1), ubound(b, 1)
+        i_c = i_b
+        b(i_b) = a(i_a) + 1.0
+        c(i_c) = b(i_b1) * 2.0
+        i_a = i_a + 1
+        i_b1 = i_b1 + 1
+    end do
+
+Two loop nests are fused if
+
+    * only the initialisation of their index variables and the association
+      of the pointer temporaries of array sections (array_struct_temporary)
+      separate them,
+    * their loop heads are equal at every depth (the bounds of explicit shape
+      arrays are compared using their declarations),
+    * every array assigned to by one nest and accessed by the other one is
+      accessed at the same element in the same iteration everywhere, so that
+      no iteration of the fused nest depends on a later one.
+
+Pointer temporaries are resolved to the arrays they are associated with, any
+other pointer prevents the fusion.
+*/
+
+namespace {
+
+bool is_index_var(ASR::expr_t* x) {
+    if( x == nullptr || !is_a<ASR::Var_t>(*x) ) {
+        return false;
+    }
+    ASR::symbol_t* sym = down_cast<ASR::Var_t>(x)->m_v;
+    return is_a<ASR::Variable_t>(*sym) &&
+        startswith(ASRUtils::symbol_name(sym), "__libasr_index_");
+}
+
+ASR::symbol_t* var_symbol(ASR::expr_t* x) {
+    return ASRUtils::symbol_get_past_external(down_cast<ASR::Var_t>(x)->m_v);
+}
+
+// i = i + 1
+bool is_index_increment(ASR::stmt_t* x) {
+    if( !is_a<ASR::Assignment_t>(*x) ) {
+        return false;
+    }
+    ASR::Assignment_t* assignment = down_cast<ASR::Assignment_t>(x);
+    if( !is_index_var(assignment->m_target) ||
+        !is_a<ASR::IntegerBinOp_t>(*assignment->m_value) ) {
+        return false;
+    }
+    ASR::IntegerBinOp_t* binop = down_cast<ASR::IntegerBinOp_t>(assignment->m_value);
+    int64_t step;
+    return binop->m_op == ASR::binopType::Add && is_index_var(binop->m_left) &&
+        var_symbol(binop->m_left) == var_symbol(assignment->m_target) &&
+        ASRUtils::extract_value(ASRUtils::expr_value(binop->m_right), step) &&
+        step == 1;
+}
+
+// i = j, the loop variable of a fused loop
+bool is_index_alias(ASR::stmt_t* x) {
+    if( !is_a<ASR::Assignment_t>(*x) ) {
+        return false;
+    }
+    ASR::Assignment_t* assignment = down_cast<ASR::Assignment_t>(x);
+    return is_index_var(assignment->m_target) && is_index_var(assignment->m_value);
+}
+
+// i = <start>
+bool is_index_init(ASR::stmt_t* x) {
+    return is_a<ASR::Assignment_t>(*x) &&
+        is_index_var(down_cast<ASR::Assignment_t>(x)->m_target) &&
+        !is_index_alias(x) && !is_index_increment(x);
+}
+
+// p => a(l:u)
+bool is_section_association(ASR::stmt_t* x) {
+    if( !is_a<ASR::Associate_t>(*x) ) {
+        return false;
+    }
+    ASR::Associate_t* associate = down_cast<ASR::Associate_t>(x);
+    return is_a<ASR::Var_t>(*associate->m_target) &&
+        is_a<ASR::ArraySection_t>(*associate->m_value);
+}
+
+bool is_index_loop(ASR::stmt_t* x) {
+    if( !is_a<ASR::DoLoop_t>(*x) ) {
+        return false;
+    }
+    ASR::DoLoop_t* loop = down_cast<ASR::DoLoop_t>(x);
+    return loop->n_orelse == 0 && is_index_var(loop->m_head.m_v);
+}
+
+// The body of a loop nest is: aliases of the loop variable (fused loops),
+// then either the assignments of the innermost loop or the initialisations
+// of the index variables of the inner loop followed by the inner loop, then
+// the increments of the index variables
+void split_body(ASR::DoLoop_t* loop, size_t& begin, size_t& end) {
+    begin = 0;
+    end = loop->n_body;
+    while( begin < end && is_index_alias(loop->m_body[begin]) ) {
+        begin++;
+    }
+    while( end > begin && is_index_increment(loop->m_body[end - 1]) ) {
+        end--;
+    }
+}
+
+ASR::DoLoop_t* get_inner_loop(ASR::DoLoop_t* loop) {
+    size_t begin, end;
+    split_body(loop, begin, end);
+    if( begin < end && is_a<ASR::DoLoop_t>(*loop->m_body[end - 1]) ) {
+        return down_cast<ASR::DoLoop_t>(loop->m_body[end - 1]);
+    }
+    return nullptr;
+}
+
+typedef std::map<ASR::symbol_t*, ASR::ArraySection_t*> Associations;
+
+// The section `p` is associated with, if it has unit strides in all
+// dimensions (the lower bounds of `p` are then 1)
+ASR::ArraySection_t* get_associated_section(const Associations& associations,
+        ASR::expr_t* p) {
+    if( !is_a<ASR::Var_t>(*p) ) {
+        return nullptr;
+    }
+    auto it = associations.find(var_symbol(p));
+    if( it == associations.end() ) {
+        return nullptr;
+    }
+    ASR::ArraySection_t* section = it->second;
+    if( !is_a<ASR::Var_t>(*section->m_v) ||
+        ASRUtils::is_pointer(ASRUtils::expr_type(section->m_v)) ) {
+        return nullptr;
+    }
+    for( size_t i = 0; i < section->n_args; i++ ) {
+        ASR::array_index_t& index = section->m_args[i];
+        int64_t step;
+        if( index.m_left == nullptr || index.m_right == nullptr ||
+            index.m_step == nullptr ||
+            !ASRUtils::extract_value(ASRUtils::expr_value(index.m_step), step) ||
+            step != 1 ) {
+            return nullptr;
+        }
+    }
+    return section;
+}
+
+// Replaces lbound/ubound of a pointer temporary by the bounds of the section
+// it is associated with
+ASR::expr_t* resolve_bound(Allocator& al, const Associations& associations,
+        ASR::expr_t* x) {
+    if( !is_a<ASR::ArrayBound_t>(*x) ) {
+        return x;
+    }
+    ASR::ArrayBound_t* bound = down_cast<ASR::ArrayBound_t>(x);
+    ASR::ArraySection_t* section = get_associated_section(associations, bound->m_v);
+    int64_t dim;
+    if( section == nullptr ||
+        !ASRUtils::extract_value(ASRUtils::expr_value(bound->m_dim), dim) ||
+        dim < 1 || dim > (int64_t) section->n_args ) {
+        return x;
+    }
+    const Location& loc = x->base.loc;
+    ASR::ttype_t* int_type = ASRUtils::expr_type(x);
+    ASR::expr_t* one = ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, 1, int_type));
+    if( bound->m_bound == ASR::arrayboundType::LBound ) {
+        return one;
+    }
+    ASR::array_index_t& index = section->m_args[dim - 1];
+    ASR::expr_t* extent = ASRUtils::EXPR(ASR::make_IntegerBinOp_t(al, loc,
+        index.m_right, ASR::binopType::Sub, index.m_left, int_type, nullptr));
+    return ASRUtils::EXPR(ASR::make_IntegerBinOp_t(al, loc,
+        extent, ASR::binopType::Add, one, int_type, nullptr));
+}
+
+bool is_same_bound(Allocator& al, const Associations& associations,
+        ASR::expr_t* a, ASR::expr_t* b) {
+    int64_t diff;
+    return PassUtils::get_index_difference(resolve_bound(al, associations, a),
+        resolve_bound(al, associations, b), diff) && diff == 0;
+}
+
+bool has_unit_increment(const ASR::do_loop_head_t& head) {
+    int64_t step;
+    return head.m_increment == nullptr ||
+        (ASRUtils::extract_value(ASRUtils::expr_value(head.m_increment), step) &&
+         step == 1);
+}
+
+bool heads_match(Allocator& al, const Associations& associations,
+        ASR::DoLoop_t* a, ASR::DoLoop_t* b) {
+    if( !has_unit_increment(a->m_head) || !has_unit_increment(b->m_head) ||
+        !is_same_bound(al, associations, a->m_head.m_start, b->m_head.m_start) ||
+        !is_same_bound(al, associations, a->m_head.m_end, b->m_head.m_end) ) {
+        return false;
+    }
+    ASR::DoLoop_t* a_inner = get_inner_loop(a);
+    ASR::DoLoop_t* b_inner = get_inner_loop(b);
+    if( a_inner == nullptr || b_inner == nullptr ) {
+        return a_inner == b_inner;
+    }
+    return heads_match(al, associations, a_inner, b_inner);
+}
+
+// The value of an index variable is `expr + offset + k`, where `k` is the
+// iteration count of the loop at depth `level` (-1 for a value that does not
+// change in the loop nest). A null `expr` is an unknown value.
+struct IndexForm {
+    ASR::expr_t* expr = nullptr;
+    int64_t offset = 0;
+    int level = -1;
+};
+
+bool is_same_form(const IndexForm& a, const IndexForm& b) {
+    int64_t diff;
+    return a.level == b.level && a.expr && b.expr &&
+        PassUtils::get_index_difference(a.expr, b.expr, diff) &&
+        diff + a.offset - b.offset == 0;
+}
+
+struct ArrayAccess {
+    ASR::symbol_t* array; // Pointer temporaries are resolved to their target
+    std::vector<IndexForm> forms;
+    bool is_write;
+};
+
+struct NestInfo {
+    size_t depth = 0;
+    std::vector<ArrayAccess> accesses;
+    // All variables referenced by the nest
+    std::set<ASR::symbol_t*> symbols;
+    // Index variables and pointers assigned to by the nest
+    std::set<ASR::symbol_t*> defined;
+    // Variables whose values are read by the initialisations and loop heads
+    std::set<ASR::symbol_t*> setup_reads;
+    // Arrays assigned to by the innermost loop
+    std::set<ASR::symbol_t*> written;
+};
+
+class NestAnalyzer: public ASR::BaseWalkVisitor<NestAnalyzer>
+{
+private:
+
+    Allocator& al;
+    const Associations& associations;
+    NestInfo& info;
+    std::map<ASR::symbol_t*, IndexForm> env;
+    bool in_setup;
+    bool is_target;
+
+    IndexForm get_form(ASR::expr_t* x) {
+        if( is_index_var(x) ) {
+            auto it = env.find(var_symbol(x));
+            if( it != env.end() ) {
+                return it->second;
+            }
+            return IndexForm();
+        }
+        int64_t value;
+        if( ASRUtils::extract_value(ASRUtils::expr_value(x), value) ) {
+            IndexForm form;
+            form.expr = x;
+            return form;
+        }
+        return IndexForm();
+    }
+
+    IndexForm make_form(ASR::expr_t* start, int level) {
+        IndexForm form;
+        form.expr = resolve_bound(al, associations, start);
+        form.level = level;
+        return form;
+    }
+
+    void visit_setup(ASR::expr_t* x) {
+        if( x == nullptr ) {
+            return ;
+        }
+        in_setup = true;
+        visit_expr(*x);
+        in_setup = false;
+    }
+
+    void analyze_prologue(const std::vector<ASR::stmt_t*>& prologue,
+            std::map<ASR::symbol_t*, ASR::expr_t*>& inits) {
+        for( ASR::stmt_t* stmt: prologue ) {
+            if( is_index_init(stmt) ) {
+                ASR::Assignment_t* assignment = down_cast<ASR::Assignment_t>(stmt);
+                ASR::symbol_t* sym = var_symbol(assignment->m_target);
+                inits[sym] = assignment->m_value;
+                env[sym] = make_form(assignment->m_value, -1);
+                info.defined.insert(sym);
+                info.symbols.insert(sym);
+                visit_setup(assignment->m_value);
+            } else if( is_section_association(stmt) ) {
+                ASR::Associate_t* associate = down_cast<ASR::Associate_t>(stmt);
+                ASR::symbol_t* sym = var_symbol(associate->m_target);
+                info.defined.insert(sym);
+                info.symbols.insert(sym);
+                // Only the bounds of the section are read, not its elements
+                ASR::ArraySection_t* section = down_cast<ASR::ArraySection_t>(
+                    associate->m_value);
+                if( is_a<ASR::Var_t>(*section->m_v) ) {
+                    info.symbols.insert(var_symbol(section->m_v));
+                } else {
+                    visit_setup(section->m_v);
+                }
+                for( size_t i = 0; i < section->n_args; i++ ) {
+                    visit_setup(section->m_args[i].m_left);
+                    visit_setup(section->m_args[i].m_right);
+                    visit_setup(section->m_args[i].m_step);
+                }
+            } else {
+                valid = false;
+                return ;
+            }
+        }
+    }
+
+    void analyze_statement(ASR::stmt_t* stmt) {
+        if( !is_a<ASR::Assignment_t>(*stmt) ) {
+            valid = false;
+            return ;
+        }
+        ASR::Assignment_t* assignment = down_cast<ASR::Assignment_t>(stmt);
+        if( assignment->m_overloaded ||
+            !is_a<ASR::ArrayItem_t>(*assignment->m_target) ) {
+            valid = false;
+            return ;
+        }
+        is_target = true;
+        visit_expr(*assignment->m_target);
+        is_target = false;
+        visit_expr(*assignment->m_value);
+    }
+
+    // Maps an access through a pointer temporary to the associated array
+    bool resolve_pointer(ASR::expr_t* p, ArrayAccess& access) {
+        ASR::ArraySection_t* section = get_associated_section(associations, p);
+        if( section == nullptr || section->n_args != access.forms.size() ) {
+            return false;
+        }
+        for( size_t i = 0; i < section->n_args; i++ ) {
+            IndexForm& form = access.forms[i];
+            if( form.expr == nullptr ) {
+                continue;
+            }
+            // a(l:u)(j) is a(l + j - 1)
+            ASR::expr_t* left = section->m_args[i].m_left;
+            form.expr = ASRUtils::EXPR(ASR::make_IntegerBinOp_t(al, left->base.loc,
+                left, ASR::binopType::Add, form.expr, ASRUtils::expr_type(left), nullptr));
+            form.offset -= 1;
+        }
+        access.array = var_symbol(section->m_v);
+        return true;
+    }
+
+public:
+
+    bool valid;
+
+    NestAnalyzer(Allocator& al_, const Associations& associations_, NestInfo& info_):
+        al(al_), associations(associations_), info(info_), in_setup(false),
+        is_target(false), valid(true) {}
+
+    void analyze_loop(ASR::DoLoop_t* loop, const std::vector<ASR::stmt_t*>& prologue,
+            int level) {
+        std::map<ASR::symbol_t*, ASR::expr_t*> inits;
+        analyze_prologue(prologue, inits);
+        const ASR::do_loop_head_t& head = loop->m_head;
+        if( !valid || !has_unit_increment(head) || head.m_start == nullptr ||
+            head.m_end == nullptr ) {
+            valid = false;
+            return ;
+        }
+        ASR::symbol_t* v = var_symbol(head.m_v);
+        info.defined.insert(v);
+        info.symbols.insert(v);
+        visit_setup(head.m_start);
+        visit_setup(head.m_end);
+        env[v] = make_form(head.m_start, level);
+        info.depth = std::max(info.depth, (size_t) level + 1);
+
+        size_t begin, end;
+        split_body(loop, begin, end);
+        for( size_t i = 0; i < begin; i++ ) {
+            ASR::Assignment_t* alias = down_cast<ASR::Assignment_t>(loop->m_body[i]);
+            ASR::symbol_t* target = var_symbol(alias->m_target);
+            ASR::symbol_t* value = var_symbol(alias->m_value);
+            if( env.find(value) == env.end() ) {
+                valid = false;
+                return ;
+            }
+            env[target] = env[value];
+            info.defined.insert(target);
+            info.symbols.insert(target);
+            info.symbols.insert(value);
+        }
+        for( size_t i = end; i < loop->n_body; i++ ) {
+            ASR::Assignment_t* increment = down_cast<ASR::Assignment_t>(loop->m_body[i]);
+            ASR::symbol_t* sym = var_symbol(increment->m_target);
+            auto it = inits.find(sym);
+            if( it == inits.end() ) {
+                valid = false;
+                return ;
+            }
+            env[sym] = make_form(it->second, level);
+        }
+        if( begin == end ) {
+            valid = false;
+            return ;
+        }
+        ASR::DoLoop_t* inner = get_inner_loop(loop);
+        if( inner ) {
+            if( !is_index_loop(&inner->base) ) {
+                valid = false;
+                return ;
+            }
+            std::vector<ASR::stmt_t*> inner_prologue(loop->m_body + begin,
+                loop->m_body + end - 1);
+            analyze_loop(inner, inner_prologue, level + 1);
+        } else {
+            for( size_t i = begin; i < end && valid; i++ ) {
+                analyze_statement(loop->m_body[i]);
+            }
+        }
+    }
+
+    void visit_Var(const ASR::Var_t& x) {
+        ASR::symbol_t* sym = ASRUtils::symbol_get_past_external(x.m_v);
+        info.symbols.insert(sym);
+        if( in_setup ) {
+            info.setup_reads.insert(sym);
+        } else if( ASRUtils::is_array(ASRUtils::symbol_type(sym)) ) {
+            // Whole arrays are not expected in the innermost loop
+            valid = false;
+        }
+    }
+
+    void visit_ArrayBound(const ASR::ArrayBound_t& x) {
+        // Only the shape of the array is read
+        if( is_a<ASR::Var_t>(*x.m_v) ) {
+            info.symbols.insert(var_symbol(x.m_v));
+        } else {
+            visit_expr(*x.m_v);
+        }
+        if( x.m_dim ) {
+            visit_expr(*x.m_dim);
+        }
+    }
+
+    void visit_ArraySize(const ASR::ArraySize_t& x) {
+        if( is_a<ASR::Var_t>(*x.m_v) ) {
+            info.symbols.insert(var_symbol(x.m_v));
+        } else {
+            visit_expr(*x.m_v);
+        }
+        if( x.m_dim ) {
+            visit_expr(*x.m_dim);
+        }
+    }
+
+    void visit_ArraySection(const ASR::ArraySection_t& x) {
+        if( !in_setup ) {
+            valid = false;
+            return ;
+        }
+        ASR::BaseWalkVisitor<NestAnalyzer>::visit_ArraySection(x);
+    }
+
+    void visit_ArrayItem(const ASR::ArrayItem_t& x) {
+        if( in_setup ) {
+            ASR::BaseWalkVisitor<NestAnalyzer>::visit_ArrayItem(x);
+            return ;
+        }
+        ASR::expr_t* v = ASRUtils::get_past_array_physical_cast(x.m_v);
+        if( !is_a<ASR::Var_t>(*v) ) {
+            valid = false;
+            return ;
+        }
+        ArrayAccess access;
+        access.array = var_symbol(v);
+        access.is_write = is_target;
+        info.symbols.insert(access.array);
+        bool is_target_copy = is_target;
+        is_target = false;
+        for( size_t i = 0; i < x.n_args; i++ ) {
+            const ASR::array_index_t& index = x.m_args[i];
+            if( index.m_left || index.m_step || index.m_right == nullptr ) {
+                valid = false;
+                return ;
+            }
+            access.forms.push_back(get_form(index.m_right));
+            visit_expr(*index.m_right);
+        }
+        is_target = is_target_copy;
+        if( ASRUtils::is_pointer(ASRUtils::expr_type(v)) &&
+            !resolve_pointer(v, access) ) {
+            valid = false;
+            return ;
+        }
+        if( access.is_write ) {
+            info.written.insert(access.array);
+        }
+        info.accesses.push_back(access);
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t& x) {
+        // The calls of the fused nest are interleaved
+        ASR::symbol_t* fn = ASRUtils::symbol_get_past_external(x.m_name);
+        if( !is_a<ASR::Function_t>(*fn) ||
+            !(ASRUtils::get_FunctionType(fn)->m_pure ||
+              startswith(ASRUtils::symbol_name(fn), "_lcompilers_")) ) {
+            valid = false;
+            return ;
+        }
+        ASR::BaseWalkVisitor<NestAnalyzer>::visit_FunctionCall(x);
+    }
+
+    void visit_IntrinsicImpureFunction(const ASR::IntrinsicImpureFunction_t& /*x*/) {
+        valid = false;
+    }
+
+};
+
+bool accesses_array(const NestInfo& info, ASR::symbol_t* array) {
+    for( const ArrayAccess& access: info.accesses ) {
+        if( access.array == array ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Each iteration of the nest accesses a different element
+bool is_injective(const std::vector<IndexForm>& forms, size_t depth) {
+    if( forms.size() != depth ) {
+        return false;
+    }
+    std::set<int> levels;
+    for( const IndexForm& form: forms ) {
+        if( form.expr == nullptr || form.level < 0 ) {
+            return false;
+        }
+        levels.insert(form.level);
+    }
+    return levels.size() == depth;
+}
+
+bool is_fusion_legal(const NestInfo& a, const NestInfo& b) {
+    if( a.depth != b.depth ) {
+        return false;
+    }
+    for( ASR::symbol_t* sym: a.defined ) {
+        if( b.symbols.count(sym) ) {
+            return false;
+        }
+    }
+    for( ASR::symbol_t* sym: b.defined ) {
+        if( a.symbols.count(sym) ) {
+            return false;
+        }
+    }
+    // The initialisations of `b` are moved before `a` and the ones of
+    // the inner loops are interleaved
+    for( ASR::symbol_t* sym: a.written ) {
+        if( b.setup_reads.count(sym) ) {
+            return false;
+        }
+    }
+    for( ASR::symbol_t* sym: b.written ) {
+        if( a.setup_reads.count(sym) ) {
+            return false;
+        }
+    }
+    std::set<ASR::symbol_t*> shared;
+    for( ASR::symbol_t* sym: a.written ) {
+        if( accesses_array(b, sym) ) {
+            shared.insert(sym);
+        }
+    }
+    for( ASR::symbol_t* sym: b.written ) {
+        if( accesses_array(a, sym) ) {
+            shared.insert(sym);
+        }
+    }
+    for( ASR::symbol_t* sym: shared ) {
+        const std::vector<IndexForm>* reference = nullptr;
+        for( const NestInfo* info: {&a, &b} ) {
+            for( const ArrayAccess& access: info->accesses ) {
+                if( access.array != sym ) {
+                    continue;
+                }
+                if( reference == nullptr ) {
+                    if( !is_injective(access.forms, a.depth) ) {
+                        return false;
+                    }
+                    reference = &access.forms;
+                    continue;
+                }
+                if( access.forms.size() != reference->size() ) {
+                    return false;
+                }
+                for( size_t i = 0; i < access.forms.size(); i++ ) {
+                    if( !is_same_form(access.forms[i], (*reference)[i]) ) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+class ArrayLoopFusionVisitor : public ASR::ASRPassBaseWalkVisitor<ArrayLoopFusionVisitor>
+{
+private:
+
+    Allocator& al;
+    // The pointer temporaries associated so far in the current body
+    Associations associations;
+
+    struct LoopNest {
+        std::vector<ASR::stmt_t*> prologue;
+        ASR::DoLoop_t* loop;
+    };
+
+    bool analyze(const LoopNest& nest, NestInfo& info) {
+        NestAnalyzer analyzer(al, associations, info);
+        analyzer.analyze_loop(nest.loop, nest.prologue, 0);
+        return analyzer.valid;
+    }
+
+    ASR::DoLoop_t* fuse_loops(ASR::DoLoop_t* a, ASR::DoLoop_t* b) {
+        size_t a_begin, a_end, b_begin, b_end;
+        split_body(a, a_begin, a_end);
+        split_body(b, b_begin, b_end);
+        const Location& loc = a->base.base.loc;
+        Vec<ASR::stmt_t*> body;
+        body.reserve(al, a->n_body + b->n_body + 1);
+        for( size_t i = 0; i < a_begin; i++ ) {
+            body.push_back(al, a->m_body[i]);
+        }
+        body.push_back(al, ASRUtils::STMT(ASR::make_Assignment_t(al, loc,
+            b->m_head.m_v, a->m_head.m_v, nullptr)));
+        for( size_t i = 0; i < b_begin; i++ ) {
+            body.push_back(al, b->m_body[i]);
+        }
+        ASR::DoLoop_t* a_inner = get_inner_loop(a);
+        ASR::DoLoop_t* b_inner = get_inner_loop(b);
+        if( a_inner ) {
+            for( size_t i = a_begin; i + 1 < a_end; i++ ) {
+                body.push_back(al, a->m_body[i]);
+            }
+            for( size_t i = b_begin; i + 1 < b_end; i++ ) {
+                body.push_back(al, b->m_body[i]);
+            }
+            body.push_back(al, &fuse_loops(a_inner, b_inner)->base);
+        } else {
+            for( size_t i = a_begin; i < a_end; i++ ) {
+                body.push_back(al, a->m_body[i]);
+            }
+            for( size_t i = b_begin; i < b_end; i++ ) {
+                body.push_back(al, b->m_body[i]);
+            }
+        }
+        for( size_t i = a_end; i < a->n_body; i++ ) {
+            body.push_back(al, a->m_body[i]);
+        }
+        for( size_t i = b_end; i < b->n_body; i++ ) {
+            body.push_back(al, b->m_body[i]);
+        }
+        return down_cast<ASR::DoLoop_t>(ASRUtils::STMT(ASR::make_DoLoop_t(al, loc,
+            a->m_name, a->m_head, body.p, body.size(), nullptr, 0)));
+    }
+
+    bool try_fuse(const LoopNest& a, const LoopNest& b, LoopNest& fused) {
+        NestInfo a_info, b_info;
+        if( !analyze(a, a_info) || !analyze(b, b_info) ||
+            !heads_match(al, associations, a.loop, b.loop) ||
+            !is_fusion_legal(a_info, b_info) ) {
+            return false;
+        }
+        fused.prologue = a.prologue;
+        fused.prologue.insert(fused.prologue.end(), b.prologue.begin(), b.prologue.end());
+        fused.loop = fuse_loops(a.loop, b.loop);
+        return true;
+    }
+
+    void fuse_loop_nests(ASR::stmt_t**& m_body, size_t& n_body) {
+        Vec<ASR::stmt_t*> body;
+        body.reserve(al, n_body);
+        std::vector<ASR::stmt_t*> pending;
+        LoopNest last;
+        bool has_last = false, fused_any = false;
+        auto flush = [&]() {
+            if( has_last ) {
+                for( ASR::stmt_t* stmt: last.prologue ) {
+                    body.push_back(al, stmt);
+                }
+                body.push_back(al, &last.loop->base);
+                has_last = false;
+            }
+            for( ASR::stmt_t* stmt: pending ) {
+                body.push_back(al, stmt);
+            }
+            pending.clear();
+        };
+        for( size_t i = 0; i < n_body; i++ ) {
+            ASR::stmt_t* stmt = m_body[i];
+            if( is_index_init(stmt) ) {
+                pending.push_back(stmt);
+            } else if( is_section_association(stmt) ) {
+                ASR::Associate_t* associate = down_cast<ASR::Associate_t>(stmt);
+                associations[var_symbol(associate->m_target)] =
+                    down_cast<ASR::ArraySection_t>(associate->m_value);
+                pending.push_back(stmt);
+            } else if( is_index_loop(stmt) ) {
+                LoopNest nest;
+                nest.prologue = pending;
+                nest.loop = down_cast<ASR::DoLoop_t>(stmt);
+                pending.clear();
+                LoopNest fused;
+                if( has_last && try_fuse(last, nest, fused) ) {
+                    last = fused;
+                    fused_any = true;
+                    continue;
+                }
+                flush();
+                last = nest;
+                has_last = true;
+            } else {
+                flush();
+                // Any other statement can change the pointer associations
+                associations.clear();
+                body.push_back(al, stmt);
+            }
+        }
+        flush();
+        if( fused_any ) {
+            m_body = body.p;
+            n_body = body.size();
+        }
+    }
+
+public:
+
+    ArrayLoopFusionVisitor(Allocator& al_): al(al_) {}
+
+    void transform_stmts(ASR::stmt_t**& m_body, size_t& n_body) {
+        Associations associations_copy = associations;
+        associations.clear();
+        for( size_t i = 0; i < n_body; i++ ) {
+            visit_stmt(*m_body[i]);
+        }
+        associations.clear();
+        fuse_loop_nests(m_body, n_body);
+        associations = associations_copy;
+    }
+
+};
+
+void pass_array_loop_fusion(Allocator &al, ASR::TranslationUnit_t &unit,
+                            const LCompilers::PassOptions& pass_options) {
+    if( !pass_options.fast ) {
+        return ;
+    }
+    ArrayLoopFusionVisitor v(al);
+    v.visit_TranslationUnit(unit);
+}
+
+
+} // namespace LCompilers
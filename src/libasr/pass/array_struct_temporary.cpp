@@ -946,6 +946,67 @@ bool is_common_symbol_present_in_lhs_and_rhs(Allocator &al, ASR::expr_t* lhs, AS
     return false;
 }
 
+/*
+ * Returns true if the section `rhs` of the array assigned to by the section
+ * `lhs` can be read in place by the loop nest that array_op generates for
+ * the assignment, i.e. every element of `rhs` is read before the loop writes
+ * to it. For example `u(2:n-1) = u(3:n) + ...` is safe, but
+ * `u(2:n-1) = u(1:n-2) + ...` needs a copy of `u(1:n-2)`.
+ *
+ * The loops run forward with the last dimension outermost, so the read is
+ * safe if the offset of `rhs` relative to `lhs` is lexicographically
+ * non-negative starting from the last dimension. All the offsets must be
+ * compile time constants and all strides must be one.
+ */
+bool is_section_read_ahead_of_lhs(ASR::expr_t* lhs, ASR::expr_t* rhs) {
+    if( lhs == nullptr || !ASR::is_a<ASR::ArraySection_t>(*lhs) ||
+        !ASR::is_a<ASR::ArraySection_t>(*rhs) ) {
+        return false;
+    }
+    ASR::ArraySection_t* lhs_section = ASR::down_cast<ASR::ArraySection_t>(lhs);
+    ASR::ArraySection_t* rhs_section = ASR::down_cast<ASR::ArraySection_t>(rhs);
+    if( !ASR::is_a<ASR::Var_t>(*lhs_section->m_v) ||
+        !ASR::is_a<ASR::Var_t>(*rhs_section->m_v) ||
+        ASR::down_cast<ASR::Var_t>(lhs_section->m_v)->m_v !=
+            ASR::down_cast<ASR::Var_t>(rhs_section->m_v)->m_v ||
+        lhs_section->n_args != rhs_section->n_args ||
+        ASRUtils::is_array_indexed_with_array_indices(lhs_section) ||
+        ASRUtils::is_array_indexed_with_array_indices(rhs_section) ) {
+        return false;
+    }
+    for( int64_t i = (int64_t) lhs_section->n_args - 1; i >= 0; i-- ) {
+        ASR::array_index_t& l = lhs_section->m_args[i];
+        ASR::array_index_t& r = rhs_section->m_args[i];
+        bool l_is_scalar = l.m_left == nullptr && l.m_step == nullptr;
+        bool r_is_scalar = r.m_left == nullptr && r.m_step == nullptr;
+        if( l_is_scalar != r_is_scalar ) {
+            return false;
+        }
+        if( l_is_scalar ) {
+            // The same element in this dimension for every iteration
+            if( !PassUtils::is_same_index_expr(l.m_right, r.m_right) ) {
+                return false;
+            }
+            continue;
+        }
+        int64_t l_step, r_step, offset;
+        if( l.m_left == nullptr || l.m_step == nullptr ||
+            r.m_left == nullptr || r.m_step == nullptr ||
+            !ASRUtils::extract_value(ASRUtils::expr_value(l.m_step), l_step) ||
+            !ASRUtils::extract_value(ASRUtils::expr_value(r.m_step), r_step) ||
+            l_step != 1 || r_step != 1 ||
+            !PassUtils::get_index_difference(r.m_left, l.m_left, offset) ) {
+            return false;
+        }
+        if( offset > 0 ) {
+            return true;
+        } else if( offset < 0 ) {
+            return false;
+        }
+    }
+    return true;
+}
+
 class ArgSimplifier: public ASR::CallReplacerOnExpressionsVisitor<ArgSimplifier>
 {
 
@@ -956,6 +1017,7 @@ class ArgSimplifier: public ASR::CallReplacerOnExpressionsVisitor<ArgSimplifier>
     Vec<ASR::stmt_t*>* parent_body_for_where;
     ExprsWithTargetType& exprs_with_target;
     ASR::expr_t* lhs_var;
+    ASR::expr_t* lhs_target;
     bool realloc_lhs;
     bool inside_where;
 
@@ -963,7 +1025,8 @@ class ArgSimplifier: public ASR::CallReplacerOnExpressionsVisitor<ArgSimplifier>
 
     ArgSimplifier(Allocator& al_, ExprsWithTargetType& exprs_with_target_, bool realloc_lhs_) :
         al(al_), current_body(nullptr), parent_body_for_where(nullptr),
-            exprs_with_target(exprs_with_target_), lhs_var(nullptr), realloc_lhs(realloc_lhs_),
+            exprs_with_target(exprs_with_target_), lhs_var(nullptr), lhs_target(nullptr),
+            realloc_lhs(realloc_lhs_),
             inside_where(false) {(void)realloc_lhs; /*Silence-Warning*/}
 
 
@@ -980,8 +1043,11 @@ class ArgSimplifier: public ASR::CallReplacerOnExpressionsVisitor<ArgSimplifier>
         const std::string& name_hint, SymbolTable* current_scope, ExprsWithTargetType& exprs_with_target) {
         ASR::expr_t* x_m_args_i = ASRUtils::get_past_array_physical_cast(expr);
         ASR::expr_t* array_var_temporary = nullptr;
+        // A section of the array being assigned to needs a copy, unless the
+        // generated loop reads every element before overwriting it
         bool is_pointer_required = ASR::is_a<ASR::ArraySection_t>(*x_m_args_i) &&
-                    !is_common_symbol_present_in_lhs_and_rhs(al, lhs_var, expr) &&
+                    (!is_common_symbol_present_in_lhs_and_rhs(al, lhs_var, expr) ||
+                     is_section_read_ahead_of_lhs(lhs_target, x_m_args_i)) &&
                     !ASRUtils::is_array_indexed_with_array_indices(ASR::down_cast<ASR::ArraySection_t>(x_m_args_i));
         array_var_temporary = create_and_allocate_temporary_variable_for_array(
             x_m_args_i, name_hint, al, current_body, current_scope, exprs_with_target,
@@ -1162,8 +1228,10 @@ class ArgSimplifier: public ASR::CallReplacerOnExpressionsVisitor<ArgSimplifier>
             lhs_array_var = ASRUtils::extract_array_variable(x.m_target);
         }
         lhs_var = lhs_array_var;
+        lhs_target = x.m_target;
         ASR::CallReplacerOnExpressionsVisitor<ArgSimplifier>::visit_Assignment(x);
         lhs_var = nullptr;
+        lhs_target = nullptr;
     }
 
     void visit_Where(const ASR::Where_t &x) {
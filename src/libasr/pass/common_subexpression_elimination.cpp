@@ -0,0 +1,548 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_verify.h>
+#include <libasr/pass/common_subexpression_elimination.h>
+#include <libasr/pass/dataflow.h>
+#include <libasr/pass/pass_utils.h>
+
+#include <string>
+
+
+namespace LCompilers {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+
+This ASR pass eliminates repeated integer index arithmetic. An available
+expressions analysis (see pass/dataflow.h) finds `+`, `-` and `*` trees
+over tracked scalars, intent(in) scalars and constants that were already
+computed on every path reaching a statement, without any of their
+operands being redefined since. Such an expression is stored into a
+temporary where it is first computed and read back where it is repeated.
+
+Converts:
+
+    a(i*n + j) = b(i*n + j) + 1
+    if (i*n + j > 10) then
+        c(i*n + j + 1) = 0
+    end if
+
+to:
+
+    __libasr_cse_1 = i*n
+    __libasr_cse_2 = __libasr_cse_1 + j
+    a(__libasr_cse_2) = b(__libasr_cse_2) + 1
+    if (__libasr_cse_2 > 10) then
+        c(__libasr_cse_2 + 1) = 0
+    end if
+
+*/
+
+namespace {
+
+    typedef std::set<std::string> Available;
+
+    /*
+     * Gives every integer index expression a key that is equal for
+     * structurally equal expressions, together with the variables it
+     * reads. Operands are named after their symbols, which are unique
+     * within the procedure being optimized.
+     */
+    class ExpressionCatalog {
+
+        private:
+
+            const std::set<ASR::symbol_t*>& tracked;
+            std::map<std::string, std::set<ASR::symbol_t*>> operands;
+
+            bool describe(ASR::expr_t* x, std::string& key, std::set<ASR::symbol_t*>& syms) {
+                switch( x->type ) {
+                    case ASR::exprType::IntegerConstant: {
+                        key = std::to_string(down_cast<ASR::IntegerConstant_t>(x)->m_n) + "_" +
+                            std::to_string(ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(x)));
+                        return true;
+                    }
+                    case ASR::exprType::Var: {
+                        ASR::symbol_t* sym = down_cast<ASR::Var_t>(x)->m_v;
+                        if( tracked.find(sym) == tracked.end() &&
+                            !DataFlow::is_invariant_argument(sym) ) {
+                            return false;
+                        }
+                        if( !is_a<ASR::Integer_t>(*ASRUtils::symbol_type(sym)) ) {
+                            return false;
+                        }
+                        key = ASRUtils::symbol_name(sym);
+                        syms.insert(sym);
+                        return true;
+                    }
+                    case ASR::exprType::IntegerBinOp: {
+                        ASR::IntegerBinOp_t* e = down_cast<ASR::IntegerBinOp_t>(x);
+                        if( e->m_value ) {
+                            return false;
+                        }
+                        std::string op;
+                        switch( e->m_op ) {
+                            case ASR::binopType::Add: op = "+"; break;
+                            case ASR::binopType::Sub: op = "-"; break;
+                            case ASR::binopType::Mul: op = "*"; break;
+                            default: return false;
+                        }
+                        std::string left, right;
+                        if( !describe(e->m_left, left, syms) || !describe(e->m_right, right, syms) ) {
+                            return false;
+                        }
+                        key = "(" + left + op + right + ")_" +
+                            std::to_string(ASRUtils::extract_kind_from_ttype_t(e->m_type));
+                        return true;
+                    }
+                    case ASR::exprType::Cast: {
+                        ASR::Cast_t* e = down_cast<ASR::Cast_t>(x);
+                        std::string arg;
+                        if( e->m_value || e->m_kind != ASR::cast_kindType::IntegerToInteger ||
+                            !describe(e->m_arg, arg, syms) ) {
+                            return false;
+                        }
+                        key = "int(" + arg + ")_" +
+                            std::to_string(ASRUtils::extract_kind_from_ttype_t(e->m_type));
+                        return true;
+                    }
+                    default: {
+                        return false;
+                    }
+                }
+            }
+
+        public:
+
+            ExpressionCatalog(const std::set<ASR::symbol_t*>& tracked_): tracked(tracked_) {}
+
+            // Key of `x` if it is an arithmetic operation worth reusing, "" otherwise
+            std::string get_key(ASR::expr_t* x) {
+                if( !is_a<ASR::IntegerBinOp_t>(*x) ) {
+                    return "";
+                }
+                std::string key;
+                std::set<ASR::symbol_t*> syms;
+                if( !describe(x, key, syms) || syms.empty() ) {
+                    return "";
+                }
+                operands[key] = syms;
+                return key;
+            }
+
+            void kill(ASR::symbol_t* sym, Available& state) {
+                for( auto it = state.begin(); it != state.end(); ) {
+                    const std::set<ASR::symbol_t*>& syms = operands[*it];
+                    if( syms.find(sym) != syms.end() ) {
+                        it = state.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
+    };
+
+    enum class WalkMode {
+        Gen,        // Record the expressions a statement computes
+        Choose,     // Record the expressions that are recomputed
+        Apply       // Introduce the temporaries
+    };
+
+    /*
+     * Walks a statement expression top down. An available operation is not
+     * recomputed, so nothing below it is computed either; every other
+     * operation is computed after its operands, which makes it available.
+     */
+    class IndexExpressionWalker: public ASR::BaseExprReplacer<IndexExpressionWalker> {
+
+        private:
+
+            Allocator& al;
+            ExpressionCatalog& catalog;
+            WalkMode mode;
+
+            void walk(ASR::expr_t* x) {
+                std::string key = catalog.get_key(x);
+                if( key.empty() ) {
+                    if( is_a<ASR::Cast_t>(*x) || is_a<ASR::IntegerBinOp_t>(*x) ) {
+                        ASR::BaseExprReplacer<IndexExpressionWalker>::replace_expr(x);
+                    }
+                    return ;
+                }
+                bool is_chosen = chosen.find(key) != chosen.end();
+                if( mode == WalkMode::Apply && dry_run ) {
+                    changed = changed || is_chosen;
+                    if( !is_chosen ) {
+                        walk_children(x);
+                    }
+                    return ;
+                }
+                if( available.find(key) != available.end() ) {
+                    if( mode == WalkMode::Choose ) {
+                        chosen.insert(key);
+                    } else if( mode == WalkMode::Apply && is_chosen ) {
+                        *current_expr = get_temporary(key, x);
+                        return ;
+                    }
+                    if( mode != WalkMode::Apply ) {
+                        return ;
+                    }
+                }
+                walk_children(x);
+                if( !generate ) {
+                    return ;
+                }
+                if( mode == WalkMode::Apply && is_chosen &&
+                    available.find(key) == available.end() ) {
+                    ASR::expr_t* temporary = get_temporary(key, x);
+                    pre_statements.push_back(al, ASRUtils::STMT(ASR::make_Assignment_t(
+                        al, x->base.loc, temporary, x, nullptr)));
+                    *current_expr = temporary;
+                }
+                available.insert(key);
+            }
+
+            ASR::expr_t* get_temporary(const std::string& key, ASR::expr_t* x) {
+                auto it = temporaries.find(key);
+                if( it != temporaries.end() ) {
+                    return it->second;
+                }
+                std::string name = scope->get_unique_name("__libasr_cse_" +
+                    std::to_string(temporaries.size() + 1));
+                ASR::expr_t* temporary = PassUtils::create_auxiliary_variable(
+                    x->base.loc, name, al, scope, ASRUtils::expr_type(x));
+                temporaries[key] = temporary;
+                return temporary;
+            }
+
+            void walk_children(ASR::expr_t* x) {
+                ASR::expr_t** current_expr_copy = current_expr;
+                if( is_a<ASR::IntegerBinOp_t>(*x) ) {
+                    ASR::IntegerBinOp_t* e = down_cast<ASR::IntegerBinOp_t>(x);
+                    current_expr = &e->m_left;
+                    walk(e->m_left);
+                    current_expr = &e->m_right;
+                    walk(e->m_right);
+                } else if( is_a<ASR::Cast_t>(*x) ) {
+                    ASR::Cast_t* e = down_cast<ASR::Cast_t>(x);
+                    current_expr = &e->m_arg;
+                    walk(e->m_arg);
+                }
+                current_expr = current_expr_copy;
+            }
+
+        public:
+
+            Available available;
+            std::set<std::string>& chosen;
+            std::map<std::string, ASR::expr_t*>& temporaries;
+            SymbolTable* scope;
+            Vec<ASR::stmt_t*> pre_statements;
+            bool generate;
+            bool dry_run, changed;
+
+            IndexExpressionWalker(Allocator& al_, ExpressionCatalog& catalog_,
+                WalkMode mode_, const Available& available_, std::set<std::string>& chosen_,
+                std::map<std::string, ASR::expr_t*>& temporaries_, SymbolTable* scope_):
+                al(al_), catalog(catalog_), mode(mode_), available(available_),
+                chosen(chosen_), temporaries(temporaries_), scope(scope_),
+                generate(true), dry_run(false), changed(false) {
+                call_replacer_on_value = false;
+                pre_statements.reserve(al, 1);
+            }
+
+            void replace_expr(ASR::expr_t* x) {
+                if( x == nullptr ) {
+                    return ;
+                }
+                if( is_a<ASR::IntegerBinOp_t>(*x) && !catalog.get_key(x).empty() ) {
+                    walk(x);
+                    return ;
+                }
+                ASR::BaseExprReplacer<IndexExpressionWalker>::replace_expr(x);
+            }
+
+            void visit_slot(ASR::expr_t** slot) {
+                current_expr = slot;
+                replace_expr(*slot);
+            }
+
+    };
+
+}
+
+class AvailableExpressions: public DataFlow::ForwardAnalysis<Available> {
+
+    private:
+
+        Allocator& al;
+        const std::set<ASR::symbol_t*>& tracked;
+        ExpressionCatalog& catalog;
+
+        void gen(ASR::stmt_t* stmt, Available& state) {
+            std::set<std::string> chosen;
+            std::map<std::string, ASR::expr_t*> temporaries;
+            IndexExpressionWalker walker(al, catalog, WalkMode::Gen, state,
+                chosen, temporaries, nullptr);
+            for( DataFlow::ExpressionSlot& slot: DataFlow::get_expression_slots(stmt) ) {
+                if( !slot.at_head ) {
+                    walker.visit_slot(slot.expr);
+                }
+            }
+            state = walker.available;
+        }
+
+    public:
+
+        AvailableExpressions(Allocator& al_, const std::set<ASR::symbol_t*>& tracked_,
+            ExpressionCatalog& catalog_): al(al_), tracked(tracked_), catalog(catalog_) {}
+
+        Available join(const Available& a, const Available& b) override {
+            Available result;
+            for( const std::string& key: a ) {
+                if( b.find(key) != b.end() ) {
+                    result.insert(key);
+                }
+            }
+            return result;
+        }
+
+        bool equal(const Available& a, const Available& b) override {
+            return a == b;
+        }
+
+        void transfer(ASR::stmt_t* stmt, Available& state) override {
+            gen(stmt, state);
+            ASR::symbol_t* sym = DataFlow::get_definition(stmt, tracked);
+            if( sym ) {
+                catalog.kill(sym, state);
+            }
+        }
+
+        void transfer_condition(ASR::stmt_t* stmt, Available& state) override {
+            gen(stmt, state);
+        }
+
+        void transfer_loop_head(ASR::stmt_t* loop, Available& state) override {
+            if( is_a<ASR::DoLoop_t>(*loop) ) {
+                ASR::expr_t* v = down_cast<ASR::DoLoop_t>(loop)->m_head.m_v;
+                if( v && is_a<ASR::Var_t>(*v) ) {
+                    catalog.kill(down_cast<ASR::Var_t>(v)->m_v, state);
+                }
+            }
+        }
+
+};
+
+class CommonSubexpressionEliminationVisitor:
+    public ASR::BaseWalkVisitor<CommonSubexpressionEliminationVisitor> {
+
+    private:
+
+        Allocator& al;
+
+        template <typename F>
+        void for_each_statement(ASR::stmt_t** body, size_t n_body, F& f) {
+            for( size_t i = 0; i < n_body; i++ ) {
+                ASR::stmt_t* stmt = body[i];
+                f(stmt);
+                switch( stmt->type ) {
+                    case ASR::stmtType::If: {
+                        ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                        for_each_statement(x->m_body, x->n_body, f);
+                        for_each_statement(x->m_orelse, x->n_orelse, f);
+                        break;
+                    }
+                    case ASR::stmtType::WhileLoop: {
+                        ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                        for_each_statement(x->m_body, x->n_body, f);
+                        for_each_statement(x->m_orelse, x->n_orelse, f);
+                        break;
+                    }
+                    case ASR::stmtType::DoLoop: {
+                        ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                        for_each_statement(x->m_body, x->n_body, f);
+                        for_each_statement(x->m_orelse, x->n_orelse, f);
+                        break;
+                    }
+                    case ASR::stmtType::Select: {
+                        ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                        for( size_t j = 0; j < x->n_body; j++ ) {
+                            if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                                ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                                for_each_statement(c->m_body, c->n_body, f);
+                            } else {
+                                ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                                for_each_statement(c->m_body, c->n_body, f);
+                            }
+                        }
+                        for_each_statement(x->m_default, x->n_default, f);
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+            }
+        }
+
+        void rebuild_body(const std::map<ASR::stmt_t*, Vec<ASR::stmt_t*>>& inserted,
+            ASR::stmt_t**& body, size_t& n_body) {
+            Vec<ASR::stmt_t*> new_body;
+            new_body.reserve(al, n_body);
+            for( size_t i = 0; i < n_body; i++ ) {
+                ASR::stmt_t* stmt = body[i];
+                auto it = inserted.find(stmt);
+                if( it != inserted.end() ) {
+                    for( size_t j = 0; j < it->second.size(); j++ ) {
+                        new_body.push_back(al, it->second[j]);
+                    }
+                }
+                switch( stmt->type ) {
+                    case ASR::stmtType::If: {
+                        ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                        rebuild_body(inserted, x->m_body, x->n_body);
+                        rebuild_body(inserted, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::WhileLoop: {
+                        ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                        rebuild_body(inserted, x->m_body, x->n_body);
+                        rebuild_body(inserted, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::DoLoop: {
+                        ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                        rebuild_body(inserted, x->m_body, x->n_body);
+                        rebuild_body(inserted, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::Select: {
+                        ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                        for( size_t j = 0; j < x->n_body; j++ ) {
+                            if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                                ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                                rebuild_body(inserted, c->m_body, c->n_body);
+                            } else {
+                                ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                                rebuild_body(inserted, c->m_body, c->n_body);
+                            }
+                        }
+                        rebuild_body(inserted, x->m_default, x->n_default);
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+                new_body.push_back(al, stmt);
+            }
+            body = new_body.p;
+            n_body = new_body.size();
+        }
+
+        void optimize(SymbolTable* scope, ASR::stmt_t**& body, size_t& n_body) {
+            if( n_body == 0 || !DataFlow::is_structured(scope, body, n_body) ) {
+                return ;
+            }
+            std::set<ASR::symbol_t*> tracked = DataFlow::get_tracked_variables(
+                scope, body, n_body);
+            ExpressionCatalog catalog(tracked);
+            AvailableExpressions analysis(al, tracked, catalog);
+            analysis.run(body, n_body, Available());
+            if( !analysis.valid ) {
+                return ;
+            }
+
+            // Expressions computed again while they are still available
+            std::set<std::string> chosen;
+            std::map<std::string, ASR::expr_t*> temporaries;
+            auto choose = [&](ASR::stmt_t* stmt) {
+                auto flow = analysis.in.find(stmt);
+                if( flow == analysis.in.end() || !flow->second.reachable ) {
+                    return ;
+                }
+                IndexExpressionWalker walker(al, catalog, WalkMode::Choose,
+                    flow->second.state, chosen, temporaries, scope);
+                for( DataFlow::ExpressionSlot& slot: DataFlow::get_expression_slots(stmt) ) {
+                    if( slot.at_head ) {
+                        const auto& head = analysis.head.at(stmt);
+                        if( head.reachable ) {
+                            IndexExpressionWalker head_walker(al, catalog, WalkMode::Choose,
+                                head.state, chosen, temporaries, scope);
+                            head_walker.generate = false;
+                            head_walker.visit_slot(slot.expr);
+                        }
+                    } else {
+                        walker.visit_slot(slot.expr);
+                    }
+                }
+            };
+            for_each_statement(body, n_body, choose);
+            if( chosen.empty() ) {
+                return ;
+            }
+
+            std::map<ASR::stmt_t*, Vec<ASR::stmt_t*>> inserted;
+            auto apply = [&](ASR::stmt_t* stmt) {
+                auto flow = analysis.in.find(stmt);
+                if( flow == analysis.in.end() || !flow->second.reachable ) {
+                    return ;
+                }
+                IndexExpressionWalker walker(al, catalog, WalkMode::Apply,
+                    flow->second.state, chosen, temporaries, scope);
+                for( DataFlow::ExpressionSlot& slot: DataFlow::get_expression_slots(stmt) ) {
+                    if( slot.at_head ) {
+                        const auto& head = analysis.head.at(stmt);
+                        if( head.reachable ) {
+                            IndexExpressionWalker head_walker(al, catalog, WalkMode::Apply,
+                                head.state, chosen, temporaries, scope);
+                            head_walker.generate = false;
+                            DataFlow::rewrite_expression(al, slot.expr, head_walker);
+                        }
+                    } else {
+                        DataFlow::rewrite_expression(al, slot.expr, walker);
+                    }
+                }
+                if( walker.pre_statements.size() > 0 ) {
+                    inserted[stmt] = walker.pre_statements;
+                }
+            };
+            for_each_statement(body, n_body, apply);
+            rebuild_body(inserted, body, n_body);
+        }
+
+    public:
+
+        CommonSubexpressionEliminationVisitor(Allocator& al_): al(al_) {}
+
+        void visit_Program(const ASR::Program_t& x) {
+            for( auto& item: x.m_symtab->get_scope() ) {
+                visit_symbol(*item.second);
+            }
+            ASR::Program_t& xx = const_cast<ASR::Program_t&>(x);
+            optimize(xx.m_symtab, xx.m_body, xx.n_body);
+        }
+
+        void visit_Function(const ASR::Function_t& x) {
+            for( auto& item: x.m_symtab->get_scope() ) {
+                visit_symbol(*item.second);
+            }
+            ASR::Function_t& xx = const_cast<ASR::Function_t&>(x);
+            optimize(xx.m_symtab, xx.m_body, xx.n_body);
+        }
+
+};
+
+void pass_common_subexpression_elimination(Allocator &al, ASR::TranslationUnit_t &unit,
+                                           const PassOptions &/*pass_options*/) {
+    CommonSubexpressionEliminationVisitor v(al);
+    v.visit_TranslationUnit(unit);
+}
+
+} // namespace LCompilers
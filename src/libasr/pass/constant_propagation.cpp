@@ -0,0 +1,663 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_verify.h>
+#include <libasr/pass/constant_propagation.h>
+#include <libasr/pass/dataflow.h>
+#include <libasr/pass/pass_utils.h>
+
+#include <cstdint>
+#include <limits>
+
+
+namespace LCompilers {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+
+This ASR pass performs conditional constant propagation over the tracked
+scalar locals of each procedure (see pass/dataflow.h). A branch whose test
+is known is not followed, so constants defined on the path that is taken
+are not lost at the join, and statements that can never execute are
+removed. Assignments whose value is no longer read are deleted afterwards.
+Constant If tests are left for the `dead_code_removal` pass to fold.
+
+Converts:
+
+    n = 4
+    m = n * 2
+    if (m > 4) then
+        k = m + 1
+    else
+        k = 0
+    end if
+    a(k) = m
+
+to:
+
+    if (.true.) then
+        k = 9
+    else
+        k = 0
+    end if
+    a(9) = 8
+
+*/
+
+namespace {
+
+    struct Constant {
+        enum Kind { Integer, Logical, Real };
+
+        Kind kind;
+        int64_t i;
+        bool b;
+        double r;
+
+        bool operator==(const Constant& other) const {
+            if( kind != other.kind ) {
+                return false;
+            }
+            switch( kind ) {
+                case Integer: return i == other.i;
+                case Logical: return b == other.b;
+                default: return r == other.r;
+            }
+        }
+
+        bool operator!=(const Constant& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // Variables missing from the map are not constant
+    typedef std::map<ASR::symbol_t*, Constant> Constants;
+
+    bool fits_kind(int64_t value, int kind) {
+        switch( kind ) {
+            case 1: return value >= INT8_MIN && value <= INT8_MAX;
+            case 2: return value >= INT16_MIN && value <= INT16_MAX;
+            case 4: return value >= INT32_MIN && value <= INT32_MAX;
+            case 8: return true;
+            default: return false;
+        }
+    }
+
+    bool fold_integer(ASR::binopType op, int64_t a, int64_t b, int64_t& result) {
+        const int64_t min = std::numeric_limits<int64_t>::min();
+        const int64_t max = std::numeric_limits<int64_t>::max();
+        switch( op ) {
+            case ASR::binopType::Add: {
+                if( (b > 0 && a > max - b) || (b < 0 && a < min - b) ) {
+                    return false;
+                }
+                result = a + b;
+                return true;
+            }
+            case ASR::binopType::Sub: {
+                if( (b < 0 && a > max + b) || (b > 0 && a < min + b) ) {
+                    return false;
+                }
+                result = a - b;
+                return true;
+            }
+            case ASR::binopType::Mul: {
+                if( a == 0 || b == 0 ) {
+                    result = 0;
+                    return true;
+                }
+                if( (a == -1 && b == min) || (b == -1 && a == min) ) {
+                    return false;
+                }
+                result = (int64_t)((uint64_t)a * (uint64_t)b);
+                return result / b == a;
+            }
+            case ASR::binopType::Div: {
+                if( b == 0 || (a == min && b == -1) ) {
+                    return false;
+                }
+                result = a / b;
+                return true;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    bool compare(ASR::cmpopType op, int64_t a, int64_t b) {
+        switch( op ) {
+            case ASR::cmpopType::Eq: return a == b;
+            case ASR::cmpopType::NotEq: return a != b;
+            case ASR::cmpopType::Lt: return a < b;
+            case ASR::cmpopType::LtE: return a <= b;
+            case ASR::cmpopType::Gt: return a > b;
+            default: return a >= b;
+        }
+    }
+
+    bool has_compile_time_value(ASR::expr_t* x) {
+        switch( x->type ) {
+            case ASR::exprType::IntegerConstant:
+            case ASR::exprType::LogicalConstant:
+            case ASR::exprType::RealConstant: return true;
+            case ASR::exprType::IntegerBinOp: return down_cast<ASR::IntegerBinOp_t>(x)->m_value;
+            case ASR::exprType::IntegerUnaryMinus: return down_cast<ASR::IntegerUnaryMinus_t>(x)->m_value;
+            case ASR::exprType::IntegerCompare: return down_cast<ASR::IntegerCompare_t>(x)->m_value;
+            case ASR::exprType::LogicalBinOp: return down_cast<ASR::LogicalBinOp_t>(x)->m_value;
+            case ASR::exprType::LogicalNot: return down_cast<ASR::LogicalNot_t>(x)->m_value;
+            case ASR::exprType::Cast: return down_cast<ASR::Cast_t>(x)->m_value;
+            default: return false;
+        }
+    }
+
+    bool evaluate(ASR::expr_t* x, const Constants& state, Constant& c) {
+        if( x == nullptr ) {
+            return false;
+        }
+        switch( x->type ) {
+            case ASR::exprType::IntegerConstant: {
+                c.kind = Constant::Integer;
+                c.i = down_cast<ASR::IntegerConstant_t>(x)->m_n;
+                return true;
+            }
+            case ASR::exprType::LogicalConstant: {
+                c.kind = Constant::Logical;
+                c.b = down_cast<ASR::LogicalConstant_t>(x)->m_value;
+                return true;
+            }
+            case ASR::exprType::RealConstant: {
+                c.kind = Constant::Real;
+                c.r = down_cast<ASR::RealConstant_t>(x)->m_r;
+                return true;
+            }
+            case ASR::exprType::Var: {
+                auto it = state.find(down_cast<ASR::Var_t>(x)->m_v);
+                if( it == state.end() ) {
+                    return false;
+                }
+                c = it->second;
+                return true;
+            }
+            case ASR::exprType::IntegerBinOp: {
+                ASR::IntegerBinOp_t* e = down_cast<ASR::IntegerBinOp_t>(x);
+                if( e->m_value ) {
+                    return evaluate(e->m_value, state, c);
+                }
+                Constant left, right;
+                if( !evaluate(e->m_left, state, left) || left.kind != Constant::Integer ||
+                    !evaluate(e->m_right, state, right) || right.kind != Constant::Integer ||
+                    !fold_integer(e->m_op, left.i, right.i, c.i) ) {
+                    return false;
+                }
+                c.kind = Constant::Integer;
+                return fits_kind(c.i, ASRUtils::extract_kind_from_ttype_t(e->m_type));
+            }
+            case ASR::exprType::IntegerUnaryMinus: {
+                ASR::IntegerUnaryMinus_t* e = down_cast<ASR::IntegerUnaryMinus_t>(x);
+                if( e->m_value ) {
+                    return evaluate(e->m_value, state, c);
+                }
+                Constant arg;
+                if( !evaluate(e->m_arg, state, arg) || arg.kind != Constant::Integer ||
+                    arg.i == std::numeric_limits<int64_t>::min() ) {
+                    return false;
+                }
+                c.kind = Constant::Integer;
+                c.i = -arg.i;
+                return fits_kind(c.i, ASRUtils::extract_kind_from_ttype_t(e->m_type));
+            }
+            case ASR::exprType::IntegerCompare: {
+                ASR::IntegerCompare_t* e = down_cast<ASR::IntegerCompare_t>(x);
+                if( e->m_value ) {
+                    return evaluate(e->m_value, state, c);
+                }
+                Constant left, right;
+                if( !evaluate(e->m_left, state, left) || left.kind != Constant::Integer ||
+                    !evaluate(e->m_right, state, right) || right.kind != Constant::Integer ) {
+                    return false;
+                }
+                c.kind = Constant::Logical;
+                c.b = compare(e->m_op, left.i, right.i);
+                return true;
+            }
+            case ASR::exprType::LogicalBinOp: {
+                ASR::LogicalBinOp_t* e = down_cast<ASR::LogicalBinOp_t>(x);
+                if( e->m_value ) {
+                    return evaluate(e->m_value, state, c);
+                }
+                Constant left, right;
+                if( !evaluate(e->m_left, state, left) || left.kind != Constant::Logical ||
+                    !evaluate(e->m_right, state, right) || right.kind != Constant::Logical ) {
+                    return false;
+                }
+                c.kind = Constant::Logical;
+                switch( e->m_op ) {
+                    case ASR::logicalbinopType::And: c.b = left.b && right.b; break;
+                    case ASR::logicalbinopType::Or: c.b = left.b || right.b; break;
+                    case ASR::logicalbinopType::Eqv: c.b = left.b == right.b; break;
+                    default: c.b = left.b != right.b; break;
+                }
+                return true;
+            }
+            case ASR::exprType::LogicalNot: {
+                ASR::LogicalNot_t* e = down_cast<ASR::LogicalNot_t>(x);
+                if( e->m_value ) {
+                    return evaluate(e->m_value, state, c);
+                }
+                if( !evaluate(e->m_arg, state, c) || c.kind != Constant::Logical ) {
+                    return false;
+                }
+                c.b = !c.b;
+                return true;
+            }
+            case ASR::exprType::Cast: {
+                ASR::Cast_t* e = down_cast<ASR::Cast_t>(x);
+                if( e->m_value ) {
+                    return evaluate(e->m_value, state, c);
+                }
+                if( e->m_kind != ASR::cast_kindType::IntegerToInteger ||
+                    !evaluate(e->m_arg, state, c) || c.kind != Constant::Integer ) {
+                    return false;
+                }
+                return fits_kind(c.i, ASRUtils::extract_kind_from_ttype_t(e->m_type));
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    // The constant can be stored in (or substituted for) a value of `type`
+    bool is_compatible(const Constant& c, ASR::ttype_t* type) {
+        if( type == nullptr ) {
+            return false;
+        }
+        switch( type->type ) {
+            case ASR::ttypeType::Integer: {
+                return c.kind == Constant::Integer &&
+                    fits_kind(c.i, down_cast<ASR::Integer_t>(type)->m_kind);
+            }
+            case ASR::ttypeType::Logical: {
+                return c.kind == Constant::Logical;
+            }
+            case ASR::ttypeType::Real: {
+                return c.kind == Constant::Real;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    ASR::expr_t* make_constant(Allocator& al, const Location& loc,
+        const Constant& c, ASR::ttype_t* type) {
+        switch( c.kind ) {
+            case Constant::Integer: {
+                return ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, c.i, type));
+            }
+            case Constant::Logical: {
+                return ASRUtils::EXPR(ASR::make_LogicalConstant_t(al, loc, c.b, type));
+            }
+            default: {
+                return ASRUtils::EXPR(ASR::make_RealConstant_t(al, loc, c.r, type));
+            }
+        }
+    }
+
+    // Values that can be dropped without losing an observable effect
+    bool is_side_effect_free(ASR::expr_t* x) {
+        switch( x->type ) {
+            case ASR::exprType::IntegerConstant:
+            case ASR::exprType::LogicalConstant:
+            case ASR::exprType::RealConstant:
+            case ASR::exprType::Var: {
+                return true;
+            }
+            case ASR::exprType::IntegerBinOp: {
+                ASR::IntegerBinOp_t* e = down_cast<ASR::IntegerBinOp_t>(x);
+                return is_side_effect_free(e->m_left) && is_side_effect_free(e->m_right);
+            }
+            case ASR::exprType::RealBinOp: {
+                ASR::RealBinOp_t* e = down_cast<ASR::RealBinOp_t>(x);
+                return is_side_effect_free(e->m_left) && is_side_effect_free(e->m_right);
+            }
+            case ASR::exprType::IntegerCompare: {
+                ASR::IntegerCompare_t* e = down_cast<ASR::IntegerCompare_t>(x);
+                return is_side_effect_free(e->m_left) && is_side_effect_free(e->m_right);
+            }
+            case ASR::exprType::RealCompare: {
+                ASR::RealCompare_t* e = down_cast<ASR::RealCompare_t>(x);
+                return is_side_effect_free(e->m_left) && is_side_effect_free(e->m_right);
+            }
+            case ASR::exprType::LogicalBinOp: {
+                ASR::LogicalBinOp_t* e = down_cast<ASR::LogicalBinOp_t>(x);
+                return is_side_effect_free(e->m_left) && is_side_effect_free(e->m_right);
+            }
+            case ASR::exprType::IntegerUnaryMinus: {
+                return is_side_effect_free(down_cast<ASR::IntegerUnaryMinus_t>(x)->m_arg);
+            }
+            case ASR::exprType::RealUnaryMinus: {
+                return is_side_effect_free(down_cast<ASR::RealUnaryMinus_t>(x)->m_arg);
+            }
+            case ASR::exprType::LogicalNot: {
+                return is_side_effect_free(down_cast<ASR::LogicalNot_t>(x)->m_arg);
+            }
+            case ASR::exprType::Cast: {
+                return is_side_effect_free(down_cast<ASR::Cast_t>(x)->m_arg);
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+}
+
+class ConstantAnalysis: public DataFlow::ForwardAnalysis<Constants> {
+
+    private:
+
+        const std::set<ASR::symbol_t*>& tracked;
+
+    public:
+
+        ConstantAnalysis(const std::set<ASR::symbol_t*>& tracked_): tracked(tracked_) {}
+
+        Constants join(const Constants& a, const Constants& b) override {
+            Constants result;
+            for( auto& item: a ) {
+                auto it = b.find(item.first);
+                if( it != b.end() && it->second == item.second ) {
+                    result.insert(item);
+                }
+            }
+            return result;
+        }
+
+        bool equal(const Constants& a, const Constants& b) override {
+            if( a.size() != b.size() ) {
+                return false;
+            }
+            for( auto& item: a ) {
+                auto it = b.find(item.first);
+                if( it == b.end() || it->second != item.second ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void transfer(ASR::stmt_t* stmt, Constants& state) override {
+            ASR::symbol_t* sym = DataFlow::get_definition(stmt, tracked);
+            if( sym == nullptr ) {
+                return ;
+            }
+            Constant c;
+            if( evaluate(down_cast<ASR::Assignment_t>(stmt)->m_value, state, c) &&
+                is_compatible(c, ASRUtils::symbol_type(sym)) ) {
+                state[sym] = c;
+            } else {
+                state.erase(sym);
+            }
+        }
+
+        void transfer_loop_head(ASR::stmt_t* loop, Constants& state) override {
+            if( is_a<ASR::DoLoop_t>(*loop) ) {
+                ASR::expr_t* v = down_cast<ASR::DoLoop_t>(loop)->m_head.m_v;
+                if( v && is_a<ASR::Var_t>(*v) ) {
+                    state.erase(down_cast<ASR::Var_t>(v)->m_v);
+                }
+            }
+        }
+
+        int branch(ASR::expr_t* test, const Constants& state) override {
+            Constant c;
+            if( evaluate(test, state, c) && c.kind == Constant::Logical ) {
+                return c.b ? 1 : 0;
+            }
+            return -1;
+        }
+
+};
+
+class ConstantReplacer: public ASR::BaseExprReplacer<ConstantReplacer> {
+
+    private:
+
+        Allocator& al;
+        const Constants& state;
+
+    public:
+
+        bool dry_run, changed;
+
+        ConstantReplacer(Allocator& al_, const Constants& state_): al(al_), state(state_),
+            dry_run(true), changed(false) {
+            call_replacer_on_value = false;
+        }
+
+        void replace_expr(ASR::expr_t* x) {
+            if( x == nullptr || has_compile_time_value(x) ) {
+                return ;
+            }
+            Constant c;
+            ASR::ttype_t* type = ASRUtils::expr_type(x);
+            if( evaluate(x, state, c) && is_compatible(c, type) ) {
+                changed = true;
+                if( !dry_run ) {
+                    *current_expr = make_constant(al, x->base.loc, c, type);
+                }
+                return ;
+            }
+            ASR::BaseExprReplacer<ConstantReplacer>::replace_expr(x);
+        }
+
+};
+
+class ConstantPropagationVisitor: public ASR::BaseWalkVisitor<ConstantPropagationVisitor> {
+
+    private:
+
+        Allocator& al;
+
+        void substitute(ConstantAnalysis& analysis, ASR::stmt_t**& body, size_t& n_body) {
+            Vec<ASR::stmt_t*> new_body;
+            new_body.reserve(al, n_body);
+            for( size_t i = 0; i < n_body; i++ ) {
+                ASR::stmt_t* stmt = body[i];
+                auto flow = analysis.in.find(stmt);
+                if( flow != analysis.in.end() && !flow->second.reachable ) {
+                    continue;
+                }
+                for( DataFlow::ExpressionSlot& slot: DataFlow::get_expression_slots(stmt) ) {
+                    auto& flows = slot.at_head ? analysis.head : analysis.in;
+                    auto slot_flow = flows.find(stmt);
+                    if( slot_flow == flows.end() || !slot_flow->second.reachable ) {
+                        continue;
+                    }
+                    ConstantReplacer replacer(al, slot_flow->second.state);
+                    DataFlow::rewrite_expression(al, slot.expr, replacer);
+                }
+                switch( stmt->type ) {
+                    case ASR::stmtType::If: {
+                        ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                        substitute(analysis, x->m_body, x->n_body);
+                        substitute(analysis, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::WhileLoop: {
+                        ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                        substitute(analysis, x->m_body, x->n_body);
+                        substitute(analysis, x->m_orelse, x->n_orelse);
+                        bool test;
+                        if( ASRUtils::is_value_constant(x->m_test, test) && !test ) {
+                            // The loop never runs, only its else block does
+                            for( size_t j = 0; j < x->n_orelse; j++ ) {
+                                new_body.push_back(al, x->m_orelse[j]);
+                            }
+                            continue;
+                        }
+                        break;
+                    }
+                    case ASR::stmtType::DoLoop: {
+                        ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                        substitute(analysis, x->m_body, x->n_body);
+                        substitute(analysis, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::Select: {
+                        ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                        for( size_t j = 0; j < x->n_body; j++ ) {
+                            if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                                ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                                substitute(analysis, c->m_body, c->n_body);
+                            } else {
+                                ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                                substitute(analysis, c->m_body, c->n_body);
+                            }
+                        }
+                        substitute(analysis, x->m_default, x->n_default);
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+                new_body.push_back(al, stmt);
+            }
+            body = new_body.p;
+            n_body = new_body.size();
+        }
+
+        bool remove_statements(const std::set<ASR::stmt_t*>& dead,
+            ASR::stmt_t**& body, size_t& n_body) {
+            bool removed = false;
+            Vec<ASR::stmt_t*> new_body;
+            new_body.reserve(al, n_body);
+            for( size_t i = 0; i < n_body; i++ ) {
+                ASR::stmt_t* stmt = body[i];
+                if( dead.find(stmt) != dead.end() ) {
+                    removed = true;
+                    continue;
+                }
+                switch( stmt->type ) {
+                    case ASR::stmtType::If: {
+                        ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                        removed = remove_statements(dead, x->m_body, x->n_body) || removed;
+                        removed = remove_statements(dead, x->m_orelse, x->n_orelse) || removed;
+                        break;
+                    }
+                    case ASR::stmtType::WhileLoop: {
+                        ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                        removed = remove_statements(dead, x->m_body, x->n_body) || removed;
+                        removed = remove_statements(dead, x->m_orelse, x->n_orelse) || removed;
+                        break;
+                    }
+                    case ASR::stmtType::DoLoop: {
+                        ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                        removed = remove_statements(dead, x->m_body, x->n_body) || removed;
+                        removed = remove_statements(dead, x->m_orelse, x->n_orelse) || removed;
+                        break;
+                    }
+                    case ASR::stmtType::Select: {
+                        ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                        for( size_t j = 0; j < x->n_body; j++ ) {
+                            if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                                ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                                removed = remove_statements(dead, c->m_body, c->n_body) || removed;
+                            } else {
+                                ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                                removed = remove_statements(dead, c->m_body, c->n_body) || removed;
+                            }
+                        }
+                        removed = remove_statements(dead, x->m_default, x->n_default) || removed;
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+                new_body.push_back(al, stmt);
+            }
+            body = new_body.p;
+            n_body = new_body.size();
+            return removed;
+        }
+
+        void remove_dead_stores(const std::set<ASR::symbol_t*>& tracked,
+            ASR::stmt_t**& body, size_t& n_body) {
+            // Every removal can make the stores feeding it dead as well
+            for( size_t round = 0; round < 4; round++ ) {
+                DataFlow::ReachingDefinitions reaching_definitions(tracked);
+                reaching_definitions.analyze(body, n_body);
+                if( !reaching_definitions.valid ) {
+                    return ;
+                }
+                std::map<ASR::stmt_t*, std::set<ASR::stmt_t*>> chains =
+                    reaching_definitions.get_def_use_chains();
+                std::set<ASR::stmt_t*> dead;
+                for( auto& item: reaching_definitions.in ) {
+                    ASR::stmt_t* stmt = item.first;
+                    if( DataFlow::get_definition(stmt, tracked) &&
+                        chains.find(stmt) == chains.end() &&
+                        is_side_effect_free(down_cast<ASR::Assignment_t>(stmt)->m_value) ) {
+                        dead.insert(stmt);
+                    }
+                }
+                if( dead.empty() || !remove_statements(dead, body, n_body) ) {
+                    return ;
+                }
+            }
+        }
+
+        void optimize(SymbolTable* scope, ASR::stmt_t**& body, size_t& n_body) {
+            if( n_body == 0 || !DataFlow::is_structured(scope, body, n_body) ) {
+                return ;
+            }
+            std::set<ASR::symbol_t*> tracked = DataFlow::get_tracked_variables(
+                scope, body, n_body);
+            if( tracked.empty() ) {
+                return ;
+            }
+            ConstantAnalysis analysis(tracked);
+            analysis.run(body, n_body, Constants());
+            if( !analysis.valid ) {
+                return ;
+            }
+            substitute(analysis, body, n_body);
+            remove_dead_stores(tracked, body, n_body);
+        }
+
+    public:
+
+        ConstantPropagationVisitor(Allocator& al_): al(al_) {}
+
+        void visit_Program(const ASR::Program_t& x) {
+            for( auto& item: x.m_symtab->get_scope() ) {
+                visit_symbol(*item.second);
+            }
+            ASR::Program_t& xx = const_cast<ASR::Program_t&>(x);
+            optimize(xx.m_symtab, xx.m_body, xx.n_body);
+        }
+
+        void visit_Function(const ASR::Function_t& x) {
+            for( auto& item: x.m_symtab->get_scope() ) {
+                visit_symbol(*item.second);
+            }
+            ASR::Function_t& xx = const_cast<ASR::Function_t&>(x);
+            optimize(xx.m_symtab, xx.m_body, xx.n_body);
+        }
+
+};
+
+void pass_constant_propagation(Allocator &al, ASR::TranslationUnit_t &unit,
+                               const PassOptions &/*pass_options*/) {
+    ConstantPropagationVisitor v(al);
+    v.visit_TranslationUnit(unit);
+}
+
+} // namespace LCompilers
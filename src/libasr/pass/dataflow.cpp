@@ -0,0 +1,485 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/pass/dataflow.h>
+
+
+namespace LCompilers {
+
+namespace DataFlow {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+namespace {
+
+    bool is_compound(const ASR::stmt_t& x) {
+        return is_a<ASR::If_t>(x) || is_a<ASR::WhileLoop_t>(x) ||
+            is_a<ASR::DoLoop_t>(x) || is_a<ASR::Select_t>(x);
+    }
+
+    /*
+     * Looks for control flow that escapes the structured statements:
+     * labels and jumps anywhere, Exit and Cycle inside statements (or
+     * BLOCK constructs) whose bodies the framework does not follow.
+     */
+    class StructureChecker: public ASR::BaseWalkVisitor<StructureChecker> {
+
+        public:
+
+            bool structured;
+            size_t opaque_depth;
+
+            StructureChecker(): structured(true), opaque_depth(0) {}
+
+            void visit_stmt(const ASR::stmt_t& x) {
+                if( !structured ) {
+                    return ;
+                }
+                bool opaque = !is_compound(x);
+                if( opaque ) {
+                    opaque_depth++;
+                }
+                ASR::BaseWalkVisitor<StructureChecker>::visit_stmt(x);
+                if( opaque ) {
+                    opaque_depth--;
+                }
+            }
+
+            void visit_Exit(const ASR::Exit_t& /*x*/) {
+                structured = structured && opaque_depth <= 1;
+            }
+
+            void visit_Cycle(const ASR::Cycle_t& /*x*/) {
+                structured = structured && opaque_depth <= 1;
+            }
+
+            void visit_GoTo(const ASR::GoTo_t& /*x*/) {
+                structured = false;
+            }
+
+            void visit_GoToTarget(const ASR::GoToTarget_t& /*x*/) {
+                structured = false;
+            }
+
+            void visit_IfArithmetic(const ASR::IfArithmetic_t& /*x*/) {
+                structured = false;
+            }
+
+            void visit_Assign(const ASR::Assign_t& /*x*/) {
+                structured = false;
+            }
+
+            void visit_Function(const ASR::Function_t& /*x*/) {
+            }
+
+    };
+
+    /*
+     * Collects the variables that may change (or be observed) outside of
+     * plain Assignment and DoLoop statements: actual arguments passed by
+     * reference, pointer targets, and everything referenced from a
+     * statement the framework treats as opaque or from a nested procedure.
+     */
+    class EscapeCollector: public ASR::BaseWalkVisitor<EscapeCollector> {
+
+        public:
+
+            std::set<ASR::symbol_t*> escaped;
+            bool all;
+
+            EscapeCollector(): all(false) {}
+
+            void mark(ASR::expr_t* x) {
+                if( x && is_a<ASR::Var_t>(*x) ) {
+                    escaped.insert(down_cast<ASR::Var_t>(x)->m_v);
+                }
+            }
+
+            void visit_Var(const ASR::Var_t& x) {
+                if( all ) {
+                    escaped.insert(x.m_v);
+                }
+            }
+
+            void visit_FunctionCall(const ASR::FunctionCall_t& x) {
+                for( size_t i = 0; i < x.n_args; i++ ) {
+                    mark(x.m_args[i].m_value);
+                }
+                mark(x.m_dt);
+                ASR::BaseWalkVisitor<EscapeCollector>::visit_FunctionCall(x);
+            }
+
+            void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
+                for( size_t i = 0; i < x.n_args; i++ ) {
+                    mark(x.m_args[i].m_value);
+                }
+                mark(x.m_dt);
+                ASR::BaseWalkVisitor<EscapeCollector>::visit_SubroutineCall(x);
+            }
+
+            void visit_GetPointer(const ASR::GetPointer_t& x) {
+                mark(x.m_arg);
+                ASR::BaseWalkVisitor<EscapeCollector>::visit_GetPointer(x);
+            }
+
+            void visit_PointerToCPtr(const ASR::PointerToCPtr_t& x) {
+                mark(x.m_arg);
+                ASR::BaseWalkVisitor<EscapeCollector>::visit_PointerToCPtr(x);
+            }
+
+            void visit_FileWrite(const ASR::FileWrite_t& x) {
+                mark(x.m_iostat);
+                mark(x.m_iomsg);
+                mark(x.m_id);
+                ASR::BaseWalkVisitor<EscapeCollector>::visit_FileWrite(x);
+            }
+
+            void visit_stmt(const ASR::stmt_t& x) {
+                bool known = is_compound(x) || is_a<ASR::Exit_t>(x) ||
+                    is_a<ASR::Cycle_t>(x) || is_a<ASR::Return_t>(x) ||
+                    is_a<ASR::Stop_t>(x) || is_a<ASR::ErrorStop_t>(x) ||
+                    is_a<ASR::Print_t>(x) || is_a<ASR::FileWrite_t>(x) ||
+                    is_a<ASR::Assert_t>(x) || is_a<ASR::SubroutineCall_t>(x) ||
+                    is_a<ASR::ExplicitDeallocate_t>(x) ||
+                    is_a<ASR::ImplicitDeallocate_t>(x) ||
+                    (is_a<ASR::Assignment_t>(x) &&
+                     down_cast<ASR::Assignment_t>(&x)->m_overloaded == nullptr);
+                bool all_copy = all;
+                all = all || !known;
+                ASR::BaseWalkVisitor<EscapeCollector>::visit_stmt(x);
+                all = all_copy;
+            }
+
+    };
+
+    class UseCollector: public ASR::BaseWalkVisitor<UseCollector> {
+
+        public:
+
+            const std::set<ASR::symbol_t*>& tracked;
+            std::set<ASR::symbol_t*> uses;
+            size_t depth;
+
+            UseCollector(const std::set<ASR::symbol_t*>& tracked_):
+                tracked(tracked_), depth(0) {}
+
+            void visit_stmt(const ASR::stmt_t& x) {
+                if( depth > 0 ) {
+                    return ;
+                }
+                depth++;
+                ASR::BaseWalkVisitor<UseCollector>::visit_stmt(x);
+                depth--;
+            }
+
+            void visit_Var(const ASR::Var_t& x) {
+                if( tracked.find(x.m_v) != tracked.end() ) {
+                    uses.insert(x.m_v);
+                }
+            }
+
+            void visit_Assignment(const ASR::Assignment_t& x) {
+                if( !is_a<ASR::Var_t>(*x.m_target) ) {
+                    visit_expr(*x.m_target);
+                }
+                visit_expr(*x.m_value);
+            }
+
+            void visit_DoLoop(const ASR::DoLoop_t& x) {
+                if( x.m_head.m_start ) {
+                    visit_expr(*x.m_head.m_start);
+                }
+                if( x.m_head.m_end ) {
+                    visit_expr(*x.m_head.m_end);
+                }
+                if( x.m_head.m_increment ) {
+                    visit_expr(*x.m_head.m_increment);
+                }
+            }
+
+    };
+
+    bool is_scalar_value_type(ASR::ttype_t* type) {
+        return is_a<ASR::Integer_t>(*type) || is_a<ASR::Real_t>(*type) ||
+            is_a<ASR::Logical_t>(*type);
+    }
+
+}
+
+bool is_structured(SymbolTable* scope, ASR::stmt_t** body, size_t n_body) {
+    StructureChecker checker;
+    for( size_t i = 0; i < n_body && checker.structured; i++ ) {
+        checker.visit_stmt(*body[i]);
+    }
+    for( auto& item: scope->get_scope() ) {
+        if( is_a<ASR::Block_t>(*item.second) ) {
+            // A BLOCK body runs inside the BlockCall statement
+            checker.opaque_depth = 1;
+            checker.visit_symbol(*item.second);
+            checker.opaque_depth = 0;
+        }
+    }
+    return checker.structured;
+}
+
+std::set<ASR::symbol_t*> get_tracked_variables(SymbolTable* scope,
+    ASR::stmt_t** body, size_t n_body) {
+    EscapeCollector collector;
+    for( size_t i = 0; i < n_body; i++ ) {
+        collector.visit_stmt(*body[i]);
+    }
+    collector.all = true;
+    for( auto& item: scope->get_scope() ) {
+        if( is_a<ASR::Function_t>(*item.second) || is_a<ASR::Block_t>(*item.second) ) {
+            collector.visit_symbol(*item.second);
+        }
+    }
+
+    std::set<ASR::symbol_t*> tracked;
+    for( auto& item: scope->get_scope() ) {
+        if( !is_a<ASR::Variable_t>(*item.second) ) {
+            continue;
+        }
+        ASR::Variable_t* v = down_cast<ASR::Variable_t>(item.second);
+        if( v->m_intent != ASR::intentType::Local ||
+            v->m_storage != ASR::storage_typeType::Default ||
+            v->m_symbolic_value || v->m_value || v->m_target_attr ||
+            !is_scalar_value_type(v->m_type) ||
+            collector.escaped.find(item.second) != collector.escaped.end() ) {
+            continue;
+        }
+        tracked.insert(item.second);
+    }
+    return tracked;
+}
+
+bool is_invariant_argument(ASR::symbol_t* sym) {
+    if( !is_a<ASR::Variable_t>(*sym) ) {
+        return false;
+    }
+    ASR::Variable_t* v = down_cast<ASR::Variable_t>(sym);
+    return v->m_intent == ASR::intentType::In &&
+        v->m_presence == ASR::presenceType::Required &&
+        v->m_storage == ASR::storage_typeType::Default &&
+        !v->m_target_attr && is_scalar_value_type(v->m_type);
+}
+
+ASR::symbol_t* get_definition(ASR::stmt_t* stmt,
+    const std::set<ASR::symbol_t*>& tracked) {
+    if( !is_a<ASR::Assignment_t>(*stmt) ) {
+        return nullptr;
+    }
+    ASR::Assignment_t* x = down_cast<ASR::Assignment_t>(stmt);
+    if( x->m_overloaded || !is_a<ASR::Var_t>(*x->m_target) ) {
+        return nullptr;
+    }
+    ASR::symbol_t* sym = down_cast<ASR::Var_t>(x->m_target)->m_v;
+    return tracked.find(sym) != tracked.end() ? sym : nullptr;
+}
+
+std::set<ASR::symbol_t*> get_uses(ASR::stmt_t* stmt,
+    const std::set<ASR::symbol_t*>& tracked) {
+    UseCollector collector(tracked);
+    collector.visit_stmt(*stmt);
+    return collector.uses;
+}
+
+std::vector<ExpressionSlot> get_expression_slots(ASR::stmt_t* stmt) {
+    std::vector<ExpressionSlot> slots;
+    switch( stmt->type ) {
+        case ASR::stmtType::Assignment: {
+            ASR::Assignment_t* x = down_cast<ASR::Assignment_t>(stmt);
+            if( x->m_overloaded ) {
+                break;
+            }
+            if( !is_a<ASR::Var_t>(*x->m_target) ) {
+                slots.push_back({&x->m_target, false});
+            }
+            slots.push_back({&x->m_value, false});
+            break;
+        }
+        case ASR::stmtType::If: {
+            slots.push_back({&down_cast<ASR::If_t>(stmt)->m_test, false});
+            break;
+        }
+        case ASR::stmtType::WhileLoop: {
+            slots.push_back({&down_cast<ASR::WhileLoop_t>(stmt)->m_test, true});
+            break;
+        }
+        case ASR::stmtType::DoLoop: {
+            ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+            if( x->m_head.m_start ) {
+                slots.push_back({&x->m_head.m_start, false});
+            }
+            if( x->m_head.m_end ) {
+                slots.push_back({&x->m_head.m_end, false});
+            }
+            if( x->m_head.m_increment ) {
+                slots.push_back({&x->m_head.m_increment, false});
+            }
+            break;
+        }
+        case ASR::stmtType::Select: {
+            slots.push_back({&down_cast<ASR::Select_t>(stmt)->m_test, false});
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+    return slots;
+}
+
+void DominatorTree::build(ASR::stmt_t* parent, ASR::stmt_t** body, size_t n_body) {
+    for( size_t i = 0; i < n_body; i++ ) {
+        ASR::stmt_t* stmt = body[i];
+        positions[stmt] = Position{parent, body, i};
+        switch( stmt->type ) {
+            case ASR::stmtType::If: {
+                ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                build(stmt, x->m_body, x->n_body);
+                build(stmt, x->m_orelse, x->n_orelse);
+                break;
+            }
+            case ASR::stmtType::WhileLoop: {
+                ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                build(stmt, x->m_body, x->n_body);
+                build(stmt, x->m_orelse, x->n_orelse);
+                break;
+            }
+            case ASR::stmtType::DoLoop: {
+                ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                build(stmt, x->m_body, x->n_body);
+                build(stmt, x->m_orelse, x->n_orelse);
+                break;
+            }
+            case ASR::stmtType::Select: {
+                ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                for( size_t j = 0; j < x->n_body; j++ ) {
+                    if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                        ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                        build(stmt, c->m_body, c->n_body);
+                    } else {
+                        ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                        build(stmt, c->m_body, c->n_body);
+                    }
+                }
+                build(stmt, x->m_default, x->n_default);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+}
+
+ASR::stmt_t* DominatorTree::get_parent(ASR::stmt_t* stmt) const {
+    auto it = positions.find(stmt);
+    return it == positions.end() ? nullptr : it->second.parent;
+}
+
+bool DominatorTree::dominates(ASR::stmt_t* a, ASR::stmt_t* b) const {
+    auto a_position = positions.find(a);
+    if( a_position == positions.end() ) {
+        return false;
+    }
+    // Bodies are only entered from their first statement, so `a` dominates
+    // `b` if it is `b`, encloses it, or comes before one of its ancestors in
+    // the same statement list.
+    for( ASR::stmt_t* x = b; x != nullptr; x = get_parent(x) ) {
+        if( x == a ) {
+            return true;
+        }
+        auto x_position = positions.find(x);
+        if( x_position == positions.end() ) {
+            return false;
+        }
+        if( x_position->second.body == a_position->second.body &&
+            a_position->second.index < x_position->second.index ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DominatorTree::contains(ASR::stmt_t* region, ASR::stmt_t* stmt) const {
+    for( ASR::stmt_t* x = stmt; x != nullptr; x = get_parent(x) ) {
+        if( x == region ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Definitions ReachingDefinitions::join(const Definitions& a, const Definitions& b) {
+    Definitions result = a;
+    for( auto& item: b ) {
+        result[item.first].insert(item.second.begin(), item.second.end());
+    }
+    return result;
+}
+
+void ReachingDefinitions::transfer(ASR::stmt_t* stmt, Definitions& state) {
+    ASR::symbol_t* sym = get_definition(stmt, tracked);
+    if( sym ) {
+        state[sym] = {stmt};
+    }
+}
+
+void ReachingDefinitions::transfer_loop_head(ASR::stmt_t* loop, Definitions& state) {
+    if( !is_a<ASR::DoLoop_t>(*loop) ) {
+        return ;
+    }
+    ASR::expr_t* v = down_cast<ASR::DoLoop_t>(loop)->m_head.m_v;
+    if( v && is_a<ASR::Var_t>(*v) &&
+        tracked.find(down_cast<ASR::Var_t>(v)->m_v) != tracked.end() ) {
+        state[down_cast<ASR::Var_t>(v)->m_v] = {loop};
+    }
+}
+
+void ReachingDefinitions::analyze(ASR::stmt_t** body, size_t n_body) {
+    Definitions entry;
+    for( ASR::symbol_t* sym: tracked ) {
+        entry[sym] = {nullptr};
+    }
+    run(body, n_body, entry);
+}
+
+const std::set<ASR::stmt_t*>* ReachingDefinitions::reaching(ASR::stmt_t* stmt,
+    const ExpressionSlot& slot, ASR::symbol_t* sym) const {
+    const std::map<ASR::stmt_t*, Flow>& flows = slot.at_head ? head : in;
+    auto flow = flows.find(stmt);
+    if( flow == flows.end() || !flow->second.reachable ) {
+        return nullptr;
+    }
+    auto defs = flow->second.state.find(sym);
+    return defs == flow->second.state.end() ? nullptr : &defs->second;
+}
+
+std::map<ASR::stmt_t*, std::set<ASR::stmt_t*>> ReachingDefinitions::get_def_use_chains() const {
+    std::map<ASR::stmt_t*, std::set<ASR::stmt_t*>> chains;
+    for( auto& item: in ) {
+        ASR::stmt_t* stmt = item.first;
+        const Flow& flow = is_a<ASR::WhileLoop_t>(*stmt) ? head.at(stmt) : item.second;
+        if( !flow.reachable ) {
+            continue;
+        }
+        for( ASR::symbol_t* sym: get_uses(stmt, tracked) ) {
+            auto defs = flow.state.find(sym);
+            if( defs == flow.state.end() ) {
+                continue;
+            }
+            for( ASR::stmt_t* def: defs->second ) {
+                chains[def].insert(stmt);
+            }
+        }
+    }
+    return chains;
+}
+
+} // namespace DataFlow
+
+} // namespace LCompilers
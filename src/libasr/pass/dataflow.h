@@ -0,0 +1,392 @@
+#ifndef LIBASR_PASS_DATAFLOW_H
+#define LIBASR_PASS_DATAFLOW_H
+
+#include <libasr/asr.h>
+#include <libasr/asr_utils.h>
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace LCompilers {
+
+/*
+ * Dataflow analysis over the structured control flow of ASR procedure
+ * bodies.
+ *
+ * ASR keeps If, WhileLoop, DoLoop and Select as trees, so instead of
+ * lowering a body to a control flow graph the analyses below walk the
+ * statement tree directly. Loops are iterated to a fixed point, Exit and
+ * Cycle are routed to the loop they leave and Return/Stop end a path.
+ * Procedures with GoTo (or Exit/Cycle hidden inside statements the
+ * framework does not descend into) are rejected by `is_structured`.
+ *
+ * Only "tracked" variables are modelled: scalar locals whose value can
+ * change through an Assignment or a DoLoop head and nothing else (see
+ * `get_tracked_variables`). Every other statement is transparent for
+ * them, which keeps the transfer functions small and sound.
+ */
+namespace DataFlow {
+
+    // Returns false if the body has control flow the framework cannot follow
+    bool is_structured(SymbolTable* scope, ASR::stmt_t** body, size_t n_body);
+
+    // Scalar locals of `scope` that are only defined by Assignment and DoLoop
+    // statements of `body` and never reachable through an alias
+    std::set<ASR::symbol_t*> get_tracked_variables(SymbolTable* scope,
+        ASR::stmt_t** body, size_t n_body);
+
+    // Required intent(in) scalar dummy arguments, their value never changes
+    bool is_invariant_argument(ASR::symbol_t* sym);
+
+    // Tracked variable assigned by `stmt`, nullptr if there is none
+    ASR::symbol_t* get_definition(ASR::stmt_t* stmt,
+        const std::set<ASR::symbol_t*>& tracked);
+
+    // Tracked variables read by the expressions of `stmt` itself, nested
+    // statement bodies are not included
+    std::set<ASR::symbol_t*> get_uses(ASR::stmt_t* stmt,
+        const std::set<ASR::symbol_t*>& tracked);
+
+    struct ExpressionSlot {
+        ASR::expr_t** expr;
+        // Evaluated at the loop head on every iteration (WhileLoop test)
+        bool at_head;
+    };
+
+    // Expressions of `stmt` that optimizations may rewrite in place: the
+    // value and the non variable target of an Assignment, If, WhileLoop and
+    // Select tests and the bounds of a DoLoop.
+    std::vector<ExpressionSlot> get_expression_slots(ASR::stmt_t* stmt);
+
+    /*
+     * Replaces `*slot` using `replacer`, a BaseExprReplacer with `dry_run`
+     * and `changed` members. ASR expressions can be shared between
+     * statements, so the expression is duplicated before it is modified.
+     */
+    template <typename Replacer>
+    bool rewrite_expression(Allocator& al, ASR::expr_t** slot, Replacer& replacer) {
+        if( *slot == nullptr ) {
+            return false;
+        }
+        replacer.dry_run = true;
+        replacer.changed = false;
+        replacer.current_expr = slot;
+        replacer.replace_expr(*slot);
+        if( !replacer.changed ) {
+            return false;
+        }
+        ASRUtils::ExprStmtDuplicator duplicator(al);
+        *slot = duplicator.duplicate_expr(*slot);
+        replacer.dry_run = false;
+        replacer.current_expr = slot;
+        replacer.replace_expr(*slot);
+        return true;
+    }
+
+    class DominatorTree {
+
+        private:
+
+            struct Position {
+                ASR::stmt_t* parent;
+                ASR::stmt_t** body;
+                size_t index;
+            };
+
+            std::map<ASR::stmt_t*, Position> positions;
+
+            void build(ASR::stmt_t* parent, ASR::stmt_t** body, size_t n_body);
+
+        public:
+
+            DominatorTree(ASR::stmt_t** body, size_t n_body) {
+                build(nullptr, body, n_body);
+            }
+
+            // Innermost compound statement containing `stmt`
+            ASR::stmt_t* get_parent(ASR::stmt_t* stmt) const;
+
+            // Every path from the procedure entry to `b` goes through `a`
+            bool dominates(ASR::stmt_t* a, ASR::stmt_t* b) const;
+
+            // `stmt` is `region` or is nested in one of its bodies
+            bool contains(ASR::stmt_t* region, ASR::stmt_t* stmt) const;
+
+    };
+
+    template <typename State>
+    class ForwardAnalysis {
+
+        public:
+
+            struct Flow {
+                bool reachable;
+                State state;
+            };
+
+            // Flow on entry to each statement, for loops before the first iteration
+            std::map<ASR::stmt_t*, Flow> in;
+            // Flow at the head of each loop, joined over all the iterations
+            std::map<ASR::stmt_t*, Flow> head;
+            bool valid;
+
+            ForwardAnalysis(): valid(true) {}
+
+            virtual ~ForwardAnalysis() {}
+
+            virtual State join(const State& a, const State& b) = 0;
+
+            virtual bool equal(const State& a, const State& b) = 0;
+
+            // Effect of a statement without nested control flow
+            virtual void transfer(ASR::stmt_t* stmt, State& state) = 0;
+
+            // Effect of evaluating the test of an If or Select, or the
+            // bounds of a DoLoop, before any of their bodies run
+            virtual void transfer_condition(ASR::stmt_t* /*stmt*/, State& /*state*/) {}
+
+            // Effect of entering a loop iteration, a DoLoop defines its variable
+            virtual void transfer_loop_head(ASR::stmt_t* /*loop*/, State& /*state*/) {}
+
+            // 1 or 0 if `test` is known to be true or false, -1 otherwise
+            virtual int branch(ASR::expr_t* /*test*/, const State& /*state*/) {
+                return -1;
+            }
+
+            Flow run(ASR::stmt_t** body, size_t n_body, const State& entry) {
+                in.clear();
+                head.clear();
+                loops.clear();
+                valid = true;
+                return run_body(body, n_body, Flow{true, entry});
+            }
+
+        private:
+
+            static const size_t max_iterations = 64;
+
+            struct LoopContext {
+                ASR::stmt_t* loop;
+                char* name;
+                Flow exits;
+                Flow continues;
+            };
+
+            std::vector<LoopContext> loops;
+
+            Flow unreachable() {
+                return Flow{false, State()};
+            }
+
+            Flow merge(const Flow& a, const Flow& b) {
+                if( !a.reachable ) {
+                    return b;
+                }
+                if( !b.reachable ) {
+                    return a;
+                }
+                return Flow{true, join(a.state, b.state)};
+            }
+
+            bool same(const Flow& a, const Flow& b) {
+                if( a.reachable != b.reachable ) {
+                    return false;
+                }
+                return !a.reachable || equal(a.state, b.state);
+            }
+
+            Flow run_body(ASR::stmt_t** body, size_t n_body, Flow flow) {
+                for( size_t i = 0; i < n_body && valid; i++ ) {
+                    flow = run_stmt(body[i], flow);
+                }
+                return flow;
+            }
+
+            LoopContext* find_loop(char* name) {
+                for( size_t i = loops.size(); i > 0; i-- ) {
+                    if( name == nullptr || (loops[i - 1].name &&
+                            std::strcmp(loops[i - 1].name, name) == 0) ) {
+                        return &loops[i - 1];
+                    }
+                }
+                return nullptr;
+            }
+
+            Flow run_loop(ASR::stmt_t* loop, char* name, ASR::expr_t* test,
+                ASR::stmt_t** body, size_t n_body,
+                ASR::stmt_t** orelse, size_t n_orelse, Flow entry) {
+                Flow current = entry;
+                if( current.reachable ) {
+                    transfer_loop_head(loop, current.state);
+                }
+                for( size_t iteration = 0; ; iteration++ ) {
+                    head[loop] = current;
+                    int taken = (test && current.reachable) ? branch(test, current.state) : -1;
+                    loops.push_back(LoopContext{loop, name, unreachable(), unreachable()});
+                    Flow body_flow = run_body(body, n_body, taken == 0 ? unreachable() : current);
+                    LoopContext context = loops.back();
+                    loops.pop_back();
+                    if( !valid ) {
+                        return current;
+                    }
+                    Flow next = merge(entry, merge(body_flow, context.continues));
+                    if( next.reachable ) {
+                        transfer_loop_head(loop, next.state);
+                    }
+                    if( same(next, current) ) {
+                        Flow normal_exit = run_body(orelse, n_orelse,
+                            taken == 1 ? unreachable() : current);
+                        return merge(normal_exit, context.exits);
+                    }
+                    if( iteration + 1 == max_iterations ) {
+                        valid = false;
+                        return current;
+                    }
+                    current = next;
+                }
+            }
+
+            Flow run_select(ASR::Select_t* x, Flow flow) {
+                Flow out = unreachable();
+                Flow previous = unreachable();
+                bool fall_through = false;
+                for( size_t i = 0; i < x->n_body && valid; i++ ) {
+                    Flow start = fall_through ? merge(flow, previous) : flow;
+                    ASR::case_stmt_t* case_stmt = x->m_body[i];
+                    if( ASR::is_a<ASR::CaseStmt_t>(*case_stmt) ) {
+                        ASR::CaseStmt_t* c = ASR::down_cast<ASR::CaseStmt_t>(case_stmt);
+                        previous = run_body(c->m_body, c->n_body, start);
+                        fall_through = x->m_enable_fall_through || c->m_fall_through;
+                    } else {
+                        ASR::CaseStmt_Range_t* c = ASR::down_cast<ASR::CaseStmt_Range_t>(case_stmt);
+                        previous = run_body(c->m_body, c->n_body, start);
+                        fall_through = x->m_enable_fall_through;
+                    }
+                    if( !fall_through ) {
+                        out = merge(out, previous);
+                    }
+                }
+                Flow start = fall_through ? merge(flow, previous) : flow;
+                return merge(out, run_body(x->m_default, x->n_default, start));
+            }
+
+            Flow run_stmt(ASR::stmt_t* stmt, Flow flow) {
+                in[stmt] = flow;
+                switch( stmt->type ) {
+                    case ASR::stmtType::If: {
+                        ASR::If_t* x = ASR::down_cast<ASR::If_t>(stmt);
+                        int taken = -1;
+                        if( flow.reachable ) {
+                            transfer_condition(stmt, flow.state);
+                            taken = branch(x->m_test, flow.state);
+                        }
+                        Flow then_flow = run_body(x->m_body, x->n_body,
+                            taken == 0 ? unreachable() : flow);
+                        Flow else_flow = run_body(x->m_orelse, x->n_orelse,
+                            taken == 1 ? unreachable() : flow);
+                        return merge(then_flow, else_flow);
+                    }
+                    case ASR::stmtType::WhileLoop: {
+                        ASR::WhileLoop_t* x = ASR::down_cast<ASR::WhileLoop_t>(stmt);
+                        return run_loop(stmt, x->m_name, x->m_test, x->m_body, x->n_body,
+                            x->m_orelse, x->n_orelse, flow);
+                    }
+                    case ASR::stmtType::DoLoop: {
+                        ASR::DoLoop_t* x = ASR::down_cast<ASR::DoLoop_t>(stmt);
+                        if( flow.reachable ) {
+                            transfer_condition(stmt, flow.state);
+                        }
+                        return run_loop(stmt, x->m_name, nullptr, x->m_body, x->n_body,
+                            x->m_orelse, x->n_orelse, flow);
+                    }
+                    case ASR::stmtType::Select: {
+                        if( flow.reachable ) {
+                            transfer_condition(stmt, flow.state);
+                        }
+                        return run_select(ASR::down_cast<ASR::Select_t>(stmt), flow);
+                    }
+                    case ASR::stmtType::Exit:
+                    case ASR::stmtType::Cycle: {
+                        char* name = ASR::is_a<ASR::Exit_t>(*stmt) ?
+                            ASR::down_cast<ASR::Exit_t>(stmt)->m_stmt_name :
+                            ASR::down_cast<ASR::Cycle_t>(stmt)->m_stmt_name;
+                        LoopContext* context = find_loop(name);
+                        if( context == nullptr ) {
+                            valid = false;
+                            return flow;
+                        }
+                        if( ASR::is_a<ASR::Exit_t>(*stmt) ) {
+                            context->exits = merge(context->exits, flow);
+                        } else {
+                            context->continues = merge(context->continues, flow);
+                        }
+                        return unreachable();
+                    }
+                    case ASR::stmtType::Return:
+                    case ASR::stmtType::Stop:
+                    case ASR::stmtType::ErrorStop: {
+                        return unreachable();
+                    }
+                    case ASR::stmtType::GoTo:
+                    case ASR::stmtType::GoToTarget:
+                    case ASR::stmtType::IfArithmetic: {
+                        valid = false;
+                        return flow;
+                    }
+                    default: {
+                        if( flow.reachable ) {
+                            transfer(stmt, flow.state);
+                        }
+                        return flow;
+                    }
+                }
+            }
+
+    };
+
+    typedef std::map<ASR::symbol_t*, std::set<ASR::stmt_t*>> Definitions;
+
+    /*
+     * Reaching definitions of the tracked variables. A definition is the
+     * Assignment or DoLoop statement writing the variable, the value a
+     * variable has on entry to the procedure is represented by nullptr.
+     */
+    class ReachingDefinitions: public ForwardAnalysis<Definitions> {
+
+        private:
+
+            const std::set<ASR::symbol_t*>& tracked;
+
+        public:
+
+            ReachingDefinitions(const std::set<ASR::symbol_t*>& tracked_):
+                tracked(tracked_) {}
+
+            Definitions join(const Definitions& a, const Definitions& b) override;
+
+            bool equal(const Definitions& a, const Definitions& b) override {
+                return a == b;
+            }
+
+            void transfer(ASR::stmt_t* stmt, Definitions& state) override;
+
+            void transfer_loop_head(ASR::stmt_t* loop, Definitions& state) override;
+
+            void analyze(ASR::stmt_t** body, size_t n_body);
+
+            // Definitions of `sym` reaching the evaluation of `slot` in `stmt`
+            const std::set<ASR::stmt_t*>* reaching(ASR::stmt_t* stmt,
+                const ExpressionSlot& slot, ASR::symbol_t* sym) const;
+
+            // Def-use chains: the statements reading the value of each definition
+            std::map<ASR::stmt_t*, std::set<ASR::stmt_t*>> get_def_use_chains() const;
+
+    };
+
+} // namespace DataFlow
+
+} // namespace LCompilers
+
+#endif // LIBASR_PASS_DATAFLOW_H
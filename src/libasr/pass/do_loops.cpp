@@ -32,6 +32,10 @@ to:
     end do
 
 The comparison is >= for c<0.
+
+A `do concurrent` is converted the same way, one while loop per loop
+variable. Its loop hint is kept on every one of them, so that the backend
+can vectorize the loops without checking their memory accesses.
 */
 class DoLoopVisitor : public ASR::StatementWalkVisitor<DoLoopVisitor>
 {
@@ -55,13 +59,17 @@ public:
             body.push_back(al,x.m_body[i]);
         }
         for (int i = static_cast<int>(x.n_head) - 1; i > 0; i--) {
-            ASR::asr_t* do_loop = ASR::make_DoLoop_t(al, x.base.base.loc, s2c(al, ""), x.m_head[i], body.p, body.n, nullptr, 0);
+            ASR::asr_t* do_loop = x.m_hint
+                ? ASR::make_DoConcurrentLoop_t(al, x.base.base.loc, &x.m_head[i], 1, nullptr, 0,
+                    nullptr, 0, nullptr, 0, body.p, body.n, x.m_schedule, nullptr, x.m_hint)
+                : ASR::make_DoLoop_t(al, x.base.base.loc, s2c(al, ""), x.m_head[i], body.p, body.n, nullptr, 0);
             body={};body.reserve(al,1);
             body.push_back(al,ASRUtils::STMT(do_loop));
         }
         ASR::asr_t* do_loop = ASR::make_DoLoop_t(al, x.base.base.loc, s2c(al, ""), x.m_head[0], body.p, body.n, nullptr, 0);
         const ASR::DoLoop_t &do_loop_ref = (const ASR::DoLoop_t&)(*do_loop);
-        pass_result = PassUtils::replace_doloop(al, do_loop_ref, -1, use_loop_variable_after_loop);
+        pass_result = PassUtils::replace_doloop(al, do_loop_ref, -1, use_loop_variable_after_loop,
+            x.m_hint);
     }
 };
 
@@ -0,0 +1,680 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_verify.h>
+#include <libasr/pass/hoist_temporaries.h>
+#include <libasr/pass/pass_utils.h>
+#include <libasr/pass/intrinsic_function_registry.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+
+namespace LCompilers {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+This ASR pass moves the allocation of the array temporaries created by the
+array_struct_temporary pass out of the loops whose iterations allocate them
+with the same shape, and lets temporaries with disjoint live ranges in a loop
+share one buffer. It runs only with --fast.
+
+Converts:
+
+    do i = 1, n
+        deallocate(__libasr_created_a)
+        allocate(__libasr_created_a(size(x)))
+        __libasr_created_a = f(x)
+        y = y + __libasr_created_a
+        deallocate(__libasr_created_b)
+        allocate(__libasr_created_b(size(x)))
+        __libasr_created_b = g(y)
+        z = z + __libasr_created_b
+    end do
+
+to:
+
+    deallocate(__libasr_created_a)
+    do i = 1, n
+        if (.not. allocated(__libasr_created_a)) then
+            allocate(__libasr_created_a(size(x)))
+        end if
+        __libasr_created_a = f(x)
+        y = y + __libasr_created_a
+        if (.not. allocated(__libasr_created_a)) then
+            allocate(__libasr_created_a(size(x)))
+        end if
+        __libasr_created_a = g(y)
+        z = z + __libasr_created_a
+    end do
+
+The allocation itself stays in the loop behind the `allocated` check, so
+that its shape is only evaluated if the loop runs at least once. An
+allocation is moved out of a loop if
+
+    * nothing else in the loop allocates, deallocates or passes the
+      temporary to a procedure,
+    * the variables its shape depends on are not modified in the loop,
+      the shape of an array is enough for `size` and `lbound`/`ubound`,
+    * its shape does not call a function and, if the loop calls any
+      procedure, depends only on local variables.
+
+Nested loops are handled inside out, so a temporary is moved as far out as
+its shape stays invariant. Two temporaries moved out of the same loop are
+merged if their types and shapes are equal and no statement of the loop body
+uses both of them.
+*/
+
+namespace {
+
+bool is_temporary(ASR::expr_t* x) {
+    if( x == nullptr || !is_a<ASR::Var_t>(*x) ) {
+        return false;
+    }
+    ASR::symbol_t* sym = down_cast<ASR::Var_t>(x)->m_v;
+    if( !is_a<ASR::Variable_t>(*sym) ||
+        !startswith(ASRUtils::symbol_name(sym), "__libasr_created_") ) {
+        return false;
+    }
+    ASR::Variable_t* var = down_cast<ASR::Variable_t>(sym);
+    return var->m_intent == ASR::intentType::Local &&
+        ASR::is_a<ASR::Allocatable_t>(*var->m_type) &&
+        ASRUtils::is_array(var->m_type) &&
+        !ASRUtils::is_struct(*var->m_type) &&
+        !ASRUtils::is_character(*var->m_type);
+}
+
+// The variable whose storage is modified by writing to `x`
+ASR::symbol_t* get_root_symbol(ASR::expr_t* x) {
+    while( x ) {
+        switch( x->type ) {
+            case ASR::exprType::Var: {
+                return ASRUtils::symbol_get_past_external(
+                    down_cast<ASR::Var_t>(x)->m_v);
+            }
+            case ASR::exprType::ArrayItem: {
+                x = down_cast<ASR::ArrayItem_t>(x)->m_v;
+                break;
+            }
+            case ASR::exprType::ArraySection: {
+                x = down_cast<ASR::ArraySection_t>(x)->m_v;
+                break;
+            }
+            case ASR::exprType::StructInstanceMember: {
+                x = down_cast<ASR::StructInstanceMember_t>(x)->m_v;
+                break;
+            }
+            case ASR::exprType::UnionInstanceMember: {
+                x = down_cast<ASR::UnionInstanceMember_t>(x)->m_v;
+                break;
+            }
+            case ASR::exprType::ArrayPhysicalCast: {
+                x = down_cast<ASR::ArrayPhysicalCast_t>(x)->m_arg;
+                break;
+            }
+            default: {
+                return nullptr;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/*
+Collects what the statements of a loop may modify. `values` has every
+variable that may be written to, `shapes` only those whose allocation or
+association may change. `released` is `shapes` without the reallocations,
+which keep a buffer of the same size.
+*/
+class LoopEffects: public ASR::BaseWalkVisitor<LoopEffects>
+{
+public:
+
+    std::set<ASR::symbol_t*> values, shapes, released;
+    std::map<ASR::symbol_t*, std::vector<ASR::Allocate_t*>> allocations;
+    bool has_calls, opaque;
+    ASR::stmt_t* skip;
+
+    LoopEffects(ASR::stmt_t* skip_): has_calls(false), opaque(false),
+        skip(skip_), record_all(false) {}
+
+    void visit_loop(ASR::stmt_t* loop) {
+        if( is_a<ASR::DoLoop_t>(*loop) ) {
+            ASR::DoLoop_t* do_loop = down_cast<ASR::DoLoop_t>(loop);
+            if( do_loop->m_head.m_v ) {
+                write(do_loop->m_head.m_v, true);
+            }
+            visit_do_loop_head(do_loop->m_head);
+            for( size_t i = 0; i < do_loop->n_body; i++ ) {
+                visit_stmt(*do_loop->m_body[i]);
+            }
+        } else {
+            ASR::WhileLoop_t* while_loop = down_cast<ASR::WhileLoop_t>(loop);
+            visit_expr(*while_loop->m_test);
+            for( size_t i = 0; i < while_loop->n_body; i++ ) {
+                visit_stmt(*while_loop->m_body[i]);
+            }
+        }
+    }
+
+    void visit_stmt(const ASR::stmt_t& x) {
+        if( &x == skip ) {
+            return ;
+        }
+        switch( x.type ) {
+            case ASR::stmtType::Allocate:
+            case ASR::stmtType::ReAlloc:
+            case ASR::stmtType::Assignment:
+            case ASR::stmtType::Associate:
+            case ASR::stmtType::Cycle:
+            case ASR::stmtType::ExplicitDeallocate:
+            case ASR::stmtType::ImplicitDeallocate:
+            case ASR::stmtType::DoLoop:
+            case ASR::stmtType::DoConcurrentLoop:
+            case ASR::stmtType::ErrorStop:
+            case ASR::stmtType::Exit:
+            case ASR::stmtType::GoTo:
+            case ASR::stmtType::GoToTarget:
+            case ASR::stmtType::If:
+            case ASR::stmtType::Print:
+            case ASR::stmtType::Return:
+            case ASR::stmtType::Select:
+            case ASR::stmtType::Stop:
+            case ASR::stmtType::Assert:
+            case ASR::stmtType::SubroutineCall:
+            case ASR::stmtType::WhileLoop:
+            case ASR::stmtType::Nullify:
+            case ASR::stmtType::BlockCall: {
+                ASR::BaseWalkVisitor<LoopEffects>::visit_stmt(x);
+                break;
+            }
+            default: {
+                // Anything else may write to every variable it mentions
+                bool record_all_copy = record_all;
+                record_all = true;
+                ASR::BaseWalkVisitor<LoopEffects>::visit_stmt(x);
+                record_all = record_all_copy;
+                break;
+            }
+        }
+    }
+
+    void visit_Var(const ASR::Var_t& x) {
+        if( record_all ) {
+            ASR::symbol_t* sym = ASRUtils::symbol_get_past_external(x.m_v);
+            values.insert(sym);
+            shapes.insert(sym);
+            released.insert(sym);
+        }
+    }
+
+    void visit_Assignment(const ASR::Assignment_t& x) {
+        write(x.m_target, is_a<ASR::Var_t>(*x.m_target));
+        ASR::BaseWalkVisitor<LoopEffects>::visit_Assignment(x);
+    }
+
+    void visit_Associate(const ASR::Associate_t& x) {
+        write(x.m_target, true);
+        ASR::BaseWalkVisitor<LoopEffects>::visit_Associate(x);
+    }
+
+    void visit_Allocate(const ASR::Allocate_t& x) {
+        for( size_t i = 0; i < x.n_args; i++ ) {
+            ASR::symbol_t* sym = get_root_symbol(x.m_args[i].m_a);
+            if( sym == nullptr ) {
+                opaque = true;
+                continue;
+            }
+            values.insert(sym);
+            shapes.insert(sym);
+            allocations[sym].push_back(const_cast<ASR::Allocate_t*>(&x));
+        }
+        ASR::BaseWalkVisitor<LoopEffects>::visit_Allocate(x);
+    }
+
+    void visit_ReAlloc(const ASR::ReAlloc_t& x) {
+        for( size_t i = 0; i < x.n_args; i++ ) {
+            ASR::symbol_t* sym = get_root_symbol(x.m_args[i].m_a);
+            if( sym == nullptr ) {
+                opaque = true;
+                continue;
+            }
+            values.insert(sym);
+            shapes.insert(sym);
+        }
+        ASR::BaseWalkVisitor<LoopEffects>::visit_ReAlloc(x);
+    }
+
+    void visit_ExplicitDeallocate(const ASR::ExplicitDeallocate_t& x) {
+        for( size_t i = 0; i < x.n_vars; i++ ) {
+            write(x.m_vars[i], true);
+        }
+    }
+
+    void visit_ImplicitDeallocate(const ASR::ImplicitDeallocate_t& x) {
+        for( size_t i = 0; i < x.n_vars; i++ ) {
+            write(x.m_vars[i], true);
+        }
+    }
+
+    void visit_Nullify(const ASR::Nullify_t& x) {
+        for( size_t i = 0; i < x.n_vars; i++ ) {
+            write(x.m_vars[i], true);
+        }
+    }
+
+    void visit_DoConcurrentLoop(const ASR::DoConcurrentLoop_t& x) {
+        for( size_t i = 0; i < x.n_head; i++ ) {
+            if( x.m_head[i].m_v ) {
+                write(x.m_head[i].m_v, true);
+            }
+        }
+        ASR::BaseWalkVisitor<LoopEffects>::visit_DoConcurrentLoop(x);
+    }
+
+    void visit_DoLoop(const ASR::DoLoop_t& x) {
+        if( x.m_head.m_v ) {
+            write(x.m_head.m_v, true);
+        }
+        ASR::BaseWalkVisitor<LoopEffects>::visit_DoLoop(x);
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
+        visit_call(x.m_name, x.m_args, x.n_args, x.m_dt);
+        ASR::BaseWalkVisitor<LoopEffects>::visit_SubroutineCall(x);
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t& x) {
+        visit_call(x.m_name, x.m_args, x.n_args, x.m_dt);
+        ASR::BaseWalkVisitor<LoopEffects>::visit_FunctionCall(x);
+    }
+
+    void visit_BlockCall(const ASR::BlockCall_t& x) {
+        ASR::Block_t* block = down_cast<ASR::Block_t>(x.m_m);
+        for( size_t i = 0; i < block->n_body; i++ ) {
+            visit_stmt(*block->m_body[i]);
+        }
+    }
+
+private:
+
+    bool record_all;
+
+    void write(ASR::expr_t* x, bool whole) {
+        ASR::symbol_t* sym = get_root_symbol(x);
+        if( sym == nullptr ) {
+            opaque = true;
+            return ;
+        }
+        values.insert(sym);
+        if( whole ) {
+            shapes.insert(sym);
+            released.insert(sym);
+        }
+    }
+
+    // Only allocatable and pointer dummy arguments can change the shape of
+    // the actual argument
+    void visit_call(ASR::symbol_t* name, ASR::call_arg_t* args, size_t n_args,
+        ASR::expr_t* dt) {
+        has_calls = true;
+        ASR::FunctionType_t* func_type = nullptr;
+        ASR::symbol_t* func = ASRUtils::symbol_get_past_external(name);
+        if( dt == nullptr && is_a<ASR::Function_t>(*func) ) {
+            func_type = ASRUtils::get_FunctionType(down_cast<ASR::Function_t>(func));
+        }
+        for( size_t i = 0; i < n_args; i++ ) {
+            if( args[i].m_value == nullptr || get_root_symbol(args[i].m_value) == nullptr ) {
+                continue;
+            }
+            bool whole = true;
+            if( func_type && i < func_type->n_arg_types ) {
+                ASR::ttype_t* arg_type = func_type->m_arg_types[i];
+                whole = ASRUtils::is_allocatable(arg_type) || ASRUtils::is_pointer(arg_type);
+            }
+            write(args[i].m_value, whole);
+        }
+        if( dt && get_root_symbol(dt) ) {
+            write(dt, true);
+        }
+    }
+
+};
+
+// Checks that an expression evaluates to the same value in every iteration
+class InvarianceChecker: public ASR::BaseWalkVisitor<InvarianceChecker>
+{
+public:
+
+    bool invariant;
+
+    InvarianceChecker(const LoopEffects& effects_, SymbolTable* current_scope_):
+        invariant(true), effects(effects_), current_scope(current_scope_) {}
+
+    void visit_Var(const ASR::Var_t& x) {
+        check(ASRUtils::symbol_get_past_external(x.m_v), effects.values);
+    }
+
+    void visit_ArraySize(const ASR::ArraySize_t& x) {
+        visit_shape_query(x.m_v, x.m_dim);
+    }
+
+    void visit_ArrayBound(const ASR::ArrayBound_t& x) {
+        visit_shape_query(x.m_v, x.m_dim);
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t& /*x*/) {
+        invariant = false;
+    }
+
+private:
+
+    const LoopEffects& effects;
+    SymbolTable* current_scope;
+
+    void visit_shape_query(ASR::expr_t* v, ASR::expr_t* dim) {
+        if( is_a<ASR::Var_t>(*v) ) {
+            check(ASRUtils::symbol_get_past_external(
+                down_cast<ASR::Var_t>(v)->m_v), effects.shapes);
+        } else {
+            visit_expr(*v);
+        }
+        if( dim ) {
+            visit_expr(*dim);
+        }
+    }
+
+    void check(ASR::symbol_t* sym, const std::set<ASR::symbol_t*>& modified) {
+        if( effects.opaque || modified.find(sym) != modified.end() ) {
+            invariant = false;
+            return ;
+        }
+        if( !is_a<ASR::Variable_t>(*sym) ) {
+            return ;
+        }
+        ASR::Variable_t* var = down_cast<ASR::Variable_t>(sym);
+        // Pointers and their targets may be written through other names
+        if( var->m_target_attr || ASRUtils::is_pointer(var->m_type) ) {
+            invariant = false;
+            return ;
+        }
+        if( effects.has_calls && var->m_parent_symtab != current_scope ) {
+            invariant = false;
+        }
+    }
+
+};
+
+class SymbolCollector: public ASR::BaseWalkVisitor<SymbolCollector>
+{
+public:
+
+    std::set<ASR::symbol_t*> symbols;
+
+    void visit_Var(const ASR::Var_t& x) {
+        symbols.insert(x.m_v);
+    }
+
+};
+
+class SymbolReplacer: public ASR::BaseWalkVisitor<SymbolReplacer>
+{
+public:
+
+    ASR::symbol_t *from, *to;
+
+    SymbolReplacer(ASR::symbol_t* from_, ASR::symbol_t* to_):
+        from(from_), to(to_) {}
+
+    void visit_Var(const ASR::Var_t& x) {
+        if( x.m_v == from ) {
+            const_cast<ASR::Var_t&>(x).m_v = to;
+        }
+    }
+
+};
+
+bool is_same_shape(const ASR::alloc_arg_t& a, const ASR::alloc_arg_t& b) {
+    if( a.n_dims != b.n_dims ) {
+        return false;
+    }
+    for( size_t i = 0; i < a.n_dims; i++ ) {
+        if( !a.m_dims[i].m_start || !b.m_dims[i].m_start ||
+            !a.m_dims[i].m_length || !b.m_dims[i].m_length ||
+            !PassUtils::is_same_index_expr(a.m_dims[i].m_start, b.m_dims[i].m_start) ||
+            !PassUtils::is_same_index_expr(a.m_dims[i].m_length, b.m_dims[i].m_length) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool is_same_temporary_type(ASR::symbol_t* a, ASR::symbol_t* b) {
+    ASR::Variable_t* a_var = down_cast<ASR::Variable_t>(a);
+    ASR::Variable_t* b_var = down_cast<ASR::Variable_t>(b);
+    return a_var->m_parent_symtab == b_var->m_parent_symtab &&
+        ASRUtils::types_equal(a_var->m_type, b_var->m_type, true) &&
+        ASRUtils::extract_physical_type(a_var->m_type) ==
+            ASRUtils::extract_physical_type(b_var->m_type);
+}
+
+ASR::stmt_t** get_loop_body(ASR::stmt_t* loop, size_t*& n_body) {
+    if( is_a<ASR::DoLoop_t>(*loop) ) {
+        ASR::DoLoop_t* do_loop = down_cast<ASR::DoLoop_t>(loop);
+        n_body = &do_loop->n_body;
+        return do_loop->m_body;
+    }
+    ASR::WhileLoop_t* while_loop = down_cast<ASR::WhileLoop_t>(loop);
+    n_body = &while_loop->n_body;
+    return while_loop->m_body;
+}
+
+} // namespace
+
+class HoistTemporariesVisitor : public ASR::ASRPassBaseWalkVisitor<HoistTemporariesVisitor>
+{
+private:
+
+    Allocator& al;
+    // Allocations already placed behind an `allocated` check
+    std::set<ASR::Allocate_t*> guarded;
+
+    ASR::stmt_t* guard_allocation(ASR::Allocate_t* x) {
+        const Location& loc = x->base.base.loc;
+        ASR::ttype_t* logical_type = ASRUtils::TYPE(ASR::make_Logical_t(al, loc, 4));
+        ASR::expr_t* is_allocated = ASRUtils::EXPR(ASR::make_IntrinsicImpureFunction_t(
+            al, loc, static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::Allocated),
+            &x->m_args[0].m_a, 1, 0, logical_type, nullptr));
+        ASR::expr_t* test = ASRUtils::EXPR(ASR::make_LogicalNot_t(al, loc,
+            is_allocated, logical_type, nullptr));
+        Vec<ASR::stmt_t*> body; body.reserve(al, 1);
+        body.push_back(al, &x->base);
+        guarded.insert(x);
+        return ASRUtils::STMT(ASR::make_If_t(al, loc, test, body.p, body.size(),
+            nullptr, 0));
+    }
+
+    // Returns an allocation of the temporary deallocated by `body[i]` if the
+    // deallocation can be moved out of `loop`, the one following it if any
+    ASR::Allocate_t* get_hoistable_allocation(ASR::stmt_t* loop,
+        ASR::stmt_t** body, size_t n_body, size_t i) {
+        if( !is_a<ASR::ExplicitDeallocate_t>(*body[i]) ) {
+            return nullptr;
+        }
+        ASR::ExplicitDeallocate_t* dealloc = down_cast<ASR::ExplicitDeallocate_t>(body[i]);
+        if( dealloc->n_vars != 1 || !is_temporary(dealloc->m_vars[0]) ) {
+            return nullptr;
+        }
+        ASR::symbol_t* temporary = down_cast<ASR::Var_t>(dealloc->m_vars[0])->m_v;
+        LoopEffects effects(body[i]);
+        effects.visit_loop(loop);
+        if( effects.opaque ||
+            effects.released.find(temporary) != effects.released.end() ||
+            effects.allocations[temporary].empty() ) {
+            return nullptr;
+        }
+        ASR::Allocate_t* follower = nullptr;
+        InvarianceChecker checker(effects, current_scope);
+        for( ASR::Allocate_t* alloc: effects.allocations[temporary] ) {
+            if( i + 1 < n_body && body[i + 1] == &alloc->base ) {
+                follower = alloc;
+            } else if( guarded.find(alloc) == guarded.end() ) {
+                return nullptr;
+            }
+            if( alloc->n_args != 1 || alloc->m_stat || alloc->m_errmsg ||
+                alloc->m_source || alloc->m_args[0].m_len_expr ||
+                alloc->m_args[0].m_type ) {
+                return nullptr;
+            }
+            for( size_t j = 0; j < alloc->m_args[0].n_dims; j++ ) {
+                checker.visit_dimension(alloc->m_args[0].m_dims[j]);
+            }
+        }
+        if( !checker.invariant ) {
+            return nullptr;
+        }
+        return follower ? follower : effects.allocations[temporary][0];
+    }
+
+    void hoist_from_loop(ASR::stmt_t* loop, std::vector<ASR::stmt_t*>& hoisted) {
+        size_t* n_body = nullptr;
+        ASR::stmt_t** body = get_loop_body(loop, n_body);
+        size_t i = 0;
+        while( i < *n_body ) {
+            ASR::Allocate_t* alloc = get_hoistable_allocation(loop, body, *n_body, i);
+            if( alloc == nullptr ) {
+                i++;
+                continue;
+            }
+            hoisted.push_back(body[i]);
+            if( i + 1 < *n_body && body[i + 1] == &alloc->base ) {
+                body[i + 1] = guard_allocation(alloc);
+            }
+            for( size_t j = i + 1; j < *n_body; j++ ) {
+                body[j - 1] = body[j];
+            }
+            *n_body -= 1;
+        }
+    }
+
+    // Lets temporaries moved out of `loop` share a buffer if their live
+    // ranges in the loop body do not overlap
+    void merge_temporaries(ASR::stmt_t* loop, std::vector<ASR::stmt_t*>& hoisted,
+        const std::set<ASR::symbol_t*>& used_outside) {
+        if( hoisted.size() < 2 ) {
+            return ;
+        }
+        size_t* n_body = nullptr;
+        ASR::stmt_t** body = get_loop_body(loop, n_body);
+        std::vector<std::set<ASR::symbol_t*>> used(*n_body);
+        for( size_t i = 0; i < *n_body; i++ ) {
+            SymbolCollector collector;
+            collector.visit_stmt(*body[i]);
+            used[i] = collector.symbols;
+        }
+        LoopEffects effects(nullptr);
+        effects.visit_loop(loop);
+
+        struct Buffer {
+            ASR::symbol_t* temporary;
+            ASR::alloc_arg_t* shape;
+            size_t last;
+        };
+        std::vector<Buffer> buffers;
+        std::vector<ASR::stmt_t*> kept;
+        for( ASR::stmt_t* dealloc: hoisted ) {
+            ASR::symbol_t* temporary = down_cast<ASR::Var_t>(
+                down_cast<ASR::ExplicitDeallocate_t>(dealloc)->m_vars[0])->m_v;
+            size_t first = *n_body, last = 0;
+            for( size_t i = 0; i < *n_body; i++ ) {
+                if( used[i].find(temporary) != used[i].end() ) {
+                    first = std::min(first, i);
+                    last = i;
+                }
+            }
+            if( first == *n_body || used_outside.find(temporary) != used_outside.end() ) {
+                kept.push_back(dealloc);
+                continue;
+            }
+            ASR::alloc_arg_t* shape = &effects.allocations[temporary][0]->m_args[0];
+            Buffer* reused = nullptr;
+            for( Buffer& buffer: buffers ) {
+                if( buffer.last < first &&
+                    is_same_temporary_type(buffer.temporary, temporary) &&
+                    is_same_shape(*buffer.shape, *shape) ) {
+                    reused = &buffer;
+                    break;
+                }
+            }
+            if( reused == nullptr ) {
+                buffers.push_back({temporary, shape, last});
+                kept.push_back(dealloc);
+                continue;
+            }
+            SymbolReplacer replacer(temporary, reused->temporary);
+            for( size_t i = first; i <= last; i++ ) {
+                replacer.visit_stmt(*body[i]);
+                used[i].erase(temporary);
+                used[i].insert(reused->temporary);
+            }
+            reused->last = last;
+        }
+        hoisted = kept;
+    }
+
+public:
+
+    HoistTemporariesVisitor(Allocator& al_): al(al_) {}
+
+    void transform_stmts(ASR::stmt_t**& m_body, size_t& n_body) {
+        for( size_t i = 0; i < n_body; i++ ) {
+            visit_stmt(*m_body[i]);
+        }
+        std::vector<std::set<ASR::symbol_t*>> used(n_body);
+        for( size_t i = 0; i < n_body; i++ ) {
+            SymbolCollector collector;
+            collector.visit_stmt(*m_body[i]);
+            used[i] = collector.symbols;
+        }
+        Vec<ASR::stmt_t*> body;
+        body.reserve(al, n_body);
+        for( size_t i = 0; i < n_body; i++ ) {
+            if( is_a<ASR::DoLoop_t>(*m_body[i]) ||
+                is_a<ASR::WhileLoop_t>(*m_body[i]) ) {
+                std::vector<ASR::stmt_t*> hoisted;
+                hoist_from_loop(m_body[i], hoisted);
+                std::set<ASR::symbol_t*> used_outside;
+                for( size_t j = 0; j < n_body; j++ ) {
+                    if( j != i ) {
+                        used_outside.insert(used[j].begin(), used[j].end());
+                    }
+                }
+                merge_temporaries(m_body[i], hoisted, used_outside);
+                for( ASR::stmt_t* dealloc: hoisted ) {
+                    body.push_back(al, dealloc);
+                }
+            }
+            body.push_back(al, m_body[i]);
+        }
+        m_body = body.p;
+        n_body = body.size();
+    }
+
+};
+
+void pass_hoist_temporaries(Allocator &al, ASR::TranslationUnit_t &unit,
+                            const LCompilers::PassOptions& pass_options) {
+    if( !pass_options.fast ) {
+        return ;
+    }
+    HoistTemporariesVisitor v(al);
+    v.visit_TranslationUnit(unit);
+}
+
+
+} // namespace LCompilers
@@ -794,6 +794,14 @@ class ArrayConstantVisitor : public ASR::CallReplacerOnExpressionsVisitor<ArrayC
                 if( x.m_shape )
                 this->visit_expr(*x.m_shape);
             }
+            if (x.m_lower_bounds) {
+                ASR::expr_t** current_expr_copy = current_expr;
+                current_expr = const_cast<ASR::expr_t**>(&(x.m_lower_bounds));
+                this->call_replacer();
+                current_expr = current_expr_copy;
+                if( x.m_lower_bounds )
+                this->visit_expr(*x.m_lower_bounds);
+            }
         }
 
         void visit_ArrayBroadcast(const ASR::ArrayBroadcast_t& x) {
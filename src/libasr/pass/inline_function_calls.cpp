@@ -6,8 +6,10 @@
 #include <libasr/pass/inline_function_calls.h>
 #include <libasr/pass/pass_utils.h>
 
+#include <algorithm>
 #include <vector>
 #include <map>
+#include <set>
 #include <utility>
 
 
@@ -34,7 +36,138 @@ to:
 
     c = a + 5
 
+Subroutine calls are replaced the same way. Scalar arguments passed as
+local variables of the caller are used in place of the dummy arguments,
+others are copied into new local variables.
+
+Procedures are visited bottom-up in the call graph, so that a call is
+inlined after the calls in the callee. Recursive procedures and bodies
+with labels are never inlined. With --fast a call is inlined if the size
+of the callee (in statements) fits a budget which grows with the loop
+depth of the call site and the number of constant arguments, and if the
+caller has not grown too much already. Without --fast, and for callees
+with an early return, only procedures marked inline are inlined.
+
 */
+
+namespace {
+
+    // Statement budget of a callee
+    const size_t inline_threshold = 8;
+    const size_t loop_depth_bonus = 4;
+    const size_t max_loop_depth_bonus = 3;
+    const size_t constant_argument_bonus = 2;
+    // Statements that may be inlined into one procedure
+    const size_t max_inlined_statements = 400;
+
+    bool is_constant(ASR::expr_t* x) {
+        return x && (ASR::is_a<ASR::IntegerConstant_t>(*x) ||
+            ASR::is_a<ASR::RealConstant_t>(*x) ||
+            ASR::is_a<ASR::LogicalConstant_t>(*x) ||
+            ASR::is_a<ASR::ComplexConstant_t>(*x));
+    }
+
+} // namespace
+
+class CallGraph: public ASR::BaseWalkVisitor<CallGraph>
+{
+private:
+
+    ASR::Function_t* current_function;
+    std::map<ASR::Function_t*, bool> recursive;
+
+    void add_call(ASR::symbol_t* name) {
+        ASR::symbol_t* callee = ASRUtils::symbol_get_past_external(name);
+        if( current_function && ASR::is_a<ASR::Function_t>(*callee) ) {
+            callees[current_function].insert(ASR::down_cast<ASR::Function_t>(callee));
+        }
+    }
+
+    bool reaches(ASR::Function_t* from, ASR::Function_t* to,
+        std::set<ASR::Function_t*>& visited) {
+        for( ASR::Function_t* callee: callees[from] ) {
+            if( callee == to ) {
+                return true;
+            }
+            if( visited.insert(callee).second && reaches(callee, to, visited) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+
+    std::map<ASR::Function_t*, std::set<ASR::Function_t*>> callees;
+
+    CallGraph(): current_function(nullptr) {}
+
+    bool is_recursive(ASR::Function_t* x) {
+        if( recursive.find(x) == recursive.end() ) {
+            std::set<ASR::Function_t*> visited;
+            recursive[x] = reaches(x, x, visited);
+        }
+        return recursive[x];
+    }
+
+    void visit_Function(const ASR::Function_t& x) {
+        ASR::Function_t* current_function_copy = current_function;
+        current_function = const_cast<ASR::Function_t*>(&x);
+        ASR::BaseWalkVisitor<CallGraph>::visit_Function(x);
+        current_function = current_function_copy;
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t& x) {
+        add_call(x.m_name);
+        ASR::BaseWalkVisitor<CallGraph>::visit_FunctionCall(x);
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
+        add_call(x.m_name);
+        ASR::BaseWalkVisitor<CallGraph>::visit_SubroutineCall(x);
+    }
+
+};
+
+// Size of a procedure body and the statements which prevent inlining it
+class BodySize: public ASR::BaseWalkVisitor<BodySize>
+{
+public:
+
+    size_t n_stmts;
+    bool has_labels;
+    bool has_early_return;
+
+    BodySize(): n_stmts(0), has_labels(false), has_early_return(false) {}
+
+    void visit_body(const ASR::Function_t& x) {
+        for( size_t i = 0; i < x.n_body; i++ ) {
+            if( i + 1 == x.n_body && ASR::is_a<ASR::Return_t>(*x.m_body[i]) ) {
+                break;
+            }
+            visit_stmt(*x.m_body[i]);
+        }
+    }
+
+    void visit_stmt(const ASR::stmt_t& x) {
+        n_stmts += 1;
+        ASR::BaseWalkVisitor<BodySize>::visit_stmt(x);
+    }
+
+    void visit_GoTo(const ASR::GoTo_t& /*x*/) {
+        has_labels = true;
+    }
+
+    void visit_GoToTarget(const ASR::GoToTarget_t& /*x*/) {
+        has_labels = true;
+    }
+
+    void visit_Return(const ASR::Return_t& /*x*/) {
+        has_early_return = true;
+    }
+
+};
+
 class FixSymbolsVisitor: public ASR::BaseWalkVisitor<FixSymbolsVisitor>
 {
 private:
@@ -118,124 +251,79 @@ private:
     ASR::symbol_t* empty_block;
     ASRUtils::ReplaceReturnWithGotoVisitor return_replacer;
     Vec<ASR::stmt_t*>& pass_result;
+    CallGraph& call_graph;
 
-public:
-
-    SymbolTable* current_scope;
-    FixSymbolsVisitor fix_symbols_visitor;
-    bool function_inlined;
-
-    InlineFunctionCall(Allocator &al_, const std::string& rl_path_,
-        bool inline_external_symbol_calls_, bool is_fast_,
-        Vec<ASR::stmt_t*>& pass_result_, bool& from_inline_function_call_,
-        std::string& current_routine_): al(al_), rl_path(rl_path_), function_result_var(nullptr),
-        from_inline_function_call(from_inline_function_call_), inlining_function(false), fixed_duplicated_expr_stmt(false),
-        is_fast(is_fast_), current_routine(current_routine_), inline_external_symbol_calls(inline_external_symbol_calls_),
-        node_duplicator(al_), current_routine_scope(nullptr), label_generator(ASRUtils::LabelGenerator::get_instance()),
-        empty_block(nullptr), return_replacer(al_, 0), pass_result(pass_result_), current_scope(nullptr),
-        fix_symbols_visitor(current_routine_scope, current_scope, fixed_duplicated_expr_stmt, arg2value),
-        function_inlined(false) {}
-
-    void configure_node_duplicator(bool allow_procedure_calls_) {
-        node_duplicator.allow_procedure_calls = allow_procedure_calls_;
-    }
-
-    void set_empty_block(SymbolTable* scope, const Location& loc) {
-        std::string empty_block_name = scope->get_unique_name("~empty_block", false);
-        if( empty_block_name != "~empty_block" ) {
-            empty_block = scope->get_symbol("~empty_block");
-        } else {
-            SymbolTable* empty_symtab = al.make_new<SymbolTable>(scope);
-            empty_block = ASR::down_cast<ASR::symbol_t>(ASR::make_Block_t(al, loc,
-                                empty_symtab,
-                                s2c(al, empty_block_name), nullptr, 0));
-            scope->add_symbol(empty_block_name, empty_block);
+    // Whether the caller may use the local variable passed as `value`
+    // in place of the dummy argument `arg`
+    bool is_passed_by_reference(ASR::Variable_t* arg, ASR::expr_t* value) {
+        if( !ASR::is_a<ASR::Var_t>(*value) || arg->m_value_attr ) {
+            return false;
         }
-        arg2value[empty_block_name] = empty_block;
-    }
-
-    void remove_empty_block(SymbolTable* scope) {
-        scope->erase_symbol("~empty_block");
+        ASR::symbol_t* sym = ASR::down_cast<ASR::Var_t>(value)->m_v;
+        return ASR::is_a<ASR::Variable_t>(*sym) &&
+            ASR::down_cast<ASR::Variable_t>(sym)->m_parent_symtab == current_scope &&
+            ASRUtils::check_equal_type(ASRUtils::symbol_type(sym), arg->m_type);
     }
 
-    void replace_FunctionCall(ASR::FunctionCall_t* x) {
-        // If this node is visited by any other visitor
-        // or it is being visited while inlining another function call
-        // then return. To ensure that only one function call is inlined
-        // at a time.
-        if( !from_inline_function_call || inlining_function ) {
-            if( !inlining_function ) {
-                return ;
-            }
-            // TODO: Handle type later
-            if( ASR::is_a<ASR::ExternalSymbol_t>(*x->m_name) ) {
-                ASR::ExternalSymbol_t* called_sym_ext = ASR::down_cast<ASR::ExternalSymbol_t>(x->m_name);
-                ASR::symbol_t* f_sym = ASRUtils::symbol_get_past_external(called_sym_ext->m_external);
-                ASR::Function_t* f = ASR::down_cast<ASR::Function_t>(f_sym);
-
-                // Never inline intrinsic functions
-                if( ASRUtils::is_intrinsic_function2(f) ) {
-                    return ;
-                }
-
-                ASR::symbol_t* called_sym = x->m_name;
-
-                // TODO: Handle later
-                // ASR::symbol_t* called_sym_original = x.m_original_name;
-
-                std::string called_sym_name = std::string(called_sym_ext->m_name);
-                std::string new_sym_name_str = current_scope->get_unique_name(called_sym_name, false);
-                char* new_sym_name = s2c(al, new_sym_name_str);
-                if( current_scope->get_symbol(new_sym_name_str) == nullptr ) {
-                    ASR::Module_t *m = ASR::down_cast2<ASR::Module_t>(f->m_symtab->parent->asr_owner);
-                    char *modname = m->m_name;
-                    ASR::symbol_t* new_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(
-                                                al, called_sym->base.loc, current_scope, new_sym_name,
-                                                f_sym, modname, nullptr, 0,
-                                                f->m_name, ASR::accessType::Private));
-                    current_scope->add_symbol(new_sym_name_str, new_sym);
-                }
-                x->m_name = current_scope->get_symbol(new_sym_name_str);
-            }
-
-            for( size_t i = 0; i < x->n_args; i++ ) {
-                fix_symbols_visitor.visit_expr(*x->m_args[i].m_value);
+    // Whether the benefit of inlining `func` at the current call site
+    // outweighs the growth of the caller
+    bool is_worth_inlining(ASR::Function_t* func, ASR::call_arg_t* args, size_t n_args) {
+        if( call_graph.is_recursive(func) ) {
+            return false;
+        }
+        BodySize size;
+        size.visit_body(*func);
+        if( size.has_labels ) {
+            return false;
+        }
+        if( ASRUtils::get_FunctionType(func)->m_inline ) {
+            return true;
+        }
+        if( !is_fast || size.has_early_return ) {
+            return false;
+        }
+        size_t constant_args = 0;
+        for( size_t i = 0; i < n_args; i++ ) {
+            if( is_constant(args[i].m_value) ) {
+                constant_args += 1;
             }
-            return ;
         }
+        size_t budget = inline_threshold + constant_argument_bonus * constant_args +
+            loop_depth_bonus * std::min(loop_depth, max_loop_depth_bonus);
+        return size.n_stmts <= budget &&
+            inlined_statements + size.n_stmts <= max_inlined_statements;
+    }
 
-        // Avoid inlining if function call accepts a callback argument
-        for( size_t i = 0; i < x->n_args; i++ ) {
-            if( x->m_args[i].m_value &&
-                ASRUtils::expr_type(x->m_args[i].m_value) &&
+    // Resolves the procedure called by `name`, returns nullptr if it
+    // must not be inlined
+    ASR::Function_t* get_inlinable_procedure(ASR::symbol_t* name, ASR::call_arg_t* args,
+        size_t n_args, ASR::expr_t* dt) {
+        // Avoid inlining if the call accepts a callback argument
+        // or is bound to a derived type
+        if( dt ) {
+            return nullptr;
+        }
+        for( size_t i = 0; i < n_args; i++ ) {
+            if( args[i].m_value &&
+                ASRUtils::expr_type(args[i].m_value) &&
                 ASR::is_a<ASR::FunctionType_t>(
                     *ASRUtils::type_get_past_pointer(
-                        ASRUtils::expr_type(x->m_args[i].m_value))) ) {
-                return ;
+                        ASRUtils::expr_type(args[i].m_value))) ) {
+                return nullptr;
             }
         }
 
-        // Clear up any local variables present in arg2value map
-        // due to inlining other function calls
-        arg2value.clear();
-
-        // Stores the result temporarily to avoid corrupting
-        // the actual pass result due to failure of inlining function
-        // calls
-        Vec<ASR::stmt_t*> pass_result_local;
-        pass_result_local.reserve(al, 1);
-
         // Avoid external symbols for now.
-        ASR::symbol_t* routine = x->m_name;
+        ASR::symbol_t* routine = name;
         if( !ASR::is_a<ASR::Function_t>(*routine) ) {
             if( ASR::is_a<ASR::ExternalSymbol_t>(*routine) &&
                 inline_external_symbol_calls) {
-                routine = ASRUtils::symbol_get_past_external(x->m_name);
+                routine = ASRUtils::symbol_get_past_external(name);
                 if( !ASR::is_a<ASR::Function_t>(*routine) ) {
-                    return ;
+                    return nullptr;
                 }
             } else {
-                return ;
+                return nullptr;
             }
         }
 
@@ -244,15 +332,35 @@ public:
         if( ASRUtils::is_intrinsic_function2(func) ||
                 std::string(func->m_name) == current_routine ||
                 // Never Inline BindC Function
-                ASRUtils::get_FunctionType(func)->m_abi == ASR::abiType::BindC || 
+                ASRUtils::get_FunctionType(func)->m_abi == ASR::abiType::BindC ||
                 // Never Inline Interface Function
-                ASRUtils::get_FunctionType(func)->m_deftype == ASR::deftypeType::Interface) {
-            return ;
+                ASRUtils::get_FunctionType(func)->m_deftype == ASR::deftypeType::Interface ||
+                func->n_args != n_args ) {
+            return nullptr;
         }
 
-        if( !is_fast && !ASRUtils::get_FunctionType(func)->m_inline ) {
-            return ;
+        if( !is_worth_inlining(func, args, n_args) ) {
+            return nullptr;
         }
+        return func;
+    }
+
+    // Appends the body of `func` with the arguments `args` to pass_result,
+    // `result` is set to the variable holding the value of a function
+    bool inline_call(ASR::Function_t* func, ASR::call_arg_t* args,
+        const Location& loc, ASR::expr_t*& result) {
+        // Clear up any local variables present in arg2value map
+        // due to inlining other function calls
+        arg2value.clear();
+        // Dummy arguments bound to the caller's variables, which must
+        // not be erased if inlining fails
+        std::set<std::string> passed_by_reference;
+
+        // Stores the result temporarily to avoid corrupting
+        // the actual pass result due to failure of inlining function
+        // calls
+        Vec<ASR::stmt_t*> pass_result_local;
+        pass_result_local.reserve(al, 1);
 
         current_routine_scope = func->m_symtab;
 
@@ -261,29 +369,55 @@ public:
         // current function call. Variables are created in the current
         // scope for the arguments. These local variables are then initialised
         // as well with the argument value.
-        for( size_t i = 0; i < func->n_args + 1; i++ ) {
+        size_t n_args = func->n_args + (func->m_return_var ? 1 : 0);
+        bool success = true;
+        for( size_t i = 0; i < n_args && success; i++ ) {
             ASR::expr_t *func_margs_i = nullptr, *x_m_args_i = nullptr;
             if( i < func->n_args ) {
                 func_margs_i = func->m_args[i];
-                x_m_args_i = x->m_args[i].m_value;
+                x_m_args_i = args[i].m_value;
+                if( x_m_args_i == nullptr ) {
+                    success = false;
+                    break;
+                }
             } else {
                 func_margs_i = func->m_return_var;
                 x_m_args_i = nullptr;
             }
             if( !ASR::is_a<ASR::Var_t>(*func_margs_i) ) {
-                arg2value.clear();
-                return ;
+                success = false;
+                break;
             }
             ASR::Var_t* arg_var = ASR::down_cast<ASR::Var_t>(func_margs_i);
             // TODO: Expand to other symbol types, Function, Subroutine, ExternalSymbol
             if( !ASR::is_a<ASR::Variable_t>(*(arg_var->m_v)) ||
                  ASRUtils::is_character(*ASRUtils::symbol_type(arg_var->m_v)) ||
-                 ASRUtils::is_array(ASRUtils::symbol_type(arg_var->m_v)) ) {
-                arg2value.clear();
-                return ;
+                 ASRUtils::is_array(ASRUtils::symbol_type(arg_var->m_v)) ||
+                 ASR::is_a<ASR::ClassType_t>(*ASRUtils::symbol_type(arg_var->m_v)) ) {
+                success = false;
+                break;
             }
             ASR::Variable_t* arg_variable = ASR::down_cast<ASR::Variable_t>(arg_var->m_v);
             std::string arg_variable_name = std::string(arg_variable->m_name);
+            if( arg_variable->m_presence == ASR::presenceType::Optional ) {
+                success = false;
+                break;
+            }
+            if( x_m_args_i && is_passed_by_reference(arg_variable, x_m_args_i) ) {
+                arg2value[arg_variable_name] = ASR::down_cast<ASR::Var_t>(x_m_args_i)->m_v;
+                passed_by_reference.insert(arg_variable_name);
+                continue;
+            }
+            // Other arguments are copied in, which is only correct if
+            // the callee does not define them. A dummy without intent
+            // may be defined, so it is treated like intent(inout).
+            if( x_m_args_i && (arg_variable->m_intent == ASRUtils::intent_out ||
+                arg_variable->m_intent == ASRUtils::intent_inout ||
+                arg_variable->m_intent == ASRUtils::intent_unspecified ||
+                ASR::is_a<ASR::StructType_t>(*arg_variable->m_type)) ) {
+                success = false;
+                break;
+            }
             std::string arg_name = current_scope->get_unique_name(arg_variable_name + "_" + std::string(func->m_name), false);
             ASR::stmt_t* assign_stmt = nullptr;
             ASR::expr_t* call_arg_var = nullptr;
@@ -300,7 +434,6 @@ public:
             arg2value[arg_variable_name] = ASR::down_cast<ASR::Var_t>(call_arg_var)->m_v;
         }
 
-        bool success = true;
         // Stores the initialisation expression for function's local variables
         // i.e., other than the argument variables.
         std::vector<std::pair<ASR::expr_t*, ASR::symbol_t*>> exprs_to_be_visited;
@@ -309,49 +442,58 @@ public:
         // the ones other than the arguments.
         // exprs_to_be_visited temporarily stores the initialisation expression as well.
         for( auto& itr : func->m_symtab->get_scope() ) {
+            if( !success ) {
+                break;
+            }
             if( startswith(itr.first, "~empty_block") ) {
                 set_empty_block(current_scope, func->base.base.loc);
                 continue;
             }
+            if( arg2value.find(itr.first) != arg2value.end() ) {
+                continue;
+            }
             if( !ASR::is_a<ASR::Variable_t>(*itr.second) ||
                  ASRUtils::is_character(*ASRUtils::symbol_type(itr.second)) ||
                  ASRUtils::is_array(ASRUtils::symbol_type(itr.second)) ||
                  ASR::is_a<ASR::StructType_t>(*ASRUtils::symbol_type(itr.second)) ||
                  ASR::is_a<ASR::ClassType_t>(*ASRUtils::symbol_type(itr.second)) ) {
-                arg2value.clear();
-                return ;
+                success = false;
+                break;
             }
             ASR::Variable_t* func_var = ASR::down_cast<ASR::Variable_t>(itr.second);
             std::string func_var_name = itr.first;
-            if( arg2value.find(func_var_name) == arg2value.end() ) {
-                std::string local_var_name = current_scope->get_unique_name(func_var_name + "_" + std::string(func->m_name), false);
-                node_duplicator.success = true;
-                ASR::expr_t *m_symbolic_value = node_duplicator.duplicate_expr(func_var->m_symbolic_value);
-                if( !node_duplicator.success ) {
-                    success = false;
-                    break;
-                }
-                node_duplicator.success = true;
-                ASR::expr_t *m_value = node_duplicator.duplicate_expr(func_var->m_value);
-                if( !node_duplicator.success ) {
-                    success = false;
-                    break;
-                }
-                ASR::ttype_t* local_var_type = func_var->m_type;
-                ASR::symbol_t* local_var = (ASR::symbol_t*) ASRUtils::make_Variable_t_util(
-                        al, func_var->base.base.loc, current_scope,
-                        s2c(al, local_var_name), nullptr, 0, ASR::intentType::Local,
-                        nullptr, nullptr, ASR::storage_typeType::Default,
-                        local_var_type, nullptr, ASR::abiType::Source, ASR::accessType::Public,
-                        ASR::presenceType::Required, false);
-                current_scope->add_symbol(local_var_name, local_var);
-                arg2value[func_var_name] = local_var;
-                if( m_symbolic_value ) {
-                    exprs_to_be_visited.push_back(std::make_pair(m_symbolic_value, local_var));
-                }
-                if( m_value ) {
-                    exprs_to_be_visited.push_back(std::make_pair(m_value, local_var));
-                }
+            // Saved variables keep their value between calls
+            if( func_var->m_storage == ASR::storage_typeType::Save ) {
+                success = false;
+                break;
+            }
+            std::string local_var_name = current_scope->get_unique_name(func_var_name + "_" + std::string(func->m_name), false);
+            node_duplicator.success = true;
+            ASR::expr_t *m_symbolic_value = node_duplicator.duplicate_expr(func_var->m_symbolic_value);
+            if( !node_duplicator.success ) {
+                success = false;
+                break;
+            }
+            node_duplicator.success = true;
+            ASR::expr_t *m_value = node_duplicator.duplicate_expr(func_var->m_value);
+            if( !node_duplicator.success ) {
+                success = false;
+                break;
+            }
+            ASR::ttype_t* local_var_type = func_var->m_type;
+            ASR::symbol_t* local_var = (ASR::symbol_t*) ASRUtils::make_Variable_t_util(
+                    al, func_var->base.base.loc, current_scope,
+                    s2c(al, local_var_name), nullptr, 0, ASR::intentType::Local,
+                    nullptr, nullptr, ASR::storage_typeType::Default,
+                    local_var_type, nullptr, ASR::abiType::Source, ASR::accessType::Public,
+                    ASR::presenceType::Required, false);
+            current_scope->add_symbol(local_var_name, local_var);
+            arg2value[func_var_name] = local_var;
+            if( m_symbolic_value ) {
+                exprs_to_be_visited.push_back(std::make_pair(m_symbolic_value, local_var));
+            }
+            if( m_value ) {
+                exprs_to_be_visited.push_back(std::make_pair(m_value, local_var));
             }
         }
 
@@ -373,10 +515,15 @@ public:
             pass_result_local.push_back(al, assign_stmt);
         }
 
+        // A trailing return is not needed once the body is inlined
+        size_t n_body = func->n_body;
+        if( n_body > 0 && ASR::is_a<ASR::Return_t>(*func->m_body[n_body - 1]) ) {
+            n_body -= 1;
+        }
         Vec<ASR::stmt_t*> func_copy;
-        func_copy.reserve(al, func->n_body);
+        func_copy.reserve(al, n_body);
         // Duplicate each and every statement of the function body.
-        for( size_t i = 0; i < func->n_body && success; i++ ) {
+        for( size_t i = 0; i < n_body && success; i++ ) {
             node_duplicator.success = true;
             ASR::stmt_t* m_body_copy = node_duplicator.duplicate_stmt(func->m_body[i]);
             if( node_duplicator.success ) {
@@ -390,7 +537,7 @@ public:
             // Set inlining_function to true so that we inline
             // only one function at a time.
             inlining_function = true;
-            for( size_t i = 0; i < func->n_body && success; i++ ) {
+            for( size_t i = 0; i < n_body && success; i++ ) {
                 fixed_duplicated_expr_stmt = true;
                 fix_symbols_visitor.visit_stmt(*func_copy[i]);
                 success = success && fixed_duplicated_expr_stmt;
@@ -400,7 +547,7 @@ public:
                 set_empty_block(current_scope, func->base.base.loc);
                 uint64_t block_call_label = label_generator->get_unique_label();
                 ASR::stmt_t* block_call = ASRUtils::STMT(ASR::make_BlockCall_t(
-                    al, x->base.base.loc, block_call_label, empty_block));
+                    al, loc, block_call_label, empty_block));
                 label_generator->add_node_with_unique_label((ASR::asr_t*) block_call,
                                                             block_call_label);
                 return_replacer.set_goto_label(block_call_label);
@@ -413,7 +560,7 @@ public:
                 }
 
                 bool is_goto_added = false;
-                for( size_t i = 0; i < func->n_body; i++ ) {
+                for( size_t i = 0; i < n_body; i++ ) {
                     return_replacer.current_stmt = &func_copy.p[i];
                     return_replacer.has_replacement_happened = false;
                     return_replacer.replace_stmt(func_copy[i]);
@@ -425,30 +572,143 @@ public:
                 } else {
                     remove_empty_block(current_scope);
                 }
+                inlined_statements += n_body;
             }
             inlining_function = false;
-            current_routine_scope = nullptr;
-            function_result_var = return_var;
         }
+        current_routine_scope = nullptr;
 
         if (!success) {
             // If not successful then delete all the local variables
             // created for the purpose of inlining the current function call.
             for( auto& itr : arg2value ) {
+                if( passed_by_reference.find(itr.first) != passed_by_reference.end() ||
+                    !ASR::is_a<ASR::Variable_t>(*itr.second) ) {
+                    continue;
+                }
                 ASR::Variable_t* auxiliary_var = ASR::down_cast<ASR::Variable_t>(itr.second);
                 current_scope->erase_symbol(std::string(auxiliary_var->m_name));
             }
-            function_result_var = nullptr;
+            return_var = nullptr;
+        }
+        result = return_var;
+        // Clear up the arg2value to avoid corruption
+        // of any kind.
+        arg2value.clear();
+        return success;
+    }
+
+public:
+
+    SymbolTable* current_scope;
+    FixSymbolsVisitor fix_symbols_visitor;
+    bool function_inlined;
+    // Loop depth of the call site
+    size_t loop_depth;
+    // Statements inlined into the current procedure
+    size_t inlined_statements;
+
+    InlineFunctionCall(Allocator &al_, const std::string& rl_path_,
+        bool inline_external_symbol_calls_, bool is_fast_,
+        Vec<ASR::stmt_t*>& pass_result_, bool& from_inline_function_call_,
+        std::string& current_routine_, CallGraph& call_graph_): al(al_), rl_path(rl_path_), function_result_var(nullptr),
+        from_inline_function_call(from_inline_function_call_), inlining_function(false), fixed_duplicated_expr_stmt(false),
+        is_fast(is_fast_), current_routine(current_routine_), inline_external_symbol_calls(inline_external_symbol_calls_),
+        node_duplicator(al_), current_routine_scope(nullptr), label_generator(ASRUtils::LabelGenerator::get_instance()),
+        empty_block(nullptr), return_replacer(al_, 0), pass_result(pass_result_), call_graph(call_graph_),
+        current_scope(nullptr),
+        fix_symbols_visitor(current_routine_scope, current_scope, fixed_duplicated_expr_stmt, arg2value),
+        function_inlined(false), loop_depth(0), inlined_statements(0) {}
+
+    void configure_node_duplicator(bool allow_procedure_calls_) {
+        node_duplicator.allow_procedure_calls = allow_procedure_calls_;
+    }
+
+    void set_empty_block(SymbolTable* scope, const Location& loc) {
+        std::string empty_block_name = scope->get_unique_name("~empty_block", false);
+        if( empty_block_name != "~empty_block" ) {
+            empty_block = scope->get_symbol("~empty_block");
+        } else {
+            SymbolTable* empty_symtab = al.make_new<SymbolTable>(scope);
+            empty_block = ASR::down_cast<ASR::symbol_t>(ASR::make_Block_t(al, loc,
+                                empty_symtab,
+                                s2c(al, empty_block_name), nullptr, 0));
+            scope->add_symbol(empty_block_name, empty_block);
+        }
+        arg2value[empty_block_name] = empty_block;
+    }
+
+    void remove_empty_block(SymbolTable* scope) {
+        scope->erase_symbol("~empty_block");
+    }
+
+    void replace_FunctionCall(ASR::FunctionCall_t* x) {
+        // If this node is visited by any other visitor
+        // or it is being visited while inlining another function call
+        // then return. To ensure that only one function call is inlined
+        // at a time.
+        if( !from_inline_function_call || inlining_function ) {
+            if( !inlining_function ) {
+                return ;
+            }
+            // TODO: Handle type later
+            if( ASR::is_a<ASR::ExternalSymbol_t>(*x->m_name) ) {
+                ASR::ExternalSymbol_t* called_sym_ext = ASR::down_cast<ASR::ExternalSymbol_t>(x->m_name);
+                ASR::symbol_t* f_sym = ASRUtils::symbol_get_past_external(called_sym_ext->m_external);
+                ASR::Function_t* f = ASR::down_cast<ASR::Function_t>(f_sym);
+
+                // Never inline intrinsic functions
+                if( ASRUtils::is_intrinsic_function2(f) ) {
+                    return ;
+                }
+
+                ASR::symbol_t* called_sym = x->m_name;
+
+                // TODO: Handle later
+                // ASR::symbol_t* called_sym_original = x.m_original_name;
+
+                std::string called_sym_name = std::string(called_sym_ext->m_name);
+                std::string new_sym_name_str = current_scope->get_unique_name(called_sym_name, false);
+                char* new_sym_name = s2c(al, new_sym_name_str);
+                if( current_scope->get_symbol(new_sym_name_str) == nullptr ) {
+                    ASR::Module_t *m = ASR::down_cast2<ASR::Module_t>(f->m_symtab->parent->asr_owner);
+                    char *modname = m->m_name;
+                    ASR::symbol_t* new_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(
+                                                al, called_sym->base.loc, current_scope, new_sym_name,
+                                                f_sym, modname, nullptr, 0,
+                                                f->m_name, ASR::accessType::Private));
+                    current_scope->add_symbol(new_sym_name_str, new_sym);
+                }
+                x->m_name = current_scope->get_symbol(new_sym_name_str);
+            }
+
+            for( size_t i = 0; i < x->n_args; i++ ) {
+                fix_symbols_visitor.visit_expr(*x->m_args[i].m_value);
+            }
+            return ;
+        }
+
+        ASR::Function_t* func = get_inlinable_procedure(x->m_name, x->m_args, x->n_args, x->m_dt);
+        if( func == nullptr || func->m_return_var == nullptr ) {
+            return ;
         }
         // At least one function is inlined
-        function_inlined = success;
+        function_inlined = inline_call(func, x->m_args, x->base.base.loc, function_result_var);
         if( function_inlined ) {
             *current_expr = function_result_var;
         }
-        success = false;
-        // Clear up the arg2value to avoid corruption
-        // of any kind.
-        arg2value.clear();
+    }
+
+    // Appends the body of the called subroutine to pass_result, returns
+    // whether the call can be dropped
+    bool inline_SubroutineCall(ASR::SubroutineCall_t* x) {
+        ASR::Function_t* func = get_inlinable_procedure(x->m_name, x->m_args, x->n_args, x->m_dt);
+        if( func == nullptr || func->m_return_var != nullptr ) {
+            return false;
+        }
+        ASR::expr_t* result = nullptr;
+        function_inlined = inline_call(func, x->m_args, x->base.base.loc, result);
+        return function_inlined;
     }
 
 };
@@ -464,6 +724,9 @@ private:
     Vec<ASR::stmt_t*>* parent_body;
     Vec<ASR::stmt_t*> pass_result;
 
+    CallGraph& call_graph;
+    std::set<ASR::Function_t*> visited;
+
     InlineFunctionCall replacer;
 
 public:
@@ -471,15 +734,16 @@ public:
     bool function_inlined;
 
     InlineFunctionCallVisitor(Allocator &al_, const std::string& rl_path_,
-        bool inline_external_symbol_calls_, bool is_fast_):
-        al(al_), current_routine(""), parent_body(nullptr),
+        bool inline_external_symbol_calls_, bool is_fast_, CallGraph& call_graph_):
+        al(al_), current_routine(""), parent_body(nullptr), call_graph(call_graph_),
         replacer(al_, rl_path_, inline_external_symbol_calls_, is_fast_,
-                 pass_result, from_inline_function_call, current_routine) {
+                 pass_result, from_inline_function_call, current_routine, call_graph_) {
         pass_result.reserve(al, 1);
     }
 
     void configure_node_duplicator(bool allow_procedure_calls_) {
         replacer.configure_node_duplicator(allow_procedure_calls_);
+        visited.clear();
     }
 
     void call_replacer() {
@@ -488,13 +752,35 @@ public:
         replacer.replace_expr(*current_expr);
     }
 
+    void visit_Program(const ASR::Program_t &x) {
+        size_t inlined_statements_copy = replacer.inlined_statements;
+        replacer.inlined_statements = 0;
+        ASR::CallReplacerOnExpressionsVisitor<InlineFunctionCallVisitor>::visit_Program(x);
+        replacer.inlined_statements = inlined_statements_copy;
+    }
+
     void visit_Function(const ASR::Function_t &x) {
         // FIXME: this is a hack, we need to pass in a non-const `x`,
         // which requires to generate a TransformVisitor.
         ASR::Function_t &xx = const_cast<ASR::Function_t&>(x);
+        if( !visited.insert(&xx).second ) {
+            return ;
+        }
+        // Inline into the callees first, so that they are judged
+        // by the size they end up with
+        for( ASR::Function_t* callee: call_graph.callees[&xx] ) {
+            visit_Function(*callee);
+        }
+        std::string current_routine_copy = current_routine;
+        size_t inlined_statements_copy = replacer.inlined_statements;
+        size_t loop_depth_copy = replacer.loop_depth;
         current_routine = std::string(xx.m_name);
+        replacer.inlined_statements = 0;
+        replacer.loop_depth = 0;
         ASR::CallReplacerOnExpressionsVisitor<InlineFunctionCallVisitor>::visit_Function(x);
-        current_routine.clear();
+        current_routine = current_routine_copy;
+        replacer.inlined_statements = inlined_statements_copy;
+        replacer.loop_depth = loop_depth_copy;
     }
 
     void visit_Assignment(const ASR::Assignment_t& x) {
@@ -503,6 +789,18 @@ public:
         from_inline_function_call = false;
     }
 
+    void visit_WhileLoop(const ASR::WhileLoop_t& x) {
+        replacer.loop_depth += 1;
+        ASR::CallReplacerOnExpressionsVisitor<InlineFunctionCallVisitor>::visit_WhileLoop(x);
+        replacer.loop_depth -= 1;
+    }
+
+    void visit_DoLoop(const ASR::DoLoop_t& x) {
+        replacer.loop_depth += 1;
+        ASR::CallReplacerOnExpressionsVisitor<InlineFunctionCallVisitor>::visit_DoLoop(x);
+        replacer.loop_depth -= 1;
+    }
+
     void transform_stmts(ASR::stmt_t **&m_body, size_t &n_body) {
         Vec<ASR::stmt_t*> body;
         body.reserve(al, n_body);
@@ -517,11 +815,19 @@ public:
             Vec<ASR::stmt_t*>* parent_body_copy = parent_body;
             parent_body = &body;
             visit_stmt(*m_body[i]);
+            bool inlined = false;
+            if( ASR::is_a<ASR::SubroutineCall_t>(*m_body[i]) ) {
+                replacer.current_scope = current_scope;
+                inlined = replacer.inline_SubroutineCall(
+                    ASR::down_cast<ASR::SubroutineCall_t>(m_body[i]));
+            }
             parent_body = parent_body_copy;
             for (size_t j=0; j < pass_result.size(); j++) {
                 body.push_back(al, pass_result[j]);
             }
-            body.push_back(al, m_body[i]);
+            if( !inlined ) {
+                body.push_back(al, m_body[i]);
+            }
         }
         m_body = body.p;
         n_body = body.size();
@@ -538,11 +844,18 @@ void pass_inline_function_calls(Allocator &al, ASR::TranslationUnit_t &unit,
                                 const LCompilers::PassOptions& pass_options) {
     std::string rl_path = pass_options.runtime_library_dir;
     bool inline_external_symbol_calls = pass_options.inline_external_symbol_calls;
-    InlineFunctionCallVisitor v(al, rl_path, inline_external_symbol_calls, pass_options.fast);
+    CallGraph call_graph;
+    call_graph.visit_TranslationUnit(unit);
+    InlineFunctionCallVisitor v(al, rl_path, inline_external_symbol_calls, pass_options.fast,
+        call_graph);
     v.configure_node_duplicator(false);
     v.visit_TranslationUnit(unit);
-    v.configure_node_duplicator(true);
-    v.visit_TranslationUnit(unit);
+    if( !pass_options.fast ) {
+        // Calls in an inlined body are only remapped to the caller's
+        // scope for module procedures, so --fast leaves such bodies alone
+        v.configure_node_duplicator(true);
+        v.visit_TranslationUnit(unit);
+    }
     PassUtils::UpdateDependenciesVisitor u(al);
     u.visit_TranslationUnit(unit);
 }
@@ -3962,13 +3962,18 @@ namespace MatMul {
         } else {
             mul_value = b.Mul(a_ref, b_ref);
         }
-        body.push_back(al, b.DoLoop(i, a_lbound, a_ubound, {
-            b.DoLoop(j, b_lbound, b_ubound, {
-                b.Assign_Constant(res_ref, 0),
-                b.DoLoop(k, LBound(args[1], 1), UBound(args[1], 1), {
+        // Column-major order: `i` indexes the leftmost subscript of both
+        // `result` and `matrix_a`, so it runs innermost. Every r(i, j)
+        // still accumulates over `k` in ascending order.
+        body.push_back(al, b.DoLoop(j, b_lbound, b_ubound, {
+            b.DoLoop(i, a_lbound, a_ubound, {
+                b.Assign_Constant(res_ref, 0)
+            }),
+            b.DoLoop(k, LBound(args[1], 1), UBound(args[1], 1), {
+                b.DoLoop(i, a_lbound, a_ubound, {
                     b.Assignment(res_ref, b.Add(res_ref, mul_value))
-                }),
-            })
+                })
+            }),
         }));
         body.push_back(al, b.Return());
         ASR::symbol_t *fn_sym = make_ASR_Function_t(fn_name, fn_symtab, dep, args,
@@ -5659,6 +5664,146 @@ namespace Transpose {
 
 } // namespace Transpose
 
+namespace RuntimeReduction {
+
+    /*
+        Whole array SUM, PRODUCT, MAXVAL, MINVAL, COUNT, ANY and ALL with
+        --parallel-intrinsics call the reductions of the runtime library,
+        which split large arrays over its thread pool. For `sum(array)` the
+        following function is generated:
+
+            real(8) function _lcompilers_sum_runtime(array) result(result)
+                real(8) :: array(:, :)
+                if (is_contiguous(array) .and. size(array, kind=8) > 0) then
+                    result = _lfortran_sum_r64(c_loc(array(lbound(array, 1), lbound(array, 2))), &
+                        size(array, kind=8), .true.)
+                else
+                    result = Sum_8_2_0(array)
+                end if
+            end function
+
+        Non-contiguous arrays keep the loops generated for the intrinsic.
+    */
+
+    // Name of the runtime function computing the intrinsic `id` of an array
+    // of `array_type`, empty if the reduction is left to the generated loops
+    static inline std::string get_runtime_name(int64_t id, ASR::ttype_t* array_type,
+            Vec<ASR::call_arg_t>& new_args, int64_t overload_id) {
+        if( overload_id != 0 || new_args.size() != 1 || !ASRUtils::is_array(array_type) ) {
+            return "";
+        }
+        ASR::ttype_t* element_type = ASRUtils::extract_type(array_type);
+        int kind = ASRUtils::extract_kind_from_ttype_t(element_type);
+        std::string name;
+        switch( static_cast<IntrinsicArrayFunctions>(id) ) {
+            case IntrinsicArrayFunctions::Sum: name = "sum"; break;
+            case IntrinsicArrayFunctions::Product: name = "product"; break;
+            case IntrinsicArrayFunctions::MaxVal: name = "maxval"; break;
+            case IntrinsicArrayFunctions::MinVal: name = "minval"; break;
+            case IntrinsicArrayFunctions::Count: name = "count"; break;
+            case IntrinsicArrayFunctions::Any: name = "any"; break;
+            case IntrinsicArrayFunctions::All: name = "all"; break;
+            default: return "";
+        }
+        if( name == "count" || name == "any" || name == "all" ) {
+            return ASRUtils::is_logical(*element_type) ? "_lfortran_" + name : "";
+        }
+        if( kind != 4 && kind != 8 ) {
+            return "";
+        }
+        if( ASRUtils::is_integer(*element_type) ) {
+            return "_lfortran_" + name + "_i" + std::to_string(8*kind);
+        } else if( ASRUtils::is_real(*element_type) ) {
+            return "_lfortran_" + name + "_r" + std::to_string(8*kind);
+        }
+        return "";
+    }
+
+    static inline ASR::expr_t* instantiate_RuntimeReduction(Allocator &al,
+            const Location &loc, SymbolTable *scope, ASR::ttype_t *return_type,
+            Vec<ASR::call_arg_t>& new_args, int64_t overload_id,
+            const std::string &c_func_name, impl_function instantiate_loops) {
+        std::string name = c_func_name.substr(std::string("_lfortran_").size());
+        declare_basic_variables("_lcompilers_" + name + "_runtime");
+        ASR::ttype_t* array_type = ASRUtils::duplicate_type_with_empty_dims(al,
+            ASRUtils::type_get_past_allocatable(ASRUtils::type_get_past_pointer(
+                ASRUtils::expr_type(new_args[0].m_value))));
+        // Without an intent pass_array_by_data leaves the argument alone, it
+        // would copy sections into a temporary and drop the descriptor
+        args.push_back(al, declare("array", array_type, Unspecified));
+        ASR::expr_t* result = declare("result", return_type, ReturnVar);
+
+        // interface to the runtime function, COUNT always returns integer(8)
+        bool cast_result = c_func_name == "_lfortran_count" &&
+            ASRUtils::extract_kind_from_ttype_t(return_type) != 8;
+        ASR::ttype_t* c_return_type = cast_result ? int64 : return_type;
+        SymbolTable *fn_symtab_1 = al.make_new<SymbolTable>(fn_symtab);
+        Vec<ASR::expr_t*> args_1; args_1.reserve(al, 3);
+        args_1.push_back(al, b.Variable(fn_symtab_1, "a", b.CPtr(),
+            ASR::intentType::In, ASR::abiType::BindC, true));
+        args_1.push_back(al, b.Variable(fn_symtab_1, "n", int64,
+            ASR::intentType::In, ASR::abiType::BindC, true));
+        args_1.push_back(al, b.Variable(fn_symtab_1, "parallel", logical,
+            ASR::intentType::In, ASR::abiType::BindC, true));
+        ASR::expr_t* return_var_1 = b.Variable(fn_symtab_1, "result", c_return_type,
+            ASR::intentType::ReturnVar, ASR::abiType::BindC, false);
+        SetChar dep_1; dep_1.reserve(al, 1);
+        Vec<ASR::stmt_t*> body_1; body_1.reserve(al, 1);
+        ASR::symbol_t *s = make_ASR_Function_t(c_func_name, fn_symtab_1, dep_1, args_1,
+            body_1, return_var_1, ASR::abiType::BindC, ASR::deftypeType::Interface,
+            s2c(al, c_func_name));
+        fn_symtab->add_symbol(c_func_name, s);
+        dep.push_back(al, s2c(al, c_func_name));
+
+        int rank = ASRUtils::extract_n_dims_from_ttype(array_type);
+        std::vector<ASR::expr_t*> first_index;
+        for( int i = 0; i < rank; i++ ) {
+            first_index.push_back(b.ArrayLBound(args[0], i + 1));
+        }
+        ASR::expr_t* first_element = b.ArrayItem_01(args[0], first_index);
+        ASR::expr_t* data = b.PointerToCPtr(ASRUtils::EXPR(ASR::make_GetPointer_t(al, loc,
+            first_element, ASRUtils::make_Pointer_t_util(al, loc,
+                ASRUtils::expr_type(first_element)), nullptr)), b.CPtr());
+        Vec<ASR::expr_t*> c_args; c_args.reserve(al, 3);
+        c_args.push_back(al, data);
+        c_args.push_back(al, b.ArraySize(args[0], nullptr, int64));
+        c_args.push_back(al, b.bool_t(true, logical));
+        ASR::expr_t* c_call = b.Call(s, c_args, c_return_type);
+        if( cast_result ) {
+            c_call = b.i2i_t(c_call, return_type);
+        }
+
+        Vec<ASR::ttype_t*> loop_arg_types; loop_arg_types.reserve(al, 1);
+        loop_arg_types.push_back(al, array_type);
+        Vec<ASR::call_arg_t> loop_args; loop_args.reserve(al, 1);
+        ASR::call_arg_t loop_arg;
+        loop_arg.loc = loc;
+        loop_arg.m_value = args[0];
+        loop_args.push_back(al, loop_arg);
+        ASR::expr_t* loop_call = instantiate_loops(al, loc, scope, loop_arg_types,
+            return_type, loop_args, overload_id);
+        if( ASR::is_a<ASR::FunctionCall_t>(*loop_call) ) {
+            dep.push_back(al, ASRUtils::symbol_name(
+                ASR::down_cast<ASR::FunctionCall_t>(loop_call)->m_name));
+        }
+
+        ASR::expr_t* is_contiguous = ASRUtils::EXPR(ASR::make_ArrayIsContiguous_t(
+            al, loc, args[0], logical, nullptr));
+        body.push_back(al, b.If(b.And(is_contiguous,
+                b.Gt(b.ArraySize(args[0], nullptr, int64), b.i64(0))), {
+            b.Assignment(result, c_call)
+        }, {
+            b.Assignment(result, loop_call)
+        }));
+
+        ASR::symbol_t *fn_sym = make_ASR_Function_t(fn_name, fn_symtab, dep, args,
+            body, result, ASR::abiType::Source, ASR::deftypeType::Implementation, nullptr);
+        scope->add_symbol(fn_name, fn_sym);
+        return b.Call(fn_sym, new_args, return_type, nullptr);
+    }
+
+} // namespace RuntimeReduction
+
 namespace IntrinsicArrayFunctionRegistry {
 
     static const std::map<int64_t, std::tuple<impl_function,
@@ -31,12 +31,15 @@ class ReplaceIntrinsicFunctions: public ASR::BaseExprReplacer<ReplaceIntrinsicFu
     Allocator& al;
     SymbolTable* global_scope;
     std::map<ASR::symbol_t*, ASRUtils::IntrinsicArrayFunctions>& func2intrinsicid;
+    const PassOptions& pass_options;
 
     public:
 
     ReplaceIntrinsicFunctions(Allocator& al_, SymbolTable* global_scope_,
-    std::map<ASR::symbol_t*, ASRUtils::IntrinsicArrayFunctions>& func2intrinsicid_) :
-        al(al_), global_scope(global_scope_), func2intrinsicid(func2intrinsicid_) {}
+    std::map<ASR::symbol_t*, ASRUtils::IntrinsicArrayFunctions>& func2intrinsicid_,
+    const PassOptions& pass_options_) :
+        al(al_), global_scope(global_scope_), func2intrinsicid(func2intrinsicid_),
+        pass_options(pass_options_) {}
 
 
     void replace_IntrinsicElementalFunction(ASR::IntrinsicElementalFunction_t* x) {
@@ -44,6 +47,12 @@ class ReplaceIntrinsicFunctions: public ASR::BaseExprReplacer<ReplaceIntrinsicFu
             *current_expr = x->m_value;
             return;
         }
+        // The backend generates the scalar real versions of these itself
+        if( x->n_args > 0 && !ASRUtils::is_array(x->m_type) &&
+            ASRUtils::is_real(*ASRUtils::expr_type(x->m_args[0])) &&
+            PassUtils::skip_instantiation(pass_options, x->m_intrinsic_id) ) {
+            return ;
+        }
 
         Vec<ASR::call_arg_t> new_args; new_args.reserve(al, x->n_args);
         // Replace any IntrinsicElementalFunctions in the argument first:
@@ -108,8 +117,20 @@ class ReplaceIntrinsicFunctions: public ASR::BaseExprReplacer<ReplaceIntrinsicFu
         for( size_t i = 0; i < x->n_args; i++ ) {
             arg_types.push_back(al, ASRUtils::expr_type(x->m_args[i]));
         }
-        ASR::expr_t* current_expr_ = instantiate_function(al, x->base.base.loc,
-            global_scope, arg_types, x->m_type, new_args, x->m_overload_id);
+        ASR::expr_t* current_expr_ = nullptr;
+        std::string runtime_name;
+        if( pass_options.parallel_intrinsics && x->n_args == 1 ) {
+            runtime_name = ASRUtils::RuntimeReduction::get_runtime_name(
+                x->m_arr_intrinsic_id, arg_types[0], new_args, x->m_overload_id);
+        }
+        if( !runtime_name.empty() ) {
+            current_expr_ = ASRUtils::RuntimeReduction::instantiate_RuntimeReduction(
+                al, x->base.base.loc, global_scope, x->m_type, new_args,
+                x->m_overload_id, runtime_name, instantiate_function);
+        } else {
+            current_expr_ = instantiate_function(al, x->base.base.loc,
+                global_scope, arg_types, x->m_type, new_args, x->m_overload_id);
+        }
         ASR::expr_t* func_call = current_expr_;
         *current_expr = current_expr_;
         bool condition = ASR::is_a<ASR::FunctionCall_t>(*func_call);
@@ -136,8 +157,9 @@ class ReplaceIntrinsicFunctionsVisitor : public ASR::CallReplacerOnExpressionsVi
     public:
 
         ReplaceIntrinsicFunctionsVisitor(Allocator& al_, SymbolTable* global_scope_,
-            std::map<ASR::symbol_t*, ASRUtils::IntrinsicArrayFunctions>& func2intrinsicid_) :
-            replacer(al_, global_scope_, func2intrinsicid_) {}
+            std::map<ASR::symbol_t*, ASRUtils::IntrinsicArrayFunctions>& func2intrinsicid_,
+            const PassOptions& pass_options_) :
+            replacer(al_, global_scope_, func2intrinsicid_, pass_options_) {}
 
         void call_replacer() {
             replacer.current_expr = current_expr;
@@ -348,9 +370,9 @@ class ReplaceFunctionCallReturningArrayVisitor : public ASR::CallReplacerOnExpre
 };
 
 void pass_replace_intrinsic_function(Allocator &al, ASR::TranslationUnit_t &unit,
-                            const LCompilers::PassOptions& /*pass_options*/) {
+                            const LCompilers::PassOptions& pass_options) {
     std::map<ASR::symbol_t*, ASRUtils::IntrinsicArrayFunctions> func2intrinsicid;
-    ReplaceIntrinsicFunctionsVisitor v(al, unit.m_symtab, func2intrinsicid);
+    ReplaceIntrinsicFunctionsVisitor v(al, unit.m_symtab, func2intrinsicid, pass_options);
     v.visit_TranslationUnit(unit);
     ReplaceFunctionCallReturningArrayVisitor u(al, func2intrinsicid);
     u.visit_TranslationUnit(unit);
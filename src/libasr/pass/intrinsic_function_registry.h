@@ -1146,6 +1146,10 @@ enum class IntrinsicImpureFunctions : int64_t {
     IsIostatEnd,
     IsIostatEor,
     Allocated,
+    ThisImage,
+    NumImages,
+    CoarrayAllocate,
+    CoarrayRemote,
     // ...
 };
 
@@ -1197,6 +1201,62 @@ namespace IsIostatEor {
 
 } // namespace IsIostatEor
 
+namespace ThisImage {
+
+    static inline ASR::asr_t* create_ThisImage(Allocator& al, const Location& loc,
+            Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        if( args.n != 0 ) {
+            append_error(diag, "Only `this_image()` without arguments is supported", loc);
+            return nullptr;
+        }
+        return ASR::make_IntrinsicImpureFunction_t(al, loc,
+                static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::ThisImage),
+                args.p, args.n, 0, int32, nullptr);
+    }
+
+} // namespace ThisImage
+
+namespace NumImages {
+
+    static inline ASR::asr_t* create_NumImages(Allocator& al, const Location& loc,
+            Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        if( args.n != 0 ) {
+            append_error(diag, "Only `num_images()` without arguments is supported", loc);
+            return nullptr;
+        }
+        return ASR::make_IntrinsicImpureFunction_t(al, loc,
+                static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::NumImages),
+                args.p, args.n, 0, int32, nullptr);
+    }
+
+} // namespace NumImages
+
+// Storage of a coarray, the same offset in the coarray heap of every image.
+// Takes the size in bytes and returns a `c_ptr`.
+namespace CoarrayAllocate {
+
+    static inline ASR::asr_t* create_CoarrayAllocate(Allocator& al, const Location& loc,
+            Vec<ASR::expr_t*>& args, diag::Diagnostics& /*diag*/) {
+        return ASR::make_IntrinsicImpureFunction_t(al, loc,
+                static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::CoarrayAllocate),
+                args.p, args.n, 0, ASRUtils::TYPE(ASR::make_CPtr_t(al, loc)), nullptr);
+    }
+
+} // namespace CoarrayAllocate
+
+// Address of the copy of a coarray on another image, takes the `c_ptr` of
+// the local copy and the image index
+namespace CoarrayRemote {
+
+    static inline ASR::asr_t* create_CoarrayRemote(Allocator& al, const Location& loc,
+            Vec<ASR::expr_t*>& args, diag::Diagnostics& /*diag*/) {
+        return ASR::make_IntrinsicImpureFunction_t(al, loc,
+                static_cast<int64_t>(ASRUtils::IntrinsicImpureFunctions::CoarrayRemote),
+                args.p, args.n, 0, ASRUtils::TYPE(ASR::make_CPtr_t(al, loc)), nullptr);
+    }
+
+} // namespace CoarrayRemote
+
 namespace IntrinsicImpureFunctionRegistry {
 
     static const std::map<std::string, std::tuple<create_intrinsic_function,
@@ -1204,6 +1264,8 @@ namespace IntrinsicImpureFunctionRegistry {
         {"is_iostat_end", {&IsIostatEnd::create_IsIostatEnd, nullptr}},
         {"is_iostat_eor", {&IsIostatEor::create_IsIostatEor, nullptr}},
         {"allocated", {&Allocated::create_Allocated, nullptr}},
+        {"this_image", {&ThisImage::create_ThisImage, nullptr}},
+        {"num_images", {&NumImages::create_NumImages, nullptr}},
     };
 
     static inline bool is_intrinsic_function(const std::string& name) {
@@ -1227,6 +1289,10 @@ inline std::string get_impure_intrinsic_name(int64_t x) {
         IMPURE_INTRINSIC_NAME_CASE(IsIostatEnd)
         IMPURE_INTRINSIC_NAME_CASE(IsIostatEor)
         IMPURE_INTRINSIC_NAME_CASE(Allocated)
+        IMPURE_INTRINSIC_NAME_CASE(ThisImage)
+        IMPURE_INTRINSIC_NAME_CASE(NumImages)
+        IMPURE_INTRINSIC_NAME_CASE(CoarrayAllocate)
+        IMPURE_INTRINSIC_NAME_CASE(CoarrayRemote)
         default : {
             throw LCompilersException("pickle: intrinsic_id not implemented");
         }
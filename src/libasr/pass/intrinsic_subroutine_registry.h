@@ -30,6 +30,12 @@ inline std::string get_intrinsic_subroutine_name(int x) {
         INTRINSIC_SUBROUTINE_NAME_CASE(Srand)
         INTRINSIC_SUBROUTINE_NAME_CASE(SystemClock)
         INTRINSIC_SUBROUTINE_NAME_CASE(DateAndTime)
+        INTRINSIC_SUBROUTINE_NAME_CASE(CoSum)
+        INTRINSIC_SUBROUTINE_NAME_CASE(CoMax)
+        INTRINSIC_SUBROUTINE_NAME_CASE(CoMin)
+        INTRINSIC_SUBROUTINE_NAME_CASE(CoBroadcast)
+        INTRINSIC_SUBROUTINE_NAME_CASE(SyncAll)
+        INTRINSIC_SUBROUTINE_NAME_CASE(SyncImages)
         default : {
             throw LCompilersException("pickle: intrinsic_id not implemented");
         }
@@ -65,6 +71,18 @@ namespace IntrinsicImpureSubroutineRegistry {
             {&ExecuteCommandLine::instantiate_ExecuteCommandLine, &ExecuteCommandLine::verify_args}},
         {static_cast<int64_t>(IntrinsicImpureSubroutines::CpuTime),
             {&CpuTime::instantiate_CpuTime, &CpuTime::verify_args}},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoSum),
+            {nullptr, &CoSum::verify_args}},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoMax),
+            {nullptr, &CoMax::verify_args}},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoMin),
+            {nullptr, &CoMin::verify_args}},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoBroadcast),
+            {nullptr, &CoBroadcast::verify_args}},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::SyncAll),
+            {nullptr, &SyncAll::verify_args}},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::SyncImages),
+            {nullptr, &SyncImages::verify_args}},
     };
 
     static const std::map<int64_t, std::string>& intrinsic_subroutine_id_to_name = {
@@ -90,6 +108,18 @@ namespace IntrinsicImpureSubroutineRegistry {
             "execute_command_line"},
         {static_cast<int64_t>(IntrinsicImpureSubroutines::CpuTime),
             "cpu_time"},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoSum),
+            "co_sum"},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoMax),
+            "co_max"},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoMin),
+            "co_min"},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::CoBroadcast),
+            "co_broadcast"},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::SyncAll),
+            "sync_all"},
+        {static_cast<int64_t>(IntrinsicImpureSubroutines::SyncImages),
+            "sync_images"},
     };
 
 
@@ -106,6 +136,10 @@ namespace IntrinsicImpureSubroutineRegistry {
                 {"execute_command_line", &ExecuteCommandLine::create_ExecuteCommandLine},
                 {"cpu_time", &CpuTime::create_CpuTime},
                 {"date_and_time", &DateAndTime::create_DateAndTime},
+                {"co_sum", &CoSum::create_CoSum},
+                {"co_max", &CoMax::create_CoMax},
+                {"co_min", &CoMin::create_CoMin},
+                {"co_broadcast", &CoBroadcast::create_CoBroadcast},
     };
 
     static inline bool is_intrinsic_subroutine(const std::string& name) {
@@ -30,6 +30,12 @@ enum class IntrinsicImpureSubroutines : int64_t {
     Srand,
     SystemClock,
     DateAndTime,
+    CoSum,
+    CoMax,
+    CoMin,
+    CoBroadcast,
+    SyncAll,
+    SyncImages,
     // ...
 };
 
@@ -79,19 +85,25 @@ namespace RandomInit {
         fill_func_arg_sub("repeatable", arg_types[0], InOut);
         fill_func_arg_sub("image_distinct", arg_types[1], InOut);
         SymbolTable *fn_symtab_1 = al.make_new<SymbolTable>(fn_symtab);
-        Vec<ASR::expr_t*> args_1; args_1.reserve(al, 0);
-        ASR::expr_t *return_var_1 = b.Variable(fn_symtab_1, c_func_name,
-           ASRUtils::type_get_past_array(ASRUtils::type_get_past_allocatable(arg_types[0])),
-           ASRUtils::intent_return_var, ASR::abiType::BindC, false);
+        Vec<ASR::expr_t*> args_1; args_1.reserve(al, 2);
+        args_1.push_back(al, b.Variable(fn_symtab_1, "repeatable", arg_types[0],
+            ASR::intentType::In, ASR::abiType::BindC, true));
+        args_1.push_back(al, b.Variable(fn_symtab_1, "image_distinct", arg_types[1],
+            ASR::intentType::In, ASR::abiType::BindC, true));
         SetChar dep_1; dep_1.reserve(al, 1);
         Vec<ASR::stmt_t*> body_1; body_1.reserve(al, 1);
         ASR::symbol_t *s = make_ASR_Function_t(c_func_name, fn_symtab_1, dep_1, args_1,
-            body_1, return_var_1, ASR::abiType::BindC, ASR::deftypeType::Interface, s2c(al, c_func_name));
+            body_1, nullptr, ASR::abiType::BindC, ASR::deftypeType::Interface, s2c(al, c_func_name));
         fn_symtab->add_symbol(c_func_name, s);
         dep.push_back(al, s2c(al, c_func_name));
-        Vec<ASR::expr_t*> call_args; call_args.reserve(al, 0);
-        body.push_back(al, b.Assignment(args[0], b.Call(s, call_args, arg_types[0])));
-        body.push_back(al, b.Assignment(args[1], b.Call(s, call_args, arg_types[1])));
+        Vec<ASR::call_arg_t> call_args; call_args.reserve(al, 2);
+        for (size_t i = 0; i < 2; i++) {
+            ASR::call_arg_t call_arg;
+            call_arg.loc = loc;
+            call_arg.m_value = args[i];
+            call_args.push_back(al, call_arg);
+        }
+        body.push_back(al, b.SubroutineCall(s, call_args));
         ASR::symbol_t *new_symbol = make_ASR_Function_t(fn_name, fn_symtab, dep, args,
             body, nullptr, ASR::abiType::Source, ASR::deftypeType::Implementation, nullptr);
         scope->add_symbol(fn_name, new_symbol);
@@ -865,6 +877,161 @@ namespace CpuTime {
 
 } // namespace CpuTime
 
+/*
+ * Coarray collectives and image control. These have no ASR implementation,
+ * the backend lowers them to the coarray runtime (_lfortran_caf_*).
+ *
+ * co_sum, co_max, co_min and co_broadcast keep the variable, the result or
+ * source image (0 for all images) and the optional `stat` argument.
+ * `sync all` keeps the optional `stat`. `sync images` keeps the image set
+ * and `stat`; overload 1 is `sync images(*)` without an image set.
+ */
+
+static inline void verify_collective(const ASR::IntrinsicImpureSubroutine_t& x,
+        const std::string &name, diag::Diagnostics& diagnostics) {
+    ASRUtils::require_impl(x.n_args == 2 || x.n_args == 3, "Unexpected number of args, " +
+        name + " takes 2 or 3 arguments, found " + std::to_string(x.n_args), x.base.base.loc, diagnostics);
+    if (x.n_args >= 2) {
+        ASRUtils::require_impl(ASRUtils::is_integer(*ASRUtils::expr_type(x.m_args[1])),
+            "The image argument of " + name + " must be of integer type", x.base.base.loc, diagnostics);
+    }
+}
+
+static inline ASR::asr_t* create_collective(Allocator& al, const Location& loc,
+        Vec<ASR::expr_t*>& args, diag::Diagnostics& diag,
+        IntrinsicImpureSubroutines id, const std::string &name) {
+    ASRBuilder b(al, loc);
+    ASR::expr_t *a = args[0];
+    ASR::ttype_t *el_type = ASRUtils::type_get_past_array(ASRUtils::type_get_past_allocatable(
+        ASRUtils::type_get_past_pointer(ASRUtils::expr_type(a))));
+    int kind = ASRUtils::extract_kind_from_ttype_t(el_type);
+    if (!ASR::is_a<ASR::Var_t>(*a) && !ASR::is_a<ASR::ArrayItem_t>(*a) &&
+            !ASR::is_a<ASR::StructInstanceMember_t>(*a)) {
+        append_error(diag, "The first argument of `" + name + "` must be a variable", loc);
+        return nullptr;
+    }
+    if (id != IntrinsicImpureSubroutines::CoBroadcast) {
+        bool is_numeric = (ASRUtils::is_integer(*el_type) || ASRUtils::is_real(*el_type) ||
+            (ASRUtils::is_complex(*el_type) && id == IntrinsicImpureSubroutines::CoSum)) &&
+            (kind == 4 || kind == 8);
+        if (!is_numeric) {
+            append_error(diag, "`" + name + "` supports integer and real arguments of kind 4 and 8" +
+                std::string(id == IntrinsicImpureSubroutines::CoSum ? " and complex arguments" : "") +
+                ", found " + ASRUtils::type_to_str_fortran(el_type), loc);
+            return nullptr;
+        }
+    }
+    ASR::expr_t *image = args[1];
+    if (image == nullptr) {
+        if (id == IntrinsicImpureSubroutines::CoBroadcast) {
+            append_error(diag, "`co_broadcast` requires the `source_image` argument", loc);
+            return nullptr;
+        }
+        image = b.i32(0);
+    } else if (ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(image)) != 4) {
+        image = b.i2i_t(image, int32);
+    }
+    Vec<ASR::expr_t*> m_args; m_args.reserve(al, 3);
+    m_args.push_back(al, a);
+    m_args.push_back(al, image);
+    if (args.size() > 2 && args[2]) m_args.push_back(al, args[2]);
+    return ASR::make_IntrinsicImpureSubroutine_t(al, loc, static_cast<int64_t>(id), m_args.p, m_args.n, 0);
+}
+
+namespace CoSum {
+
+    static inline void verify_args(const ASR::IntrinsicImpureSubroutine_t& x, diag::Diagnostics& diagnostics) {
+        verify_collective(x, "co_sum", diagnostics);
+    }
+
+    static inline ASR::asr_t* create_CoSum(Allocator& al, const Location& loc, Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        return create_collective(al, loc, args, diag, IntrinsicImpureSubroutines::CoSum, "co_sum");
+    }
+
+} // namespace CoSum
+
+namespace CoMax {
+
+    static inline void verify_args(const ASR::IntrinsicImpureSubroutine_t& x, diag::Diagnostics& diagnostics) {
+        verify_collective(x, "co_max", diagnostics);
+    }
+
+    static inline ASR::asr_t* create_CoMax(Allocator& al, const Location& loc, Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        return create_collective(al, loc, args, diag, IntrinsicImpureSubroutines::CoMax, "co_max");
+    }
+
+} // namespace CoMax
+
+namespace CoMin {
+
+    static inline void verify_args(const ASR::IntrinsicImpureSubroutine_t& x, diag::Diagnostics& diagnostics) {
+        verify_collective(x, "co_min", diagnostics);
+    }
+
+    static inline ASR::asr_t* create_CoMin(Allocator& al, const Location& loc, Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        return create_collective(al, loc, args, diag, IntrinsicImpureSubroutines::CoMin, "co_min");
+    }
+
+} // namespace CoMin
+
+namespace CoBroadcast {
+
+    static inline void verify_args(const ASR::IntrinsicImpureSubroutine_t& x, diag::Diagnostics& diagnostics) {
+        verify_collective(x, "co_broadcast", diagnostics);
+    }
+
+    static inline ASR::asr_t* create_CoBroadcast(Allocator& al, const Location& loc, Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        return create_collective(al, loc, args, diag, IntrinsicImpureSubroutines::CoBroadcast, "co_broadcast");
+    }
+
+} // namespace CoBroadcast
+
+namespace SyncAll {
+
+    static inline void verify_args(const ASR::IntrinsicImpureSubroutine_t& x, diag::Diagnostics& diagnostics) {
+        ASRUtils::require_impl(x.n_args <= 1, "sync all takes at most 1 argument, found " +
+            std::to_string(x.n_args), x.base.base.loc, diagnostics);
+    }
+
+    static inline ASR::asr_t* create_SyncAll(Allocator& al, const Location& loc, Vec<ASR::expr_t*>& args, diag::Diagnostics& /*diag*/) {
+        return ASR::make_IntrinsicImpureSubroutine_t(al, loc, static_cast<int64_t>(IntrinsicImpureSubroutines::SyncAll), args.p, args.n, 0);
+    }
+
+} // namespace SyncAll
+
+namespace SyncImages {
+
+    static inline void verify_args(const ASR::IntrinsicImpureSubroutine_t& x, diag::Diagnostics& diagnostics) {
+        ASRUtils::require_impl(x.m_overload_id == 0 || x.m_overload_id == 1,
+            "Overload Id for sync images expected to be 0 or 1, found " + std::to_string(x.m_overload_id),
+            x.base.base.loc, diagnostics);
+        if (x.m_overload_id == 0) {
+            ASRUtils::require_impl(x.n_args >= 1 && x.n_args <= 2 &&
+                ASRUtils::is_integer(*ASRUtils::expr_type(x.m_args[0])),
+                "sync images expects an integer image set", x.base.base.loc, diagnostics);
+        } else {
+            ASRUtils::require_impl(x.n_args <= 1, "sync images(*) takes at most 1 argument, found " +
+                std::to_string(x.n_args), x.base.base.loc, diagnostics);
+        }
+    }
+
+    // args[0] is the image set, nullptr for `*`
+    static inline ASR::asr_t* create_SyncImages(Allocator& al, const Location& loc, Vec<ASR::expr_t*>& args, diag::Diagnostics& diag) {
+        ASR::expr_t *image_set = args[0];
+        if (image_set && (!ASRUtils::is_integer(*ASRUtils::expr_type(image_set)) ||
+                ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(image_set)) != 4)) {
+            append_error(diag, "The image set of `sync images` must be a default integer scalar or array", loc);
+            return nullptr;
+        }
+        Vec<ASR::expr_t*> m_args; m_args.reserve(al, 2);
+        if (image_set) m_args.push_back(al, image_set);
+        if (args[1]) m_args.push_back(al, args[1]);
+        return ASR::make_IntrinsicImpureSubroutine_t(al, loc, static_cast<int64_t>(IntrinsicImpureSubroutines::SyncImages),
+            m_args.p, m_args.n, image_set ? 0 : 1);
+    }
+
+} // namespace SyncImages
+
 } // namespace LCompilers::ASRUtils
 
 #endif // LIBASR_PASS_INTRINSIC_SUBROUTINES_H
@@ -0,0 +1,792 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_verify.h>
+#include <libasr/asr_builder.h>
+#include <libasr/pass/loop_interchange.h>
+#include <libasr/pass/pass_utils.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace LCompilers {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+
+This ASR pass reorders perfectly nested DoLoops so that the loop walking
+the contiguous (leftmost, as Fortran arrays are column-major) subscript of
+most array references runs innermost, and with --tile-size also tiles the
+two innermost loops of the nest. It runs only with --fast, before the
+do_loops pass lowers DoLoops.
+
+Converts:
+
+    do i = 1, n
+        do j = 1, m
+            b(i, j) = a(i - 1, j) + a(i + 1, j)
+        end do
+    end do
+
+to:
+
+    do j = 1, m
+        do i = 1, n
+            b(i, j) = a(i - 1, j) + a(i + 1, j)
+        end do
+    end do
+
+and with --tile-size 32 further to:
+
+    do __libasr_tile_j = 1, m, 32
+        __libasr_tile_end_j = __libasr_tile_j + 31
+        if (__libasr_tile_end_j > m) __libasr_tile_end_j = m
+        do __libasr_tile_i = 1, n, 32
+            __libasr_tile_end_i = __libasr_tile_i + 31
+            if (__libasr_tile_end_i > n) __libasr_tile_end_i = n
+            do j = __libasr_tile_j, __libasr_tile_end_j
+                do i = __libasr_tile_i, __libasr_tile_end_i
+                    b(i, j) = a(i - 1, j) + a(i + 1, j)
+                end do
+            end do
+        end do
+    end do
+
+A nest is transformed only if its loop bounds do not depend on each other
+or on the array elements it assigns, its innermost body consists of
+assignments to array elements, and its loop variables are not read after
+it. Subscripts of the form `i + c`, where `i` is a loop variable of the
+nest and `c` a constant or an expression the nest does not change, give
+the distance of the dependences between two references to an array; any
+other subscript leaves the distance unknown. The new loop order must keep
+every dependence pointing forward, and the tiled loops must not reverse a
+dependence carried by either of them.
+
+With --loop-transform-report every nest the pass changes is reported as a
+note.
+
+*/
+
+namespace {
+
+    const size_t max_nest_depth = 6;
+
+    // A DoLoop nest where every loop but the innermost contains just the
+    // next one, outermost first
+    struct LoopNest {
+        std::vector<ASR::DoLoop_t*> loops;
+        std::vector<ASR::symbol_t*> variables;
+        std::vector<int64_t> steps;
+    };
+
+    // Subscript `variables[loop] + offset + invariant`, where `loop` is -1
+    // if the subscript does not depend on the nest and `invariant` is an
+    // optional expression which the nest does not change
+    struct Subscript {
+        bool affine;
+        int loop;
+        int64_t offset;
+        ASR::expr_t* invariant;
+    };
+
+    struct ArrayAccess {
+        ASR::symbol_t* array;
+        bool is_write;
+        size_t contiguous_dim;
+        std::vector<Subscript> subscripts;
+    };
+
+    // Possible signs of the iteration distance of a dependence in one loop
+    enum Direction {
+        Backward = 1,
+        Equal = 2,
+        Forward = 4,
+        Any = 7
+    };
+
+    int get_loop_index(const LoopNest& nest, ASR::symbol_t* sym) {
+        for( size_t i = 0; i < nest.variables.size(); i++ ) {
+            if( nest.variables[i] == sym ) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    class NestVariableFinder: public ASR::BaseWalkVisitor<NestVariableFinder> {
+    public:
+        const LoopNest& nest;
+        bool found;
+
+        NestVariableFinder(const LoopNest& nest_): nest(nest_), found(false) {}
+
+        void visit_Var(const ASR::Var_t& x) {
+            if( get_loop_index(nest, x.m_v) >= 0 ) {
+                found = true;
+            }
+        }
+    };
+
+    bool depends_on_nest(const LoopNest& nest, ASR::expr_t* x) {
+        NestVariableFinder finder(nest);
+        finder.visit_expr(*x);
+        return finder.found;
+    }
+
+    bool is_same_invariant(ASR::expr_t* x, ASR::expr_t* y) {
+        if( x == nullptr || y == nullptr ) {
+            return x == y;
+        }
+        if( x->type != y->type ) {
+            return false;
+        }
+        switch( x->type ) {
+            case ASR::exprType::Var: {
+                return down_cast<ASR::Var_t>(x)->m_v == down_cast<ASR::Var_t>(y)->m_v;
+            }
+            case ASR::exprType::IntegerConstant: {
+                return down_cast<ASR::IntegerConstant_t>(x)->m_n ==
+                    down_cast<ASR::IntegerConstant_t>(y)->m_n;
+            }
+            case ASR::exprType::IntegerBinOp: {
+                ASR::IntegerBinOp_t* x_binop = down_cast<ASR::IntegerBinOp_t>(x);
+                ASR::IntegerBinOp_t* y_binop = down_cast<ASR::IntegerBinOp_t>(y);
+                return x_binop->m_op == y_binop->m_op &&
+                    is_same_invariant(x_binop->m_left, y_binop->m_left) &&
+                    is_same_invariant(x_binop->m_right, y_binop->m_right);
+            }
+            case ASR::exprType::Cast: {
+                ASR::Cast_t* x_cast = down_cast<ASR::Cast_t>(x);
+                ASR::Cast_t* y_cast = down_cast<ASR::Cast_t>(y);
+                return x_cast->m_kind == y_cast->m_kind &&
+                    ASRUtils::check_equal_type(x_cast->m_type, y_cast->m_type) &&
+                    is_same_invariant(x_cast->m_arg, y_cast->m_arg);
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    Subscript parse_subscript(const LoopNest& nest, ASR::expr_t* x) {
+        Subscript unknown = {false, -1, 0, nullptr};
+        if( !depends_on_nest(nest, x) ) {
+            if( is_a<ASR::IntegerConstant_t>(*x) ) {
+                return {true, -1, down_cast<ASR::IntegerConstant_t>(x)->m_n, nullptr};
+            }
+            return {true, -1, 0, x};
+        }
+        switch( x->type ) {
+            case ASR::exprType::Var: {
+                return {true, get_loop_index(nest, down_cast<ASR::Var_t>(x)->m_v), 0, nullptr};
+            }
+            case ASR::exprType::Cast: {
+                ASR::Cast_t* cast = down_cast<ASR::Cast_t>(x);
+                if( cast->m_kind == ASR::cast_kindType::IntegerToInteger ) {
+                    return parse_subscript(nest, cast->m_arg);
+                }
+                return unknown;
+            }
+            case ASR::exprType::IntegerBinOp: {
+                ASR::IntegerBinOp_t* binop = down_cast<ASR::IntegerBinOp_t>(x);
+                Subscript left = parse_subscript(nest, binop->m_left);
+                Subscript right = parse_subscript(nest, binop->m_right);
+                if( !left.affine || !right.affine ) {
+                    return unknown;
+                }
+                if( binop->m_op == ASR::binopType::Sub ) {
+                    if( right.loop >= 0 || right.invariant ) {
+                        return unknown;
+                    }
+                    return {true, left.loop, left.offset - right.offset, left.invariant};
+                }
+                if( binop->m_op == ASR::binopType::Add ) {
+                    if( (left.loop >= 0 && right.loop >= 0) ||
+                        (left.invariant && right.invariant) ) {
+                        return unknown;
+                    }
+                    return {true, std::max(left.loop, right.loop), left.offset + right.offset,
+                        left.invariant ? left.invariant : right.invariant};
+                }
+                return unknown;
+            }
+            default: {
+                return unknown;
+            }
+        }
+    }
+
+    /*
+    Checks that an expression only reads scalars and array elements
+    without side effects and collects the array elements it references.
+    */
+    class AccessCollector: public ASR::BaseWalkVisitor<AccessCollector> {
+    public:
+        const LoopNest& nest;
+        std::vector<ArrayAccess> accesses;
+        bool supported;
+        bool is_write;
+
+        AccessCollector(const LoopNest& nest_): nest(nest_),
+            supported(true), is_write(false) {}
+
+        void visit_expr(const ASR::expr_t& x) {
+            if( !supported ) {
+                return ;
+            }
+            switch( x.type ) {
+                case ASR::exprType::Var:
+                case ASR::exprType::IntegerConstant:
+                case ASR::exprType::RealConstant:
+                case ASR::exprType::LogicalConstant:
+                case ASR::exprType::IntegerBinOp:
+                case ASR::exprType::RealBinOp:
+                case ASR::exprType::ComplexBinOp:
+                case ASR::exprType::IntegerUnaryMinus:
+                case ASR::exprType::RealUnaryMinus:
+                case ASR::exprType::IntegerCompare:
+                case ASR::exprType::RealCompare:
+                case ASR::exprType::LogicalBinOp:
+                case ASR::exprType::LogicalNot:
+                case ASR::exprType::Cast:
+                case ASR::exprType::ComplexConstructor:
+                case ASR::exprType::IntrinsicElementalFunction:
+                case ASR::exprType::ArrayItem:
+                case ASR::exprType::ArraySize:
+                case ASR::exprType::ArrayBound: {
+                    break;
+                }
+                default: {
+                    supported = false;
+                    return ;
+                }
+            }
+            if( ASRUtils::is_array(ASRUtils::expr_type(&x)) ) {
+                supported = false;
+                return ;
+            }
+            ASR::BaseWalkVisitor<AccessCollector>::visit_expr(x);
+        }
+
+        void visit_ArrayItem(const ASR::ArrayItem_t& x) {
+            if( !is_a<ASR::Var_t>(*x.m_v) ) {
+                supported = false;
+                return ;
+            }
+            ASR::symbol_t* array = ASRUtils::symbol_get_past_external(
+                down_cast<ASR::Var_t>(x.m_v)->m_v);
+            if( !is_a<ASR::Variable_t>(*array) ||
+                ASRUtils::is_pointer(ASRUtils::symbol_type(array)) ||
+                down_cast<ASR::Variable_t>(array)->m_target_attr ) {
+                supported = false;
+                return ;
+            }
+            ArrayAccess access;
+            access.array = array;
+            access.is_write = is_write;
+            access.contiguous_dim = 0;
+            if( x.m_storage_format == ASR::arraystorageType::RowMajor ) {
+                access.contiguous_dim = x.n_args - 1;
+            }
+            bool is_write_copy = is_write;
+            is_write = false;
+            for( size_t i = 0; i < x.n_args; i++ ) {
+                if( x.m_args[i].m_left || x.m_args[i].m_step || !x.m_args[i].m_right ) {
+                    supported = false;
+                    return ;
+                }
+                visit_expr(*x.m_args[i].m_right);
+                access.subscripts.push_back(parse_subscript(nest, x.m_args[i].m_right));
+            }
+            is_write = is_write_copy;
+            accesses.push_back(access);
+        }
+
+        void visit_ArraySize(const ASR::ArraySize_t& x) {
+            if( x.m_dim ) {
+                visit_expr(*x.m_dim);
+            }
+        }
+
+        void visit_ArrayBound(const ASR::ArrayBound_t& x) {
+            if( x.m_dim ) {
+                visit_expr(*x.m_dim);
+            }
+        }
+    };
+
+    /*
+    Collects the variables referenced outside of `nest` while no enclosing
+    DoLoop defines them, i.e., the variables whose value after `nest` may
+    be observed.
+    */
+    class ExposedVariables: public ASR::BaseWalkVisitor<ExposedVariables> {
+    public:
+        ASR::stmt_t* nest;
+        std::map<ASR::symbol_t*, size_t> defined;
+        std::set<ASR::symbol_t*> exposed;
+
+        ExposedVariables(ASR::stmt_t* nest_): nest(nest_) {}
+
+        void visit_DoLoop(const ASR::DoLoop_t& x) {
+            if( &x.base == nest ) {
+                return ;
+            }
+            if( x.m_head.m_start ) {
+                visit_expr(*x.m_head.m_start);
+            }
+            if( x.m_head.m_end ) {
+                visit_expr(*x.m_head.m_end);
+            }
+            if( x.m_head.m_increment ) {
+                visit_expr(*x.m_head.m_increment);
+            }
+            ASR::symbol_t* variable = nullptr;
+            if( x.m_head.m_v && is_a<ASR::Var_t>(*x.m_head.m_v) ) {
+                variable = down_cast<ASR::Var_t>(x.m_head.m_v)->m_v;
+                defined[variable] += 1;
+            }
+            for( size_t i = 0; i < x.n_body; i++ ) {
+                visit_stmt(*x.m_body[i]);
+            }
+            for( size_t i = 0; i < x.n_orelse; i++ ) {
+                visit_stmt(*x.m_orelse[i]);
+            }
+            if( variable ) {
+                defined[variable] -= 1;
+            }
+        }
+
+        void visit_Var(const ASR::Var_t& x) {
+            if( defined[x.m_v] == 0 ) {
+                exposed.insert(x.m_v);
+            }
+        }
+    };
+
+    // Appends the directions of the dependence between `x` and `y` to
+    // `dependences`, unless the two never reference the same element
+    void add_dependence(const LoopNest& nest, const ArrayAccess& x,
+        const ArrayAccess& y, std::vector<std::vector<int>>& dependences) {
+        size_t depth = nest.loops.size();
+        std::vector<bool> known(depth, false);
+        std::vector<int64_t> distance(depth, 0);
+        size_t n_dims = std::min(x.subscripts.size(), y.subscripts.size());
+        for( size_t d = 0; d < n_dims; d++ ) {
+            const Subscript& sx = x.subscripts[d];
+            const Subscript& sy = y.subscripts[d];
+            if( !sx.affine || !sy.affine || sx.loop != sy.loop ||
+                !is_same_invariant(sx.invariant, sy.invariant) ) {
+                continue;
+            }
+            if( sx.loop < 0 ) {
+                if( sx.offset != sy.offset ) {
+                    return ;
+                }
+                continue;
+            }
+            // x at iteration I and y at iteration J reference the same
+            // element along this dimension if J - I == sx.offset - sy.offset
+            int64_t step = nest.steps[sx.loop];
+            int64_t delta = sx.offset - sy.offset;
+            if( delta % step != 0 ) {
+                return ;
+            }
+            delta /= step;
+            if( known[sx.loop] && distance[sx.loop] != delta ) {
+                return ;
+            }
+            known[sx.loop] = true;
+            distance[sx.loop] = delta;
+        }
+        std::vector<int> directions(depth, Direction::Any);
+        for( size_t k = 0; k < depth; k++ ) {
+            if( known[k] ) {
+                directions[k] = distance[k] > 0 ? Direction::Forward :
+                    (distance[k] == 0 ? Direction::Equal : Direction::Backward);
+            }
+        }
+        dependences.push_back(directions);
+    }
+
+    bool is_preserved(const std::vector<int>& signs, const std::vector<size_t>& order,
+        size_t band) {
+        int orientation = 0;
+        for( int sign: signs ) {
+            if( sign != 0 ) {
+                orientation = sign;
+                break;
+            }
+        }
+        for( size_t p = 0; p < order.size(); p++ ) {
+            int sign = orientation * signs[order[p]];
+            if( sign < 0 ) {
+                return false;
+            }
+            if( sign > 0 && p < band ) {
+                return true;
+            }
+        }
+        return true;
+    }
+
+    bool is_preserved(const std::vector<int>& directions, std::vector<int>& signs,
+        size_t level, const std::vector<size_t>& order, size_t band) {
+        if( level == signs.size() ) {
+            return is_preserved(signs, order, band);
+        }
+        for( int sign = -1; sign <= 1; sign++ ) {
+            if( directions[level] & (1 << (sign + 1)) ) {
+                signs[level] = sign;
+                if( !is_preserved(directions, signs, level + 1, order, band) ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Whether running the loops in `order` (outermost first) and tiling the
+    // loops from position `band` on executes every pair of dependent
+    // iterations in the original order
+    bool preserves_dependences(const std::vector<std::vector<int>>& dependences,
+        const std::vector<size_t>& order, size_t band) {
+        std::vector<int> signs(order.size(), 0);
+        for( const std::vector<int>& directions: dependences ) {
+            if( !is_preserved(directions, signs, 0, order, band) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string get_loop_names(const LoopNest& nest, const std::vector<size_t>& order,
+        size_t first) {
+        std::string names;
+        for( size_t p = first; p < order.size(); p++ ) {
+            if( !names.empty() ) {
+                names += ", ";
+            }
+            names += ASRUtils::symbol_name(nest.variables[order[p]]);
+        }
+        return "(" + names + ")";
+    }
+
+} // namespace
+
+class LoopInterchangeVisitor: public ASR::ASRPassBaseWalkVisitor<LoopInterchangeVisitor>
+{
+private:
+
+    Allocator& al;
+    const PassOptions& pass_options;
+    ASR::symbol_t* procedure;
+
+    bool is_nest_variable(ASR::expr_t* x) {
+        if( x == nullptr || !is_a<ASR::Var_t>(*x) ) {
+            return false;
+        }
+        ASR::symbol_t* sym = down_cast<ASR::Var_t>(x)->m_v;
+        if( !is_a<ASR::Variable_t>(*sym) ) {
+            return false;
+        }
+        ASR::Variable_t* variable = down_cast<ASR::Variable_t>(sym);
+        return variable->m_parent_symtab == current_scope &&
+            variable->m_intent == ASRUtils::intent_local &&
+            variable->m_storage == ASR::storage_typeType::Default &&
+            !variable->m_target_attr &&
+            is_a<ASR::Integer_t>(*variable->m_type);
+    }
+
+    bool get_nest(ASR::stmt_t* x, LoopNest& nest) {
+        while( is_a<ASR::DoLoop_t>(*x) ) {
+            ASR::DoLoop_t* loop = down_cast<ASR::DoLoop_t>(x);
+            if( loop->m_name || loop->n_orelse > 0 || !is_nest_variable(loop->m_head.m_v) ||
+                !loop->m_head.m_start || !loop->m_head.m_end ) {
+                return false;
+            }
+            int64_t step = 1;
+            if( loop->m_head.m_increment ) {
+                if( !is_a<ASR::IntegerConstant_t>(*loop->m_head.m_increment) ) {
+                    return false;
+                }
+                step = down_cast<ASR::IntegerConstant_t>(loop->m_head.m_increment)->m_n;
+                if( step == 0 ) {
+                    return false;
+                }
+            }
+            nest.loops.push_back(loop);
+            nest.variables.push_back(down_cast<ASR::Var_t>(loop->m_head.m_v)->m_v);
+            nest.steps.push_back(step);
+            if( loop->n_body != 1 || !is_a<ASR::DoLoop_t>(*loop->m_body[0]) ) {
+                break;
+            }
+            x = loop->m_body[0];
+        }
+        return nest.loops.size() >= 2 && nest.loops.size() <= max_nest_depth;
+    }
+
+    // Loop bounds must be the same on every entry to a loop of the nest
+    bool has_invariant_bounds(const LoopNest& nest) {
+        for( ASR::DoLoop_t* loop: nest.loops ) {
+            for( ASR::expr_t* bound: {loop->m_head.m_start, loop->m_head.m_end} ) {
+                AccessCollector collector(nest);
+                collector.visit_expr(*bound);
+                if( !collector.supported || !collector.accesses.empty() ||
+                    depends_on_nest(nest, bound) ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool collect_accesses(const LoopNest& nest, std::vector<ArrayAccess>& accesses) {
+        ASR::DoLoop_t* innermost = nest.loops.back();
+        AccessCollector collector(nest);
+        for( size_t i = 0; i < innermost->n_body; i++ ) {
+            ASR::stmt_t* stmt = innermost->m_body[i];
+            if( !is_a<ASR::Assignment_t>(*stmt) ) {
+                return false;
+            }
+            ASR::Assignment_t* assignment = down_cast<ASR::Assignment_t>(stmt);
+            if( assignment->m_overloaded || !is_a<ASR::ArrayItem_t>(*assignment->m_target) ) {
+                return false;
+            }
+            collector.is_write = true;
+            collector.visit_expr(*assignment->m_target);
+            collector.is_write = false;
+            collector.visit_expr(*assignment->m_value);
+            if( !collector.supported ) {
+                return false;
+            }
+        }
+        accesses = collector.accesses;
+        return true;
+    }
+
+    bool has_exposed_variables(const LoopNest& nest, ASR::stmt_t* x) {
+        ExposedVariables uses(x);
+        SymbolTable* symtab = ASRUtils::symbol_symtab(procedure);
+        ASR::stmt_t** body = nullptr;
+        size_t n_body = 0;
+        if( is_a<ASR::Program_t>(*procedure) ) {
+            body = down_cast<ASR::Program_t>(procedure)->m_body;
+            n_body = down_cast<ASR::Program_t>(procedure)->n_body;
+        } else {
+            body = down_cast<ASR::Function_t>(procedure)->m_body;
+            n_body = down_cast<ASR::Function_t>(procedure)->n_body;
+        }
+        for( size_t i = 0; i < n_body; i++ ) {
+            uses.visit_stmt(*body[i]);
+        }
+        for( auto& item: symtab->get_scope() ) {
+            if( is_a<ASR::Function_t>(*item.second) || is_a<ASR::Block_t>(*item.second) ) {
+                uses.visit_symbol(*item.second);
+            }
+        }
+        for( ASR::symbol_t* variable: nest.variables ) {
+            if( uses.exposed.find(variable) != uses.exposed.end() ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Replaces `do u` and `do v`, the two innermost loops of a nest, by
+    // loops over tiles of `tile_size` iterations and loops within a tile
+    ASR::stmt_t* tile(ASR::DoLoop_t* outer, ASR::DoLoop_t* inner) {
+        const Location& loc = outer->base.base.loc;
+        ASRUtils::ASRBuilder b(al, loc);
+        ASRUtils::ExprStmtDuplicator duplicator(al);
+        std::vector<ASR::expr_t*> tile_starts, tile_ends;
+        for( ASR::DoLoop_t* loop: {outer, inner} ) {
+            ASR::ttype_t* type = ASRUtils::expr_type(loop->m_head.m_v);
+            std::string name = ASRUtils::symbol_name(
+                down_cast<ASR::Var_t>(loop->m_head.m_v)->m_v);
+            std::string start_name = current_scope->get_unique_name("__libasr_tile_" + name);
+            tile_starts.push_back(PassUtils::create_auxiliary_variable(loc, start_name,
+                al, current_scope, ASRUtils::duplicate_type(al, type)));
+            std::string end_name = current_scope->get_unique_name("__libasr_tile_end_" + name);
+            tile_ends.push_back(PassUtils::create_auxiliary_variable(loc, end_name,
+                al, current_scope, ASRUtils::duplicate_type(al, type)));
+        }
+        std::vector<ASR::stmt_t*> tile_loops;
+        ASR::stmt_t* body = &outer->base;
+        ASR::DoLoop_t* loops[2] = {outer, inner};
+        for( int i = 1; i >= 0; i-- ) {
+            ASR::do_loop_head_t& head = loops[i]->m_head;
+            ASR::ttype_t* type = ASRUtils::expr_type(head.m_v);
+            ASR::expr_t* start = tile_starts[i];
+            ASR::expr_t* end = tile_ends[i];
+            ASR::expr_t* last = duplicator.duplicate_expr(head.m_end);
+            body = b.DoLoop(start, head.m_start, head.m_end, {
+                b.Assignment(end, b.Add(start, b.i_t(pass_options.tile_size - 1, type))),
+                b.If(b.Gt(end, last), {
+                    b.Assignment(end, duplicator.duplicate_expr(head.m_end))
+                }, {}),
+                body
+            }, b.i_t(pass_options.tile_size, type));
+            head.m_start = start;
+            head.m_end = end;
+            head.m_increment = nullptr;
+        }
+        return body;
+    }
+
+    bool can_tile(const LoopNest& nest, const std::vector<size_t>& order,
+        const std::vector<std::vector<int>>& dependences) {
+        size_t depth = order.size();
+        for( size_t p = depth - 2; p < depth; p++ ) {
+            ASR::do_loop_head_t& head = nest.loops[order[p]]->m_head;
+            ASR::ttype_t* type = ASRUtils::expr_type(head.m_v);
+            if( nest.steps[order[p]] != 1 ||
+                !ASRUtils::check_equal_type(type, ASRUtils::expr_type(head.m_start)) ||
+                !ASRUtils::check_equal_type(type, ASRUtils::expr_type(head.m_end)) ) {
+                return false;
+            }
+        }
+        return preserves_dependences(dependences, order, depth - 2);
+    }
+
+    // Reorders and tiles the nest starting at `x`, returns whether it
+    // changed anything
+    bool transform_nest(ASR::stmt_t*& x) {
+        if( procedure == nullptr || ASRUtils::symbol_symtab(procedure) != current_scope ) {
+            return false;
+        }
+        LoopNest nest;
+        std::vector<ArrayAccess> accesses;
+        if( !get_nest(x, nest) || !has_invariant_bounds(nest) ||
+            !collect_accesses(nest, accesses) || has_exposed_variables(nest, x) ) {
+            return false;
+        }
+        size_t depth = nest.loops.size();
+
+        std::vector<std::vector<int>> dependences;
+        for( size_t i = 0; i < accesses.size(); i++ ) {
+            for( size_t j = i; j < accesses.size(); j++ ) {
+                if( accesses[i].array == accesses[j].array &&
+                    (accesses[i].is_write || accesses[j].is_write) ) {
+                    add_dependence(nest, accesses[i], accesses[j], dependences);
+                }
+            }
+        }
+
+        // Move the loop walking the contiguous subscript of the most
+        // references innermost
+        std::vector<size_t> contiguous(depth, 0);
+        for( const ArrayAccess& access: accesses ) {
+            const Subscript& subscript = access.subscripts[access.contiguous_dim];
+            if( subscript.affine && subscript.loop >= 0 ) {
+                contiguous[subscript.loop] += 1;
+            }
+        }
+        size_t innermost = depth - 1;
+        for( size_t k = 0; k < depth; k++ ) {
+            if( contiguous[k] > contiguous[innermost] ) {
+                innermost = k;
+            }
+        }
+        std::vector<size_t> order;
+        for( size_t k = 0; k < depth; k++ ) {
+            if( k != innermost ) {
+                order.push_back(k);
+            }
+        }
+        order.push_back(innermost);
+        bool interchange = innermost != depth - 1 &&
+            preserves_dependences(dependences, order, depth);
+        if( !interchange ) {
+            for( size_t k = 0; k < depth; k++ ) {
+                order[k] = k;
+            }
+        }
+        bool tiling = pass_options.tile_size > 1 && can_tile(nest, order, dependences);
+        if( !interchange && !tiling ) {
+            return false;
+        }
+
+        std::string scope_name = ASRUtils::symbol_name(procedure);
+        if( interchange ) {
+            std::vector<size_t> identity(depth);
+            for( size_t k = 0; k < depth; k++ ) {
+                identity[k] = k;
+            }
+            if( pass_options.loop_transform_report ) {
+                PassUtils::add_report_note(pass_options, scope_name + ": loop nest " +
+                    get_loop_names(nest, identity, 0) + " interchanged to " +
+                    get_loop_names(nest, order, 0), nest.loops[0]->base.base.loc);
+            }
+            std::vector<ASR::do_loop_head_t> heads;
+            for( ASR::DoLoop_t* loop: nest.loops ) {
+                heads.push_back(loop->m_head);
+            }
+            for( size_t p = 0; p < depth; p++ ) {
+                nest.loops[p]->m_head = heads[order[p]];
+            }
+        }
+        if( tiling ) {
+            if( pass_options.loop_transform_report ) {
+                PassUtils::add_report_note(pass_options, scope_name + ": loops " +
+                    get_loop_names(nest, order, depth - 2) + " tiled by " +
+                    std::to_string(pass_options.tile_size), nest.loops[0]->base.base.loc);
+            }
+            ASR::stmt_t* tiled = tile(nest.loops[depth - 2], nest.loops[depth - 1]);
+            if( depth == 2 ) {
+                x = tiled;
+            } else {
+                nest.loops[depth - 3]->m_body[0] = tiled;
+            }
+        }
+        return true;
+    }
+
+public:
+
+    LoopInterchangeVisitor(Allocator& al_, const PassOptions& pass_options_):
+        al(al_), pass_options(pass_options_), procedure(nullptr) {}
+
+    void transform_stmts(ASR::stmt_t**& m_body, size_t& n_body) {
+        for( size_t i = 0; i < n_body; i++ ) {
+            if( is_a<ASR::DoLoop_t>(*m_body[i]) && transform_nest(m_body[i]) ) {
+                continue;
+            }
+            visit_stmt(*m_body[i]);
+        }
+    }
+
+    void visit_Program(const ASR::Program_t& x) {
+        ASR::symbol_t* procedure_copy = procedure;
+        procedure = (ASR::symbol_t*) &x;
+        ASR::ASRPassBaseWalkVisitor<LoopInterchangeVisitor>::visit_Program(x);
+        procedure = procedure_copy;
+    }
+
+    void visit_Function(const ASR::Function_t& x) {
+        ASR::symbol_t* procedure_copy = procedure;
+        procedure = (ASR::symbol_t*) &x;
+        ASR::ASRPassBaseWalkVisitor<LoopInterchangeVisitor>::visit_Function(x);
+        procedure = procedure_copy;
+    }
+
+};
+
+void pass_loop_interchange(Allocator &al, ASR::TranslationUnit_t &unit,
+                           const LCompilers::PassOptions& pass_options) {
+    if( !pass_options.fast ) {
+        return ;
+    }
+    LoopInterchangeVisitor v(al, pass_options);
+    v.visit_TranslationUnit(unit);
+}
+
+
+} // namespace LCompilers
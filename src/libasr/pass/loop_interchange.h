@@ -0,0 +1,14 @@
+#ifndef LIBASR_PASS_LOOP_INTERCHANGE_H
+#define LIBASR_PASS_LOOP_INTERCHANGE_H
+
+#include <libasr/asr.h>
+#include <libasr/utils.h>
+
+namespace LCompilers {
+
+    void pass_loop_interchange(Allocator &al, ASR::TranslationUnit_t &unit,
+                               const PassOptions &pass_options);
+
+} // namespace LCompilers
+
+#endif // LIBASR_PASS_LOOP_INTERCHANGE_H
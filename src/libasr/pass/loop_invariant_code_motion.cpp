@@ -0,0 +1,431 @@
+#include <libasr/asr.h>
+#include <libasr/containers.h>
+#include <libasr/exception.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_verify.h>
+#include <libasr/pass/loop_invariant_code_motion.h>
+#include <libasr/pass/dataflow.h>
+#include <libasr/pass/pass_utils.h>
+
+#include <cstring>
+#include <string>
+
+
+namespace LCompilers {
+
+using ASR::down_cast;
+using ASR::is_a;
+
+/*
+
+This ASR pass moves arithmetic that computes the same value on every
+iteration of a loop in front of the loop. An operand is invariant in a
+loop when none of its reaching definitions (see pass/dataflow.h) lies in
+the loop, or when it is an intent(in) scalar. Only operations that cannot
+trap are moved (no integer division), as the loop may not run at all.
+Loops are handled outermost first, so an expression leaves the whole nest
+whenever it can.
+
+Converts:
+
+    do while (i + 1 <= n - 1)
+        i = i + 1
+        a(i) = b(i) * (2.0 * x) + c(j * n + 1)
+    end do
+
+to:
+
+    __libasr_licm_1 = n - 1
+    __libasr_licm_2 = 2.0 * x
+    __libasr_licm_3 = j * n + 1
+    do while (i + 1 <= __libasr_licm_1)
+        i = i + 1
+        a(i) = b(i) * __libasr_licm_2 + c(__libasr_licm_3)
+    end do
+
+*/
+
+namespace {
+
+    bool is_scalar_number(ASR::ttype_t* type) {
+        return type && (is_a<ASR::Integer_t>(*type) || is_a<ASR::Real_t>(*type));
+    }
+
+    bool is_operation(ASR::expr_t* x) {
+        switch( x->type ) {
+            case ASR::exprType::IntegerBinOp:
+            case ASR::exprType::RealBinOp:
+            case ASR::exprType::IntegerUnaryMinus:
+            case ASR::exprType::RealUnaryMinus:
+            case ASR::exprType::Cast: {
+                return true;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+}
+
+class InvariantHoister: public ASR::BaseExprReplacer<InvariantHoister> {
+
+    private:
+
+        Allocator& al;
+        SymbolTable* scope;
+        const std::set<ASR::symbol_t*>& tracked;
+        const DataFlow::ReachingDefinitions& reaching_definitions;
+        const DataFlow::DominatorTree& dominator_tree;
+        std::map<ASR::symbol_t*, ASR::stmt_t*>& hoisted_from;
+        ASR::stmt_t* loop;
+        std::map<std::string, ASR::expr_t*> temporaries;
+
+        bool is_invariant_operand(ASR::symbol_t* sym) {
+            auto hoisted = hoisted_from.find(sym);
+            if( hoisted != hoisted_from.end() ) {
+                return dominator_tree.contains(hoisted->second, loop);
+            }
+            if( tracked.find(sym) != tracked.end() ) {
+                const std::set<ASR::stmt_t*>* defs = reaching_definitions.reaching(
+                    stmt, slot, sym);
+                if( defs == nullptr ) {
+                    return false;
+                }
+                for( ASR::stmt_t* def: *defs ) {
+                    if( def && dominator_tree.contains(loop, def) ) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            return DataFlow::is_invariant_argument(sym);
+        }
+
+        // Checks that `x` computes the same value on every iteration of
+        // `loop`, and builds a key identifying the computation
+        bool is_invariant(ASR::expr_t* x, bool& reads_variable, std::string& key) {
+            if( !is_scalar_number(ASRUtils::expr_type(x)) ) {
+                return false;
+            }
+            std::string kind = "_" + std::to_string(
+                ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(x)));
+            switch( x->type ) {
+                case ASR::exprType::IntegerConstant: {
+                    key = std::to_string(down_cast<ASR::IntegerConstant_t>(x)->m_n) + kind;
+                    return true;
+                }
+                case ASR::exprType::RealConstant: {
+                    double r = down_cast<ASR::RealConstant_t>(x)->m_r;
+                    uint64_t bits;
+                    std::memcpy(&bits, &r, sizeof(bits));
+                    key = "r" + std::to_string(bits) + kind;
+                    return true;
+                }
+                case ASR::exprType::Var: {
+                    ASR::symbol_t* sym = down_cast<ASR::Var_t>(x)->m_v;
+                    if( !is_invariant_operand(sym) ) {
+                        return false;
+                    }
+                    reads_variable = true;
+                    key = ASRUtils::symbol_name(sym);
+                    return true;
+                }
+                case ASR::exprType::IntegerBinOp:
+                case ASR::exprType::RealBinOp: {
+                    ASR::expr_t *left, *right, *value;
+                    ASR::binopType op;
+                    if( is_a<ASR::IntegerBinOp_t>(*x) ) {
+                        ASR::IntegerBinOp_t* e = down_cast<ASR::IntegerBinOp_t>(x);
+                        left = e->m_left, right = e->m_right, op = e->m_op, value = e->m_value;
+                        if( op == ASR::binopType::Div ) {
+                            return false;
+                        }
+                    } else {
+                        ASR::RealBinOp_t* e = down_cast<ASR::RealBinOp_t>(x);
+                        left = e->m_left, right = e->m_right, op = e->m_op, value = e->m_value;
+                    }
+                    if( value || (op != ASR::binopType::Add && op != ASR::binopType::Sub &&
+                        op != ASR::binopType::Mul && op != ASR::binopType::Div) ) {
+                        return false;
+                    }
+                    std::string left_key, right_key;
+                    if( !is_invariant(left, reads_variable, left_key) ||
+                        !is_invariant(right, reads_variable, right_key) ) {
+                        return false;
+                    }
+                    key = "(" + left_key + std::to_string((int)op) + right_key + ")" + kind;
+                    return true;
+                }
+                case ASR::exprType::IntegerUnaryMinus:
+                case ASR::exprType::RealUnaryMinus: {
+                    ASR::expr_t* arg = is_a<ASR::IntegerUnaryMinus_t>(*x) ?
+                        down_cast<ASR::IntegerUnaryMinus_t>(x)->m_arg :
+                        down_cast<ASR::RealUnaryMinus_t>(x)->m_arg;
+                    ASR::expr_t* value = is_a<ASR::IntegerUnaryMinus_t>(*x) ?
+                        down_cast<ASR::IntegerUnaryMinus_t>(x)->m_value :
+                        down_cast<ASR::RealUnaryMinus_t>(x)->m_value;
+                    std::string arg_key;
+                    if( value || !is_invariant(arg, reads_variable, arg_key) ) {
+                        return false;
+                    }
+                    key = "-" + arg_key + kind;
+                    return true;
+                }
+                case ASR::exprType::Cast: {
+                    ASR::Cast_t* e = down_cast<ASR::Cast_t>(x);
+                    std::string arg_key;
+                    if( e->m_value || (e->m_kind != ASR::cast_kindType::IntegerToInteger &&
+                        e->m_kind != ASR::cast_kindType::IntegerToReal &&
+                        e->m_kind != ASR::cast_kindType::RealToReal) ||
+                        !is_invariant(e->m_arg, reads_variable, arg_key) ) {
+                        return false;
+                    }
+                    key = "cast" + std::to_string((int)e->m_kind) + "(" + arg_key + ")" + kind;
+                    return true;
+                }
+                default: {
+                    return false;
+                }
+            }
+        }
+
+    public:
+
+        ASR::stmt_t* stmt;
+        DataFlow::ExpressionSlot slot;
+        Vec<ASR::stmt_t*> hoisted;
+        bool dry_run, changed;
+
+        InvariantHoister(Allocator& al_, SymbolTable* scope_,
+            const std::set<ASR::symbol_t*>& tracked_,
+            const DataFlow::ReachingDefinitions& reaching_definitions_,
+            const DataFlow::DominatorTree& dominator_tree_,
+            std::map<ASR::symbol_t*, ASR::stmt_t*>& hoisted_from_, ASR::stmt_t* loop_):
+            al(al_), scope(scope_), tracked(tracked_),
+            reaching_definitions(reaching_definitions_), dominator_tree(dominator_tree_),
+            hoisted_from(hoisted_from_), loop(loop_), stmt(nullptr), slot({nullptr, false}),
+            dry_run(true), changed(false) {
+            call_replacer_on_value = false;
+            hoisted.reserve(al, 1);
+        }
+
+        void replace_expr(ASR::expr_t* x) {
+            if( x == nullptr ) {
+                return ;
+            }
+            bool reads_variable = false;
+            std::string key;
+            if( is_operation(x) && is_invariant(x, reads_variable, key) && reads_variable ) {
+                changed = true;
+                if( dry_run ) {
+                    return ;
+                }
+                auto it = temporaries.find(key);
+                if( it == temporaries.end() ) {
+                    std::string name = scope->get_unique_name("__libasr_licm_" +
+                        std::to_string(hoisted_from.size() + 1));
+                    ASR::expr_t* temporary = PassUtils::create_auxiliary_variable(
+                        x->base.loc, name, al, scope, ASRUtils::expr_type(x));
+                    hoisted.push_back(al, ASRUtils::STMT(ASR::make_Assignment_t(
+                        al, x->base.loc, temporary, x, nullptr)));
+                    hoisted_from[down_cast<ASR::Var_t>(temporary)->m_v] = loop;
+                    it = temporaries.insert({key, temporary}).first;
+                }
+                *current_expr = it->second;
+                return ;
+            }
+            ASR::BaseExprReplacer<InvariantHoister>::replace_expr(x);
+        }
+
+};
+
+class LoopInvariantCodeMotionVisitor:
+    public ASR::BaseWalkVisitor<LoopInvariantCodeMotionVisitor> {
+
+    private:
+
+        Allocator& al;
+
+        template <typename F>
+        void for_each_statement(ASR::stmt_t** body, size_t n_body, F& f) {
+            for( size_t i = 0; i < n_body; i++ ) {
+                f(body[i]);
+                for_each_nested_statement(body[i], f);
+            }
+        }
+
+        template <typename F>
+        void for_each_nested_statement(ASR::stmt_t* stmt, F& f) {
+            switch( stmt->type ) {
+                case ASR::stmtType::If: {
+                    ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                    for_each_statement(x->m_body, x->n_body, f);
+                    for_each_statement(x->m_orelse, x->n_orelse, f);
+                    break;
+                }
+                case ASR::stmtType::WhileLoop: {
+                    ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                    for_each_statement(x->m_body, x->n_body, f);
+                    for_each_statement(x->m_orelse, x->n_orelse, f);
+                    break;
+                }
+                case ASR::stmtType::DoLoop: {
+                    ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                    for_each_statement(x->m_body, x->n_body, f);
+                    for_each_statement(x->m_orelse, x->n_orelse, f);
+                    break;
+                }
+                case ASR::stmtType::Select: {
+                    ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                    for( size_t j = 0; j < x->n_body; j++ ) {
+                        if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                            ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                            for_each_statement(c->m_body, c->n_body, f);
+                        } else {
+                            ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                            for_each_statement(c->m_body, c->n_body, f);
+                        }
+                    }
+                    for_each_statement(x->m_default, x->n_default, f);
+                    break;
+                }
+                default: {
+                    break;
+                }
+            }
+        }
+
+        struct Procedure {
+            SymbolTable* scope;
+            const std::set<ASR::symbol_t*>& tracked;
+            const DataFlow::ReachingDefinitions& reaching_definitions;
+            const DataFlow::DominatorTree& dominator_tree;
+            std::map<ASR::symbol_t*, ASR::stmt_t*> hoisted_from;
+        };
+
+        Vec<ASR::stmt_t*> hoist(Procedure& procedure, ASR::stmt_t* loop) {
+            InvariantHoister hoister(al, procedure.scope, procedure.tracked,
+                procedure.reaching_definitions, procedure.dominator_tree,
+                procedure.hoisted_from, loop);
+            auto visit = [&](ASR::stmt_t* stmt) {
+                for( DataFlow::ExpressionSlot& slot: DataFlow::get_expression_slots(stmt) ) {
+                    // The bounds of the loop itself are evaluated before it
+                    if( stmt == loop && !slot.at_head ) {
+                        continue;
+                    }
+                    const auto& flows = slot.at_head ? procedure.reaching_definitions.head :
+                        procedure.reaching_definitions.in;
+                    auto flow = flows.find(stmt);
+                    if( flow == flows.end() || !flow->second.reachable ) {
+                        continue;
+                    }
+                    hoister.stmt = stmt;
+                    hoister.slot = slot;
+                    DataFlow::rewrite_expression(al, slot.expr, hoister);
+                }
+            };
+            visit(loop);
+            for_each_nested_statement(loop, visit);
+            return hoister.hoisted;
+        }
+
+        void process_body(Procedure& procedure, ASR::stmt_t**& body, size_t& n_body) {
+            Vec<ASR::stmt_t*> new_body;
+            new_body.reserve(al, n_body);
+            for( size_t i = 0; i < n_body; i++ ) {
+                ASR::stmt_t* stmt = body[i];
+                if( is_a<ASR::WhileLoop_t>(*stmt) || is_a<ASR::DoLoop_t>(*stmt) ) {
+                    Vec<ASR::stmt_t*> hoisted = hoist(procedure, stmt);
+                    for( size_t j = 0; j < hoisted.size(); j++ ) {
+                        new_body.push_back(al, hoisted[j]);
+                    }
+                }
+                switch( stmt->type ) {
+                    case ASR::stmtType::If: {
+                        ASR::If_t* x = down_cast<ASR::If_t>(stmt);
+                        process_body(procedure, x->m_body, x->n_body);
+                        process_body(procedure, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::WhileLoop: {
+                        ASR::WhileLoop_t* x = down_cast<ASR::WhileLoop_t>(stmt);
+                        process_body(procedure, x->m_body, x->n_body);
+                        process_body(procedure, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::DoLoop: {
+                        ASR::DoLoop_t* x = down_cast<ASR::DoLoop_t>(stmt);
+                        process_body(procedure, x->m_body, x->n_body);
+                        process_body(procedure, x->m_orelse, x->n_orelse);
+                        break;
+                    }
+                    case ASR::stmtType::Select: {
+                        ASR::Select_t* x = down_cast<ASR::Select_t>(stmt);
+                        for( size_t j = 0; j < x->n_body; j++ ) {
+                            if( is_a<ASR::CaseStmt_t>(*x->m_body[j]) ) {
+                                ASR::CaseStmt_t* c = down_cast<ASR::CaseStmt_t>(x->m_body[j]);
+                                process_body(procedure, c->m_body, c->n_body);
+                            } else {
+                                ASR::CaseStmt_Range_t* c = down_cast<ASR::CaseStmt_Range_t>(x->m_body[j]);
+                                process_body(procedure, c->m_body, c->n_body);
+                            }
+                        }
+                        process_body(procedure, x->m_default, x->n_default);
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+                new_body.push_back(al, stmt);
+            }
+            body = new_body.p;
+            n_body = new_body.size();
+        }
+
+        void optimize(SymbolTable* scope, ASR::stmt_t**& body, size_t& n_body) {
+            if( n_body == 0 || !DataFlow::is_structured(scope, body, n_body) ) {
+                return ;
+            }
+            std::set<ASR::symbol_t*> tracked = DataFlow::get_tracked_variables(
+                scope, body, n_body);
+            DataFlow::ReachingDefinitions reaching_definitions(tracked);
+            reaching_definitions.analyze(body, n_body);
+            if( !reaching_definitions.valid ) {
+                return ;
+            }
+            DataFlow::DominatorTree dominator_tree(body, n_body);
+            Procedure procedure{scope, tracked, reaching_definitions, dominator_tree, {}};
+            process_body(procedure, body, n_body);
+        }
+
+    public:
+
+        LoopInvariantCodeMotionVisitor(Allocator& al_): al(al_) {}
+
+        void visit_Program(const ASR::Program_t& x) {
+            for( auto& item: x.m_symtab->get_scope() ) {
+                visit_symbol(*item.second);
+            }
+            ASR::Program_t& xx = const_cast<ASR::Program_t&>(x);
+            optimize(xx.m_symtab, xx.m_body, xx.n_body);
+        }
+
+        void visit_Function(const ASR::Function_t& x) {
+            for( auto& item: x.m_symtab->get_scope() ) {
+                visit_symbol(*item.second);
+            }
+            ASR::Function_t& xx = const_cast<ASR::Function_t&>(x);
+            optimize(xx.m_symtab, xx.m_body, xx.n_body);
+        }
+
+};
+
+void pass_loop_invariant_code_motion(Allocator &al, ASR::TranslationUnit_t &unit,
+                                     const PassOptions &/*pass_options*/) {
+    LoopInvariantCodeMotionVisitor v(al);
+    v.visit_TranslationUnit(unit);
+}
+
+} // namespace LCompilers
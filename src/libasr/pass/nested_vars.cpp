@@ -5,6 +5,7 @@
 #include <libasr/asr_verify.h>
 #include <libasr/pass/nested_vars.h>
 #include <libasr/pass/pass_utils.h>
+#include <algorithm>
 #include <set>
 
 namespace LCompilers {
@@ -81,7 +82,40 @@ preserve the assignments in case of intent out. This highlighted in the line
 where we change to `call_subroutine B(global_context_module_for_A_k)`.
 
 
-This Pass is designed using three classes:
+Passing captured variables by reference:
+
+Whenever possible the captured variables are not copied into a global
+module at all. Instead they are passed to the nested functions as extra
+dummy arguments (the static chain), so that host associated state stays
+in the frame of the caller. For the example above, B becomes
+
+    subroutine B(l, k, w, x, y)
+        x += y
+        w += l
+        p += k
+    end
+
+    call_subroutine B(k, k, w, x, y)
+
+A nested function that calls a sibling forwards its own chain arguments,
+so the chain of a function is the closure of the variables used by it
+and by every sibling it calls. This keeps nested functions reentrant,
+which is needed for recursion and for calls from OpenMP threads (the
+OpenMP pass runs pass_nested_vars_static_chain before outlining parallel
+regions, so that the chain becomes part of the shared data). It is
+done by LiftNestedVars for a host when all of the following hold, and
+the host falls back to the global module otherwise:
+
+* The nested functions have no nested functions of their own, are not
+  elemental, and have a Source ABI.
+* Every captured variable is a non-allocatable, non-pointer, non-optional
+  scalar of integer, real, complex or logical type.
+* Nested functions are only ever called directly (they are not passed as
+  procedure arguments) and only from within the host.
+* Nested functions do not return arrays, and the captured variables do
+  not appear in their declarations (e.g. as array bounds).
+
+This Pass is designed using three classes (after LiftNestedVars):
 1. NestedVarVisitor - This captures the variables for each function that
                       are used by nested functions and creates a map of
                       function_syms -> {variables_syms}.
@@ -94,6 +128,328 @@ This Pass is designed using three classes:
 
 */
 
+class NestedProcedureUseCounter : public ASR::BaseWalkVisitor<NestedProcedureUseCounter>
+{
+public:
+    std::map<ASR::symbol_t*, size_t> calls;
+    std::set<ASR::symbol_t*> non_call_references;
+
+    void visit_Var(const ASR::Var_t &x) {
+        ASR::symbol_t* sym = ASRUtils::symbol_get_past_external(x.m_v);
+        if ( ASR::is_a<ASR::Function_t>(*sym) ) {
+            non_call_references.insert(sym);
+        }
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        calls[ASRUtils::symbol_get_past_external(x.m_name)]++;
+        ASR::BaseWalkVisitor<NestedProcedureUseCounter>::visit_FunctionCall(x);
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
+        calls[ASRUtils::symbol_get_past_external(x.m_name)]++;
+        ASR::BaseWalkVisitor<NestedProcedureUseCounter>::visit_SubroutineCall(x);
+    }
+};
+
+class HostAssociationCollector : public ASR::BaseWalkVisitor<HostAssociationCollector>
+{
+public:
+    SymbolTable* host_scope;
+    std::set<ASR::symbol_t*> captured;
+    std::set<ASR::symbol_t*> callees;
+    bool calls_procedure_variable = false;
+    // A host variable or procedure in a declaration also appears in the
+    // function type, which cannot refer to a dummy argument
+    bool captured_in_type = false;
+    bool in_type = false;
+
+    HostAssociationCollector(SymbolTable* host_scope_): host_scope(host_scope_) {}
+
+    void visit_Var(const ASR::Var_t &x) {
+        if ( ASR::is_a<ASR::Variable_t>(*x.m_v) &&
+             ASRUtils::symbol_parent_symtab(x.m_v) == host_scope ) {
+            captured.insert(x.m_v);
+            captured_in_type |= in_type;
+        }
+    }
+
+    void visit_ttype(const ASR::ttype_t &x) {
+        bool in_type_copy = in_type;
+        in_type = true;
+        ASR::BaseWalkVisitor<HostAssociationCollector>::visit_ttype(x);
+        in_type = in_type_copy;
+    }
+
+    void record_call(ASR::symbol_t* name) {
+        if ( ASRUtils::symbol_parent_symtab(name) != host_scope ) {
+            return;
+        }
+        if ( ASR::is_a<ASR::Function_t>(*name) ) {
+            callees.insert(name);
+            // e.g. `integer :: x(n)` calls the getter `__lcompilers_get_n`
+            captured_in_type |= in_type;
+        } else if ( ASR::is_a<ASR::Variable_t>(*name) ) {
+            calls_procedure_variable = true;
+        }
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        record_call(x.m_name);
+        ASR::BaseWalkVisitor<HostAssociationCollector>::visit_FunctionCall(x);
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
+        record_call(x.m_name);
+        ASR::BaseWalkVisitor<HostAssociationCollector>::visit_SubroutineCall(x);
+    }
+};
+
+class HostVarRedirector : public ASR::BaseWalkVisitor<HostVarRedirector>
+{
+public:
+    std::map<ASR::symbol_t*, ASR::symbol_t*> &host_var_to_dummy;
+
+    HostVarRedirector(std::map<ASR::symbol_t*, ASR::symbol_t*> &host_var_to_dummy_):
+        host_var_to_dummy(host_var_to_dummy_) {}
+
+    void visit_Var(const ASR::Var_t &x) {
+        auto it = host_var_to_dummy.find(x.m_v);
+        if ( it != host_var_to_dummy.end() ) {
+            const_cast<ASR::Var_t&>(x).m_v = it->second;
+        }
+    }
+};
+
+class StaticChainAppender : public ASR::BaseWalkVisitor<StaticChainAppender>
+{
+public:
+    Allocator &al;
+    SymbolTable* host_scope;
+    std::map<ASR::symbol_t*, std::vector<ASR::symbol_t*>> &chain;
+    std::map<ASR::symbol_t*, std::map<ASR::symbol_t*, ASR::symbol_t*>> &chain_dummies;
+    // The nested function whose body is being visited, nullptr in the host
+    ASR::symbol_t* frame = nullptr;
+
+    StaticChainAppender(Allocator &al_, SymbolTable* host_scope_,
+        std::map<ASR::symbol_t*, std::vector<ASR::symbol_t*>> &chain_,
+        std::map<ASR::symbol_t*, std::map<ASR::symbol_t*, ASR::symbol_t*>> &chain_dummies_):
+        al(al_), host_scope(host_scope_), chain(chain_), chain_dummies(chain_dummies_) {}
+
+    void visit_Function(const ASR::Function_t &x) {
+        ASR::symbol_t* frame_copy = frame;
+        if ( x.m_symtab->parent == host_scope ) {
+            frame = (ASR::symbol_t*) &x;
+        }
+        ASR::BaseWalkVisitor<StaticChainAppender>::visit_Function(x);
+        frame = frame_copy;
+    }
+
+    template <typename T>
+    void append_chain(T &x) {
+        auto it = chain.find(ASRUtils::symbol_get_past_external(x.m_name));
+        if ( it == chain.end() || it->second.empty() ) {
+            return;
+        }
+        Vec<ASR::call_arg_t> args;
+        args.reserve(al, x.n_args + it->second.size());
+        for ( size_t i = 0; i < x.n_args; i++ ) {
+            args.push_back(al, x.m_args[i]);
+        }
+        for ( ASR::symbol_t* host_var: it->second ) {
+            ASR::symbol_t* actual = frame ? chain_dummies[frame][host_var] : host_var;
+            LCOMPILERS_ASSERT(actual != nullptr);
+            ASR::call_arg_t arg;
+            arg.loc = x.base.base.loc;
+            arg.m_value = ASRUtils::EXPR(ASR::make_Var_t(al, x.base.base.loc, actual));
+            args.push_back(al, arg);
+        }
+        x.m_args = args.p;
+        x.n_args = args.size();
+    }
+
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        ASR::BaseWalkVisitor<StaticChainAppender>::visit_FunctionCall(x);
+        append_chain(const_cast<ASR::FunctionCall_t&>(x));
+    }
+
+    void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
+        ASR::BaseWalkVisitor<StaticChainAppender>::visit_SubroutineCall(x);
+        append_chain(const_cast<ASR::SubroutineCall_t&>(x));
+    }
+};
+
+class LiftNestedVars
+{
+public:
+    Allocator &al;
+    NestedProcedureUseCounter &tu_uses;
+
+    LiftNestedVars(Allocator &al_, NestedProcedureUseCounter &tu_uses_):
+        al(al_), tu_uses(tu_uses_) {}
+
+    static bool is_liftable(ASR::symbol_t* sym) {
+        ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(sym);
+        if ( v->m_value_attr || v->m_type_declaration ||
+             v->m_presence == ASR::presenceType::Optional ) {
+            return false;
+        }
+        ASR::ttype_t* type = v->m_type;
+        if ( ASRUtils::is_array(type) || ASRUtils::is_allocatable(type) ||
+             ASRUtils::is_pointer(type) ) {
+            return false;
+        }
+        return ASRUtils::is_integer(*type) || ASRUtils::is_real(*type) ||
+            ASRUtils::is_complex(*type) || ASRUtils::is_logical(*type);
+    }
+
+    void visit_TranslationUnit(ASR::TranslationUnit_t &x) {
+        for ( auto &item: x.m_symtab->get_scope() ) {
+            if ( ASR::is_a<ASR::Program_t>(*item.second) ) {
+                lift(item.second, ASR::down_cast<ASR::Program_t>(item.second)->m_symtab);
+            } else if ( ASR::is_a<ASR::Function_t>(*item.second) ) {
+                lift(item.second, ASR::down_cast<ASR::Function_t>(item.second)->m_symtab);
+            } else if ( ASR::is_a<ASR::Module_t>(*item.second) ) {
+                ASR::Module_t* m = ASR::down_cast<ASR::Module_t>(item.second);
+                for ( auto &item2: m->m_symtab->get_scope() ) {
+                    if ( ASR::is_a<ASR::Function_t>(*item2.second) ) {
+                        lift(item2.second, ASR::down_cast<ASR::Function_t>(
+                            item2.second)->m_symtab);
+                    }
+                }
+            }
+        }
+    }
+
+    // Passes the variables captured by the nested functions of `host` as
+    // extra arguments. Returns false, leaving the host untouched, if the
+    // host does not meet the conditions listed at the top of this file.
+    bool lift(ASR::symbol_t* host, SymbolTable* host_scope) {
+        std::vector<ASR::Function_t*> procs;
+        for ( auto &item: host_scope->get_scope() ) {
+            if ( !ASR::is_a<ASR::Function_t>(*item.second) ) {
+                continue;
+            }
+            ASR::Function_t* f = ASR::down_cast<ASR::Function_t>(item.second);
+            ASR::FunctionType_t* f_type = ASRUtils::get_FunctionType(f);
+            if ( f_type->m_elemental || f_type->m_abi != ASR::abiType::Source ||
+                 f_type->m_deftype != ASR::deftypeType::Implementation ||
+                 (f->m_return_var && ASRUtils::is_array(ASRUtils::expr_type(f->m_return_var))) ||
+                 tu_uses.non_call_references.count(item.second) ) {
+                return false;
+            }
+            for ( auto &item2: f->m_symtab->get_scope() ) {
+                if ( ASR::is_a<ASR::Function_t>(*item2.second) ) {
+                    return false;
+                }
+            }
+            procs.push_back(f);
+        }
+        if ( procs.empty() ) {
+            return false;
+        }
+
+        // Every call of a nested function must be visible from the host
+        NestedProcedureUseCounter host_uses;
+        host_uses.visit_symbol(*host);
+        for ( ASR::Function_t* f: procs ) {
+            ASR::symbol_t* f_sym = (ASR::symbol_t*) f;
+            if ( host_uses.calls[f_sym] != tu_uses.calls[f_sym] ) {
+                return false;
+            }
+        }
+
+        std::map<ASR::symbol_t*, std::set<ASR::symbol_t*>> captured;
+        std::map<ASR::symbol_t*, std::set<ASR::symbol_t*>> callees;
+        for ( ASR::Function_t* f: procs ) {
+            HostAssociationCollector c(host_scope);
+            c.visit_Function(*f);
+            if ( c.calls_procedure_variable || c.captured_in_type ) {
+                return false;
+            }
+            captured[(ASR::symbol_t*) f] = c.captured;
+            callees[(ASR::symbol_t*) f] = c.callees;
+        }
+        bool changed = true;
+        while ( changed ) {
+            changed = false;
+            for ( auto &it: callees ) {
+                std::set<ASR::symbol_t*> &f_captured = captured[it.first];
+                for ( ASR::symbol_t* callee: it.second ) {
+                    for ( ASR::symbol_t* host_var: captured[callee] ) {
+                        changed |= f_captured.insert(host_var).second;
+                    }
+                }
+            }
+        }
+        for ( auto &it: captured ) {
+            for ( ASR::symbol_t* host_var: it.second ) {
+                if ( !is_liftable(host_var) ) {
+                    return false;
+                }
+            }
+        }
+
+        std::map<ASR::symbol_t*, std::vector<ASR::symbol_t*>> chain;
+        std::map<ASR::symbol_t*, std::map<ASR::symbol_t*, ASR::symbol_t*>> chain_dummies;
+        for ( ASR::Function_t* f: procs ) {
+            ASR::symbol_t* f_sym = (ASR::symbol_t*) f;
+            // Order the chain by name so that the generated code is deterministic
+            std::vector<ASR::symbol_t*> &f_chain = chain[f_sym];
+            f_chain.assign(captured[f_sym].begin(), captured[f_sym].end());
+            std::sort(f_chain.begin(), f_chain.end(),
+                [](ASR::symbol_t* a, ASR::symbol_t* b) {
+                    return std::string(ASRUtils::symbol_name(a)) <
+                        std::string(ASRUtils::symbol_name(b));
+                });
+            if ( f_chain.empty() ) {
+                continue;
+            }
+
+            ASR::FunctionType_t* f_type = ASRUtils::get_FunctionType(f);
+            Vec<ASR::expr_t*> args;
+            args.reserve(al, f->n_args + f_chain.size());
+            Vec<ASR::ttype_t*> arg_types;
+            arg_types.reserve(al, f->n_args + f_chain.size());
+            for ( size_t i = 0; i < f->n_args; i++ ) {
+                args.push_back(al, f->m_args[i]);
+                arg_types.push_back(al, f_type->m_arg_types[i]);
+            }
+            std::map<ASR::symbol_t*, ASR::symbol_t*> &host_var_to_dummy = chain_dummies[f_sym];
+            for ( ASR::symbol_t* host_var: f_chain ) {
+                ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(host_var);
+                std::string name = f->m_symtab->get_unique_name(v->m_name, false);
+                ASR::intentType intent = ASR::intentType::InOut;
+                if ( v->m_storage == ASR::storage_typeType::Parameter ||
+                     v->m_intent == ASR::intentType::In ) {
+                    intent = ASR::intentType::In;
+                }
+                ASR::symbol_t* dummy = ASR::down_cast<ASR::symbol_t>(
+                    ASRUtils::make_Variable_t_util(al, v->base.base.loc, f->m_symtab,
+                        s2c(al, name), nullptr, 0, intent, nullptr, nullptr,
+                        ASR::storage_typeType::Default, ASRUtils::duplicate_type(al, v->m_type),
+                        nullptr, ASR::abiType::Source, ASR::accessType::Public,
+                        ASR::presenceType::Required, false, v->m_target_attr));
+                f->m_symtab->add_symbol(name, dummy);
+                host_var_to_dummy[host_var] = dummy;
+                args.push_back(al, ASRUtils::EXPR(ASR::make_Var_t(al, v->base.base.loc, dummy)));
+                arg_types.push_back(al, ASRUtils::duplicate_type(al, v->m_type));
+            }
+            f->m_args = args.p;
+            f->n_args = args.size();
+            f_type->m_arg_types = arg_types.p;
+            f_type->n_arg_types = arg_types.size();
+
+            HostVarRedirector r(host_var_to_dummy);
+            r.visit_Function(*f);
+        }
+
+        StaticChainAppender a(al, host_scope, chain, chain_dummies);
+        a.visit_symbol(*host);
+        return true;
+    }
+};
+
 class NestedVarVisitor : public ASR::BaseWalkVisitor<NestedVarVisitor>
 {
 public:
@@ -816,8 +1172,17 @@ public:
     }
 };
 
-void pass_nested_vars(Allocator &al, ASR::TranslationUnit_t &unit,
+void pass_nested_vars_static_chain(Allocator &al, ASR::TranslationUnit_t &unit,
     const LCompilers::PassOptions& /*pass_options*/) {
+    NestedProcedureUseCounter u;
+    u.visit_TranslationUnit(unit);
+    LiftNestedVars l(al, u);
+    l.visit_TranslationUnit(unit);
+}
+
+void pass_nested_vars(Allocator &al, ASR::TranslationUnit_t &unit,
+    const LCompilers::PassOptions& pass_options) {
+    pass_nested_vars_static_chain(al, unit, pass_options);
     NestedVarVisitor v(al);
     v.visit_TranslationUnit(unit);
     ReplaceNestedVisitor w(al, v.nesting_map);
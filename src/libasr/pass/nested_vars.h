@@ -9,6 +9,11 @@ namespace LCompilers {
     void pass_nested_vars(Allocator &al, ASR::TranslationUnit_t &unit,
                                 const PassOptions &pass_options);
 
+    // Only the reentrant part of pass_nested_vars: passes variables captured
+    // by nested functions as extra arguments wherever that is possible.
+    void pass_nested_vars_static_chain(Allocator &al, ASR::TranslationUnit_t &unit,
+                                const PassOptions &pass_options);
+
 } // namespace LCompilers
 
 #endif // LIBASR_PASS_NESTED_VARS_H
@@ -1,4 +1,7 @@
+#include <float.h>
 #include <limits.h>
+#include <functional>
+#include <set>
 #include <libasr/asr.h>
 #include <libasr/containers.h>
 #include <libasr/exception.h>
@@ -7,6 +10,7 @@
 #include <libasr/asr_builder.h>
 #include <libasr/pass/pass_utils.h>
 #include <libasr/pass/replace_openmp.h>
+#include <libasr/pass/nested_vars.h>
 
 namespace LCompilers {
 
@@ -21,6 +25,11 @@ class ReplaceArrayPhysicalCast: public ASR::BaseExprReplacer<ReplaceArrayPhysica
             al(al_) {}
 
         void replace_ArrayPhysicalCast(ASR::ArrayPhysicalCast_t* x) {
+            if (!ASR::is_a<ASR::Var_t>(*x->m_arg)) {
+                // e.g. `abs(a - 1)`, the variables are reached below
+                ASR::BaseExprReplacer<ReplaceArrayPhysicalCast>::replace_ArrayPhysicalCast(x);
+                return;
+            }
             ASRUtils::ASRBuilder b(al, x->base.base.loc);
             ASR::symbol_t* sym = ASR::down_cast<ASR::Var_t>(x->m_arg)->m_v;
             std::string sym_name = ASRUtils::symbol_name(sym);
@@ -313,6 +322,36 @@ class ReductionVariableVisitor: public ASR::CallReplacerOnExpressionsVisitor<Red
         }
 };
 
+// Redirects references to an array reduction variable to the private
+// partial array of the current thread
+class ReplaceReductionArray: public ASR::BaseExprReplacer<ReplaceReductionArray> {
+    public:
+        std::map<ASR::symbol_t*, ASR::symbol_t*> &partials;
+
+        ReplaceReductionArray(std::map<ASR::symbol_t*, ASR::symbol_t*> &partials_) :
+            partials(partials_) {}
+
+        void replace_Var(ASR::Var_t* x) {
+            if (partials.find(x->m_v) != partials.end()) {
+                x->m_v = partials[x->m_v];
+            }
+        }
+};
+
+class ReplaceReductionArrayVisitor: public ASR::CallReplacerOnExpressionsVisitor<ReplaceReductionArrayVisitor> {
+    private:
+        ReplaceReductionArray replacer;
+
+    public:
+        ReplaceReductionArrayVisitor(std::map<ASR::symbol_t*, ASR::symbol_t*> &partials_) :
+            replacer(partials_) {}
+
+        void call_replacer() {
+            replacer.current_expr = current_expr;
+            replacer.replace_expr(*current_expr);
+        }
+};
+
 class ReplaceExpression: public ASR::BaseExprReplacer<ReplaceExpression> {
     private:
         Allocator& al;
@@ -358,6 +397,23 @@ class DoConcurrentStatementVisitor : public ASR::CallReplacerOnExpressionsVisito
         // Create a module add it to current_scope->parent symtab
         // Add func to that module symtab
         // Overwrite External symbol to x's asr_owner's symtab
+        if (ASR::is_a<ASR::ExternalSymbol_t>(*x.m_name)) {
+            // e.g. a module procedure used by the program, which keeps
+            // referring to it outside of the loop
+            ASR::ExternalSymbol_t* ext = ASR::down_cast<ASR::ExternalSymbol_t>(x.m_name);
+            ASR::symbol_t* func_sym = current_scope->get_symbol(ext->m_name);
+            if (func_sym == nullptr) {
+                func_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(
+                    al, x.base.base.loc, current_scope, ext->m_name, ext->m_external,
+                    ext->m_module_name, ext->m_scope_names, ext->n_scope_names,
+                    ext->m_original_name, ext->m_access));
+                current_scope->add_symbol(ext->m_name, func_sym);
+            }
+            LCOMPILERS_ASSERT(ASRUtils::symbol_get_past_external(func_sym) == ext->m_external);
+            x_copy->m_name = func_sym;
+            x_copy->m_original_name = func_sym;
+            return;
+        }
         if (ASR::is_a<ASR::Program_t>(*ASR::down_cast<ASR::symbol_t>(asr_owner))) {
             ASRUtils::SymbolDuplicator duplicator(al);
             SymbolTable* module_scope = al.make_new<SymbolTable>(current_scope->parent);
@@ -415,6 +471,24 @@ class DoConcurrentStatementVisitor : public ASR::CallReplacerOnExpressionsVisito
                 func_sym = current_scope->get_symbol(fn->m_name);
             } else if (ASR::is_a<ASR::Module_t>(*ASR::down_cast<ASR::symbol_t>(asr_owner))) {
                 func_sym = current_scope->resolve_symbol(fn->m_name);
+                if (func_sym == nullptr) {
+                    // a module procedure that is not imported in this scope
+                    ASR::Module_t* module = ASR::down_cast<ASR::Module_t>(
+                                            ASR::down_cast<ASR::symbol_t>(asr_owner));
+                    ASR::asr_t* ext_fn = ASR::make_ExternalSymbol_t(
+                                            al,
+                                            x.base.base.loc,
+                                            current_scope,
+                                            fn->m_name,
+                                            ASRUtils::symbol_get_past_external(x.m_name),
+                                            module->m_name,
+                                            nullptr,
+                                            0,
+                                            fn->m_name,
+                                            ASR::accessType::Public);
+                    current_scope->add_symbol(fn->m_name, ASR::down_cast<ASR::symbol_t>(ext_fn));
+                    func_sym = current_scope->get_symbol(fn->m_name);
+                }
             }
         }
         LCOMPILERS_ASSERT(func_sym != nullptr);
@@ -448,6 +522,56 @@ class InvolvedSymbolsCollector:
         }
 };
 
+// Decides whether the iterations of a `do concurrent` can be handed to the
+// runtime thread pool by `--auto-parallel`: the body must not do I/O, leave
+// the loop, (de)allocate or call anything that is not pure
+class AutoParallelChecker:
+    public ASR::BaseWalkVisitor<AutoParallelChecker>
+{
+    public:
+        bool is_parallelizable = true;
+
+        void visit_Print(const ASR::Print_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileOpen(const ASR::FileOpen_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileClose(const ASR::FileClose_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileRead(const ASR::FileRead_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileWrite(const ASR::FileWrite_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileBackspace(const ASR::FileBackspace_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileRewind(const ASR::FileRewind_t &/*x*/) { is_parallelizable = false; }
+        void visit_FileInquire(const ASR::FileInquire_t &/*x*/) { is_parallelizable = false; }
+        void visit_Flush(const ASR::Flush_t &/*x*/) { is_parallelizable = false; }
+        void visit_Stop(const ASR::Stop_t &/*x*/) { is_parallelizable = false; }
+        void visit_ErrorStop(const ASR::ErrorStop_t &/*x*/) { is_parallelizable = false; }
+        void visit_Return(const ASR::Return_t &/*x*/) { is_parallelizable = false; }
+        void visit_GoTo(const ASR::GoTo_t &/*x*/) { is_parallelizable = false; }
+        void visit_Allocate(const ASR::Allocate_t &/*x*/) { is_parallelizable = false; }
+        void visit_ExplicitDeallocate(const ASR::ExplicitDeallocate_t &/*x*/) { is_parallelizable = false; }
+        void visit_IntrinsicImpureSubroutine(const ASR::IntrinsicImpureSubroutine_t &/*x*/) { is_parallelizable = false; }
+        void visit_IntrinsicImpureFunction(const ASR::IntrinsicImpureFunction_t &/*x*/) { is_parallelizable = false; }
+
+        void check_callee(ASR::symbol_t* callee) {
+            callee = ASRUtils::symbol_get_past_external(callee);
+            if (!ASR::is_a<ASR::Function_t>(*callee)) {
+                is_parallelizable = false;
+                return;
+            }
+            ASR::FunctionType_t* type = ASRUtils::get_FunctionType(callee);
+            if (!type->m_pure && !type->m_elemental) {
+                is_parallelizable = false;
+            }
+        }
+
+        void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+            check_callee(x.m_name);
+            ASR::BaseWalkVisitor<AutoParallelChecker>::visit_FunctionCall(x);
+        }
+
+        void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
+            check_callee(x.m_name);
+            ASR::BaseWalkVisitor<AutoParallelChecker>::visit_SubroutineCall(x);
+        }
+};
+
 // Replaces all the symbols used inside the DoConcurrentLoop region with the
 // same symbols passed as argument to the function
 class ReplaceSymbols: public ASR::BaseExprReplacer<ReplaceSymbols> {
@@ -534,6 +658,12 @@ class DoConcurrentVisitor :
             pass_result_allocatable.n = 0;
         }
 
+        // `--auto-parallel` without `--openmp` runs the loops on the thread
+        // pool of the LFortran runtime instead of libgomp
+        bool use_thread_pool() {
+            return pass_options.auto_parallel && !pass_options.openmp;
+        }
+
         void transform_stmts(ASR::stmt_t **&m_body, size_t &n_body) {
             bool remove_original_statement_copy = remove_original_statement;
             Vec<ASR::stmt_t*> body;
@@ -746,7 +876,9 @@ class DoConcurrentVisitor :
             return module_sym;
         }
 
-        std::pair<std::string, ASR::symbol_t*> create_thread_data_module(std::map<std::string, ASR::ttype_t*> &involved_symbols, const Location& loc) {
+        // Arrays and the scalars in `by_reference` are stored as `type(c_ptr)`
+        std::pair<std::string, ASR::symbol_t*> create_thread_data_module(std::map<std::string, ASR::ttype_t*> &involved_symbols, const Location& loc,
+                const std::set<std::string> &by_reference = {}) {
             SymbolTable* current_scope_copy = current_scope;
             while (current_scope->parent != nullptr) {
                 current_scope = current_scope->parent;
@@ -778,7 +910,7 @@ class DoConcurrentVisitor :
             for (auto it: involved_symbols) {
                 ASR::ttype_t* sym_type = nullptr;
                 bool is_array = ASRUtils::is_array(it.second);
-                sym_type = is_array ? b.CPtr() : it.second;
+                sym_type = (is_array || by_reference.count(it.first)) ? b.CPtr() : it.second;
                 b.VariableDeclaration(current_scope, it.first, sym_type, ASR::intentType::Local);
                 if (is_array) {
                     // add lbound and ubound variables for array
@@ -821,6 +953,36 @@ class DoConcurrentVisitor :
             return module_symbols;
         }
 
+        // The loop over the iterations [first, last] of a chunk. It keeps the
+        // loop hint of `do_loop`, so that the chunks are vectorized like the
+        // serial loop would be.
+        ASR::stmt_t* create_chunk_loop(ASRUtils::ASRBuilder &b, const ASR::DoConcurrentLoop_t &do_loop,
+                    ASR::expr_t* I, ASR::expr_t* first, ASR::expr_t* last,
+                    std::vector<ASR::stmt_t*> &body) {
+            if (!do_loop.m_hint) {
+                return b.DoLoop(I, first, last, body);
+            }
+            const Location &loc = do_loop.base.base.loc;
+            ASR::LoopHint_t* hint = ASR::down_cast<ASR::LoopHint_t>(do_loop.m_hint);
+            ASR::do_loop_head_t head;
+            head.loc = I->base.loc;
+            head.m_v = I;
+            head.m_start = first;
+            head.m_end = last;
+            head.m_increment = nullptr;
+            Vec<ASR::do_loop_head_t> heads; heads.reserve(al, 1);
+            heads.push_back(al, head);
+            Vec<ASR::stmt_t*> m_body;
+            m_body.from_pointer_n_copy(al, body.data(), body.size());
+            // the chunk is already running on its own thread
+            ASR::loop_hint_t* chunk_hint = ASR::down_cast<ASR::loop_hint_t>(ASR::make_LoopHint_t(al,
+                loc, hint->m_independent, hint->m_vectorize, hint->m_vectorize_width,
+                hint->m_aligned, hint->n_aligned, true));
+            return ASRUtils::STMT(ASR::make_DoConcurrentLoop_t(al, loc, heads.p, heads.n,
+                nullptr, 0, nullptr, 0, nullptr, 0, m_body.p, m_body.n,
+                ASR::schedule_typeType::ScheduleStatic, nullptr, chunk_hint));
+        }
+
         ASR::symbol_t* create_lcompilers_function(const Location &loc, const ASR::DoConcurrentLoop_t &do_loop,
                     std::map<std::string, ASR::ttype_t*> &involved_symbols, std::string thread_data_module_name,
                     std::vector<ASR::symbol_t*> module_symbols) {
@@ -857,12 +1019,25 @@ class DoConcurrentVisitor :
             Vec<ASR::stmt_t*> body; body.reserve(al, involved_symbols.size() + 1);
             body.push_back(al, b.CPtrToPointer(data_expr, tdata_expr));
 
-            Vec<ASR::expr_t*> args; args.reserve(al, 1);
+            Vec<ASR::expr_t*> args; args.reserve(al, 3);
             args.push_back(al, data_expr);
 
+            // the thread pool hands out the range [lo, hi) of the flattened
+            // iterations: `integer(c_int64_t), value :: lo, hi`
+            ASR::expr_t* lo_expr = nullptr;
+            ASR::expr_t* hi_expr = nullptr;
+            if (use_thread_pool()) {
+                ASR::ttype_t* range_type = ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 8));
+                lo_expr = b.Variable(current_scope, "lo", range_type, ASR::intentType::Unspecified, ASR::abiType::BindC, true);
+                hi_expr = b.Variable(current_scope, "hi", range_type, ASR::intentType::Unspecified, ASR::abiType::BindC, true);
+                args.push_back(al, lo_expr);
+                args.push_back(al, hi_expr);
+            }
+
             // declare involved variables
             for (auto it: involved_symbols) {
-                LCOMPILERS_ASSERT(b.Variable(current_scope, it.first, it.second, ASR::intentType::Local, ASR::abiType::BindC));
+                [[maybe_unused]] ASR::expr_t* var = b.Variable(current_scope, it.first, it.second, ASR::intentType::Local, ASR::abiType::BindC);
+                LCOMPILERS_ASSERT(var != nullptr);
             }
 
             // add external symbols to struct members, we need those for `data%n = n`
@@ -895,6 +1070,7 @@ class DoConcurrentVisitor :
                 if (ASRUtils::is_array(sym_type)) {
                     ASR::Array_t* array_type = ASR::down_cast<ASR::Array_t>(ASRUtils::type_get_past_pointer(sym_type));
                     Vec<ASR::expr_t*> size_args; size_args.reserve(al, array_type->n_dims);
+                    Vec<ASR::expr_t*> lbound_args; lbound_args.reserve(al, array_type->n_dims);
                     for (size_t i = 0; i < array_type->n_dims; i++) {
                         std::string ubound_name = std::string(ASRUtils::symbol_name(thread_data_sym)) + "_ubound_" + it.first + "_" + std::to_string(i);
                         ASR::symbol_t* ubound_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(al, loc,
@@ -911,35 +1087,43 @@ class DoConcurrentVisitor :
                         ASR::expr_t* lbound = ASRUtils::EXPR(ASR::make_StructInstanceMember_t(al, loc, tdata_expr,
                             lbound_sym, ASRUtils::symbol_type(lbound_sym), nullptr));
                         size_args.push_back(al, b.Add(b.Sub(ubound, lbound), b.i32(1)));
+                        lbound_args.push_back(al, lbound);
                     }
                     ASR::expr_t* shape = ASRUtils::EXPR(ASRUtils::make_ArrayConstructor_t_util(al, loc,
                         size_args.p, size_args.n, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), ASR::arraystorageType::ColMajor));
-                    // call c_f_pointer(tdata%<sym>, <sym>, [ubound-lbound+1])
+                    ASR::expr_t* lower_bounds = ASRUtils::EXPR(ASRUtils::make_ArrayConstructor_t_util(al, loc,
+                        lbound_args.p, lbound_args.n, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), ASR::arraystorageType::ColMajor));
+                    // call c_f_pointer(tdata%<sym>, <sym>, [ubound-lbound+1], [lbound])
                     body.push_back(al, b.CPtrToPointer(
                         ASRUtils::EXPR(ASR::make_StructInstanceMember_t(al, loc, tdata_expr,
                         sym, ASRUtils::symbol_type(sym), nullptr)),
                         b.Var(current_scope->get_symbol(it.first)),
-                        shape
+                        shape, lower_bounds
                     ));
                 }
             }
 
             // Partitioning logic
             // declare start, end, num_threads, chunk, leftovers, thread_num
+            // the iteration space is counted in 64 bits, so that grids with
+            // more than 2^31 points do not overflow
             // TODO: find a better way to declare these
             ASR::ttype_t* int_type = ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4));
-            ASR::expr_t* start = b.Variable(current_scope, current_scope->get_unique_name("start"), int_type, ASR::intentType::Local, ASR::abiType::BindC);
-            ASR::expr_t* end = b.Variable(current_scope, current_scope->get_unique_name("end"), int_type, ASR::intentType::Local, ASR::abiType::BindC);
+            ASR::ttype_t* i64_type = ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 8));
+            ASR::expr_t* start = b.Variable(current_scope, current_scope->get_unique_name("start"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
+            ASR::expr_t* end = b.Variable(current_scope, current_scope->get_unique_name("end"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
             ASR::expr_t* num_threads = b.Variable(current_scope, current_scope->get_unique_name("num_threads"), int_type, ASR::intentType::Local, ASR::abiType::BindC);
-            ASR::expr_t* chunk = b.Variable(current_scope, current_scope->get_unique_name("chunk"), int_type, ASR::intentType::Local, ASR::abiType::BindC);
-            ASR::expr_t* leftovers = b.Variable(current_scope, current_scope->get_unique_name("leftovers"), int_type, ASR::intentType::Local, ASR::abiType::BindC);
+            ASR::expr_t* chunk = b.Variable(current_scope, current_scope->get_unique_name("chunk"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
+            ASR::expr_t* leftovers = b.Variable(current_scope, current_scope->get_unique_name("leftovers"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
             ASR::expr_t* thread_num = b.Variable(current_scope, current_scope->get_unique_name("thread_num"), int_type, ASR::intentType::Local, ASR::abiType::BindC);
+            auto to_i64 = [&](ASR::expr_t* x) -> ASR::expr_t* {
+                return ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(x)) == 8 ? x : b.i2i_t(x, i64_type);
+            };
 
             // update all expr present in DoConcurrent to use the new symbols
             DoConcurrentStatementVisitor v(al, current_scope);
             v.current_expr = nullptr;
             v.visit_DoConcurrentLoop(do_loop);
-            ASR::do_loop_head_t loop_head = do_loop.m_head[0];
 
             /*
             do concurrent ( ix =ax:nx, iy = ay:ny, iz=az:nz , ik=ak:nk )
@@ -949,206 +1133,432 @@ class DoConcurrentVisitor :
 
             ------To----->
 
-            total_iterations = (nx - ax + 1) * (ny - ay + 1) * (nz - az + 1) * (nk - ak + 1) - 1
-            integer :: I = 0;
-            do I = 0, total_iterations
-                ix = (I / ((ny - ay + 1) * (nz - az + 1) * (nk - ak + 1))) + ax
-                iy = ((I / ((nz - az + 1) * (nk - ak + 1))) % (ny - ay + 1)) + ay
-                iz = ((I / (nk - ak + 1)) % (nz - az + 1)) + az
-                ik = (I % (nk - ak + 1)) + ak
+            len_x = max(0, (nx - ax + sx) / sx), ..., len_k = max(0, (nk - ak + sk) / sk)
+            loop_length = len_x * len_y * len_z * len_k
+            ! [start, end) is the chunk of the flattened space of this thread,
+            ! its first point is decomposed once
+            c_k = mod(start, len_k); c_z = mod(start / len_k, len_z); ...
+            ix = ax + c_x * sx; ...; ik = ak + (c_k - 1) * sk; c_k = c_k - 1
+            integer(8) :: I
+            do I = start + 1, end
+                ! step to the next point, carrying into the outer counters
+                c_k = c_k + 1; ik = ik + sk
+                if (c_k == len_k) then
+                    c_k = 0; ik = ak
+                    c_z = c_z + 1; iz = iz + sz
+                    if (c_z == len_z) then
+                        ...
+                    end if
+                end if
                 ! ... some computation ...
             end do
             */
 
-            // total_iterations = (nx - ax + 1) * (ny - ay + 1) * (nz - az + 1) * (nk - ak + 1) - 1
-            ASR::expr_t* total_iterations = b.i32(1);
-            std::vector<ASR::expr_t*> dimension_lengths;
+            // len_i = max(0, (n_i - a_i + s_i) / s_i), all in 64 bits, so that an
+            // empty stepped range is not run once
+            ASR::expr_t* total_iterations = b.i64(1);
+            std::vector<ASR::expr_t*> loop_vars, dimension_lengths, dimension_counters, dimension_steps;
             for (size_t i = 0; i < do_loop.n_head; ++i) {
                 ASR::do_loop_head_t head = do_loop.m_head[i];
-                ASR::expr_t* length = b.Add(b.Sub(head.m_end, head.m_start), b.i32(1));
+                // the loop variables are private, so the body keeps them as
+                // variables of the outlined function
+                if (!ASR::is_a<ASR::Var_t>(*head.m_v)) {
+                    throw LCompilersException("The loop variable of a collapsed loop must be a variable");
+                }
+                ASR::symbol_t* loop_var = current_scope->resolve_symbol(
+                    ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(head.m_v)->m_v));
+                LCOMPILERS_ASSERT(loop_var != nullptr);
+                loop_vars.push_back(b.Var(loop_var));
+                ASR::ttype_t* var_type = ASRUtils::expr_type(head.m_v);
+                dimension_steps.push_back(head.m_increment ? head.m_increment : b.i_t(1, var_type));
+                ASR::expr_t* length = b.Variable(current_scope, current_scope->get_unique_name("len"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
+                ASR::expr_t* trip_count = b.Sub(to_i64(head.m_end), to_i64(head.m_start));
+                if (head.m_increment) {
+                    trip_count = b.Div(b.Add(trip_count, to_i64(head.m_increment)), to_i64(head.m_increment));
+                } else {
+                    trip_count = b.Add(trip_count, b.i64(1));
+                }
+                body.push_back(al, b.Assignment(length, trip_count));
+                body.push_back(al, b.If(b.Lt(length, b.i64(0)), {
+                    b.Assignment(length, b.i64(0))
+                }, {
+                    // do nothing
+                }));
                 dimension_lengths.push_back(length);
+                dimension_counters.push_back(b.Variable(current_scope, current_scope->get_unique_name("c"), i64_type, ASR::intentType::Local, ASR::abiType::BindC));
                 total_iterations = b.Mul(total_iterations, length);
             }
-  
-            // always this shall be IntegerBinOp_t
+
             ASR::expr_t* loop_length = total_iterations;
-            // ASR::expr_t* loop_length = b.Add(b.Sub(loop_head.m_end, loop_head.m_start), b.i32(1));
-            // calculate chunk size
-            body.push_back(al, b.Assignment(num_threads,
-                            ASRUtils::EXPR(ASR::make_FunctionCall_t(al, loc, current_scope->get_symbol("omp_get_max_threads"),
-                            current_scope->get_symbol("omp_get_max_threads"), nullptr, 0, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), nullptr, nullptr))));
-            body.push_back(al, b.Assignment(chunk,
-                            b.Div(loop_length, num_threads)));
-            Vec<ASR::expr_t*> mod_args; mod_args.reserve(al, 2);
-            mod_args.push_back(al, loop_length);
-            mod_args.push_back(al, num_threads);
-            body.push_back(al, b.Assignment(leftovers,
-                            ASRUtils::EXPR(ASRUtils::make_IntrinsicElementalFunction_t_util(al, loc,
-                            2,
-                            mod_args.p, 2, 0, ASRUtils::expr_type(loop_length), nullptr))));
-            body.push_back(al, b.Assignment(thread_num,
-                            ASRUtils::EXPR(ASR::make_FunctionCall_t(al, loc, current_scope->get_symbol("omp_get_thread_num"),
-                            current_scope->get_symbol("omp_get_thread_num"), nullptr, 0, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), nullptr, nullptr))));
-            body.push_back(al, b.Assignment(start, b.Mul(chunk, thread_num)));
-            body.push_back(al, b.If(b.Lt(thread_num, leftovers), {
-                b.Assignment(start, b.Add(start, thread_num))
-            }, {
-                b.Assignment(start, b.Add(start, leftovers))
-            }));
-            body.push_back(al, b.Assignment(end, b.Add(start, chunk)));
-            body.push_back(al, b.If(b.Lt(thread_num, leftovers), {
-                b.Assignment(end, b.Add(end, b.i32(1)))
-            }, {
-                // do nothing
-            }));
+
+            // `schedule(static)` and `schedule(auto)` use the block partition
+            // computed below, every other schedule asks libgomp for chunks
+            std::string schedule_kind = "";
+            switch (do_loop.m_schedule) {
+                case ASR::schedule_typeType::ScheduleStatic : {
+                    if (do_loop.m_chunk) schedule_kind = "static";
+                    break;
+                }
+                case ASR::schedule_typeType::ScheduleDynamic : {
+                    schedule_kind = "dynamic";
+                    break;
+                }
+                case ASR::schedule_typeType::ScheduleGuided : {
+                    schedule_kind = "guided";
+                    break;
+                }
+                case ASR::schedule_typeType::ScheduleRuntime : {
+                    schedule_kind = "runtime";
+                    break;
+                }
+                case ASR::schedule_typeType::ScheduleAuto : {
+                    break;
+                }
+            }
+
+            if (use_thread_pool()) {
+                schedule_kind = "";
+                body.push_back(al, b.Assignment(start, lo_expr));
+                body.push_back(al, b.Assignment(end, hi_expr));
+            } else if (schedule_kind.empty()) {
+                // calculate chunk size
+                body.push_back(al, b.Assignment(num_threads,
+                                ASRUtils::EXPR(ASR::make_FunctionCall_t(al, loc, current_scope->get_symbol("omp_get_max_threads"),
+                                current_scope->get_symbol("omp_get_max_threads"), nullptr, 0, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), nullptr, nullptr))));
+                body.push_back(al, b.Assignment(chunk,
+                                b.Div(loop_length, to_i64(num_threads))));
+                Vec<ASR::expr_t*> mod_args; mod_args.reserve(al, 2);
+                mod_args.push_back(al, loop_length);
+                mod_args.push_back(al, to_i64(num_threads));
+                body.push_back(al, b.Assignment(leftovers,
+                                ASRUtils::EXPR(ASRUtils::make_IntrinsicElementalFunction_t_util(al, loc,
+                                2,
+                                mod_args.p, 2, 0, ASRUtils::expr_type(loop_length), nullptr))));
+                body.push_back(al, b.Assignment(thread_num,
+                                ASRUtils::EXPR(ASR::make_FunctionCall_t(al, loc, current_scope->get_symbol("omp_get_thread_num"),
+                                current_scope->get_symbol("omp_get_thread_num"), nullptr, 0, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), nullptr, nullptr))));
+                body.push_back(al, b.Assignment(start, b.Mul(chunk, to_i64(thread_num))));
+                body.push_back(al, b.If(b.Lt(to_i64(thread_num), leftovers), {
+                    b.Assignment(start, b.Add(start, to_i64(thread_num)))
+                }, {
+                    b.Assignment(start, b.Add(start, leftovers))
+                }));
+                body.push_back(al, b.Assignment(end, b.Add(start, chunk)));
+                body.push_back(al, b.If(b.Lt(to_i64(thread_num), leftovers), {
+                    b.Assignment(end, b.Add(end, b.i64(1)))
+                }, {
+                    // do nothing
+                }));
+            }
 
             // Partioning logic ends
 
-            // initialize reduction variables
-            for ( size_t i = 0; i < do_loop.n_reduction; i++ ) {
-                ASR::reduction_expr_t red = do_loop.m_reduction[i];
-                reduction_variables.push_back(ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(red.m_arg)->m_v));
-                switch (red.m_op) {
-                    case ASR::reduction_opType::ReduceAdd : {
-                        body.push_back(al, b.Assignment(red.m_arg, b.constant_t(0.0, ASRUtils::expr_type(red.m_arg))));
-                        break;
+            // initialize reduction variables, every thread accumulates into
+            // its own private copy which lives on that thread's stack
+            auto reduction_identity = [&](ASR::reduction_opType op, ASR::ttype_t* type) -> ASR::expr_t* {
+                int kind = ASRUtils::extract_kind_from_ttype_t(type);
+                switch (op) {
+                    case ASR::reduction_opType::ReduceAdd :
+                    case ASR::reduction_opType::ReduceSub : {
+                        return b.constant_t(0.0, type);
                     }
                     case ASR::reduction_opType::ReduceMul : {
-                        body.push_back(al, b.Assignment(red.m_arg, b.constant_t(1.0, ASRUtils::expr_type(red.m_arg))));
-                        break;
-                    }
-                    case ASR::reduction_opType::ReduceSub : {
-                        body.push_back(al, b.Assignment(red.m_arg, b.constant_t(0.0, ASRUtils::expr_type(red.m_arg))));
-                        break;
+                        return b.constant_t(1.0, type);
                     }
                     case ASR::reduction_opType::ReduceMAX : {
-                        if (ASRUtils::is_integer(*ASRUtils::expr_type(red.m_arg))) {
-                            body.push_back(al, b.Assignment(red.m_arg, b.i_t(INT_MIN, ASRUtils::expr_type(red.m_arg))));
-                        } else if (ASRUtils::is_real(*ASRUtils::expr_type(red.m_arg))) {
-                            body.push_back(al, b.Assignment(red.m_arg, b.f_t(std::numeric_limits<double>::min(), ASRUtils::expr_type(red.m_arg))));
-                        } else {
-                            // handle other types
-                            LCOMPILERS_ASSERT(false);
+                        if (ASRUtils::is_integer(*type)) {
+                            int64_t lowest = kind == 1 ? INT8_MIN : kind == 2 ? INT16_MIN
+                                : kind == 4 ? INT32_MIN : INT64_MIN;
+                            return b.i_t(lowest, type);
+                        } else if (ASRUtils::is_real(*type)) {
+                            return b.f_t(kind == 4 ? -FLT_MAX : -DBL_MAX, type);
                         }
                         break;
                     }
                     case ASR::reduction_opType::ReduceMIN : {
-                        if (ASRUtils::is_integer(*ASRUtils::expr_type(red.m_arg))) {
-                            body.push_back(al, b.Assignment(red.m_arg, b.i_t(INT_MAX, ASRUtils::expr_type(red.m_arg))));
-                        } else if (ASRUtils::is_real(*ASRUtils::expr_type(red.m_arg))) {
-                            body.push_back(al, b.Assignment(red.m_arg, b.f_t(std::numeric_limits<double>::max(), ASRUtils::expr_type(red.m_arg))));
-                        } else {
-                            // handle other types
-                            LCOMPILERS_ASSERT(false);
+                        if (ASRUtils::is_integer(*type)) {
+                            int64_t highest = kind == 1 ? INT8_MAX : kind == 2 ? INT16_MAX
+                                : kind == 4 ? INT32_MAX : INT64_MAX;
+                            return b.i_t(highest, type);
+                        } else if (ASRUtils::is_real(*type)) {
+                            return b.f_t(kind == 4 ? FLT_MAX : DBL_MAX, type);
                         }
                         break;
                     }
                     default: {
-                        LCOMPILERS_ASSERT(false);
+                        break;
                     }
                 }
-            }
-
-            // integer :: I = 0;
-            std::vector<ASR::stmt_t*> flattened_body;
-            ASR::expr_t* I = b.Variable(current_scope, "I", ASRUtils::TYPE(ASR::make_Integer_t(al, loc,
-            4)),ASR::intentType::Local, ASR::abiType::BindC);
+                // handle other types
+                LCOMPILERS_ASSERT(false);
+                return nullptr;
+            };
+
+            // visits every element of `arr` (lower bound 1) with the first
+            // dimension innermost
+            auto for_each_element = [&](ASR::expr_t* arr,
+                    const std::function<std::vector<ASR::stmt_t*>(std::vector<ASR::expr_t*>&)> &element_body) -> ASR::stmt_t* {
+                size_t n_dims = ASRUtils::extract_n_dims_from_ttype(ASRUtils::expr_type(arr));
+                std::vector<ASR::expr_t*> idx;
+                for (size_t d = 0; d < n_dims; d++) {
+                    idx.push_back(b.Variable(current_scope, current_scope->get_unique_name("red_i"), int_type,
+                        ASR::intentType::Local, ASR::abiType::BindC));
+                }
+                std::vector<ASR::stmt_t*> loop_body = element_body(idx);
+                for (size_t d = 0; d < n_dims; d++) {
+                    loop_body = {b.DoLoop(idx[d], b.i32(1), b.ArraySize(arr, b.i32(d + 1), int_type), loop_body)};
+                }
+                return loop_body[0];
+            };
 
-            ASR::expr_t* temp_I = I;
-            for (size_t i = 0; i < do_loop.n_head; ++i) {
-                ASR::do_loop_head_t head = do_loop.m_head[i];
-                ASR::expr_t* computed_var;
-
-                if (i == do_loop.n_head - 1) {
-                    // Last loop variable -> ik = (I % (nk - ak 1)) + ak
-                    Vec<ASR::expr_t*> mod_args; mod_args.reserve(al, 2);
-                    mod_args.push_back(al, temp_I);
-                    mod_args.push_back(al, dimension_lengths[i]);
-                    computed_var = b.Add(ASRUtils::EXPR(ASRUtils::make_IntrinsicElementalFunction_t_util(al,
-                    loc,2,mod_args.p, 2, 0, ASRUtils::expr_type(dimension_lengths[i]), nullptr)),head.m_start);
-                } else {
-                    // Intermediate loop variable -> iy = ((I / ((nz - az 1) * (nk - ak 1))) % (ny - ay +1)) ay
-                    ASR::expr_t* product_of_next_dimensions = b.i32(1); 
-                    for (size_t j = i + 1 ; j <do_loop.n_head; ++j) {
-                        product_of_next_dimensions = b.Mul(product_of_next_dimensions, dimension_lengths[j]);
-                    }
+            // array reductions accumulate into `<name>_partial`, the loop body is
+            // redirected to it and the shared array is updated once per thread
+            std::map<ASR::symbol_t*, ASR::symbol_t*> reduction_partials;
+            for ( size_t i = 0; i < do_loop.n_reduction; i++ ) {
+                ASR::reduction_expr_t red = do_loop.m_reduction[i];
+                ASR::ttype_t* red_type = ASRUtils::expr_type(red.m_arg);
+                ASR::ttype_t* element_type = ASRUtils::extract_type(red_type);
+                if (!ASRUtils::is_array(red_type)) {
+                    reduction_variables.push_back(ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(red.m_arg)->m_v));
+                    body.push_back(al, b.Assignment(red.m_arg, reduction_identity(red.m_op, element_type)));
+                    continue;
+                }
+                ASR::symbol_t* shared_sym = ASR::down_cast<ASR::Var_t>(red.m_arg)->m_v;
+                ASR::expr_t* partial = b.Variable(current_scope,
+                    current_scope->get_unique_name(std::string(ASRUtils::symbol_name(shared_sym)) + "_partial"),
+                    ASRUtils::TYPE(ASRUtils::make_Allocatable_t_util(al, loc,
+                        ASRUtils::type_get_past_allocatable_pointer(red_type))),
+                    ASR::intentType::Local, ASR::abiType::BindC);
+                reduction_partials[shared_sym] = ASR::down_cast<ASR::Var_t>(partial)->m_v;
+
+                size_t n_dims = ASRUtils::extract_n_dims_from_ttype(red_type);
+                Vec<ASR::dimension_t> dims; dims.reserve(al, n_dims);
+                for (size_t d = 0; d < n_dims; d++) {
+                    ASR::dimension_t dim; dim.loc = loc;
+                    dim.m_start = b.i32(1);
+                    dim.m_length = b.ArraySize(red.m_arg, b.i32(d + 1), int_type);
+                    dims.push_back(al, dim);
+                }
+                body.push_back(al, b.Allocate(partial, dims));
+                body.push_back(al, for_each_element(red.m_arg, [&](std::vector<ASR::expr_t*> &idx) {
+                    return std::vector<ASR::stmt_t*>{b.Assignment(b.ArrayItem_01(partial, idx),
+                        reduction_identity(red.m_op, element_type))};
+                }));
+            }
+            if (!reduction_partials.empty()) {
+                ReplaceReductionArrayVisitor redirect(reduction_partials);
+                for (size_t i = 0; i < do_loop.n_body; i++) {
+                    redirect.visit_stmt(*do_loop.m_body[i]);
+                }
+            }
 
-                    if (i != 0){
+            // integer(8) :: I
+            ASR::expr_t* I = b.Variable(current_scope, "I", i64_type, ASR::intentType::Local, ASR::abiType::BindC);
+
+            // decompose the flat index `first` into the loop variables, once
+            // per chunk; the innermost one is left a step before its value
+            // so that the carry at the top of the body lands on `first`
+            auto decompose = [&](ASR::expr_t* first) -> std::vector<ASR::stmt_t*> {
+                std::vector<ASR::stmt_t*> stmts;
+                ASR::expr_t* rem = first;
+                for (int i = (int) do_loop.n_head - 1; i >= 0; --i) {
+                    ASR::do_loop_head_t head = do_loop.m_head[i];
+                    ASR::expr_t* counter = dimension_counters[i];
+                    if (i == 0) {
+                        stmts.push_back(b.Assignment(counter, rem));
+                    } else {
                         Vec<ASR::expr_t*> mod_args; mod_args.reserve(al, 2);
-                        mod_args.push_back(al, b.Div(temp_I, product_of_next_dimensions));
+                        mod_args.push_back(al, rem);
                         mod_args.push_back(al, dimension_lengths[i]);
-                        computed_var = b.Add(ASRUtils::EXPR(ASRUtils::make_IntrinsicElementalFunction_t_util(al,
-                    loc,2,mod_args.p, 2, 0, ASRUtils::expr_type(dimension_lengths[i]), nullptr)),head.m_start);
-                    } else {
-                        computed_var = b.Add(b.Div(b.Add(temp_I,b.i32(-1)), product_of_next_dimensions),head.m_start);
+                        stmts.push_back(b.Assignment(counter, ASRUtils::EXPR(ASRUtils::make_IntrinsicElementalFunction_t_util(al,
+                            loc, 2, mod_args.p, 2, 0, i64_type, nullptr))));
+                        rem = b.Div(rem, dimension_lengths[i]);
                     }
+                    if (i == (int) do_loop.n_head - 1) {
+                        stmts.push_back(b.Assignment(counter, b.Sub(counter, b.i64(1))));
+                    }
+                    ASR::ttype_t* var_type = ASRUtils::expr_type(loop_vars[i]);
+                    stmts.push_back(b.Assignment(loop_vars[i], b.Add(head.m_start,
+                        b.Mul(b.i2i_t(counter, var_type), dimension_steps[i]))));
                 }
+                return stmts;
+            };
 
-                // Add the assignment to the body
-                flattened_body.push_back(b.Assignment(b.Var(current_scope->resolve_symbol(ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(head.m_v)->m_v))),
-                computed_var));
-            }
+            // step to the next point: bump the innermost counter and carry
+            // into the enclosing ones when it wraps around
+            std::function<std::vector<ASR::stmt_t*>(size_t)> advance = [&](size_t i) -> std::vector<ASR::stmt_t*> {
+                ASR::do_loop_head_t head = do_loop.m_head[i];
+                std::vector<ASR::stmt_t*> stmts = {
+                    b.Assignment(dimension_counters[i], b.Add(dimension_counters[i], b.i64(1))),
+                    b.Assignment(loop_vars[i], b.Add(loop_vars[i], dimension_steps[i]))
+                };
+                if (i > 0) {
+                    std::vector<ASR::stmt_t*> wrap = {
+                        b.Assignment(dimension_counters[i], b.i64(0)),
+                        b.Assignment(loop_vars[i], head.m_start)
+                    };
+                    for (auto &stmt: advance(i - 1)) {
+                        wrap.push_back(stmt);
+                    }
+                    stmts.push_back(b.If(b.Eq(dimension_counters[i], dimension_lengths[i]), wrap, {
+                        // do nothing
+                    }));
+                }
+                return stmts;
+            };
 
+            std::vector<ASR::stmt_t*> flattened_body = advance(do_loop.n_head - 1);
             for (size_t i = 0; i < do_loop.n_body; ++i) {
                 flattened_body.push_back(do_loop.m_body[i]);
             }
             //  Collapse Ends Here
 
-            body.push_back(al, b.DoLoop(I, b.Add(start, b.i32(1)), end, flattened_body, loop_head.m_increment));
-            body.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, loc, current_scope->get_symbol("gomp_barrier"), nullptr, nullptr, 0, nullptr)));
-
+            if (schedule_kind.empty()) {
+                // an empty chunk must not be decomposed, a zero length
+                // dimension would be divided by
+                std::vector<ASR::stmt_t*> chunk_body = decompose(start);
+                chunk_body.push_back(create_chunk_loop(b, do_loop, I, b.Add(start, b.i64(1)), end, flattened_body));
+                body.push_back(al, b.If(b.Lt(start, end), chunk_body, {
+                    // do nothing
+                }));
+            } else {
+                /*
+                    The iterations [istart, iend) of each chunk are handed out by libgomp:
+
+                    more = GOMP_loop_<kind>_start(0, loop_length, 1, [chunk,] istart, iend)
+                    do while (more)
+                        do I = istart + 1, iend
+                            ! ... some computation ...
+                        end do
+                        more = GOMP_loop_<kind>_next(istart, iend)
+                    end do
+                    call GOMP_loop_end_nowait()
+                */
+                ASR::expr_t* istart = b.Variable(current_scope, current_scope->get_unique_name("istart"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
+                ASR::expr_t* iend = b.Variable(current_scope, current_scope->get_unique_name("iend"), i64_type, ASR::intentType::Local, ASR::abiType::BindC);
+                ASR::symbol_t* loop_start = current_scope->get_symbol("gomp_loop_" + schedule_kind + "_start");
+                ASR::symbol_t* loop_next = current_scope->get_symbol("gomp_loop_" + schedule_kind + "_next");
+                LCOMPILERS_ASSERT(loop_start != nullptr && loop_next != nullptr);
+                ASR::ttype_t* more_type = ASRUtils::get_FunctionType(loop_start)->m_return_var_type;
+                ASR::expr_t* more = b.Variable(current_scope, current_scope->get_unique_name("more"), more_type, ASR::intentType::Local, ASR::abiType::BindC);
+
+                Vec<ASR::expr_t*> start_args; start_args.reserve(al, 6);
+                start_args.push_back(al, b.i64(0));
+                start_args.push_back(al, loop_length);
+                start_args.push_back(al, b.i64(1));
+                if (schedule_kind != "runtime") {
+                    ASR::expr_t* chunk_size = do_loop.m_chunk ? do_loop.m_chunk : b.i64(1);
+                    if (ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(chunk_size)) != 8) {
+                        chunk_size = b.i2i_t(chunk_size, i64_type);
+                    }
+                    start_args.push_back(al, chunk_size);
+                }
+                start_args.push_back(al, istart);
+                start_args.push_back(al, iend);
+                Vec<ASR::expr_t*> next_args; next_args.reserve(al, 2);
+                next_args.push_back(al, istart);
+                next_args.push_back(al, iend);
+
+                std::vector<ASR::stmt_t*> chunk_body = decompose(istart);
+                chunk_body.push_back(create_chunk_loop(b, do_loop, I, b.Add(istart, b.i64(1)), iend, flattened_body));
+                chunk_body.push_back(b.Assignment(more, b.Call(loop_next, next_args, more_type)));
+                body.push_back(al, b.Assignment(more, b.Call(loop_start, start_args, more_type)));
+                body.push_back(al, b.While(more, chunk_body));
+                body.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, loc, current_scope->get_symbol("gomp_loop_end_nowait"), nullptr, nullptr, 0, nullptr)));
+            }
             /*
-                handle reduction variables if any then:
+                combine the partial result of this thread into the shared one:
+                integer and real kinds 4 and 8 use a lock-free compare and swap
+                => call lfortran_atomic_<op>_<type>(c_loc(tdata%<var>), <var>)
+                everything else is serialized through
                 call gomp_atomic_start()
-                => perform atomic operation
+                => perform operation
                 call gomp_atomic_end()
+                The combine synchronizes by itself and the implicit barrier at
+                the end of GOMP_parallel orders it before the copy back, so no
+                barrier is needed after the loop.
             */
-            if (do_loop.n_reduction > 0) {
-                body.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, loc,
-                        current_scope->get_symbol("gomp_atomic_start"), nullptr, nullptr, 0, nullptr)));
-            }
-            for ( size_t i = 0; i < do_loop.n_reduction; i++ ) {
-                ASR::reduction_expr_t red = do_loop.m_reduction[i];
-                ASR::symbol_t* red_sym = current_scope->get_symbol(std::string(ASRUtils::symbol_name(thread_data_sym)) + "_" + std::string(ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(red.m_arg)->m_v)));
-                ASR::expr_t* lhs = ASRUtils::EXPR(ASR::make_StructInstanceMember_t(al, loc, tdata_expr, red_sym, ASRUtils::symbol_type(red_sym), nullptr));
-
-                switch (red.m_op) {
-                    case ASR::reduction_opType::ReduceAdd : {
-                        body.push_back(al, b.Assignment(lhs, b.Add(lhs, red.m_arg)));
-                        break;
-                    }
+            std::vector<ASR::stmt_t*> locked_combine;
+            auto is_lock_free = [&](ASR::ttype_t* type) -> bool {
+                int kind = ASRUtils::extract_kind_from_ttype_t(type);
+                return (ASRUtils::is_integer(*type) || ASRUtils::is_real(*type)) && (kind == 4 || kind == 8);
+            };
+            auto combine = [&](ASR::reduction_opType op, ASR::expr_t* lhs, ASR::expr_t* partial) -> ASR::stmt_t* {
+                ASR::ttype_t* type = ASRUtils::expr_type(lhs);
+                int kind = ASRUtils::extract_kind_from_ttype_t(type);
+                if (is_lock_free(type)) {
+                    // `-` partials are summed up as well
+                    std::string op_name = op == ASR::reduction_opType::ReduceMul ? "mul"
+                        : op == ASR::reduction_opType::ReduceMAX ? "max"
+                        : op == ASR::reduction_opType::ReduceMIN ? "min" : "add";
+                    ASR::symbol_t* atomic_sym = current_scope->get_symbol("lfortran_atomic_" + op_name + "_"
+                        + (ASRUtils::is_integer(*type) ? "i" : "r") + std::to_string(kind * 8));
+                    LCOMPILERS_ASSERT(atomic_sym != nullptr);
+                    Vec<ASR::call_arg_t> atomic_args; atomic_args.reserve(al, 2);
+                    // the shared value is updated in place through its address
+                    ASR::call_arg_t arg1; arg1.loc = loc; arg1.m_value = c_loc(lhs);
+                    ASR::call_arg_t arg2; arg2.loc = loc; arg2.m_value = partial;
+                    atomic_args.push_back(al, arg1); atomic_args.push_back(al, arg2);
+                    return b.SubroutineCall(atomic_sym, atomic_args);
+                }
+                switch (op) {
+                    case ASR::reduction_opType::ReduceAdd :
                     case ASR::reduction_opType::ReduceSub : {
-                        body.push_back(al, b.Assignment(lhs, b.Sub(lhs, red.m_arg)));
-                        break;
+                        return b.Assignment(lhs, b.Add(lhs, partial));
                     }
                     case ASR::reduction_opType::ReduceMul : {
-                        body.push_back(al, b.Assignment(lhs, b.Mul(lhs, red.m_arg)));
-                        break;
+                        return b.Assignment(lhs, b.Mul(lhs, partial));
                     }
                     case ASR::reduction_opType::ReduceMAX : {
-                        body.push_back(al, b.If(b.Lt(lhs, red.m_arg), {
-                            b.Assignment(lhs, red.m_arg)
+                        return b.If(b.Lt(lhs, partial), {
+                            b.Assignment(lhs, partial)
                         }, {
                             // do nothing
-                        }));
-                        break;
+                        });
                     }
                     case ASR::reduction_opType::ReduceMIN : {
-                        body.push_back(al, b.If(b.Gt(lhs, red.m_arg), {
-                            b.Assignment(lhs, red.m_arg)
+                        return b.If(b.Gt(lhs, partial), {
+                            b.Assignment(lhs, partial)
                         }, {
                             // do nothing
-                        }));
-                        break;
+                        });
                     }
                     default : {
                         LCOMPILERS_ASSERT(false);
+                        return nullptr;
                     }
                 }
+            };
+            for ( size_t i = 0; i < do_loop.n_reduction; i++ ) {
+                ASR::reduction_expr_t red = do_loop.m_reduction[i];
+                ASR::symbol_t* var_sym = ASR::down_cast<ASR::Var_t>(red.m_arg)->m_v;
+                ASR::stmt_t* stmt = nullptr;
+                if (reduction_partials.find(var_sym) != reduction_partials.end()) {
+                    // the shared array is reached through the pointer in tdata
+                    ASR::expr_t* partial = b.Var(reduction_partials[var_sym]);
+                    stmt = for_each_element(red.m_arg, [&](std::vector<ASR::expr_t*> &idx) {
+                        return std::vector<ASR::stmt_t*>{combine(red.m_op,
+                            b.ArrayItem_01(red.m_arg, idx), b.ArrayItem_01(partial, idx))};
+                    });
+                } else {
+                    ASR::symbol_t* red_sym = current_scope->get_symbol(std::string(ASRUtils::symbol_name(thread_data_sym)) + "_" + std::string(ASRUtils::symbol_name(var_sym)));
+                    ASR::expr_t* lhs = ASRUtils::EXPR(ASR::make_StructInstanceMember_t(al, loc, tdata_expr, red_sym, ASRUtils::symbol_type(red_sym), nullptr));
+                    stmt = combine(red.m_op, lhs, red.m_arg);
+                }
+                if (is_lock_free(ASRUtils::extract_type(ASRUtils::expr_type(red.m_arg)))) {
+                    body.push_back(al, stmt);
+                } else {
+                    locked_combine.push_back(stmt);
+                }
             }
-            if (do_loop.n_reduction > 0) {
+            if (!locked_combine.empty()) {
+                body.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, loc,
+                        current_scope->get_symbol(use_thread_pool() ? "lfortran_pool_lock" : "gomp_atomic_start"), nullptr, nullptr, 0, nullptr)));
+                for (auto &stmt: locked_combine) {
+                    body.push_back(al, stmt);
+                }
                 body.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, loc,
-                        current_scope->get_symbol("gomp_atomic_end"), nullptr, nullptr, 0, nullptr)));
+                        current_scope->get_symbol(use_thread_pool() ? "lfortran_pool_unlock" : "gomp_atomic_end"), nullptr, nullptr, 0, nullptr)));
             }
 
             ASR::symbol_t* function = ASR::down_cast<ASR::symbol_t>(ASRUtils::make_Function_t_util(al, loc, current_scope, s2c(al, current_scope->parent->get_unique_name("lcompilers_function")),
@@ -1171,13 +1581,18 @@ class DoConcurrentVisitor :
             return nullptr;
         }
 
-        ASR::symbol_t* create_interface_lcompilers_function(ASR::Function_t* func) {
+        ASR::symbol_t* create_interface_lcompilers_function(ASR::Function_t* func, bool with_range = true) {
             ASRUtils::ASRBuilder b(al, func->base.base.loc);
             SymbolTable* current_scope_copy = current_scope;
             current_scope = al.make_new<SymbolTable>(current_scope);
             ASR::expr_t* data_expr = b.Variable(current_scope, "data", ASRUtils::TYPE(ASR::make_CPtr_t(al, func->base.base.loc)), ASR::intentType::Unspecified, ASR::abiType::BindC, true);
-            Vec<ASR::expr_t*> args; args.reserve(al, 1);
+            Vec<ASR::expr_t*> args; args.reserve(al, 3);
             args.push_back(al, data_expr);
+            if (with_range && use_thread_pool()) {
+                ASR::ttype_t* range_type = ASRUtils::TYPE(ASR::make_Integer_t(al, func->base.base.loc, 8));
+                args.push_back(al, b.Variable(current_scope, "lo", range_type, ASR::intentType::Unspecified, ASR::abiType::BindC, true));
+                args.push_back(al, b.Variable(current_scope, "hi", range_type, ASR::intentType::Unspecified, ASR::abiType::BindC, true));
+            }
             ASR::symbol_t* interface_function = ASR::down_cast<ASR::symbol_t>(ASRUtils::make_Function_t_util(al, func->base.base.loc,
                     current_scope, func->m_name, func->m_dependencies, func->n_dependencies,
                     args.p, args.n, nullptr, 0, nullptr, ASR::abiType::BindC, ASR::accessType::Public,
@@ -1368,6 +1783,16 @@ class DoConcurrentVisitor :
         }
 
         void visit_DoConcurrentLoop(const ASR::DoConcurrentLoop_t &x) {
+            if (x.m_hint && ASR::down_cast<ASR::LoopHint_t>(x.m_hint)->m_simd_only) {
+                // `!$omp simd` loops are only vectorized
+                return;
+            }
+            if (use_thread_pool()) {
+                // loops that are not safe to split stay serial
+                AutoParallelChecker checker;
+                checker.visit_DoConcurrentLoop(x);
+                if (!checker.is_parallelizable) return;
+            }
             std::map<std::string, ASR::ttype_t*> involved_symbols;
 
             InvolvedSymbolsCollector c(involved_symbols);
@@ -1638,6 +2063,37 @@ class DoConcurrentVisitor :
                     ASRUtils::expr_type(tdata_expr), nullptr))
             ));
 
+            // the thread pool needs the number of flattened iterations, the
+            // bounds are copied as the outlined function rewrites them in place,
+            // and the arrays they refer to (e.g. `1:size(a)`) were redeclared
+            // above as pointers
+            ASR::expr_t* trip_count = nullptr;
+            if (use_thread_pool()) {
+                ASRUtils::ExprStmtDuplicator duplicator(al);
+                ArrayVisitor array_replacer(al, current_scope, array_variables);
+                ASR::ttype_t* i64_type = ASRUtils::TYPE(ASR::make_Integer_t(al, x.base.base.loc, 8));
+                auto to_i64 = [&](ASR::expr_t* e) -> ASR::expr_t* {
+                    e = duplicator.duplicate_expr(e);
+                    array_replacer.current_expr = &e;
+                    array_replacer.call_replacer();
+                    array_replacer.visit_expr(*e);
+                    return ASRUtils::extract_kind_from_ttype_t(ASRUtils::expr_type(e)) == 8 ? e : b.i2i_t(e, i64_type);
+                };
+                trip_count = b.i64(1);
+                for (size_t i = 0; i < x.n_head; i++) {
+                    // max(0, (n - a + s)/s), so that empty stepped ranges are
+                    // not run once
+                    ASR::do_loop_head_t head = x.m_head[i];
+                    ASR::expr_t* length = b.Sub(to_i64(head.m_end), to_i64(head.m_start));
+                    if (head.m_increment) {
+                        length = b.Div(b.Add(length, to_i64(head.m_increment)), to_i64(head.m_increment));
+                    } else {
+                        length = b.Add(length, b.i64(1));
+                    }
+                    trip_count = b.Mul(trip_count, b.Max(length, b.i64(0)));
+                }
+            }
+
             ASR::symbol_t* lcompilers_function = create_lcompilers_function(x.base.base.loc, x, involved_symbols, thread_data_module.first, module_symbols);
             LCOMPILERS_ASSERT(lcompilers_function != nullptr);
             ASR::Function_t* lcompilers_func = ASR::down_cast<ASR::Function_t>(lcompilers_function);
@@ -1655,8 +2111,10 @@ class DoConcurrentVisitor :
             Vec<ASR::call_arg_t> call_args; call_args.reserve(al, 4);
             ASR::call_arg_t arg1; arg1.loc = x.base.base.loc; arg1.m_value = c_funloc;
             ASR::call_arg_t arg2; arg2.loc = x.base.base.loc; arg2.m_value = tdata_expr;
-            ASR::call_arg_t arg3; arg3.loc = x.base.base.loc; arg3.m_value = b.i32(0);
-            ASR::call_arg_t arg4; arg4.loc = x.base.base.loc; arg4.m_value = b.i32(0);
+            // GOMP_parallel(fn, data, num_threads = 0, flags = 0) or
+            // _lfortran_parallel_for(fn, data, n, grain = 0)
+            ASR::call_arg_t arg3; arg3.loc = x.base.base.loc; arg3.m_value = use_thread_pool() ? trip_count : b.i32(0);
+            ASR::call_arg_t arg4; arg4.loc = x.base.base.loc; arg4.m_value = use_thread_pool() ? b.i64(0) : b.i32(0);
 
             call_args.push_back(al, arg1); call_args.push_back(al, arg2);
             call_args.push_back(al, arg3); call_args.push_back(al, arg4);
@@ -1666,7 +2124,8 @@ class DoConcurrentVisitor :
             std::string unsupported_sym_name = import_all(ASR::down_cast<ASR::Module_t>(mod_sym));
             LCOMPILERS_ASSERT(unsupported_sym_name == "");
 
-            pass_result.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, x.base.base.loc, current_scope->get_symbol("gomp_parallel"), nullptr,
+            pass_result.push_back(al, ASRUtils::STMT(ASR::make_SubroutineCall_t(al, x.base.base.loc,
+                                current_scope->get_symbol(use_thread_pool() ? "lfortran_parallel_for" : "gomp_parallel"), nullptr,
                                 call_args.p, call_args.n, nullptr)));
 
             for (auto it: reduction_variables) {
@@ -1694,6 +2153,317 @@ class DoConcurrentVisitor :
             return;
         }
 
+        // c_loc(x), built like the frontend does
+        ASR::expr_t* c_loc(ASR::expr_t* x) {
+            const Location &loc = x->base.loc;
+            ASR::ttype_t* type = ASRUtils::expr_type(x);
+            if (!ASRUtils::is_pointer(type)) {
+                x = ASRUtils::EXPR(ASR::make_GetPointer_t(al, loc, x,
+                    ASRUtils::make_Pointer_t_util(al, loc, ASRUtils::type_get_past_allocatable(type)), nullptr));
+            }
+            return ASRUtils::EXPR(ASR::make_PointerToCPtr_t(al, loc, x,
+                ASRUtils::TYPE(ASR::make_CPtr_t(al, loc)), nullptr));
+        }
+
+        /*
+            The variables of a task that are reached through their address in
+            the data block of the task. These are arrays, the variables listed
+            in `shared`, module and `save` variables and, as in OpenMP, all the
+            variables of a program. The other scalars, like the local variables
+            and the arguments of procedures, are copied into the data block
+            when the task is created (firstprivate). This is the default of
+            OpenMP: the arguments and local variables of a procedure are
+            firstprivate in an orphaned task, and in a task of a parallel
+            region the variables shared by the region are already pointers
+            into the data block of the region here, so they stay shared.
+            The semantics rejects `firstprivate` on anything but scalars, as
+            arrays are never copied.
+        */
+        std::set<std::string> get_task_shared_variables(const ASR::OMPTask_t &x,
+                std::map<std::string, ASR::ttype_t*> &involved_symbols) {
+            std::set<std::string> listed_shared, listed_firstprivate;
+            for (size_t i = 0; i < x.n_shared; i++) {
+                listed_shared.insert(to_lower(ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(x.m_shared[i])->m_v)));
+            }
+            for (size_t i = 0; i < x.n_firstprivate; i++) {
+                listed_firstprivate.insert(to_lower(ASRUtils::symbol_name(ASR::down_cast<ASR::Var_t>(x.m_firstprivate[i])->m_v)));
+            }
+            bool in_program = ASR::is_a<ASR::symbol_t>(*current_scope->asr_owner) &&
+                ASR::is_a<ASR::Program_t>(*ASR::down_cast<ASR::symbol_t>(current_scope->asr_owner));
+            std::set<std::string> shared;
+            for (auto &it: involved_symbols) {
+                ASR::symbol_t* sym = current_scope->resolve_symbol(it.first);
+                ASR::Variable_t* var = ASR::down_cast<ASR::Variable_t>(ASRUtils::symbol_get_past_external(sym));
+                ASR::ttype_t* type = it.second;
+                if (var->m_storage == ASR::storage_typeType::Parameter) {
+                    continue;
+                }
+                bool is_value = !ASRUtils::is_array(type) && !ASRUtils::is_pointer(type) &&
+                    !ASRUtils::is_allocatable(type) && (ASRUtils::is_integer(*type) ||
+                    ASRUtils::is_real(*type) || ASRUtils::is_complex(*type) || ASRUtils::is_logical(*type));
+                bool is_global = ASR::is_a<ASR::ExternalSymbol_t>(*sym) ||
+                    var->m_storage == ASR::storage_typeType::Save ||
+                    (ASR::is_a<ASR::symbol_t>(*var->m_parent_symtab->asr_owner) &&
+                     ASR::is_a<ASR::Module_t>(*ASR::down_cast<ASR::symbol_t>(var->m_parent_symtab->asr_owner)));
+                if (!is_value || listed_shared.count(it.first) ||
+                        (!listed_firstprivate.count(it.first) && (in_program || is_global))) {
+                    shared.insert(it.first);
+                }
+            }
+            return shared;
+        }
+
+        ASR::symbol_t* create_lcompilers_task_function(const Location &loc, const ASR::OMPTask_t &task,
+                std::map<std::string, ASR::ttype_t*> &involved_symbols, const std::set<std::string> &shared,
+                std::string thread_data_module_name, std::vector<ASR::symbol_t*> module_symbols) {
+            SymbolTable* current_scope_copy = current_scope;
+            while (current_scope->parent != nullptr) {
+                current_scope = current_scope->parent;
+            }
+            current_scope = al.make_new<SymbolTable>(current_scope);
+            // load modules
+            std::string unsupported_sym_name = import_all(ASR::down_cast<ASR::Module_t>(module_symbols[0]));
+            LCOMPILERS_ASSERT(unsupported_sym_name == "");
+            unsupported_sym_name = import_all(ASR::down_cast<ASR::Module_t>(module_symbols[1]));
+            LCOMPILERS_ASSERT(unsupported_sym_name == "");
+            ASR::symbol_t* mod_sym = create_module(loc, thread_data_module_name);
+            LCOMPILERS_ASSERT(mod_sym != nullptr && ASR::is_a<ASR::Module_t>(*mod_sym));
+            unsupported_sym_name = import_all(ASR::down_cast<ASR::Module_t>(mod_sym));
+            LCOMPILERS_ASSERT(unsupported_sym_name == "");
+
+            ASRUtils::ASRBuilder b(al, loc);
+            ASR::symbol_t* thread_data_sym = current_scope->get_symbol("thread_data" + thread_data_module_name.substr(18));
+            ASR::symbol_t* thread_data_ext_sym = ASRUtils::symbol_get_past_external(thread_data_sym);
+            SymbolTable* thread_data_symtab = ASRUtils::symbol_symtab(thread_data_ext_sym);
+
+            // `type(c_ptr), value :: data` is the copy of the data block made
+            // by the runtime
+            ASR::expr_t* data_expr = b.Variable(current_scope, "data", ASRUtils::TYPE(ASR::make_CPtr_t(al, loc)), ASR::intentType::Unspecified,
+                    ASR::abiType::BindC, true);
+            ASR::expr_t* tdata_expr = b.Variable(current_scope, "tdata", ASRUtils::TYPE(ASR::make_Pointer_t(al, loc, ASRUtils::TYPE(ASR::make_StructType_t(al, loc, thread_data_sym)))),
+                    ASR::intentType::Local, ASR::abiType::BindC);
+
+            Vec<ASR::stmt_t*> body; body.reserve(al, involved_symbols.size() + task.n_body + 1);
+            body.push_back(al, b.CPtrToPointer(data_expr, tdata_expr));
+            Vec<ASR::expr_t*> args; args.reserve(al, 1);
+            args.push_back(al, data_expr);
+
+            // tdata%<name>
+            auto member = [&](const std::string &name) -> ASR::expr_t* {
+                std::string sym_name = std::string(ASRUtils::symbol_name(thread_data_sym)) + "_" + name;
+                ASR::symbol_t* sym = current_scope->get_symbol(sym_name);
+                if (sym == nullptr) {
+                    sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(al, loc,
+                        current_scope, s2c(al, sym_name), thread_data_symtab->resolve_symbol(name), ASRUtils::symbol_name(thread_data_sym), nullptr, 0,
+                        s2c(al, name), ASR::accessType::Public));
+                    current_scope->add_symbol(sym_name, sym);
+                }
+                return ASRUtils::EXPR(ASR::make_StructInstanceMember_t(al, loc, tdata_expr,
+                    sym, ASRUtils::symbol_type(sym), nullptr));
+            };
+
+            for (auto it: involved_symbols) {
+                ASR::ttype_t* sym_type = it.second;
+                if (ASRUtils::is_array(sym_type)) {
+                    // call c_f_pointer(tdata%<sym>, <sym>, [ubound-lbound+1])
+                    ASR::Array_t* array_type = ASR::down_cast<ASR::Array_t>(
+                        ASRUtils::type_get_past_allocatable(ASRUtils::type_get_past_pointer(sym_type)));
+                    Vec<ASR::dimension_t> dims; dims.reserve(al, array_type->n_dims);
+                    Vec<ASR::expr_t*> size_args; size_args.reserve(al, array_type->n_dims);
+                    Vec<ASR::expr_t*> lbound_args; lbound_args.reserve(al, array_type->n_dims);
+                    for (size_t i = 0; i < array_type->n_dims; i++) {
+                        ASR::dimension_t empty_dim; empty_dim.loc = loc;
+                        empty_dim.m_start = nullptr; empty_dim.m_length = nullptr;
+                        dims.push_back(al, empty_dim);
+                        size_args.push_back(al, b.Add(b.Sub(member("ubound_" + it.first + "_" + std::to_string(i)),
+                            member("lbound_" + it.first + "_" + std::to_string(i))), b.i32(1)));
+                        lbound_args.push_back(al, member("lbound_" + it.first + "_" + std::to_string(i)));
+                    }
+                    ASR::expr_t* var = b.Variable(current_scope, it.first,
+                        ASRUtils::TYPE(ASR::make_Pointer_t(al, loc, ASRUtils::TYPE(ASR::make_Array_t(al, loc,
+                        array_type->m_type, dims.p, dims.n, ASR::array_physical_typeType::DescriptorArray)))),
+                        ASR::intentType::Local, ASR::abiType::BindC);
+                    ASR::expr_t* shape = ASRUtils::EXPR(ASRUtils::make_ArrayConstructor_t_util(al, loc,
+                        size_args.p, size_args.n, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), ASR::arraystorageType::ColMajor));
+                    ASR::expr_t* lower_bounds = ASRUtils::EXPR(ASRUtils::make_ArrayConstructor_t_util(al, loc,
+                        lbound_args.p, lbound_args.n, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)), ASR::arraystorageType::ColMajor));
+                    body.push_back(al, b.CPtrToPointer(member(it.first), var, shape, lower_bounds));
+                } else if (shared.count(it.first)) {
+                    // call c_f_pointer(tdata%<sym>, <sym>)
+                    ASR::expr_t* var = b.Variable(current_scope, it.first,
+                        ASRUtils::TYPE(ASR::make_Pointer_t(al, loc, ASRUtils::duplicate_type(al,
+                        ASRUtils::type_get_past_allocatable(ASRUtils::type_get_past_pointer(sym_type))))),
+                        ASR::intentType::Local, ASR::abiType::BindC);
+                    body.push_back(al, b.CPtrToPointer(member(it.first), var));
+                } else {
+                    // <sym> = tdata%<sym>
+                    ASR::expr_t* var = b.Variable(current_scope, it.first, ASRUtils::duplicate_type(al, sym_type),
+                        ASR::intentType::Local, ASR::abiType::BindC);
+                    body.push_back(al, b.Assignment(var, member(it.first)));
+                }
+            }
+
+            // update all expr present in the task to use the new symbols
+            DoConcurrentStatementVisitor v(al, current_scope);
+            v.current_expr = nullptr;
+            for (size_t i = 0; i < task.n_body; i++) {
+                v.visit_stmt(*task.m_body[i]);
+                body.push_back(al, task.m_body[i]);
+            }
+
+            ASR::symbol_t* function = ASR::down_cast<ASR::symbol_t>(ASRUtils::make_Function_t_util(al, loc, current_scope, s2c(al, current_scope->parent->get_unique_name("lcompilers_task")),
+                nullptr, 0,
+                args.p, args.n,
+                body.p, body.n,
+                nullptr, ASR::abiType::BindC, ASR::accessType::Public,
+                ASR::deftypeType::Implementation, nullptr, false, false, false, false, false,
+                nullptr, 0,
+                false, false, false, nullptr));
+            current_scope->parent->add_symbol(ASRUtils::symbol_name(function), function);
+            current_scope = current_scope_copy;
+            return function;
+        }
+
+        ASR::stmt_t* omp_runtime_call(const Location &loc, std::string name, Vec<ASR::call_arg_t> *args = nullptr) {
+            ASR::symbol_t* mod_sym = create_module(loc, "omp_lib");
+            LCOMPILERS_ASSERT(mod_sym != nullptr && ASR::is_a<ASR::Module_t>(*mod_sym));
+            std::string unsupported_sym_name = import_all(ASR::down_cast<ASR::Module_t>(mod_sym));
+            LCOMPILERS_ASSERT(unsupported_sym_name == "");
+            // a module calling the runtime now depends on omp_lib
+            SymbolTable* scope = current_scope;
+            while (scope->parent != nullptr && scope->parent->parent != nullptr) {
+                scope = scope->parent;
+            }
+            if (ASR::is_a<ASR::symbol_t>(*scope->asr_owner) &&
+                    ASR::is_a<ASR::Module_t>(*ASR::down_cast<ASR::symbol_t>(scope->asr_owner))) {
+                ASR::Module_t* module = ASR::down_cast<ASR::Module_t>(ASR::down_cast<ASR::symbol_t>(scope->asr_owner));
+                SetChar dependencies;
+                dependencies.from_pointer_n_copy(al, module->m_dependencies, module->n_dependencies);
+                dependencies.push_back(al, s2c(al, "omp_lib"));
+                module->m_dependencies = dependencies.p;
+                module->n_dependencies = dependencies.size();
+            }
+            return ASRUtils::STMT(ASR::make_SubroutineCall_t(al, loc, current_scope->get_symbol(name), nullptr,
+                args ? args->p : nullptr, args ? args->n : 0, nullptr));
+        }
+
+        /*
+            !$omp task shared(x)
+                x = fib(n - 1)
+            !$omp end task
+
+            ------To----->
+
+            data%n = n; data%x = c_loc(x)
+            call lfortran_task_spawn(c_funloc(lcompilers_task), c_loc(data), sizeof(data))
+
+            subroutine lcompilers_task(data) bind(C)
+                type(c_ptr), value :: data
+                call c_f_pointer(data, tdata)
+                n = tdata%n; call c_f_pointer(tdata%x, x)
+                x = fib(n - 1)
+            end subroutine
+        */
+        void visit_OMPTask(const ASR::OMPTask_t &x) {
+            Location loc = x.base.base.loc;
+            std::map<std::string, ASR::ttype_t*> involved_symbols;
+            InvolvedSymbolsCollector c(involved_symbols);
+            c.visit_OMPTask(x);
+            for (auto it = involved_symbols.begin(); it != involved_symbols.end(); ) {
+                ASR::symbol_t* sym = current_scope->resolve_symbol(it->first);
+                if (sym == nullptr || !ASR::is_a<ASR::Variable_t>(*ASRUtils::symbol_get_past_external(sym))) {
+                    it = involved_symbols.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            std::set<std::string> shared = get_task_shared_variables(x, involved_symbols);
+            std::set<std::string> by_reference;
+            for (auto &name: shared) {
+                if (!ASRUtils::is_array(involved_symbols[name])) by_reference.insert(name);
+            }
+
+            std::pair<std::string, ASR::symbol_t*> thread_data_module = create_thread_data_module(involved_symbols, loc, by_reference);
+            std::vector<ASR::symbol_t*> module_symbols = create_modules_for_lcompilers_function(loc);
+            ASR::symbol_t* task_function = create_lcompilers_task_function(loc, x, involved_symbols, shared,
+                thread_data_module.first, module_symbols);
+            // a taskwait or taskgroup in the task
+            visit_Function(*ASR::down_cast<ASR::Function_t>(task_function));
+            ASR::symbol_t* task_interface = create_interface_lcompilers_function(
+                ASR::down_cast<ASR::Function_t>(task_function), false);
+
+            ASR::symbol_t* thread_data_ext_sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(al, loc,
+                current_scope, ASRUtils::symbol_name(thread_data_module.second), thread_data_module.second, s2c(al, thread_data_module.first),
+                nullptr, 0, ASRUtils::symbol_name(thread_data_module.second), ASR::accessType::Public));
+            current_scope->add_symbol(ASRUtils::symbol_name(thread_data_module.second), thread_data_ext_sym);
+            ASRUtils::ASRBuilder b(al, loc);
+            ASR::ttype_t* data_type = ASRUtils::TYPE(ASR::make_StructType_t(al, loc, thread_data_ext_sym));
+            ASR::expr_t* data_expr = b.Variable(current_scope, current_scope->get_unique_name("task_data"), data_type, ASR::intentType::Local);
+
+            // data%<name>
+            ASR::symbol_t* thread_data_sym = thread_data_module.second;
+            SymbolTable* thread_data_symtab = ASRUtils::symbol_symtab(thread_data_sym);
+            auto member = [&](const std::string &name) -> ASR::expr_t* {
+                std::string sym_name = std::string(ASRUtils::symbol_name(thread_data_sym)) + "_" + name;
+                ASR::symbol_t* sym = ASR::down_cast<ASR::symbol_t>(ASR::make_ExternalSymbol_t(al, loc,
+                    current_scope, s2c(al, sym_name), thread_data_symtab->resolve_symbol(name), ASRUtils::symbol_name(thread_data_sym), nullptr, 0,
+                    s2c(al, name), ASR::accessType::Public));
+                current_scope->add_symbol(sym_name, sym);
+                return ASRUtils::EXPR(ASR::make_StructInstanceMember_t(al, loc, data_expr,
+                    sym, ASRUtils::symbol_type(sym), nullptr));
+            };
+            for (auto it: involved_symbols) {
+                ASR::expr_t* var = b.Var(current_scope->resolve_symbol(it.first));
+                if (ASRUtils::is_array(it.second)) {
+                    pass_result.push_back(al, b.Assignment(member(it.first), c_loc(var)));
+                    size_t n_dims = ASRUtils::extract_n_dims_from_ttype(it.second);
+                    for (size_t i = 0; i < n_dims; i++) {
+                        pass_result.push_back(al, b.Assignment(member("lbound_" + it.first + "_" + std::to_string(i)),
+                            b.ArrayLBound(var, i+1)));
+                        pass_result.push_back(al, b.Assignment(member("ubound_" + it.first + "_" + std::to_string(i)),
+                            b.ArrayUBound(var, i+1)));
+                    }
+                } else if (shared.count(it.first)) {
+                    pass_result.push_back(al, b.Assignment(member(it.first), c_loc(var)));
+                } else {
+                    pass_result.push_back(al, b.Assignment(member(it.first), var));
+                }
+            }
+
+            // call lfortran_task_spawn(c_funloc(lcompilers_task), c_loc(data), sizeof(data))
+            ASR::Function_t* task_interface_func = ASR::down_cast<ASR::Function_t>(task_interface);
+            Vec<ASR::call_arg_t> call_args; call_args.reserve(al, 3);
+            ASR::call_arg_t arg; arg.loc = loc;
+            arg.m_value = ASRUtils::EXPR(ASR::make_PointerToCPtr_t(al, loc,
+                ASRUtils::EXPR(ASR::make_GetPointer_t(al, loc, b.Var(task_interface),
+                ASRUtils::TYPE(ASR::make_Pointer_t(al, loc, task_interface_func->m_function_signature)), nullptr)),
+                ASRUtils::TYPE(ASR::make_CPtr_t(al, loc)), nullptr));
+            call_args.push_back(al, arg);
+            arg.m_value = c_loc(data_expr);
+            call_args.push_back(al, arg);
+            arg.m_value = ASRUtils::EXPR(ASR::make_SizeOfType_t(al, loc, data_type,
+                ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 8)), nullptr));
+            call_args.push_back(al, arg);
+            pass_result.push_back(al, omp_runtime_call(loc, "lfortran_task_spawn", &call_args));
+            remove_original_statement = true;
+        }
+
+        void visit_OMPTaskwait(const ASR::OMPTaskwait_t &x) {
+            pass_result.push_back(al, omp_runtime_call(x.base.base.loc, "lfortran_taskwait"));
+            remove_original_statement = true;
+        }
+
+        void visit_OMPTaskgroup(const ASR::OMPTaskgroup_t &x) {
+            ASR::OMPTaskgroup_t& xx = const_cast<ASR::OMPTaskgroup_t&>(x);
+            transform_stmts_do_loop(xx.m_body, xx.n_body);
+            pass_result.push_back(al, omp_runtime_call(x.base.base.loc, "lfortran_taskgroup_start"));
+            for (size_t i = 0; i < xx.n_body; i++) {
+                pass_result.push_back(al, xx.m_body[i]);
+            }
+            pass_result.push_back(al, omp_runtime_call(x.base.base.loc, "lfortran_taskgroup_end"));
+            remove_original_statement = true;
+        }
+
         void visit_Function(const ASR::Function_t &x) {
             // FIXME: this is a hack, we need to pass in a non-const `x`,
             // which requires to generate a TransformVisitor.
@@ -1751,13 +2521,38 @@ class DoConcurrentVisitor :
             transform_stmts_do_loop(xx.m_orelse, xx.n_orelse);
         }
 
+        void visit_If(const ASR::If_t &x) {
+            ASR::If_t& xx = const_cast<ASR::If_t&>(x);
+
+            visit_expr(*xx.m_test);
+
+            transform_stmts_do_loop(xx.m_body, xx.n_body);
+            transform_stmts_do_loop(xx.m_orelse, xx.n_orelse);
+        }
+
+        void visit_WhileLoop(const ASR::WhileLoop_t &x) {
+            ASR::WhileLoop_t& xx = const_cast<ASR::WhileLoop_t&>(x);
+
+            visit_expr(*xx.m_test);
+
+            transform_stmts_do_loop(xx.m_body, xx.n_body);
+            transform_stmts_do_loop(xx.m_orelse, xx.n_orelse);
+        }
+
 };
 
 void pass_replace_openmp(Allocator &al, ASR::TranslationUnit_t &unit,
                             const PassOptions &pass_options) {
-    if (pass_options.openmp) {
+    if (pass_options.openmp || pass_options.auto_parallel) {
+        // Internal procedures called from parallel regions must not share
+        // their host variables through a global context
+        pass_nested_vars_static_chain(al, unit, pass_options);
         DoConcurrentVisitor v(al, pass_options);
         v.visit_TranslationUnit(unit);
+        // Outlining moves calls out of their functions, e.g. a recursive
+        // call inside a task now belongs to the outlined function
+        PassUtils::UpdateDependenciesVisitor u(al);
+        u.visit_TranslationUnit(unit);
     }
     return;
 }
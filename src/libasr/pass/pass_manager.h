@@ -2,10 +2,12 @@
 #define LCOMPILERS_PASS_MANAGER_H
 
 #include <iostream>
+#include <memory>
 
 #include <libasr/asr.h>
 #include <libasr/string_utils.h>
 #include <libasr/alloc.h>
+#include <libasr/profiler.h>
 
 // TODO: Remove lpython/lfortran includes, make it compiler agnostic
 #if __has_include(<lfortran/utils.h>)
@@ -22,6 +24,9 @@
 #include <libasr/pass/replace_init_expr.h>
 #include <libasr/pass/replace_implied_do_loops.h>
 #include <libasr/pass/replace_array_op.h>
+#include <libasr/pass/array_loop_fusion.h>
+#include <libasr/pass/hoist_temporaries.h>
+#include <libasr/pass/loop_interchange.h>
 #include <libasr/pass/replace_select_case.h>
 #include <libasr/pass/wrap_global_stmts.h>
 #include <libasr/pass/replace_param_to_const.h>
@@ -41,6 +46,9 @@
 #include <libasr/pass/unused_functions.h>
 #include <libasr/pass/inline_function_calls.h>
 #include <libasr/pass/dead_code_removal.h>
+#include <libasr/pass/constant_propagation.h>
+#include <libasr/pass/common_subexpression_elimination.h>
+#include <libasr/pass/loop_invariant_code_motion.h>
 #include <libasr/pass/replace_for_all.h>
 #include <libasr/pass/replace_init_expr.h>
 #include <libasr/pass/replace_select_case.h>
@@ -63,8 +71,10 @@
 #include <libasr/codegen/asr_to_fortran.h>
 #include <libasr/asr_verify.h>
 #include <libasr/pickle.h>
+#include <libasr/pass/pass_utils.h>
 
 #include <map>
+#include <set>
 #include <vector>
 #include <algorithm>
 #include <fstream>
@@ -74,6 +84,229 @@ namespace LCompilers {
     typedef void (*pass_function)(Allocator&, ASR::TranslationUnit_t&,
                                   const LCompilers::PassOptions&);
 
+    // The statement and expression kinds a pass rewrites. A pass with a
+    // trigger does nothing on an ASR that contains none of these nodes.
+    struct PassTrigger {
+        std::vector<ASR::stmtType> stmts;
+        std::vector<ASR::exprType> exprs;
+        // Also triggered by the statements on whole arrays
+        bool array_stmts = false;
+        // A pass that is listed twice only runs again if some of its trigger
+        // nodes were created since its previous run started
+        bool new_nodes_only = false;
+    };
+
+    // Records the statement and expression kinds present in an ASR, with the
+    // number of the pass that created them last (0 for the initial ASR). It
+    // is taken once, then every node created by the passes adds its kind, so
+    // it may also list kinds that a pass has since lowered away.
+    class ASRNodeCensus : public ASR::BaseWalkVisitor<ASRNodeCensus> {
+        public:
+        // Indexed by the kind, 0 if absent, else 1 + the pass number
+        std::vector<size_t> stmts;
+        std::vector<size_t> exprs;
+        size_t array_stmts = 0;
+        // The number of the running pass
+        size_t pass = 0;
+#if defined(WITH_LFORTRAN_ASSERT)
+        // The locations of the nodes created by the running pass
+        std::vector<Location> created;
+#endif
+
+        static void add(std::vector<size_t> &kinds, size_t kind, size_t when) {
+            if (kind >= kinds.size()) kinds.resize(kind + 1, 0);
+            kinds[kind] = std::max(kinds[kind], when);
+        }
+
+        static size_t get(const std::vector<size_t> &kinds, size_t kind) {
+            return kind < kinds.size() ? kinds[kind] : 0;
+        }
+
+        // The statements that array_op rewrites
+        static bool is_array_stmt(const ASR::stmt_t &x) {
+            switch (x.type) {
+                case ASR::stmtType::Assignment:
+                    return ASRUtils::is_array(ASRUtils::expr_type(
+                        ASR::down_cast<ASR::Assignment_t>(&x)->m_target));
+                case ASR::stmtType::If:
+                    return ASRUtils::is_array(ASRUtils::expr_type(
+                        ASR::down_cast<ASR::If_t>(&x)->m_test));
+                case ASR::stmtType::SubroutineCall:
+                    return PassUtils::is_elemental(
+                        ASR::down_cast<ASR::SubroutineCall_t>(&x)->m_name);
+                default:
+                    return false;
+            }
+        }
+
+        void visit_stmt(const ASR::stmt_t &x) {
+            add(stmts, x.type, 1);
+            if (is_array_stmt(x)) array_stmts = 1;
+            ASR::BaseWalkVisitor<ASRNodeCensus>::visit_stmt(x);
+        }
+
+        void visit_expr(const ASR::expr_t &x) {
+            add(exprs, x.type, 1);
+            ASR::BaseWalkVisitor<ASRNodeCensus>::visit_expr(x);
+        }
+
+        static ASRNodeCensus*& current() {
+            static thread_local ASRNodeCensus* census = nullptr;
+            return census;
+        }
+
+        // A node created while a nested pass manager runs is also counted
+        // by the census of the outer one. The types of a created node may
+        // not be resolved yet (e.g. while a module is loaded), so every
+        // created statement that array_op could rewrite is counted as one
+        // on whole arrays.
+        static void node_created(const ASR::asr_t &x) {
+            for (ASRNodeCensus* c = current(); c; c = c->outer) {
+                size_t when = c->pass + 1;
+                if (x.type == ASR::asrType::stmt) {
+                    ASR::stmtType kind = ASR::down_cast<ASR::stmt_t>(&x)->type;
+                    add(c->stmts, kind, when);
+                    if (kind == ASR::stmtType::Assignment ||
+                            kind == ASR::stmtType::If ||
+                            kind == ASR::stmtType::SubroutineCall) {
+                        c->array_stmts = when;
+                    }
+                } else {
+                    add(c->exprs, ASR::down_cast<ASR::expr_t>(&x)->type, when);
+                }
+#if defined(WITH_LFORTRAN_ASSERT)
+                c->created.push_back(x.loc);
+#endif
+            }
+        }
+
+        // Keeps the census up to date from now on, until it is destroyed
+        void start() {
+            LCOMPILERS_ASSERT(!hook);
+            outer = current();
+            current() = this;
+            hook = std::make_unique<ASR::NodeCreatedHook>(&ASRNodeCensus::node_created);
+        }
+
+        ~ASRNodeCensus() {
+            if (hook) {
+                LCOMPILERS_ASSERT(current() == this);
+                current() = outer;
+            }
+        }
+
+        // Whether a trigger node was present or created since the pass
+        // `since` started
+        bool contains(const PassTrigger &trigger, size_t since) const {
+            for (auto &stmt: trigger.stmts) {
+                if (get(stmts, stmt) > since) return true;
+            }
+            for (auto &expr: trigger.exprs) {
+                if (get(exprs, expr) > since) return true;
+            }
+            return trigger.array_stmts && array_stmts > since;
+        }
+
+        private:
+        // The census that was current when this one started
+        ASRNodeCensus* outer = nullptr;
+        std::unique_ptr<ASR::NodeCreatedHook> hook;
+    };
+
+#if defined(WITH_LFORTRAN_ASSERT)
+    // The bodies, symbol tables and dependencies of the functions (and of
+    // the blocks in them) that passes replace when they change a function.
+    // Used to verify only the functions that a pass changed.
+    class FunctionSnapshot {
+        public:
+
+        struct State {
+            ASR::stmt_t** m_body;
+            size_t n_body;
+            size_t n_symbols;
+            char** m_dependencies;
+            size_t n_dependencies;
+            ASR::ttype_t* m_function_signature;
+
+            bool operator==(const State &o) const {
+                return m_body == o.m_body && n_body == o.n_body &&
+                    n_symbols == o.n_symbols &&
+                    m_dependencies == o.m_dependencies &&
+                    n_dependencies == o.n_dependencies &&
+                    m_function_signature == o.m_function_signature;
+            }
+        };
+
+        std::map<const ASR::symbol_t*, State> states;
+
+        void take(const SymbolTable &symtab) {
+            for (auto &item: symtab.get_scope()) {
+                const ASR::symbol_t* sym = item.second;
+                if (ASR::is_a<ASR::Function_t>(*sym)) {
+                    const ASR::Function_t* f = ASR::down_cast<ASR::Function_t>(sym);
+                    states[sym] = {f->m_body, f->n_body, f->m_symtab->get_scope().size(),
+                        f->m_dependencies, f->n_dependencies, f->m_function_signature};
+                    take(*f->m_symtab);
+                } else if (ASR::is_a<ASR::Block_t>(*sym)) {
+                    const ASR::Block_t* b = ASR::down_cast<ASR::Block_t>(sym);
+                    states[sym] = {b->m_body, b->n_body, b->m_symtab->get_scope().size(),
+                        nullptr, 0, nullptr};
+                    take(*b->m_symtab);
+                } else if (ASR::is_a<ASR::Program_t>(*sym)) {
+                    take(*ASR::down_cast<ASR::Program_t>(sym)->m_symtab);
+                } else if (ASR::is_a<ASR::Module_t>(*sym)) {
+                    take(*ASR::down_cast<ASR::Module_t>(sym)->m_symtab);
+                }
+            }
+        }
+
+        // Adds the functions of `symtab` that are the same in `before` and
+        // contain no node created at the (sorted) locations `created` to
+        // `unchanged`. Returns whether every function and block of `symtab`
+        // is unchanged.
+        bool find_unchanged(const SymbolTable &symtab, const FunctionSnapshot &before,
+                const std::vector<Location> &created,
+                std::set<const ASR::symbol_t*> &unchanged) const {
+            bool all_unchanged = true;
+            for (auto &item: symtab.get_scope()) {
+                const ASR::symbol_t* sym = item.second;
+                SymbolTable* nested = nullptr;
+                if (ASR::is_a<ASR::Function_t>(*sym)) {
+                    nested = ASR::down_cast<ASR::Function_t>(sym)->m_symtab;
+                } else if (ASR::is_a<ASR::Block_t>(*sym)) {
+                    nested = ASR::down_cast<ASR::Block_t>(sym)->m_symtab;
+                } else if (ASR::is_a<ASR::Program_t>(*sym)) {
+                    find_unchanged(*ASR::down_cast<ASR::Program_t>(sym)->m_symtab,
+                        before, created, unchanged);
+                    continue;
+                } else if (ASR::is_a<ASR::Module_t>(*sym)) {
+                    find_unchanged(*ASR::down_cast<ASR::Module_t>(sym)->m_symtab,
+                        before, created, unchanged);
+                    continue;
+                } else {
+                    continue;
+                }
+                bool same = find_unchanged(*nested, before, created, unchanged);
+                auto it = before.states.find(sym);
+                same = same && it != before.states.end() &&
+                    it->second == states.at(sym);
+                if (same) {
+                    auto loc = std::lower_bound(created.begin(), created.end(),
+                        sym->base.loc, [](const Location &a, const Location &b) {
+                            return a.first < b.first;
+                        });
+                    same = loc == created.end() || loc->first > sym->base.loc.last;
+                }
+                if (same && ASR::is_a<ASR::Function_t>(*sym)) {
+                    unchanged.insert(sym);
+                }
+                all_unchanged = all_unchanged && same;
+            }
+            return all_unchanged;
+        }
+    };
+#endif
+
     class PassManager {
         private:
 
@@ -88,6 +321,9 @@ namespace LCompilers {
             {"global_stmts", &pass_wrap_global_stmts},
             {"implied_do_loops", &pass_replace_implied_do_loops},
             {"array_op", &pass_replace_array_op},
+            {"array_loop_fusion", &pass_array_loop_fusion},
+            {"hoist_temporaries", &pass_hoist_temporaries},
+            {"loop_interchange", &pass_loop_interchange},
             {"symbolic", &pass_replace_symbolic},
             {"flip_sign", &pass_replace_flip_sign},
             {"intrinsic_function", &pass_replace_intrinsic_function},
@@ -103,6 +339,9 @@ namespace LCompilers {
             {"inline_function_calls", &pass_inline_function_calls},
             {"loop_unroll", &pass_loop_unroll},
             {"dead_code_removal", &pass_dead_code_removal},
+            {"constant_propagation", &pass_constant_propagation},
+            {"common_subexpression_elimination", &pass_common_subexpression_elimination},
+            {"loop_invariant_code_motion", &pass_loop_invariant_code_motion},
             {"forall", &pass_replace_for_all},
             {"select_case", &pass_replace_select_case},
             {"loop_vectorise", &pass_loop_vectorise},
@@ -124,6 +363,29 @@ namespace LCompilers {
             {"array_struct_temporary", &pass_array_struct_temporary}
         };
 
+        // Passes that only rewrite specific nodes. They are skipped (and so
+        // is the verification after them) when the ASR has no such node.
+        // Passes without an entry always run, and so do the passes that end
+        // by updating the dependencies of every function (class_constructor,
+        // pass_list_expr, intrinsic_subroutine, fma).
+        std::map<std::string, PassTrigger> _pass_triggers = {
+            {"forall", {{ASR::stmtType::ForAllSingle}, {}}},
+            {"where", {{ASR::stmtType::Where}, {}}},
+            {"array_op", {{}, {}, true}},
+            // Listed twice, it runs again for the prints created by print_arr
+            // and for the members of nested structs that it printed
+            {"print_struct_type", {{ASR::stmtType::Print},
+                {ASR::exprType::StructInstanceMember}, false, true}},
+            {"print_arr", {{ASR::stmtType::Print, ASR::stmtType::FileWrite}, {}}},
+            {"print_list_tuple", {{ASR::stmtType::Print}, {ASR::exprType::StringFormat}}},
+            {"loop_interchange", {{ASR::stmtType::DoLoop}, {}}},
+            {"do_loops", {{ASR::stmtType::DoLoop, ASR::stmtType::DoConcurrentLoop}, {}}},
+            {"while_else", {{ASR::stmtType::WhileLoop}, {}}},
+            {"select_case", {{ASR::stmtType::Select}, {}}},
+            {"sign_from_value", {{}, {ASR::exprType::RealBinOp}}},
+            {"div_to_mul", {{}, {ASR::exprType::RealBinOp}}},
+        };
+
         bool apply_default_passes;
         bool c_skip_pass; // This will contain the passes that are to be skipped in C
 
@@ -131,7 +393,11 @@ namespace LCompilers {
         bool rtlib=false;
         void apply_passes(Allocator& al, ASR::TranslationUnit_t* asr,
                            std::vector<std::string>& passes, PassOptions &pass_options,
-                           [[maybe_unused]] diag::Diagnostics &diagnostics) {
+                           diag::Diagnostics &diagnostics) {
+            // The passes add the notes of their reports to the diagnostics
+            // of this compilation
+            PassOptions reporting_pass_options = pass_options;
+            reporting_pass_options.diagnostics = &diagnostics;
             if (pass_options.pass_cumulative) {
                 std::vector<std::string> _with_optimization_passes;
                 _with_optimization_passes.insert(
@@ -168,6 +434,21 @@ namespace LCompilers {
                         passes.push_back(_with_optimization_passes[i]);
                 }
             }
+            // The census is taken at the first pass with a trigger, the
+            // created nodes are counted from the start
+            ASRNodeCensus census;
+            census.start();
+            bool census_taken = false;
+            // The number of the last run of each pass
+            std::map<std::string, size_t> last_run;
+#if defined(WITH_LFORTRAN_ASSERT)
+            // The functions are verified after a pass only if it changed
+            // them, and everything once after the last pass
+            FunctionSnapshot before;
+            before.take(*asr->m_symtab);
+            bool verified_all = true;
+            std::string last_pass;
+#endif
             for (size_t i = 0; i < passes.size(); i++) {
                 // TODO: rework the whole pass manager: construct the passes
                 // ahead of time (not at the last minute), and remove this much
@@ -181,21 +462,73 @@ namespace LCompilers {
                 if (c_skip_pass && std::find(_c_skip_passes.begin(),
                         _c_skip_passes.end(), passes[i]) != _c_skip_passes.end())
                     continue;
+                auto trigger = _pass_triggers.find(passes[i]);
+                if (trigger != _pass_triggers.end()) {
+                    if (!census_taken) {
+                        ProfileRegion profile_region("asr_node_census", "asr_pass");
+                        census.visit_TranslationUnit(*asr);
+                        census_taken = true;
+                    }
+                    size_t since = 0;
+                    auto previous = last_run.find(passes[i]);
+                    if (trigger->second.new_nodes_only && previous != last_run.end()) {
+                        since = previous->second;
+                    }
+                    if (!census.contains(trigger->second, since)) {
+                        if (pass_options.verbose) {
+                            std::cerr << "ASR Pass skipped: '" << passes[i] << "'\n";
+                        }
+                        continue;
+                    }
+                }
                 if (pass_options.verbose) {
                     std::cerr << "ASR Pass starts: '" << passes[i] << "'\n";
                 }
-                _passes_db[passes[i]](al, *asr, pass_options);
+                census.pass++;
+                last_run[passes[i]] = census.pass;
+                {
+                    ProfileRegion profile_region(passes[i], "asr_pass");
+                    _passes_db[passes[i]](al, *asr, reporting_pass_options);
+                }
 #if defined(WITH_LFORTRAN_ASSERT)
-                if (!asr_verify(*asr, true, diagnostics)) {
-                    std::cerr << diagnostics.render2();
-                    throw LCompilersException("Verify failed in the pass: "
-                        + passes[i]);
-                };
+                {
+                    ProfileRegion profile_region("asr_verify", "asr_verify");
+                    FunctionSnapshot after;
+                    after.take(*asr->m_symtab);
+                    std::sort(census.created.begin(), census.created.end(),
+                        [](const Location &a, const Location &b) {
+                            return a.first < b.first;
+                        });
+                    std::set<const ASR::symbol_t*> unchanged;
+                    after.find_unchanged(*asr->m_symtab, before, census.created,
+                        unchanged);
+                    if (!asr_verify(*asr, true, diagnostics, unchanged)) {
+                        std::cerr << diagnostics.render2();
+                        throw LCompilersException("Verify failed in the pass: "
+                            + passes[i]);
+                    };
+                    census.created.clear();
+                    before = std::move(after);
+                    verified_all = unchanged.empty();
+                    last_pass = passes[i];
+                }
 #endif
                 if (pass_options.verbose) {
                     std::cerr << "ASR Pass ends: '" << passes[i] << "'\n";
                 }
             }
+#if defined(WITH_LFORTRAN_ASSERT)
+            // A pass may also change a function in place without creating a
+            // node in it
+            if (!verified_all) {
+                ProfileRegion profile_region("asr_verify", "asr_verify");
+                if (!asr_verify(*asr, true, diagnostics)) {
+                    std::cerr << diagnostics.render2();
+                    throw LCompilersException("Verify failed in the passes up to: "
+                        + last_pass);
+                };
+            }
+#endif
         }
 
         void _parse_pass_arg(std::string& arg, std::vector<std::string>& passes) {
@@ -244,6 +577,8 @@ namespace LCompilers {
                 "intrinsic_function",
                 "intrinsic_subroutine",
                 "array_op",
+                "array_loop_fusion",
+                "hoist_temporaries",
                 "pass_array_by_data",
                 "array_passed_in_function_call",
                 "print_struct_type",
@@ -251,6 +586,7 @@ namespace LCompilers {
                 "print_list_tuple",
                 "print_struct_type",
                 "array_dim_intrinsics_update",
+                "loop_interchange",
                 "do_loops",
                 "while_else",
                 "select_case",
@@ -260,14 +596,18 @@ namespace LCompilers {
             };
             _optimization_passes = {
                 "replace_with_compile_time_values",
+                // Before the lowered move_alloc calls are inlined
+                "promote_allocatable_to_nonallocatable",
+                "inline_function_calls",
+                "constant_propagation",
+                "common_subexpression_elimination",
+                "loop_invariant_code_motion",
                 "loop_vectorise",
                 "dead_code_removal",
                 "unused_functions",
                 "sign_from_value",
                 "div_to_mul",
-                "fma",
-                // "inline_function_calls",
-                // "promote_allocatable_to_nonallocatable"
+                "fma"
             };
 
             // These are re-write passes which are already handled
@@ -277,8 +617,7 @@ namespace LCompilers {
                 "pass_list_expr",
                 "print_list_tuple",
                 "do_loops",
-                "select_case",
-                "inline_function_calls"
+                "select_case"
             };
             _user_defined_passes.clear();
         }
@@ -395,6 +734,13 @@ namespace LCompilers {
         void use_fortran_passes() {
             _user_defined_passes.push_back("unique_symbols");
         }
+
+        // Returns the passes selected or skipped by the user, they change the
+        // generated code (used as a part of the compilation cache key)
+        std::string get_user_passes_key() const {
+            return "passes=" + join(",", _user_defined_passes)
+                + ";skip=" + join(",", _skip_passes);
+        }
     };
 
 }
@@ -847,7 +847,190 @@ namespace LCompilers {
                         int32_type, bound_type, nullptr));
         }
 
-        bool skip_instantiation(PassOptions pass_options, int64_t id) {
+        bool is_same_index_expr(ASR::expr_t* a, ASR::expr_t* b) {
+            if( a == b ) {
+                return true;
+            }
+            if( a == nullptr || b == nullptr ) {
+                return false;
+            }
+            int64_t a_value, b_value;
+            if( ASRUtils::extract_value(ASRUtils::expr_value(a), a_value) &&
+                ASRUtils::extract_value(ASRUtils::expr_value(b), b_value) ) {
+                return a_value == b_value;
+            }
+            if( a->type != b->type ) {
+                return false;
+            }
+            switch( a->type ) {
+                case ASR::exprType::Var: {
+                    return ASRUtils::symbol_get_past_external(ASR::down_cast<ASR::Var_t>(a)->m_v) ==
+                        ASRUtils::symbol_get_past_external(ASR::down_cast<ASR::Var_t>(b)->m_v);
+                }
+                case ASR::exprType::IntegerBinOp: {
+                    ASR::IntegerBinOp_t* a_binop = ASR::down_cast<ASR::IntegerBinOp_t>(a);
+                    ASR::IntegerBinOp_t* b_binop = ASR::down_cast<ASR::IntegerBinOp_t>(b);
+                    return a_binop->m_op == b_binop->m_op &&
+                        is_same_index_expr(a_binop->m_left, b_binop->m_left) &&
+                        is_same_index_expr(a_binop->m_right, b_binop->m_right);
+                }
+                case ASR::exprType::Cast: {
+                    ASR::Cast_t* a_cast = ASR::down_cast<ASR::Cast_t>(a);
+                    ASR::Cast_t* b_cast = ASR::down_cast<ASR::Cast_t>(b);
+                    return a_cast->m_kind == b_cast->m_kind &&
+                        ASRUtils::types_equal(a_cast->m_type, b_cast->m_type, true) &&
+                        is_same_index_expr(a_cast->m_arg, b_cast->m_arg);
+                }
+                case ASR::exprType::ArrayBound: {
+                    ASR::ArrayBound_t* a_bound = ASR::down_cast<ASR::ArrayBound_t>(a);
+                    ASR::ArrayBound_t* b_bound = ASR::down_cast<ASR::ArrayBound_t>(b);
+                    return a_bound->m_bound == b_bound->m_bound &&
+                        is_same_index_expr(a_bound->m_v, b_bound->m_v) &&
+                        is_same_index_expr(a_bound->m_dim, b_bound->m_dim);
+                }
+                case ASR::exprType::ArraySize: {
+                    ASR::ArraySize_t* a_size = ASR::down_cast<ASR::ArraySize_t>(a);
+                    ASR::ArraySize_t* b_size = ASR::down_cast<ASR::ArraySize_t>(b);
+                    return is_same_index_expr(a_size->m_v, b_size->m_v) &&
+                        is_same_index_expr(a_size->m_dim, b_size->m_dim);
+                }
+                default: {
+                    return false;
+                }
+            }
+        }
+
+        // True if `x` cannot change during the execution of a procedure:
+        // constants, parameters and intent(in) dummy arguments
+        static bool is_invariant_dimension_expr(ASR::expr_t* x) {
+            if( ASRUtils::expr_value(x) ) {
+                return true;
+            }
+            switch( x->type ) {
+                case ASR::exprType::Var: {
+                    ASR::symbol_t* sym = ASRUtils::symbol_get_past_external(
+                        ASR::down_cast<ASR::Var_t>(x)->m_v);
+                    if( !ASR::is_a<ASR::Variable_t>(*sym) ) {
+                        return false;
+                    }
+                    ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(sym);
+                    return v->m_intent == ASR::intentType::In ||
+                        v->m_storage == ASR::storage_typeType::Parameter;
+                }
+                case ASR::exprType::IntegerBinOp: {
+                    ASR::IntegerBinOp_t* binop = ASR::down_cast<ASR::IntegerBinOp_t>(x);
+                    return is_invariant_dimension_expr(binop->m_left) &&
+                        is_invariant_dimension_expr(binop->m_right);
+                }
+                case ASR::exprType::Cast: {
+                    return is_invariant_dimension_expr(ASR::down_cast<ASR::Cast_t>(x)->m_arg);
+                }
+                default: {
+                    return false;
+                }
+            }
+        }
+
+        // Replaces lbound/ubound of an explicit shape array by the declared
+        // bounds, so that the bounds of arrays declared with the same shape
+        // compare equal
+        static ASR::expr_t* get_declared_bound(ASR::expr_t* x,
+                int64_t& extra_offset) {
+            extra_offset = 0;
+            if( !ASR::is_a<ASR::ArrayBound_t>(*x) ) {
+                return x;
+            }
+            ASR::ArrayBound_t* bound = ASR::down_cast<ASR::ArrayBound_t>(x);
+            int64_t dim;
+            if( !ASR::is_a<ASR::Var_t>(*bound->m_v) ||
+                !ASRUtils::extract_value(ASRUtils::expr_value(bound->m_dim), dim) ) {
+                return x;
+            }
+            ASR::ttype_t* type = ASRUtils::expr_type(bound->m_v);
+            if( ASRUtils::is_allocatable(type) || ASRUtils::is_pointer(type) ) {
+                return x;
+            }
+            ASR::dimension_t* m_dims = nullptr;
+            int n_dims = ASRUtils::extract_dimensions_from_ttype(type, m_dims);
+            if( dim < 1 || dim > n_dims ) {
+                return x;
+            }
+            ASR::expr_t* start = m_dims[dim - 1].m_start;
+            ASR::expr_t* length = m_dims[dim - 1].m_length;
+            if( start == nullptr || !is_invariant_dimension_expr(start) ) {
+                return x;
+            }
+            if( bound->m_bound == ASR::arrayboundType::LBound ) {
+                return start;
+            }
+            if( length == nullptr || !is_invariant_dimension_expr(length) ) {
+                return x;
+            }
+            // ubound = start + length - 1, only `length` is kept as the base
+            // when `start` is a constant
+            int64_t start_value;
+            if( !ASRUtils::extract_value(ASRUtils::expr_value(start), start_value) ) {
+                return x;
+            }
+            extra_offset = start_value - 1;
+            return length;
+        }
+
+        static void split_constant_offset(ASR::expr_t* x, ASR::expr_t*& base,
+                int64_t& offset) {
+            offset = 0;
+            base = x;
+            while( base != nullptr ) {
+                int64_t value;
+                if( ASRUtils::extract_value(ASRUtils::expr_value(base), value) ) {
+                    offset += value;
+                    base = nullptr;
+                    break;
+                }
+                int64_t extra_offset;
+                ASR::expr_t* declared = get_declared_bound(base, extra_offset);
+                if( declared != base ) {
+                    offset += extra_offset;
+                    base = declared;
+                    continue;
+                }
+                if( !ASR::is_a<ASR::IntegerBinOp_t>(*base) ) {
+                    break;
+                }
+                ASR::IntegerBinOp_t* binop = ASR::down_cast<ASR::IntegerBinOp_t>(base);
+                if( binop->m_op != ASR::binopType::Add &&
+                    binop->m_op != ASR::binopType::Sub ) {
+                    break;
+                }
+                if( ASRUtils::extract_value(ASRUtils::expr_value(binop->m_right), value) ) {
+                    offset += binop->m_op == ASR::binopType::Add ? value : -value;
+                    base = binop->m_left;
+                } else if( binop->m_op == ASR::binopType::Add &&
+                    ASRUtils::extract_value(ASRUtils::expr_value(binop->m_left), value) ) {
+                    offset += value;
+                    base = binop->m_right;
+                } else {
+                    break;
+                }
+            }
+        }
+
+        bool get_index_difference(ASR::expr_t* a, ASR::expr_t* b, int64_t& diff) {
+            if( a == nullptr || b == nullptr ) {
+                return false;
+            }
+            ASR::expr_t *a_base, *b_base;
+            int64_t a_offset, b_offset;
+            split_constant_offset(a, a_base, a_offset);
+            split_constant_offset(b, b_base, b_offset);
+            if( !is_same_index_expr(a_base, b_base) ) {
+                return false;
+            }
+            diff = a_offset - b_offset;
+            return true;
+        }
+
+        bool skip_instantiation(const PassOptions& pass_options, int64_t id) {
             if (!pass_options.skip_optimization_func_instantiation.empty()) {
                 for (size_t i=0; i<pass_options.skip_optimization_func_instantiation.size(); i++) {
                     if (pass_options.skip_optimization_func_instantiation[i] == id) {
@@ -1225,7 +1408,8 @@ namespace LCompilers {
         }
 
         Vec<ASR::stmt_t*> replace_doloop(Allocator &al, const ASR::DoLoop_t &loop,
-                                         int comp, bool use_loop_variable_after_loop) {
+                                         int comp, bool use_loop_variable_after_loop,
+                                         ASR::loop_hint_t* hint) {
             Location loc = loop.base.base.loc;
             ASR::expr_t *a=loop.m_head.m_start;
             ASR::expr_t *b=loop.m_head.m_end;
@@ -1372,7 +1556,7 @@ namespace LCompilers {
             }
 
             ASR::stmt_t *while_loop_stmt = ASRUtils::STMT(ASR::make_WhileLoop_t(al, loc,
-                loop.m_name, cond, body.p, body.size(), loop.m_orelse, loop.n_orelse));
+                loop.m_name, cond, body.p, body.size(), loop.m_orelse, loop.n_orelse, hint));
             Vec<ASR::stmt_t*> result;
             result.reserve(al, 2);
             if( loop_init_stmt ) {
@@ -1634,6 +1818,16 @@ namespace LCompilers {
         }
     }
 
+    void add_report_note(const PassOptions& pass_options,
+        const std::string& message, const Location& loc) {
+        if( pass_options.diagnostics == nullptr ) {
+            return ;
+        }
+        pass_options.diagnostics->add(diag::Diagnostic(message,
+            diag::Level::Note, diag::Stage::ASRPass,
+            {diag::Label("", {loc})}));
+    }
+
     } // namespace PassUtils
 
 } // namespace LCompilers
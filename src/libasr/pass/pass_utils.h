@@ -5,6 +5,7 @@
 #include <libasr/containers.h>
 #include <libasr/asr_pass_walk_visitor.h>
 
+#include <algorithm>
 #include <deque>
 
 namespace LCompilers {
@@ -82,6 +83,16 @@ namespace LCompilers {
         ASR::expr_t* get_bound(ASR::expr_t* arr_expr, int dim, std::string bound,
                                 Allocator& al);
 
+        // Structural equality of integer index expressions, variables are
+        // compared by their symbol
+        bool is_same_index_expr(ASR::expr_t* a, ASR::expr_t* b);
+
+        // Sets `diff` to `a - b` if the difference is a compile time constant
+        bool get_index_difference(ASR::expr_t* a, ASR::expr_t* b, int64_t& diff);
+
+        // Whether the backend generates the intrinsic `id` itself
+        bool skip_instantiation(const PassOptions& pass_options, int64_t id);
+
         ASR::expr_t* get_flipsign(ASR::expr_t* arg0, ASR::expr_t* arg1,
                              Allocator& al, ASR::TranslationUnit_t& unit, const Location& loc,
                              PassOptions& pass_options);
@@ -109,7 +120,8 @@ namespace LCompilers {
             SymbolTable*& global_scope, Location& loc);
 
         Vec<ASR::stmt_t*> replace_doloop(Allocator &al, const ASR::DoLoop_t &loop,
-                                         int comp=-1, bool use_loop_variable_after_loop=false);
+                                         int comp=-1, bool use_loop_variable_after_loop=false,
+                                         ASR::loop_hint_t* hint=nullptr);
 
         ASR::stmt_t* create_do_loop_helper_pack(Allocator &al, const Location &loc,
             std::vector<ASR::expr_t*> do_loop_variables, ASR::expr_t* array, ASR::expr_t* mask,
@@ -307,6 +319,12 @@ namespace LCompilers {
                             body.push_back(al, m_body[i]);
                         }
                     }
+                    // An unchanged body is kept, so that the pass manager
+                    // sees that the function did not change
+                    if (body.size() == n_body && std::equal(body.p,
+                            body.p + n_body, m_body)) {
+                        return;
+                    }
                     m_body = body.p;
                     n_body = body.size();
                 }
@@ -1304,6 +1322,10 @@ namespace LCompilers {
         }
     }
 
+        // Adds a note of a pass report (--array-storage-report, ...) to the
+        // diagnostics of the compilation
+        void add_report_note(const PassOptions& pass_options,
+            const std::string& message, const Location& loc);
 
     } // namespace PassUtils
 
@@ -174,6 +174,16 @@ public:
     void visit_Print(const ASR::Print_t& x) {
         LCOMPILERS_ASSERT(ASR::is_a<ASR::String_t>(*ASRUtils::expr_type(x.m_text)));
         if (ASR::is_a<ASR::StringFormat_t>(*x.m_text)) {
+            ASR::StringFormat_t* fmt = ASR::down_cast<ASR::StringFormat_t>(x.m_text);
+            bool has_array = false;
+            for (size_t i=0; i<fmt->n_args && !has_array; i++) {
+                has_array = PassUtils::is_array(fmt->m_args[i]);
+            }
+            if (!has_array) {
+                // Keep the original statement
+                remove_original_stmt = false;
+                return;
+            }
             std::vector<ASR::expr_t*> print_body;
             ASR::stmt_t* empty_print_endl;
             ASR::stmt_t* print_stmt;
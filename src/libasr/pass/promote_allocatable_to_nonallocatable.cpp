@@ -4,101 +4,359 @@
 #include <libasr/pass/pass_utils.h>
 #include <libasr/containers.h>
 #include <map>
+#include <set>
 
 #include <libasr/pass/intrinsic_function_registry.h>
 
 namespace LCompilers {
 
-class IsAllocatedCalled: public ASR::CallReplacerOnExpressionsVisitor<IsAllocatedCalled> {
+/*
+This ASR pass promotes local allocatable arrays that do not escape the
+procedure to automatic arrays, which the LLVM backend places on the stack
+(up to --stack-arrays-limit bytes, above that on the heap). It is one of the
+--fast optimization passes.
+
+Converts:
+
+    subroutine f(n)
+        integer, intent(in) :: n
+        real, allocatable :: a(:)
+        allocate(a(n))
+        ...
+        deallocate(a)
+    end subroutine
+
+to:
+
+    subroutine f(n)
+        integer, intent(in) :: n
+        real :: a(n)
+        ...
+    end subroutine
+
+An allocatable array is promoted if
+
+    * it is a local variable of a function or a program without the target
+      attribute, and its elements are of an intrinsic non-character type,
+    * it is allocated by exactly one `allocate` statement without options,
+      whose bounds can be evaluated at the entry of the procedure (constants,
+      intent(in) scalar arguments and the shape of non-allocatable array
+      arguments),
+    * its allocation status is never queried, it is never reallocated, never
+      passed to an allocatable or pointer dummy argument or an intrinsic
+      subroutine, never an argument of `move_alloc` (an intrinsic function
+      in the ASR, or the function it is lowered to), never assigned to as a whole, never the target of a
+      pointer or `c_loc` and never used by a nested procedure,
+    * it has at most --stack-arrays-limit bytes if its size is a compile time
+      constant, fixed size arrays are always placed on the stack.
+
+With --array-storage-report the storage chosen for every local array is
+reported as a note, together with the reason why an allocatable array stays
+on the heap.
+*/
+
+// Checks that an expression can be evaluated at the entry of a procedure
+// and has the same value there as anywhere in its body
+class EntryInvariantExpr: public ASR::BaseWalkVisitor<EntryInvariantExpr> {
+
     public:
 
-        std::map<SymbolTable*, std::vector<ASR::symbol_t*>>& scope2var;
+        bool is_invariant;
+
+        EntryInvariantExpr(): is_invariant(true) {}
+
+        static bool is_shape_fixed_argument(ASR::expr_t* x) {
+            if( !ASR::is_a<ASR::Var_t>(*x) ||
+                !ASR::is_a<ASR::Variable_t>(*ASR::down_cast<ASR::Var_t>(x)->m_v) ) {
+                return false;
+            }
+            ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(
+                ASR::down_cast<ASR::Var_t>(x)->m_v);
+            return ASRUtils::is_arg_dummy(v->m_intent) &&
+                v->m_presence != ASR::presenceType::Optional &&
+                !ASRUtils::is_allocatable(v->m_type) &&
+                !ASRUtils::is_pointer(v->m_type);
+        }
+
+        void visit_Var(const ASR::Var_t& x) {
+            if( !ASR::is_a<ASR::Variable_t>(*x.m_v) ) {
+                is_invariant = false;
+                return ;
+            }
+            ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(x.m_v);
+            if( v->m_storage == ASR::storage_typeType::Parameter ) {
+                return ;
+            }
+            is_invariant = is_invariant && !ASRUtils::is_array(v->m_type) &&
+                v->m_intent == ASR::intentType::In &&
+                v->m_presence != ASR::presenceType::Optional &&
+                !ASRUtils::is_allocatable(v->m_type) &&
+                !ASRUtils::is_pointer(v->m_type);
+        }
+
+        void visit_ArraySize(const ASR::ArraySize_t& x) {
+            is_invariant = is_invariant && is_shape_fixed_argument(x.m_v);
+            if( x.m_dim ) {
+                visit_expr(*x.m_dim);
+            }
+        }
+
+        void visit_ArrayBound(const ASR::ArrayBound_t& x) {
+            is_invariant = is_invariant && is_shape_fixed_argument(x.m_v);
+            if( x.m_dim ) {
+                visit_expr(*x.m_dim);
+            }
+        }
+
+        void visit_FunctionCall(const ASR::FunctionCall_t& /*x*/) {
+            is_invariant = false;
+        }
 
-        IsAllocatedCalled(std::map<SymbolTable*, std::vector<ASR::symbol_t*>>& scope2var_):
-            scope2var(scope2var_) {}
+        void visit_ArrayItem(const ASR::ArrayItem_t& /*x*/) {
+            is_invariant = false;
+        }
+
+        void visit_ArraySection(const ASR::ArraySection_t& /*x*/) {
+            is_invariant = false;
+        }
+
+        void visit_StructInstanceMember(const ASR::StructInstanceMember_t& /*x*/) {
+            is_invariant = false;
+        }
+
+        static bool check(ASR::expr_t* x) {
+            if( x == nullptr ) {
+                return false;
+            }
+            if( ASRUtils::expr_value(x) ) {
+                return true;
+            }
+            EntryInvariantExpr visitor;
+            visitor.visit_expr(*x);
+            return visitor.is_invariant;
+        }
+};
+
+class ArrayEscapeAnalysis: public ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis> {
+    public:
+
+        // The reason why an allocatable array has to stay on the heap
+        std::map<ASR::symbol_t*, std::string>& escapes;
+        std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>>& allocations;
+
+        ArrayEscapeAnalysis(std::map<ASR::symbol_t*, std::string>& escapes_,
+            std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>>& allocations_):
+            escapes(escapes_), allocations(allocations_) {}
+
+        void escape(ASR::expr_t* x, const std::string& reason) {
+            while( x ) {
+                if( ASR::is_a<ASR::Var_t>(*x) ) {
+                    ASR::symbol_t* sym = ASR::down_cast<ASR::Var_t>(x)->m_v;
+                    if( escapes.find(sym) == escapes.end() ) {
+                        escapes[sym] = reason;
+                    }
+                    return ;
+                } else if( ASR::is_a<ASR::ArraySection_t>(*x) ) {
+                    x = ASR::down_cast<ASR::ArraySection_t>(x)->m_v;
+                } else if( ASR::is_a<ASR::ArrayItem_t>(*x) ) {
+                    x = ASR::down_cast<ASR::ArrayItem_t>(x)->m_v;
+                } else if( ASR::is_a<ASR::ArrayPhysicalCast_t>(*x) ) {
+                    x = ASR::down_cast<ASR::ArrayPhysicalCast_t>(x)->m_arg;
+                } else {
+                    return ;
+                }
+            }
+        }
+
+        void visit_Var(const ASR::Var_t& x) {
+            if( !ASR::is_a<ASR::Variable_t>(*x.m_v) ) {
+                return ;
+            }
+            SymbolTable* var_scope = ASR::down_cast<ASR::Variable_t>(x.m_v)->m_parent_symtab;
+            for( SymbolTable* scope = current_scope; scope && scope != var_scope;
+                 scope = scope->parent ) {
+                if( scope->asr_owner && ASR::is_a<ASR::symbol_t>(*scope->asr_owner) &&
+                    ASR::is_a<ASR::Function_t>(*ASR::down_cast<ASR::symbol_t>(scope->asr_owner)) ) {
+                    escape(const_cast<ASR::expr_t*>(&x.base), "used by a nested procedure");
+                    return ;
+                }
+            }
+        }
 
         void visit_IntrinsicImpureFunction(const ASR::IntrinsicImpureFunction_t& x) {
             if( x.m_impure_intrinsic_id == static_cast<int64_t>(
                 ASRUtils::IntrinsicImpureFunctions::Allocated) ) {
                 LCOMPILERS_ASSERT(x.n_args == 1);
-                if( ASR::is_a<ASR::Var_t>(*x.m_args[0]) ) {
-                    scope2var[current_scope].push_back(
-                        ASR::down_cast<ASR::Var_t>(x.m_args[0])->m_v);
+                escape(x.m_args[0], "its allocation status is queried");
+            }
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_IntrinsicImpureFunction(x);
+        }
+
+        void visit_IntrinsicElementalFunction(const ASR::IntrinsicElementalFunction_t& x) {
+            // move_alloc(from, to) is `to = MoveAlloc(from, to)`, both
+            // arrays must keep their descriptors
+            if( x.m_intrinsic_id == static_cast<int64_t>(
+                ASRUtils::IntrinsicElementalFunctions::MoveAlloc) ) {
+                for( size_t i = 0; i < x.n_args; i++ ) {
+                    escape(x.m_args[i], "it is an argument of move_alloc");
                 }
             }
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_IntrinsicElementalFunction(x);
         }
 
-        void visit_FunctionCall(const ASR::FunctionCall_t& x) {
-            ASR::FunctionType_t* func_type = ASRUtils::get_FunctionType(x.m_name);
+        void visit_IntrinsicImpureSubroutine(const ASR::IntrinsicImpureSubroutine_t& x) {
             for( size_t i = 0; i < x.n_args; i++ ) {
-                if( ASR::is_a<ASR::Allocatable_t>(*func_type->m_arg_types[i]) ||
+                escape(x.m_args[i], "passed to an intrinsic subroutine");
+            }
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_IntrinsicImpureSubroutine(x);
+        }
+
+        void visit_call_args(ASR::symbol_t* name, ASR::call_arg_t* args, size_t n_args) {
+            ASR::FunctionType_t* func_type = ASRUtils::get_FunctionType(name);
+            for( size_t i = 0; i < n_args; i++ ) {
+                if( args[i].m_value == nullptr ) {
+                    continue;
+                }
+                if( i >= func_type->n_arg_types ||
+                    ASR::is_a<ASR::Allocatable_t>(*func_type->m_arg_types[i]) ||
                     ASR::is_a<ASR::Pointer_t>(*func_type->m_arg_types[i]) ) {
-                    if( ASR::is_a<ASR::Var_t>(*x.m_args[i].m_value) ) {
-                        scope2var[current_scope].push_back(
-                            ASR::down_cast<ASR::Var_t>(x.m_args[i].m_value)->m_v);
-                    }
+                    escape(args[i].m_value, "passed to an allocatable or pointer dummy argument");
                 }
             }
         }
 
-        void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
-            ASR::FunctionType_t* func_type = ASRUtils::get_FunctionType(x.m_name);
-            for( size_t i = 0; i < x.n_args; i++ ) {
-                if( ASR::is_a<ASR::Allocatable_t>(*func_type->m_arg_types[i]) ||
-                    ASR::is_a<ASR::Pointer_t>(*func_type->m_arg_types[i]) ) {
-                    if( ASR::is_a<ASR::Var_t>(*x.m_args[i].m_value) ) {
-                        scope2var[current_scope].push_back(
-                            ASR::down_cast<ASR::Var_t>(x.m_args[i].m_value)->m_v);
-                    }
+        void visit_FunctionCall(const ASR::FunctionCall_t& x) {
+            // In the --fast pipeline MoveAlloc is already lowered to
+            // `to(i) = _lcompilers_move_alloc_<type>(from(i), to(i))`
+            if( startswith(ASRUtils::symbol_name(
+                    ASRUtils::symbol_get_past_external(x.m_name)),
+                    "_lcompilers_move_alloc_") ) {
+                for( size_t i = 0; i < x.n_args; i++ ) {
+                    escape(x.m_args[i].m_value, "it is an argument of move_alloc");
                 }
             }
+            visit_call_args(x.m_name, x.m_args, x.n_args);
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_FunctionCall(x);
+        }
+
+        void visit_SubroutineCall(const ASR::SubroutineCall_t& x) {
+            visit_call_args(x.m_name, x.m_args, x.n_args);
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_SubroutineCall(x);
         }
 
         void visit_ReAlloc(const ASR::ReAlloc_t& x) {
             for( size_t i = 0; i < x.n_args; i++ ) {
-                if( ASR::is_a<ASR::Allocatable_t>(*ASRUtils::expr_type(x.m_args[i].m_a)) ||
-                    ASR::is_a<ASR::Pointer_t>(*ASRUtils::expr_type(x.m_args[i].m_a)) ) {
-                    if( ASR::is_a<ASR::Var_t>(*x.m_args[i].m_a) ) {
-                        scope2var[current_scope].push_back(
-                            ASR::down_cast<ASR::Var_t>(x.m_args[i].m_a)->m_v);
-                    }
-                }
+                escape(x.m_args[i].m_a, "it is reallocated");
             }
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_ReAlloc(x);
         }
 
-        bool is_array_size_called_on_pointer(ASR::dimension_t* m_dims, size_t n_dims) {
-            for( size_t i = 0; i < n_dims; i++ ) {
-                #define check_pointer_in_array_size(expr) if( expr && ASR::is_a<ASR::ArraySize_t>(*expr) ) { \
-                    ASR::ArraySize_t* array_size_t = ASR::down_cast<ASR::ArraySize_t>(expr); \
-                    if( ASRUtils::is_pointer(ASRUtils::expr_type(array_size_t->m_v)) ) { \
-                        return true; \
-                    } \
-                } \
+        void visit_Assignment(const ASR::Assignment_t& x) {
+            if( ASR::is_a<ASR::Var_t>(*x.m_target) ) {
+                escape(x.m_target, "it is assigned to as a whole");
+            }
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_Assignment(x);
+        }
 
-                check_pointer_in_array_size(m_dims[i].m_start)
-                check_pointer_in_array_size(m_dims[i].m_length)
+        void visit_Associate(const ASR::Associate_t& x) {
+            escape(x.m_value, "it is the target of a pointer");
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_Associate(x);
+        }
 
-            }
+        void visit_GetPointer(const ASR::GetPointer_t& x) {
+            escape(x.m_arg, "its address is taken");
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_GetPointer(x);
+        }
 
-            return false;
+        void visit_PointerToCPtr(const ASR::PointerToCPtr_t& x) {
+            escape(x.m_arg, "its address is taken");
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_PointerToCPtr(x);
         }
 
         void visit_Allocate(const ASR::Allocate_t& x) {
             for( size_t i = 0; i < x.n_args; i++ ) {
                 ASR::alloc_arg_t alloc_arg = x.m_args[i];
-                if( !ASRUtils::is_dimension_dependent_only_on_arguments(
-                        alloc_arg.m_dims, alloc_arg.n_dims) ||
-                    is_array_size_called_on_pointer(alloc_arg.m_dims, alloc_arg.n_dims) ) {
-                    if( ASR::is_a<ASR::Var_t>(*alloc_arg.m_a) ) {
-                        scope2var[current_scope].push_back(
-                                ASR::down_cast<ASR::Var_t>(alloc_arg.m_a)->m_v);
+                if( !ASR::is_a<ASR::Var_t>(*alloc_arg.m_a) ) {
+                    continue;
+                }
+                allocations[ASR::down_cast<ASR::Var_t>(alloc_arg.m_a)->m_v].push_back(&x);
+                if( x.m_stat || x.m_errmsg || x.m_source ||
+                    alloc_arg.m_len_expr || alloc_arg.m_type ) {
+                    escape(alloc_arg.m_a, "it is allocated with options");
+                    continue;
+                }
+                for( size_t j = 0; j < alloc_arg.n_dims; j++ ) {
+                    if( (alloc_arg.m_dims[j].m_start &&
+                         !EntryInvariantExpr::check(alloc_arg.m_dims[j].m_start)) ||
+                        !EntryInvariantExpr::check(alloc_arg.m_dims[j].m_length) ) {
+                        escape(alloc_arg.m_a, "its shape depends on values computed in the procedure");
+                        break;
                     }
                 }
             }
+            ASR::CallReplacerOnExpressionsVisitor<ArrayEscapeAnalysis>::visit_Allocate(x);
         }
 
 };
 
+int64_t get_element_size(ASR::ttype_t* type) {
+    ASR::ttype_t* element_type = ASRUtils::type_get_past_array(
+        ASRUtils::type_get_past_allocatable(type));
+    int64_t kind = ASRUtils::extract_kind_from_ttype_t(element_type);
+    if( ASR::is_a<ASR::Complex_t>(*element_type) ) {
+        return 2 * kind;
+    }
+    return kind;
+}
+
+// Returns the reason why `sym` cannot be promoted, or an empty string
+std::string get_promotion_blocker(ASR::symbol_t* sym,
+    std::map<ASR::symbol_t*, std::string>& escapes,
+    std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>>& allocations,
+    const PassOptions& pass_options) {
+    ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(sym);
+    ASR::ttype_t* element_type = ASRUtils::type_get_past_array(
+        ASRUtils::type_get_past_allocatable(v->m_type));
+    if( v->m_target_attr ) {
+        return "it has the target attribute";
+    }
+    if( v->m_storage != ASR::storage_typeType::Default ) {
+        return "it is saved";
+    }
+    if( ASR::is_a<ASR::StructType_t>(*element_type) ||
+        ASR::is_a<ASR::String_t>(*element_type) ||
+        ASR::is_a<ASR::ClassType_t>(*element_type) ) {
+        return "its elements are not of an intrinsic numeric or logical type";
+    }
+    if( escapes.find(sym) != escapes.end() ) {
+        return escapes[sym];
+    }
+    if( allocations[sym].size() != 1 ) {
+        return allocations[sym].empty() ? "it is not allocated in the procedure"
+            : "it is allocated more than once";
+    }
+    const ASR::Allocate_t* alloc = allocations[sym][0];
+    for( size_t i = 0; i < alloc->n_args; i++ ) {
+        if( ASR::is_a<ASR::Var_t>(*alloc->m_args[i].m_a) &&
+            ASR::down_cast<ASR::Var_t>(alloc->m_args[i].m_a)->m_v == sym ) {
+            int64_t size = ASRUtils::get_fixed_size_of_array(
+                alloc->m_args[i].m_dims, alloc->m_args[i].n_dims);
+            if( size >= 0 && size * get_element_size(v->m_type) >
+                    pass_options.stack_arrays_limit ) {
+                return "its " + std::to_string(size * get_element_size(v->m_type)) +
+                    " bytes exceed --stack-arrays-limit";
+            }
+        }
+    }
+    return "";
+}
+
+bool is_promotion_scope(SymbolTable* scope) {
+    return scope->asr_owner && ASR::is_a<ASR::symbol_t>(*scope->asr_owner) &&
+        (ASR::is_a<ASR::Function_t>(*ASR::down_cast<ASR::symbol_t>(scope->asr_owner)) ||
+         ASR::is_a<ASR::Program_t>(*ASR::down_cast<ASR::symbol_t>(scope->asr_owner)));
+}
+
 class PromoteAllocatableToNonAllocatable:
     public ASR::CallReplacerOnExpressionsVisitor<PromoteAllocatableToNonAllocatable>
 {
@@ -106,14 +364,33 @@ class PromoteAllocatableToNonAllocatable:
 
         Allocator& al;
         bool remove_original_statement;
+        const PassOptions& pass_options;
 
     public:
 
-        std::map<SymbolTable*, std::vector<ASR::symbol_t*>>& scope2var;
+        std::map<ASR::symbol_t*, std::string>& escapes;
+        std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>>& allocations;
+        std::set<ASR::symbol_t*> promoted;
 
-        PromoteAllocatableToNonAllocatable(Allocator& al_,
-            std::map<SymbolTable*, std::vector<ASR::symbol_t*>>& scope2var_):
-            al(al_), remove_original_statement(false), scope2var(scope2var_) {}
+        PromoteAllocatableToNonAllocatable(Allocator& al_, const PassOptions& pass_options_,
+            std::map<ASR::symbol_t*, std::string>& escapes_,
+            std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>>& allocations_):
+            al(al_), remove_original_statement(false), pass_options(pass_options_),
+            escapes(escapes_), allocations(allocations_) {}
+
+        bool is_promotable(ASR::expr_t* x) {
+            if( !ASR::is_a<ASR::Var_t>(*x) ||
+                !ASR::is_a<ASR::Variable_t>(*ASR::down_cast<ASR::Var_t>(x)->m_v) ) {
+                return false;
+            }
+            ASR::symbol_t* sym = ASR::down_cast<ASR::Var_t>(x)->m_v;
+            ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(sym);
+            return ASR::is_a<ASR::Allocatable_t>(*v->m_type) &&
+                ASRUtils::is_array(v->m_type) &&
+                v->m_intent == ASRUtils::intent_local &&
+                is_promotion_scope(v->m_parent_symtab) &&
+                get_promotion_blocker(sym, escapes, allocations, pass_options).empty();
+        }
 
         void visit_Allocate(const ASR::Allocate_t& x) {
             ASR::Allocate_t& xx = const_cast<ASR::Allocate_t&>(x);
@@ -121,20 +398,10 @@ class PromoteAllocatableToNonAllocatable:
             x_args.reserve(al, x.n_args);
             for( size_t i = 0; i < x.n_args; i++ ) {
                 ASR::alloc_arg_t alloc_arg = x.m_args[i];
-                if( ASR::is_a<ASR::Var_t>(*alloc_arg.m_a) &&
-                    ASR::is_a<ASR::Allocatable_t>(*ASRUtils::expr_type(alloc_arg.m_a)) &&
-                    ASRUtils::is_array(ASRUtils::expr_type(alloc_arg.m_a)) &&
-                    ASR::is_a<ASR::Variable_t>(
-                        *ASR::down_cast<ASR::Var_t>(alloc_arg.m_a)->m_v) &&
-                    ASRUtils::expr_intent(alloc_arg.m_a) == ASRUtils::intent_local &&
-                    ASRUtils::is_dimension_dependent_only_on_arguments(
-                        alloc_arg.m_dims, alloc_arg.n_dims) &&
-                    std::find(scope2var[current_scope].begin(),
-                        scope2var[current_scope].end(),
-                        ASR::down_cast<ASR::Var_t>(alloc_arg.m_a)->m_v) ==
-                        scope2var[current_scope].end() ) {
+                if( is_promotable(alloc_arg.m_a) ) {
                     ASR::Variable_t* alloc_variable = ASR::down_cast<ASR::Variable_t>(
                         ASR::down_cast<ASR::Var_t>(alloc_arg.m_a)->m_v);
+                    promoted.insert(&alloc_variable->base);
                     alloc_variable->m_type = ASRUtils::make_Array_t_util(al, x.base.base.loc,
                         ASRUtils::type_get_past_array(
                             ASRUtils::type_get_past_allocatable(alloc_variable->m_type)),
@@ -279,19 +546,65 @@ class FixArrayPhysicalCastVisitor: public ASR::CallReplacerOnExpressionsVisitor<
         }
 };
 
+void report_array_storage(SymbolTable* scope, const std::set<ASR::symbol_t*>& promoted,
+    std::map<ASR::symbol_t*, std::string>& escapes,
+    std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>>& allocations,
+    const PassOptions& pass_options) {
+    for( auto& item: scope->get_scope() ) {
+        ASR::symbol_t* sym = item.second;
+        if( ASR::is_a<ASR::Variable_t>(*sym) && is_promotion_scope(scope) ) {
+            ASR::Variable_t* v = ASR::down_cast<ASR::Variable_t>(sym);
+            if( v->m_intent != ASRUtils::intent_local || !ASRUtils::is_array(v->m_type) ||
+                ASRUtils::is_pointer(v->m_type) ) {
+                continue;
+            }
+            std::string storage;
+            if( ASRUtils::is_allocatable(v->m_type) ) {
+                storage = "heap, " + get_promotion_blocker(sym, escapes, allocations, pass_options);
+            } else if( v->m_storage == ASR::storage_typeType::Save ||
+                       v->m_storage == ASR::storage_typeType::Parameter ) {
+                storage = "static";
+            } else if( ASRUtils::get_fixed_size_of_array(v->m_type) >= 0 ) {
+                storage = "stack, " + std::to_string(ASRUtils::get_fixed_size_of_array(v->m_type) *
+                    get_element_size(v->m_type)) + " bytes";
+            } else if( pass_options.stack_arrays ) {
+                storage = "stack";
+            } else {
+                storage = "stack up to " + std::to_string(pass_options.stack_arrays_limit) +
+                    " bytes, heap above";
+            }
+            if( promoted.find(sym) != promoted.end() ) {
+                storage += ", promoted from allocatable";
+            }
+            PassUtils::add_report_note(pass_options, std::string("Array storage of ") +
+                ASRUtils::symbol_name(ASR::down_cast<ASR::symbol_t>(scope->asr_owner)) +
+                "::" + v->m_name + ": " + storage, v->base.base.loc);
+        } else if( ASRUtils::symbol_symtab(sym) && !ASR::is_a<ASR::Struct_t>(*sym) &&
+                   !ASR::is_a<ASR::ExternalSymbol_t>(*sym) ) {
+            report_array_storage(ASRUtils::symbol_symtab(sym), promoted, escapes,
+                allocations, pass_options);
+        }
+    }
+}
+
 void pass_promote_allocatable_to_nonallocatable(
     Allocator &al, ASR::TranslationUnit_t &unit,
-    const PassOptions &/*pass_options*/) {
-    std::map<SymbolTable*, std::vector<ASR::symbol_t*>> scope2var;
-    IsAllocatedCalled is_allocated_called(scope2var);
-    is_allocated_called.visit_TranslationUnit(unit);
-    PromoteAllocatableToNonAllocatable promoter(al, scope2var);
+    const PassOptions &pass_options) {
+    std::map<ASR::symbol_t*, std::string> escapes;
+    std::map<ASR::symbol_t*, std::vector<const ASR::Allocate_t*>> allocations;
+    ArrayEscapeAnalysis escape_analysis(escapes, allocations);
+    escape_analysis.visit_TranslationUnit(unit);
+    PromoteAllocatableToNonAllocatable promoter(al, pass_options, escapes, allocations);
     promoter.visit_TranslationUnit(unit);
     promoter.visit_TranslationUnit(unit);
     FixArrayPhysicalCastVisitor fix_array_physical_cast(al);
     fix_array_physical_cast.visit_TranslationUnit(unit);
     PassUtils::UpdateDependenciesVisitor u(al);
     u.visit_TranslationUnit(unit);
+    if( pass_options.array_storage_report ) {
+        report_array_storage(unit.m_symtab, promoter.promoted, escapes,
+            allocations, pass_options);
+    }
 }
 
 } // namespace LCompilers
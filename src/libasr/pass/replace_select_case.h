@@ -1,6 +1,8 @@
 #ifndef LIBASR_PASS_REPLACE_SELECT_CASE_H
 #define LIBASR_PASS_REPLACE_SELECT_CASE_H
 
+#include <map>
+
 #include <libasr/asr.h>
 #include <libasr/utils.h>
 
@@ -9,6 +11,20 @@ namespace LCompilers {
     void pass_replace_select_case(Allocator &al, ASR::TranslationUnit_t &unit,
                                 const PassOptions &pass_options);
 
+    // Collects the labels of an integer `select case` as disjoint ranges of
+    // values, keyed by their lower bound and mapped to the upper bound and
+    // the index of the case. Returns false, so that the `select case` is not
+    // lowered to a `switch`, if a label is not a compile time constant, a
+    // range is open-ended, two labels overlap or the labels cover more than
+    // `max_values` values.
+    bool get_select_case_switch_values(const ASR::Select_t &x,
+        std::map<int64_t, std::pair<int64_t, size_t>> &ranges,
+        size_t max_values=1024);
+
+    // Lowers a `select case` without fall through to an if-else-if chain
+    Vec<ASR::stmt_t*> replace_selectcase(Allocator &al,
+        const ASR::Select_t &select_case);
+
 } // namespace LCompilers
 
 #endif // LIBASR_PASS_REPLACE_SELECT_CASE_H
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <iterator>
+
 #include <libasr/asr.h>
 #include <libasr/containers.h>
 #include <libasr/exception.h>
@@ -46,8 +49,307 @@ to:
         ...
     end if
 
+A `select case` with at least `min_binary_search_labels` constant integer or
+character labels is instead lowered to a binary search over its sorted labels,
+which sets the index of the matching case, followed by a binary search over
+that index:
+
+    __libasr_case = 0
+    if ( a < d ) then
+        if ( b <= a && a <= c ) __libasr_case = 1
+    else if ( a <= e ) then
+        __libasr_case = 2
+    else
+        if ( a == f ) __libasr_case = 3
+    end if
+    if ( __libasr_case < 2 ) then
+        if ( __libasr_case < 1 ) then
+            ...     ! default
+        else
+            ...     ! case (b:c)
+        end if
+    else
+        ...
+    end if
+
+A backend that sets `PassOptions::select_case_to_switch` keeps every
+`select case` for which `get_select_case_switch_values` succeeds
+and emits a `switch` for it.
+
 */
 
+namespace {
+
+// `select case` with fewer labels stay an if-else-if chain
+const size_t min_binary_search_labels = 8;
+
+// Compile time value of a label, `s` for character selectors
+struct LabelValue {
+    int64_t i;
+    std::string s;
+};
+
+// A label as the interval `[lo, hi]` of selector values, `lo` (`hi`) is
+// nullptr for a range open to the left (right)
+struct CaseLabel {
+    ASR::expr_t *lo, *hi;
+    LabelValue lo_value, hi_value;
+    size_t case_idx;
+};
+
+bool get_label_value(ASR::expr_t* label, bool is_string, LabelValue& value) {
+    ASR::expr_t* label_value = ASRUtils::expr_value(label);
+    if( !is_string ) {
+        return ASRUtils::extract_value(label_value, value.i);
+    }
+    if( label_value == nullptr ||
+        !ASR::is_a<ASR::StringConstant_t>(*label_value) ) {
+        return false;
+    }
+    std::string s = ASR::down_cast<ASR::StringConstant_t>(label_value)->m_s;
+    for( char c: s ) {
+        // Sorted with the signed `char` comparison of the runtime
+        if( static_cast<unsigned char>(c) > 127 ) {
+            return false;
+        }
+    }
+    // Trailing blanks do not take part in a comparison
+    value.s = s.substr(0, s.find_last_not_of(' ') + 1);
+    return true;
+}
+
+// Orders label values like the comparison of the selector at runtime does
+int compare_label_values(const LabelValue& a, const LabelValue& b, bool is_string) {
+    if( !is_string ) {
+        return (a.i > b.i) - (a.i < b.i);
+    }
+    // The shorter value is padded with blanks, which sort after the
+    // characters below 0x20
+    size_t n = std::max(a.s.size(), b.s.size());
+    for( size_t i = 0; i < n; i++ ) {
+        char ca = i < a.s.size() ? a.s[i] : ' ';
+        char cb = i < b.s.size() ? b.s[i] : ' ';
+        if( ca != cb ) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Collects the labels sorted by their lower bound. Returns false if a label
+// is not a compile time constant or two labels overlap, then the
+// if-else-if chain keeps the first matching case.
+bool get_sorted_case_labels(const ASR::Select_t& x, std::vector<CaseLabel>& labels) {
+    ASR::ttype_t* test_type = ASRUtils::expr_type(x.m_test);
+    bool is_string = ASRUtils::is_character(*test_type);
+    if( !is_string && !ASRUtils::is_integer(*test_type) ) {
+        return false;
+    }
+    for( size_t i = 0; i < x.n_body; i++ ) {
+        if( ASR::is_a<ASR::CaseStmt_t>(*x.m_body[i]) ) {
+            ASR::CaseStmt_t* case_stmt = ASR::down_cast<ASR::CaseStmt_t>(x.m_body[i]);
+            for( size_t j = 0; j < case_stmt->n_test; j++ ) {
+                CaseLabel label {case_stmt->m_test[j], case_stmt->m_test[j], {}, {}, i};
+                if( !get_label_value(label.lo, is_string, label.lo_value) ) {
+                    return false;
+                }
+                label.hi_value = label.lo_value;
+                labels.push_back(label);
+            }
+        } else {
+            ASR::CaseStmt_Range_t* case_range = ASR::down_cast<ASR::CaseStmt_Range_t>(x.m_body[i]);
+            CaseLabel label {case_range->m_start, case_range->m_end, {}, {}, i};
+            if( (label.lo && !get_label_value(label.lo, is_string, label.lo_value)) ||
+                (label.hi && !get_label_value(label.hi, is_string, label.hi_value)) ) {
+                return false;
+            }
+            if( label.lo && label.hi &&
+                compare_label_values(label.lo_value, label.hi_value, is_string) > 0 ) {
+                // An empty range never matches
+                continue;
+            }
+            labels.push_back(label);
+        }
+    }
+    std::sort(labels.begin(), labels.end(), [=](const CaseLabel& a, const CaseLabel& b) {
+        if( a.lo == nullptr || b.lo == nullptr ) {
+            return a.lo == nullptr && b.lo != nullptr;
+        }
+        return compare_label_values(a.lo_value, b.lo_value, is_string) < 0;
+    });
+    for( size_t i = 1; i < labels.size(); i++ ) {
+        if( labels[i - 1].hi == nullptr || labels[i].lo == nullptr ||
+            compare_label_values(labels[i - 1].hi_value, labels[i].lo_value, is_string) >= 0 ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class SelectCaseBinarySearch {
+
+    private:
+
+    Allocator& al;
+    const Location& loc;
+    ASR::expr_t* a_test;
+    ASR::expr_t* case_idx;
+    const std::vector<CaseLabel>& labels;
+
+    ASR::expr_t* compare(ASR::expr_t* left, ASR::cmpopType op, ASR::expr_t* right) {
+        return PassUtils::create_compare_helper(al, loc, left, right, op);
+    }
+
+    ASR::expr_t* and_(ASR::expr_t* left, ASR::expr_t* right) {
+        if( left == nullptr ) {
+            return right;
+        }
+        if( right == nullptr ) {
+            return left;
+        }
+        return ASRUtils::EXPR(ASR::make_LogicalBinOp_t(al, loc, left,
+            ASR::logicalbinopType::And, right, ASRUtils::expr_type(left), nullptr));
+    }
+
+    ASR::stmt_t* set_case_idx(size_t label) {
+        return ASRUtils::STMT(ASR::make_Assignment_t(al, loc, case_idx,
+            index(labels[label].case_idx + 1), nullptr));
+    }
+
+    ASR::expr_t* index(size_t i) {
+        return ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, i,
+            ASRUtils::expr_type(case_idx)));
+    }
+
+    ASR::stmt_t* make_if(ASR::expr_t* test, Vec<ASR::stmt_t*>& body,
+            Vec<ASR::stmt_t*>& orelse) {
+        return ASRUtils::STMT(ASR::make_If_t(al, loc, test, body.p, body.size(),
+            orelse.p, orelse.size()));
+    }
+
+    public:
+
+    SelectCaseBinarySearch(Allocator& al_, const Location& loc_,
+        ASR::expr_t* a_test_, ASR::expr_t* case_idx_,
+        const std::vector<CaseLabel>& labels_):
+        al(al_), loc(loc_), a_test(a_test_), case_idx(case_idx_),
+        labels(labels_) {}
+
+    // Sets `case_idx` to the case of the label in `labels[l:r]` that
+    // matches `a_test`, leaves it unchanged if none does
+    void search_labels(size_t l, size_t r, Vec<ASR::stmt_t*>& body) {
+        body.reserve(al, 1);
+        if( r - l <= 2 ) {
+            Vec<ASR::stmt_t*> orelse; orelse.reserve(al, 1);
+            for( size_t i = r; i-- > l; ) {
+                ASR::expr_t* test = nullptr;
+                if( labels[i].lo == labels[i].hi ) {
+                    test = compare(a_test, ASR::cmpopType::Eq, labels[i].lo);
+                } else {
+                    if( labels[i].lo ) {
+                        test = compare(labels[i].lo, ASR::cmpopType::LtE, a_test);
+                    }
+                    if( labels[i].hi ) {
+                        test = and_(test, compare(a_test, ASR::cmpopType::LtE, labels[i].hi));
+                    }
+                }
+                Vec<ASR::stmt_t*> if_body; if_body.reserve(al, 1);
+                if_body.push_back(al, set_case_idx(i));
+                ASR::stmt_t* if_stmt = make_if(test, if_body, orelse);
+                orelse.reserve(al, 1);
+                orelse.push_back(al, if_stmt);
+            }
+            for( size_t i = 0; i < orelse.size(); i++ ) {
+                body.push_back(al, orelse[i]);
+            }
+            return ;
+        }
+        // Only the first label can be open to the left and only the last one
+        // open to the right
+        size_t mid = (l + r) / 2;
+        Vec<ASR::stmt_t*> left; search_labels(l, mid, left);
+        Vec<ASR::stmt_t*> right; search_labels(mid + 1, r, right);
+        Vec<ASR::stmt_t*> match; match.reserve(al, 1);
+        match.push_back(al, set_case_idx(mid));
+        Vec<ASR::stmt_t*> above; above.reserve(al, 1);
+        above.push_back(al, make_if(compare(a_test, ASR::cmpopType::LtE,
+            labels[mid].hi), match, right));
+        body.push_back(al, make_if(compare(a_test, ASR::cmpopType::Lt,
+            labels[mid].lo), left, above));
+    }
+
+    // Runs `bodies[i]` for `case_idx == i` with `i` in `[l, r)`
+    void dispatch(size_t l, size_t r, std::vector<Vec<ASR::stmt_t*>>& bodies,
+            Vec<ASR::stmt_t*>& body) {
+        if( r - l == 1 ) {
+            body = bodies[l];
+            return ;
+        }
+        size_t mid = (l + r) / 2;
+        Vec<ASR::stmt_t*> left; dispatch(l, mid, bodies, left);
+        Vec<ASR::stmt_t*> right; dispatch(mid, r, bodies, right);
+        body.reserve(al, 1);
+        body.push_back(al, make_if(compare(case_idx, ASR::cmpopType::Lt,
+            index(mid)), left, right));
+    }
+
+};
+
+} // namespace
+
+bool get_select_case_switch_values(const ASR::Select_t &x,
+        std::map<int64_t, std::pair<int64_t, size_t>> &ranges,
+        size_t max_values) {
+    ranges.clear();
+    if( x.m_enable_fall_through || !ASRUtils::is_integer(*ASRUtils::expr_type(x.m_test)) ) {
+        return false;
+    }
+    // Number of values covered so far, compared without overflow
+    uint64_t n_values = 0;
+    auto add_range = [&](int64_t lo, int64_t hi, size_t case_idx) -> bool {
+        uint64_t size = (uint64_t)hi - (uint64_t)lo;
+        if( size >= max_values || n_values + size + 1 > max_values ) {
+            return false;
+        }
+        // The neighbouring ranges must end before `lo` and start after `hi`
+        auto next = ranges.lower_bound(lo);
+        if( next != ranges.end() && next->first <= hi ) {
+            return false;
+        }
+        if( next != ranges.begin() && std::prev(next)->second.first >= lo ) {
+            return false;
+        }
+        ranges.insert(next, {lo, {hi, case_idx}});
+        n_values += size + 1;
+        return true;
+    };
+    for( size_t i = 0; i < x.n_body; i++ ) {
+        if( ASR::is_a<ASR::CaseStmt_t>(*x.m_body[i]) ) {
+            ASR::CaseStmt_t* case_stmt = ASR::down_cast<ASR::CaseStmt_t>(x.m_body[i]);
+            for( size_t j = 0; j < case_stmt->n_test; j++ ) {
+                int64_t value;
+                if( !ASRUtils::extract_value(ASRUtils::expr_value(case_stmt->m_test[j]), value) ||
+                    !add_range(value, value, i) ) {
+                    return false;
+                }
+            }
+        } else {
+            ASR::CaseStmt_Range_t* case_range = ASR::down_cast<ASR::CaseStmt_Range_t>(x.m_body[i]);
+            int64_t start, end;
+            if( case_range->m_start == nullptr || case_range->m_end == nullptr ||
+                !ASRUtils::extract_value(ASRUtils::expr_value(case_range->m_start), start) ||
+                !ASRUtils::extract_value(ASRUtils::expr_value(case_range->m_end), end) ) {
+                return false;
+            }
+            // An empty range matches nothing
+            if( start <= end && !add_range(start, end, i) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 inline ASR::expr_t* gen_test_expr_CaseStmt(Allocator& al, const Location& loc, ASR::CaseStmt_t* Case_Stmt, ASR::expr_t* a_test) {
     ASR::expr_t* test_expr = nullptr;
     if( Case_Stmt->n_test == 1 ) {
@@ -150,6 +452,52 @@ Vec<ASR::stmt_t*> replace_selectcase(Allocator &al, const ASR::Select_t &select_
     return body;
 }
 
+void case_to_binary_search(Allocator& al, const ASR::Select_t& x,
+    const std::vector<CaseLabel>& labels, Vec<ASR::stmt_t*>& body,
+    SymbolTable* scope) {
+    const Location& loc = x.base.base.loc;
+    body.reserve(al, 4);
+    ASR::expr_t* a_test = x.m_test;
+    if( !ASR::is_a<ASR::Var_t>(*a_test) &&
+        ASRUtils::is_integer(*ASRUtils::expr_type(a_test)) ) {
+        // Evaluated once instead of once per comparison
+        std::string name = scope->get_unique_name("__libasr_select");
+        ASR::stmt_t* assign_stmt = nullptr;
+        a_test = PassUtils::create_auxiliary_variable_for_expr(a_test, name,
+            al, scope, assign_stmt);
+        body.push_back(al, assign_stmt);
+    }
+    std::string name = scope->get_unique_name("__libasr_case");
+    ASR::expr_t* case_idx = PassUtils::create_auxiliary_variable(loc, name,
+        al, scope, ASRUtils::TYPE(ASR::make_Integer_t(al, loc, 4)));
+    SelectCaseBinarySearch search(al, loc, a_test, case_idx, labels);
+    body.push_back(al, ASRUtils::STMT(ASR::make_Assignment_t(al, loc, case_idx,
+        ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc, 0,
+            ASRUtils::expr_type(case_idx))), nullptr)));
+    Vec<ASR::stmt_t*> search_body;
+    search.search_labels(0, labels.size(), search_body);
+    for( size_t i = 0; i < search_body.size(); i++ ) {
+        body.push_back(al, search_body[i]);
+    }
+
+    std::vector<Vec<ASR::stmt_t*>> bodies(x.n_body + 1);
+    bodies[0].from_pointer_n(x.m_default, x.n_default);
+    for( size_t i = 0; i < x.n_body; i++ ) {
+        if( ASR::is_a<ASR::CaseStmt_t>(*x.m_body[i]) ) {
+            ASR::CaseStmt_t* case_stmt = ASR::down_cast<ASR::CaseStmt_t>(x.m_body[i]);
+            bodies[i + 1].from_pointer_n(case_stmt->m_body, case_stmt->n_body);
+        } else {
+            ASR::CaseStmt_Range_t* case_range = ASR::down_cast<ASR::CaseStmt_Range_t>(x.m_body[i]);
+            bodies[i + 1].from_pointer_n(case_range->m_body, case_range->n_body);
+        }
+    }
+    Vec<ASR::stmt_t*> dispatch_body;
+    search.dispatch(0, bodies.size(), bodies, dispatch_body);
+    for( size_t i = 0; i < dispatch_body.size(); i++ ) {
+        body.push_back(al, dispatch_body[i]);
+    }
+}
+
 void case_to_if_with_fall_through(Allocator& al, const ASR::Select_t& x,
     ASR::expr_t* a_test, Vec<ASR::stmt_t*>& body, SymbolTable* scope) {
     body.reserve(al, x.n_body + 1);
@@ -216,8 +564,12 @@ Vec<ASR::stmt_t*> replace_selectcase_with_fall_through(
 class SelectCaseVisitor : public PassUtils::PassVisitor<SelectCaseVisitor>
 {
 
+private:
+    const PassOptions& pass_options;
+
 public:
-    SelectCaseVisitor(Allocator &al) : PassVisitor(al, nullptr) {
+    SelectCaseVisitor(Allocator &al, const PassOptions& pass_options) :
+        PassVisitor(al, nullptr), pass_options(pass_options) {
     }
 
     void visit_WhileLoop(const ASR::WhileLoop_t &x) {
@@ -228,8 +580,19 @@ public:
     }
 
     void visit_Select(const ASR::Select_t &x) {
+        // Lower the `select case` nested in the cases first
+        PassVisitor::visit_Select(x);
+        pass_result.n = 0;
+        std::map<int64_t, std::pair<int64_t, size_t>> switch_values;
+        std::vector<CaseLabel> labels;
         if( x.m_enable_fall_through ) {
             pass_result = replace_selectcase_with_fall_through(al, x, current_scope);
+        } else if( pass_options.select_case_to_switch &&
+                get_select_case_switch_values(x, switch_values) ) {
+            return ;
+        } else if( get_sorted_case_labels(x, labels) &&
+                labels.size() >= min_binary_search_labels ) {
+            case_to_binary_search(al, x, labels, pass_result, current_scope);
         } else {
             pass_result = replace_selectcase(al, x);
         }
@@ -237,8 +600,8 @@ public:
 };
 
 void pass_replace_select_case(Allocator &al, ASR::TranslationUnit_t &unit,
-                              const LCompilers::PassOptions& /*pass_options*/) {
-    SelectCaseVisitor v(al);
+                              const LCompilers::PassOptions& pass_options) {
+    SelectCaseVisitor v(al, pass_options);
     // Each call transforms only one layer of nested loops, so we call it twice
     // to transform doubly nested loops:
     v.visit_TranslationUnit(unit);
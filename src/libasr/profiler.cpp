@@ -0,0 +1,316 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+#include <libasr/alloc.h>
+#include <libasr/assert.h>
+#include <libasr/profiler.h>
+#include <libasr/string_utils.h>
+
+namespace LCompilers {
+
+namespace {
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The open regions of this thread (indices into Profiler::events)
+thread_local std::vector<int64_t> open_regions;
+
+std::string format_ms(int64_t us) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", us / 1000.);
+    return buf;
+}
+
+// Escapes `s` for a JSON string literal (str_escape_c emits C escapes such
+// as \x.., which are not valid JSON)
+std::string json_escape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    // Bytes >= 0x80 are passed through as UTF-8
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string format_percent(int64_t part, int64_t total) {
+    if (total <= 0) return "";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%5.1f%%", 100. * part / total);
+    return buf;
+}
+
+} // namespace
+
+// A node of the report tree: all events with the same path of names
+struct Profiler::Node {
+    std::string name;
+    std::vector<size_t> children;
+    uint64_t calls = 0;
+    int64_t total_us = 0;
+    int64_t al_chunks = -1;
+    int64_t al_peak = -1;
+};
+
+Profiler::Profiler() : epoch_ns{steady_ns()} {}
+
+Profiler &Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+int64_t Profiler::now_us() const {
+    return (steady_ns() - epoch_ns) / 1000;
+}
+
+uint64_t Profiler::thread_id() {
+    static std::atomic<uint64_t> next_id{1};
+    thread_local uint64_t id = next_id.fetch_add(1);
+    return id;
+}
+
+void Profiler::set_allocator(Allocator *al_) {
+    std::lock_guard<std::mutex> lock(mutex);
+    al = al_;
+}
+
+void Profiler::begin(std::string_view name, std::string_view category) {
+    Event e;
+    e.name = name;
+    e.category = category;
+    e.parent = open_regions.empty() ? -1 : open_regions.back();
+    e.tid = thread_id();
+    e.dur_us = -1;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (al) e.al_start = al->high_water_mark();
+    e.start_us = now_us();
+    open_regions.push_back(events.size());
+    events.push_back(std::move(e));
+}
+
+void Profiler::end() {
+    int64_t t = now_us();
+    LCOMPILERS_ASSERT(!open_regions.empty());
+    if (open_regions.empty()) return;
+    int64_t i = open_regions.back();
+    open_regions.pop_back();
+    std::lock_guard<std::mutex> lock(mutex);
+    // The events may have been cleared while the region was open
+    if (i < 0 || i >= (int64_t)events.size()) return;
+    Event &e = events[i];
+    e.dur_us = t - e.start_us;
+    // The allocator may have been set or changed while the region was open
+    if (al && e.al_start >= 0 && (int64_t)al->high_water_mark() >= e.al_start) {
+        e.al_chunks = al->num_chunks();
+        e.al_peak = al->high_water_mark() - e.al_start;
+    }
+}
+
+void Profiler::set_thread_name(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_names[thread_id()] = name;
+}
+
+size_t Profiler::mark() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events.size();
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Keep the regions that are still open (and their ancestors), so that
+    // `end` can close them
+    std::vector<bool> keep(events.size(), false);
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].dur_us < 0) {
+            for (int64_t j = i; j >= 0 && !keep[j]; j = events[j].parent) {
+                keep[j] = true;
+            }
+        }
+    }
+    std::vector<int64_t> new_index(events.size(), -1);
+    std::vector<Event> kept;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (!keep[i]) continue;
+        new_index[i] = kept.size();
+        Event e = std::move(events[i]);
+        if (e.parent >= 0) e.parent = new_index[e.parent];
+        kept.push_back(std::move(e));
+    }
+    events = std::move(kept);
+    // Only the open regions of this thread can be renumbered here; clearing
+    // while other threads have open regions drops their remaining events
+    for (auto &r : open_regions) {
+        r = r < (int64_t)new_index.size() ? new_index[r] : -1;
+    }
+}
+
+void Profiler::aggregate(std::vector<Node> &nodes, size_t first) const {
+    // nodes[0] is the root; children are kept in the order of appearance.
+    // Regions that are still open are reported up to now.
+    int64_t now = now_us();
+    nodes.clear();
+    nodes.emplace_back();
+    std::map<std::pair<size_t, std::string>, size_t> index;
+    std::vector<size_t> node_of(events.size(), 0);
+    for (size_t i = first; i < events.size(); i++) {
+        const Event &e = events[i];
+        size_t parent = e.parent >= (int64_t)first ? node_of[e.parent] : 0;
+        auto key = std::make_pair(parent, e.name);
+        auto it = index.find(key);
+        size_t n;
+        if (it == index.end()) {
+            n = nodes.size();
+            nodes.emplace_back();
+            nodes[n].name = e.name;
+            nodes[parent].children.push_back(n);
+            index[key] = n;
+        } else {
+            n = it->second;
+        }
+        node_of[i] = n;
+        Node &node = nodes[n];
+        node.calls++;
+        node.total_us += e.dur_us >= 0 ? e.dur_us : now - e.start_us;
+        node.al_chunks = std::max(node.al_chunks, e.al_chunks);
+        node.al_peak = std::max(node.al_peak, e.al_peak);
+    }
+}
+
+std::string Profiler::report_text(size_t first) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Node> nodes;
+    aggregate(nodes, first);
+    int64_t total = 0;
+    for (size_t c : nodes[0].children) total += nodes[c].total_us;
+
+    std::string out = "Time report (ms, % of parent, calls, allocator chunks and peak):\n";
+    auto print = [&](auto &&self, size_t n, int64_t parent_us,
+            size_t depth) -> void {
+        const Node &node = nodes[n];
+        std::string line = std::string(2*depth, ' ') + node.name;
+        if (line.size() < 48) line += std::string(48 - line.size(), ' ');
+        std::string ms = format_ms(node.total_us);
+        line += std::string(ms.size() < 12 ? 12 - ms.size() : 0, ' ') + ms;
+        std::string percent = format_percent(node.total_us, parent_us);
+        line += " " + (percent.empty() ? std::string(6, ' ') : percent);
+        line += " " + std::to_string(node.calls) + "x";
+        if (node.al_chunks >= 0) {
+            line += "  [" + std::to_string(node.al_chunks) + " chunks, "
+                + std::to_string(node.al_peak / 1024) + " KiB peak]";
+        }
+        out += line + "\n";
+        for (size_t c : node.children) {
+            self(self, c, node.total_us, depth + 1);
+        }
+    };
+    for (size_t c : nodes[0].children) print(print, c, total, 0);
+    out += "Total: " + format_ms(total) + " ms\n";
+    return out;
+}
+
+std::string Profiler::report_json(size_t first) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Node> nodes;
+    aggregate(nodes, first);
+    auto print = [&](auto &&self, size_t n) -> std::string {
+        const Node &node = nodes[n];
+        int64_t self_us = node.total_us;
+        for (size_t c : node.children) self_us -= nodes[c].total_us;
+        std::string s = "{\"name\": \"" + json_escape(node.name) + "\""
+            + ", \"calls\": " + std::to_string(node.calls)
+            + ", \"total_us\": " + std::to_string(node.total_us)
+            + ", \"self_us\": " + std::to_string(self_us);
+        if (node.al_chunks >= 0) {
+            s += ", \"allocator_chunks\": " + std::to_string(node.al_chunks)
+                + ", \"allocator_peak_bytes\": "
+                + std::to_string(node.al_peak);
+        }
+        s += ", \"children\": [";
+        for (size_t i = 0; i < node.children.size(); i++) {
+            if (i > 0) s += ", ";
+            s += self(self, node.children[i]);
+        }
+        s += "]}";
+        return s;
+    };
+    std::string out = "[";
+    for (size_t i = 0; i < nodes[0].children.size(); i++) {
+        if (i > 0) out += ",\n";
+        out += print(print, nodes[0].children[i]);
+    }
+    out += "]\n";
+    return out;
+}
+
+std::string Profiler::report_chrome_trace(size_t first) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t now = now_us();
+    std::string out = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first_event = true;
+    for (auto &t : thread_names) {
+        if (!first_event) out += ",\n";
+        first_event = false;
+        out += "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1"
+            ", \"tid\": " + std::to_string(t.first)
+            + ", \"args\": {\"name\": \"" + json_escape(t.second) + "\"}}";
+    }
+    for (size_t i = first; i < events.size(); i++) {
+        const Event &e = events[i];
+        int64_t dur_us = e.dur_us >= 0 ? e.dur_us : now - e.start_us;
+        if (!first_event) out += ",\n";
+        first_event = false;
+        out += "{\"name\": \"" + json_escape(e.name) + "\""
+            + ", \"cat\": \"" + json_escape(e.category) + "\""
+            + ", \"ph\": \"X\", \"pid\": 1"
+            + ", \"tid\": " + std::to_string(e.tid)
+            + ", \"ts\": " + std::to_string(e.start_us)
+            + ", \"dur\": " + std::to_string(dur_us);
+        if (e.al_chunks >= 0) {
+            out += ", \"args\": {\"allocator_chunks\": "
+                + std::to_string(e.al_chunks)
+                + ", \"allocator_peak_bytes\": "
+                + std::to_string(e.al_peak) + "}";
+        }
+        out += "}";
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+std::string Profiler::report(const std::string &format, size_t first) const {
+    if (format == "json") return report_json(first);
+    if (format == "chrome") return report_chrome_trace(first);
+    return report_text(first);
+}
+
+bool Profiler::write_chrome_trace(const std::string &filename) const {
+    std::string trace = report_chrome_trace();
+    std::ofstream out(filename, std::ios::out | std::ios::binary);
+    if (!out.is_open()) return false;
+    out.write(trace.data(), trace.size());
+    return (bool)out;
+}
+
+} // namespace LCompilers
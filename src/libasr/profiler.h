@@ -0,0 +1,146 @@
+#ifndef LIBASR_PROFILER_H
+#define LIBASR_PROFILER_H
+
+#include <atomic>
+#include <map>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Allocator;
+
+namespace LCompilers {
+
+/*
+ * Collects timings of nested regions of the compiler (phases, passes,
+ * procedures) with microsecond resolution, used by `--time-report`.
+ *
+ * Regions are opened and closed per thread, the enclosing open region of the
+ * same thread is the parent of a region. The profiler is disabled by default,
+ * in which case opening a region only costs an atomic load.
+ *
+ * The collected regions can be reported as a tree aggregated by the path of
+ * region names (text or JSON) or as the individual events in the Chrome
+ * Trace Event Format (chrome://tracing, Perfetto).
+ */
+class Profiler
+{
+public:
+    struct Event {
+        std::string name;
+        std::string category;
+        int64_t parent;     // Index of the enclosing event, -1 for a root
+        uint64_t tid;       // Small sequential id of the thread
+        int64_t start_us;   // Since the profiler was created
+        int64_t dur_us;     // -1 while the region is open
+        // The high-water mark of the allocator set by `set_allocator` when
+        // the region was opened; its number of chunks when the region was
+        // closed and its peak usage within the region (-1 if none)
+        int64_t al_start = -1;
+        int64_t al_chunks = -1;
+        int64_t al_peak = -1;
+    };
+
+    static Profiler &get();
+
+    void enable() { enabled.store(true, std::memory_order_relaxed); }
+    void disable() { enabled.store(false, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // The allocator whose high-water mark is tracked for every region
+    void set_allocator(Allocator *al);
+
+    // Opens and closes a region of the current thread; prefer ProfileRegion
+    void begin(std::string_view name, std::string_view category);
+    void end();
+
+    // Names the current thread in the Chrome trace
+    void set_thread_name(const std::string &name);
+
+    // Removes all closed events
+    void clear();
+
+    // The number of events so far; the reports can be restricted to the
+    // events after such a mark (the regions of one compiled file)
+    size_t mark() const;
+
+    std::string report_text(size_t first=0) const;
+    std::string report_json(size_t first=0) const;
+    std::string report_chrome_trace(size_t first=0) const;
+    // `format` is one of "text", "json", "chrome"
+    std::string report(const std::string &format, size_t first=0) const;
+
+    // Writes all events as a Chrome trace, returns false on failure
+    bool write_chrome_trace(const std::string &filename) const;
+
+    // Microseconds since the profiler was created
+    int64_t now_us() const;
+    static uint64_t thread_id();
+
+private:
+    Profiler();
+
+    std::atomic<bool> enabled{false};
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::map<uint64_t, std::string> thread_names;
+    Allocator *al = nullptr;
+    int64_t epoch_ns;
+
+    struct Node;
+    void aggregate(std::vector<Node> &nodes, size_t first) const;
+};
+
+// Times the enclosing scope as a region of the Profiler
+class ProfileRegion
+{
+public:
+    ProfileRegion(std::string_view name, std::string_view category="") {
+        active = Profiler::get().is_enabled();
+        if (active) Profiler::get().begin(name, category);
+    }
+    ~ProfileRegion() {
+        if (active) Profiler::get().end();
+    }
+    ProfileRegion(const ProfileRegion &) = delete;
+    ProfileRegion &operator=(const ProfileRegion &) = delete;
+private:
+    bool active;
+};
+
+// Tracks the usage of `al` in every region during the enclosing scope
+class ProfileAllocator
+{
+public:
+    ProfileAllocator(Allocator &al) {
+        Profiler::get().set_allocator(&al);
+    }
+    ~ProfileAllocator() {
+        Profiler::get().set_allocator(nullptr);
+    }
+    ProfileAllocator(const ProfileAllocator &) = delete;
+    ProfileAllocator &operator=(const ProfileAllocator &) = delete;
+};
+
+// Enables the profiler and writes the Chrome trace of the whole compiler
+// invocation to `filename` when destroyed
+class ProfileTraceFile
+{
+public:
+    ProfileTraceFile(const std::string &filename) : filename{filename} {
+        Profiler::get().enable();
+    }
+    ~ProfileTraceFile() {
+        Profiler::get().write_chrome_trace(filename);
+    }
+    ProfileTraceFile(const ProfileTraceFile &) = delete;
+    ProfileTraceFile &operator=(const ProfileTraceFile &) = delete;
+private:
+    std::string filename;
+};
+
+} // namespace LCompilers
+
+#endif // LIBASR_PROFILER_H
@@ -19,108 +19,1833 @@
 #  include <unistd.h>
 #endif
 
+#if !defined(_WIN32) && (!defined(COMPILE_TO_WASM) || defined(__EMSCRIPTEN_PTHREADS__))
+#  define LFORTRAN_HAVE_THREADS
+#  include <pthread.h>
+#  include <sched.h>
+#  if defined(__linux__)
+#    include <strings.h>
+#    include <sys/syscall.h>
+#  endif
+#endif
+
+#if !defined(_WIN32) && !defined(COMPILE_TO_WASM)
+#  define LFORTRAN_HAVE_IMAGES
+#  include <sys/mman.h>
+#  include <sys/wait.h>
+#endif
+
+#if defined(_MSC_VER)
+#  define LFORTRAN_THREAD_LOCAL __declspec(thread)
+#else
+#  define LFORTRAN_THREAD_LOCAL _Thread_local
+#endif
+
 #if defined(__APPLE__)
 #  include <sys/time.h>
 #endif
 
-#include <libasr/runtime/lfortran_intrinsics.h>
-#include <libasr/config.h>
+#include <libasr/runtime/lfortran_intrinsics.h>
+#include <libasr/config.h>
+
+#ifdef HAVE_RUNTIME_STACKTRACE
+
+#ifdef COMPILE_TO_WASM
+    #undef HAVE_LFORTRAN_MACHO
+    #undef HAVE_LFORTRAN_LINK
+#endif
+
+#ifdef HAVE_LFORTRAN_LINK
+// For dl_iterate_phdr() functionality
+#  include <link.h>
+struct dl_phdr_info {
+    ElfW(Addr) dlpi_addr;
+    const char *dlpi_name;
+    const ElfW(Phdr) *dlpi_phdr;
+    ElfW(Half) dlpi_phnum;
+};
+extern int dl_iterate_phdr (int (*__callback) (struct dl_phdr_info *,
+    size_t, void *), void *__data);
+#endif
+
+#ifdef HAVE_LFORTRAN_UNWIND
+// For _Unwind_Backtrace() function
+#  include <unwind.h>
+#endif
+
+#ifdef HAVE_LFORTRAN_MACHO
+#  include <mach-o/dyld.h>
+#endif
+
+// Runtime Stacktrace
+#define LCOMPILERS_MAX_STACKTRACE_LENGTH 200
+char *source_filename;
+char *binary_executable_path = "/proc/self/exe";
+
+struct Stacktrace {
+    uintptr_t pc[LCOMPILERS_MAX_STACKTRACE_LENGTH];
+    uint64_t pc_size;
+    uintptr_t current_pc;
+
+    uintptr_t local_pc[LCOMPILERS_MAX_STACKTRACE_LENGTH];
+    char *binary_filename[LCOMPILERS_MAX_STACKTRACE_LENGTH];
+    uint64_t local_pc_size;
+
+    uint64_t addresses[LCOMPILERS_MAX_STACKTRACE_LENGTH];
+    uint64_t line_numbers[LCOMPILERS_MAX_STACKTRACE_LENGTH];
+    uint64_t stack_size;
+};
+
+// Styles and Colors
+#define DIM "\033[2m"
+#define BOLD "\033[1m"
+#define S_RESET "\033[0m"
+#define MAGENTA "\033[35m"
+#define C_RESET "\033[39m"
+
+#endif // HAVE_RUNTIME_STACKTRACE
+
+#ifdef HAVE_LFORTRAN_MACHO
+    #define INT64 "%lld"
+#elif HAVE_BUILD_TO_WASM
+    #define INT64 "%lld"
+#else
+    #define INT64 "%ld"
+#endif
+
+// This function performs case insensitive string comparison
+bool streql(const char *s1, const char* s2) {
+#if defined(_MSC_VER)
+    return _stricmp(s1, s2) == 0;
+#else
+    return strcasecmp(s1, s2) == 0;
+#endif
+}
+
+LFORTRAN_API double _lfortran_sum(int n, double *v)
+{
+    int i, r;
+    r = 0;
+    for (i=0; i < n; i++) {
+        r += v[i];
+    }
+    return r;
+}
+
+// Atomics ---------------------------------------------------------------------
+
+// Compare and swap on the bit pattern of a 4 or 8 byte value
+static inline bool _lfortran_cas32(int32_t *x, int32_t expected, int32_t desired)
+{
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange((volatile long*) x, desired, expected) == expected;
+#else
+    return __atomic_compare_exchange_n(x, &expected, desired, false,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline bool _lfortran_cas64(int64_t *x, int64_t expected, int64_t desired)
+{
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange64((volatile long long*) x, desired, expected) == expected;
+#else
+    return __atomic_compare_exchange_n(x, &expected, desired, false,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline int32_t _lfortran_load32(int32_t *x)
+{
+#if defined(_MSC_VER)
+    return *(volatile int32_t*) x;
+#else
+    return __atomic_load_n(x, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline int64_t _lfortran_load64(int64_t *x)
+{
+#if defined(_MSC_VER)
+    return *(volatile int64_t*) x;
+#else
+    return __atomic_load_n(x, __ATOMIC_RELAXED);
+#endif
+}
+
+#define LFORTRAN_ATOMIC_UPDATE(name, type, bits, combine)                      \
+LFORTRAN_API void _lfortran_atomic_##name(type *x, type v)                     \
+{                                                                              \
+    int##bits##_t old_bits, new_bits;                                          \
+    type old_value, new_value;                                                 \
+    do {                                                                       \
+        old_bits = _lfortran_load##bits((int##bits##_t*) x);                   \
+        memcpy(&old_value, &old_bits, sizeof(type));                           \
+        new_value = (combine);                                                 \
+        memcpy(&new_bits, &new_value, sizeof(type));                           \
+    } while (!_lfortran_cas##bits((int##bits##_t*) x, old_bits, new_bits));    \
+}
+
+LFORTRAN_ATOMIC_UPDATE(add_i32, int32_t, 32, old_value + v)
+LFORTRAN_ATOMIC_UPDATE(add_i64, int64_t, 64, old_value + v)
+LFORTRAN_ATOMIC_UPDATE(add_r32, float, 32, old_value + v)
+LFORTRAN_ATOMIC_UPDATE(add_r64, double, 64, old_value + v)
+LFORTRAN_ATOMIC_UPDATE(mul_i32, int32_t, 32, old_value * v)
+LFORTRAN_ATOMIC_UPDATE(mul_i64, int64_t, 64, old_value * v)
+LFORTRAN_ATOMIC_UPDATE(mul_r32, float, 32, old_value * v)
+LFORTRAN_ATOMIC_UPDATE(mul_r64, double, 64, old_value * v)
+LFORTRAN_ATOMIC_UPDATE(max_i32, int32_t, 32, old_value < v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(max_i64, int64_t, 64, old_value < v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(max_r32, float, 32, old_value < v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(max_r64, double, 64, old_value < v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(min_i32, int32_t, 32, old_value > v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(min_i64, int64_t, 64, old_value > v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(min_r32, float, 32, old_value > v ? v : old_value)
+LFORTRAN_ATOMIC_UPDATE(min_r64, double, 64, old_value > v ? v : old_value)
+
+#undef LFORTRAN_ATOMIC_UPDATE
+
+// Thread pool -----------------------------------------------------------------
+
+/*
+ * A small work-stealing pool used by `--auto-parallel` to run the iterations
+ * [0, n) of a `do concurrent` loop. The calling thread takes part as worker
+ * 0, the other workers are started on the first parallel loop. Each worker
+ * owns a deque of iteration ranges: it splits the range at its bottom in
+ * halves until it is no larger than the grain size, keeps working on the
+ * lower half and leaves the upper halves for thieves, which take the
+ * largest pieces from the top of a victim's deque.
+ *
+ * Worker i starts with the i-th of n equal parts of [0, n), so without
+ * imbalance it runs the same iterations in every loop of the same length.
+ *
+ * The number of workers is read from LFORTRAN_NUM_THREADS, then from
+ * OMP_NUM_THREADS, and defaults to the number of online processors.
+ *
+ * The same workers run the explicit tasks of `!$omp task`. Every worker owns
+ * a list of queued tasks, new tasks are pushed at its head, the owner takes
+ * the newest one and thieves the oldest one. A task owns a copy of the data
+ * block of its spawner, which holds the firstprivate values and the
+ * addresses of the shared variables. A task only completes after its
+ * children did, so the counter of its parent is still alive when a child
+ * decrements it. Threads that wait for tasks run queued tasks meanwhile.
+ */
+
+#define LFORTRAN_POOL_MAX_WORKERS 256
+#define LFORTRAN_POOL_DEQUE_SIZE 128
+// Tasks spawned while this many per worker are queued run immediately
+#define LFORTRAN_TASK_MAX_QUEUED 64
+
+#if defined(LFORTRAN_HAVE_THREADS)
+
+struct _lfortran_pool_deque {
+    pthread_mutex_t lock;
+    int64_t lo[LFORTRAN_POOL_DEQUE_SIZE];
+    int64_t hi[LFORTRAN_POOL_DEQUE_SIZE];
+    int top, bottom;
+    char padding[64];
+};
+
+struct _lfortran_pool_job {
+    _lfortran_range_fn fn;
+    void *data;
+    int64_t grain;
+    int64_t remaining;
+    // without stealing every worker only runs its own part
+    bool steal;
+};
+
+struct _lfortran_taskgroup {
+    int64_t pending;
+    struct _lfortran_taskgroup *outer;
+};
+
+struct _lfortran_task {
+    _lfortran_task_fn fn;
+    struct _lfortran_task *parent;
+    struct _lfortran_taskgroup *group;
+    struct _lfortran_task *prev, *next;
+    int64_t children;
+};
+
+// The copy of the data block follows the task header
+#define LFORTRAN_TASK_HEADER_SIZE ((sizeof(struct _lfortran_task) + 15) & ~(size_t) 15)
+
+struct _lfortran_task_queue {
+    pthread_mutex_t lock;
+    struct _lfortran_task *head, *tail;
+    char padding[64];
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_mutex_t job_lock;
+    pthread_mutex_t reduction_lock;
+    int n_workers;
+    int started;
+    int active;
+    uint64_t generation;
+    struct _lfortran_pool_job *job;
+    int64_t queued_tasks;
+    int sleeping;
+    struct _lfortran_pool_deque deques[LFORTRAN_POOL_MAX_WORKERS];
+    struct _lfortran_task_queue task_queues[LFORTRAN_POOL_MAX_WORKERS];
+} _lfortran_pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+};
+
+static LFORTRAN_THREAD_LOCAL int _lfortran_pool_worker_id = -1;
+// The task run by this thread, NULL outside of explicit tasks
+static LFORTRAN_THREAD_LOCAL struct _lfortran_task *_lfortran_current_task = NULL;
+// Parent of the tasks spawned outside of explicit tasks
+static LFORTRAN_THREAD_LOCAL struct _lfortran_task _lfortran_implicit_task;
+static LFORTRAN_THREAD_LOCAL struct _lfortran_taskgroup *_lfortran_current_taskgroup = NULL;
+
+static bool _lfortran_task_run_one();
+
+static bool _lfortran_pool_push(int self, int64_t lo, int64_t hi)
+{
+    struct _lfortran_pool_deque *d = &_lfortran_pool.deques[self];
+    bool pushed = false;
+    pthread_mutex_lock(&d->lock);
+    int top = d->top, bottom = d->bottom;
+    if (bottom == LFORTRAN_POOL_DEQUE_SIZE && top > 0) {
+        memmove(d->lo, d->lo + top, (bottom - top) * sizeof(int64_t));
+        memmove(d->hi, d->hi + top, (bottom - top) * sizeof(int64_t));
+        bottom -= top;
+        top = 0;
+    }
+    if (bottom < LFORTRAN_POOL_DEQUE_SIZE) {
+        d->lo[bottom] = lo;
+        d->hi[bottom] = hi;
+        bottom++;
+        pushed = true;
+    }
+    // top and bottom are peeked at by thieves without the lock
+    __atomic_store_n(&d->top, top, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->bottom, bottom, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&d->lock);
+    return pushed;
+}
+
+// The owner works depth first from the bottom, thieves take from the top
+static bool _lfortran_pool_take(int victim, bool steal, int64_t *lo, int64_t *hi)
+{
+    struct _lfortran_pool_deque *d = &_lfortran_pool.deques[victim];
+    bool taken = false;
+    if (steal && __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) ==
+            __atomic_load_n(&d->top, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    pthread_mutex_lock(&d->lock);
+    int top = d->top, bottom = d->bottom;
+    if (top < bottom) {
+        int i = steal ? top++ : --bottom;
+        *lo = d->lo[i];
+        *hi = d->hi[i];
+        taken = true;
+    }
+    if (top == bottom) {
+        top = bottom = 0;
+    }
+    __atomic_store_n(&d->top, top, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->bottom, bottom, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&d->lock);
+    return taken;
+}
+
+static void _lfortran_pool_work(int self, struct _lfortran_pool_job *job)
+{
+    unsigned victim = (unsigned) self;
+    while (__atomic_load_n(&job->remaining, __ATOMIC_ACQUIRE) > 0) {
+        int64_t lo, hi;
+        bool found = _lfortran_pool_take(self, false, &lo, &hi);
+        for (int i = 1; job->steal && !found && i < _lfortran_pool.n_workers; i++) {
+            victim = (victim + 1) % _lfortran_pool.n_workers;
+            if ((int) victim != self) {
+                found = _lfortran_pool_take(victim, true, &lo, &hi);
+            }
+        }
+        if (!found) {
+            sched_yield();
+            continue;
+        }
+        while (hi - lo > job->grain) {
+            int64_t mid = lo + (hi - lo) / 2;
+            if (!_lfortran_pool_push(self, mid, hi)) break;
+            hi = mid;
+        }
+        job->fn(job->data, lo, hi);
+        __atomic_sub_fetch(&job->remaining, hi - lo, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Thread affinity.
+ *
+ * The workers are bound to places like the threads of an OpenMP runtime.
+ * The places are read from LFORTRAN_PLACES or else OMP_PLACES. They are
+ * either an abstract name (threads, cores, sockets or numa_domains),
+ * optionally followed by the number of places in parentheses, or an
+ * explicit list such as "{0:4},{4:4}" or "{0,1}:4:2". The policy is read
+ * from LFORTRAN_PROC_BIND or else OMP_PROC_BIND. With close (or true)
+ * worker i runs on place i, with spread the workers are distributed evenly
+ * over the places, and with master (or primary) all of them share the place
+ * of worker 0. Places without a policy bind close, and a policy without
+ * places uses one place per processor. Binding is only implemented on
+ * Linux; elsewhere the workers are left to the scheduler.
+ */
+
+#define LFORTRAN_MAX_CPUS 1024
+#define LFORTRAN_MAX_NUMA_NODES 64
+
+enum {
+    LFORTRAN_BIND_FALSE, LFORTRAN_BIND_CLOSE, LFORTRAN_BIND_SPREAD,
+    LFORTRAN_BIND_MASTER
+};
+
+struct _lfortran_cpu_mask {
+    uint64_t bits[LFORTRAN_MAX_CPUS / 64];
+};
+
+static struct {
+    int policy;
+    int n_places;
+    struct _lfortran_cpu_mask *places;
+    // the place of every worker, -1 if it is not bound
+    int place[LFORTRAN_POOL_MAX_WORKERS];
+    // the processors of every node, empty for missing nodes
+    struct _lfortran_cpu_mask nodes[LFORTRAN_MAX_NUMA_NODES];
+} _lfortran_affinity;
+
+// The LFORTRAN_ variable overrides the OpenMP one, which also applies to
+// the OpenMP threads of the program
+static const char* _lfortran_pool_getenv(const char *name, const char *omp_name)
+{
+    const char *env = getenv(name);
+    return env ? env : getenv(omp_name);
+}
+
+#if defined(__linux__)
+
+static void _lfortran_cpu_mask_set(struct _lfortran_cpu_mask *m, long cpu)
+{
+    if (cpu >= 0 && cpu < LFORTRAN_MAX_CPUS) {
+        m->bits[cpu / 64] |= (uint64_t) 1 << (cpu % 64);
+    }
+}
+
+static bool _lfortran_cpu_mask_has(const struct _lfortran_cpu_mask *m, long cpu)
+{
+    return cpu >= 0 && cpu < LFORTRAN_MAX_CPUS &&
+        (m->bits[cpu / 64] >> (cpu % 64)) & 1;
+}
+
+static bool _lfortran_cpu_mask_empty(const struct _lfortran_cpu_mask *m)
+{
+    for (int i = 0; i < LFORTRAN_MAX_CPUS / 64; i++) {
+        if (m->bits[i]) return false;
+    }
+    return true;
+}
+
+// Reads a list of processors in the sysfs format "0-3,8-11"
+static bool _lfortran_read_cpu_list(const char *path, struct _lfortran_cpu_mask *m)
+{
+    char buf[4096];
+    FILE *f = fopen(path, "r");
+    memset(m, 0, sizeof(*m));
+    if (f == NULL) return false;
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+    char *s = buf;
+    for (;;) {
+        char *end;
+        long first = strtol(s, &end, 10), last;
+        if (end == s) break;
+        last = first;
+        s = end;
+        if (*s == '-') {
+            last = strtol(s + 1, &end, 10);
+            s = end;
+        }
+        for (long c = first; c <= last && c < LFORTRAN_MAX_CPUS; c++) {
+            _lfortran_cpu_mask_set(m, c);
+        }
+        if (*s != ',') break;
+        s++;
+    }
+    return !_lfortran_cpu_mask_empty(m);
+}
+
+static int _lfortran_cpu_node(long cpu)
+{
+    for (int k = 0; k < LFORTRAN_MAX_NUMA_NODES; k++) {
+        if (_lfortran_cpu_mask_has(&_lfortran_affinity.nodes[k], cpu)) return k;
+    }
+    return -1;
+}
+
+// Appends the allowed processors of p as a new place, unless there are none
+// or the same place is already in the list
+static int _lfortran_places_add(struct _lfortran_cpu_mask *places, int n,
+    const struct _lfortran_cpu_mask *p, const struct _lfortran_cpu_mask *allowed)
+{
+    struct _lfortran_cpu_mask m;
+    for (int i = 0; i < LFORTRAN_MAX_CPUS / 64; i++) {
+        m.bits[i] = p->bits[i] & allowed->bits[i];
+    }
+    if (n == LFORTRAN_MAX_CPUS || _lfortran_cpu_mask_empty(&m)) return n;
+    for (int i = 0; i < n; i++) {
+        if (memcmp(&places[i], &m, sizeof(m)) == 0) return n;
+    }
+    places[n] = m;
+    return n + 1;
+}
+
+// Returns the number of places, -1 if `s` is not a valid place list
+static int _lfortran_places_parse(const char *s, struct _lfortran_cpu_mask *places,
+    const struct _lfortran_cpu_mask *allowed)
+{
+    static const char *names[] = {"threads", "cores", "sockets", "numa_domains"};
+    // topology files of the processors sharing a core or a socket, the
+    // second one is the name used by older kernels
+    static const char *files[][2] = {
+        {NULL, NULL},
+        {"core_cpus_list", "thread_siblings_list"},
+        {"package_cpus_list", "core_siblings_list"},
+    };
+    int n = 0;
+    for (int kind = 0; kind < 4; kind++) {
+        size_t len = strlen(names[kind]);
+        if (strncasecmp(s, names[kind], len) != 0) continue;
+        long max_places = LFORTRAN_MAX_CPUS;
+        s += len;
+        if (*s == '(') {
+            char *end;
+            max_places = strtol(s + 1, &end, 10);
+            if (end == s + 1 || *end != ')' || max_places <= 0) return -1;
+            s = end + 1;
+        }
+        if (*s != '\0') return -1;
+        for (long c = 0; c < LFORTRAN_MAX_CPUS && n < max_places; c++) {
+            if (!_lfortran_cpu_mask_has(allowed, c)) continue;
+            struct _lfortran_cpu_mask p;
+            memset(&p, 0, sizeof(p));
+            if (kind == 3 && _lfortran_cpu_node(c) >= 0) {
+                p = _lfortran_affinity.nodes[_lfortran_cpu_node(c)];
+            } else if (kind == 1 || kind == 2) {
+                char path[128];
+                for (int i = 0; i < 2 && _lfortran_cpu_mask_empty(&p); i++) {
+                    snprintf(path, sizeof(path),
+                        "/sys/devices/system/cpu/cpu%ld/topology/%s", c, files[kind][i]);
+                    _lfortran_read_cpu_list(path, &p);
+                }
+            }
+            if (_lfortran_cpu_mask_empty(&p)) _lfortran_cpu_mask_set(&p, c);
+            n = _lfortran_places_add(places, n, &p, allowed);
+        }
+        return n;
+    }
+    // {first[:length[:stride]],...}[:count[:stride]], ...
+    while (*s == '{') {
+        struct _lfortran_cpu_mask p;
+        char *end;
+        memset(&p, 0, sizeof(p));
+        s++;
+        for (;;) {
+            long first = strtol(s, &end, 10), len = 1, stride = 1;
+            if (end == s) return -1;
+            s = end;
+            if (*s == ':') {
+                len = strtol(s + 1, &end, 10);
+                s = end;
+                if (*s == ':') {
+                    stride = strtol(s + 1, &end, 10);
+                    s = end;
+                }
+            }
+            for (long i = 0; i < len; i++) {
+                _lfortran_cpu_mask_set(&p, first + i * stride);
+            }
+            if (*s == '}') break;
+            if (*s != ',') return -1;
+            s++;
+        }
+        s++;
+        long count = 1, stride = 1;
+        if (*s == ':') {
+            count = strtol(s + 1, &end, 10);
+            s = end;
+            if (*s == ':') {
+                stride = strtol(s + 1, &end, 10);
+                s = end;
+            }
+        }
+        for (long i = 0; i < count; i++) {
+            struct _lfortran_cpu_mask q;
+            memset(&q, 0, sizeof(q));
+            for (long c = 0; c < LFORTRAN_MAX_CPUS; c++) {
+                if (_lfortran_cpu_mask_has(&p, c)) {
+                    _lfortran_cpu_mask_set(&q, c + i * stride);
+                }
+            }
+            n = _lfortran_places_add(places, n, &q, allowed);
+        }
+        if (*s == ',') s++;
+    }
+    return *s == '\0' ? n : -1;
+}
+
+static void _lfortran_pool_pin(int self)
+{
+    int p = _lfortran_affinity.place[self];
+    if (p >= 0) {
+        syscall(SYS_sched_setaffinity, 0, sizeof(_lfortran_affinity.places[p].bits),
+            _lfortran_affinity.places[p].bits);
+    }
+}
+
+// Assigns the places of n workers and binds the calling thread, worker 0
+static void _lfortran_pool_bind(int n)
+{
+    for (int i = 0; i < n; i++) {
+        _lfortran_affinity.place[i] = -1;
+    }
+    for (int k = 0; k < LFORTRAN_MAX_NUMA_NODES; k++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", k);
+        _lfortran_read_cpu_list(path, &_lfortran_affinity.nodes[k]);
+    }
+    const char *policy = _lfortran_pool_getenv("LFORTRAN_PROC_BIND", "OMP_PROC_BIND");
+    const char *places = _lfortran_pool_getenv("LFORTRAN_PLACES", "OMP_PLACES");
+    _lfortran_affinity.policy = LFORTRAN_BIND_FALSE;
+    if (policy) {
+        // only the outermost level of a list like "spread,close" applies
+        size_t len = strcspn(policy, ",");
+        if ((len == 4 && strncasecmp(policy, "true", 4) == 0) ||
+                (len == 5 && strncasecmp(policy, "close", 5) == 0)) {
+            _lfortran_affinity.policy = LFORTRAN_BIND_CLOSE;
+        } else if (len == 6 && strncasecmp(policy, "spread", 6) == 0) {
+            _lfortran_affinity.policy = LFORTRAN_BIND_SPREAD;
+        } else if ((len == 6 && strncasecmp(policy, "master", 6) == 0) ||
+                (len == 7 && strncasecmp(policy, "primary", 7) == 0)) {
+            _lfortran_affinity.policy = LFORTRAN_BIND_MASTER;
+        }
+    } else if (places) {
+        _lfortran_affinity.policy = LFORTRAN_BIND_CLOSE;
+    }
+    if (_lfortran_affinity.policy == LFORTRAN_BIND_FALSE) return;
+
+    struct _lfortran_cpu_mask allowed;
+    memset(&allowed, 0, sizeof(allowed));
+    if (syscall(SYS_sched_getaffinity, 0, sizeof(allowed.bits), allowed.bits) < 0) {
+        _lfortran_affinity.policy = LFORTRAN_BIND_FALSE;
+        return;
+    }
+    struct _lfortran_cpu_mask *list = (struct _lfortran_cpu_mask*) malloc(
+        LFORTRAN_MAX_CPUS * sizeof(struct _lfortran_cpu_mask));
+    int n_places = list ? _lfortran_places_parse(places ? places : "threads",
+        list, &allowed) : 0;
+    if (n_places <= 0) {
+        if (n_places < 0) {
+            fprintf(stderr, "LFortran: ignoring the invalid places '%s'\n", places);
+        }
+        free(list);
+        _lfortran_affinity.policy = LFORTRAN_BIND_FALSE;
+        return;
+    }
+    _lfortran_affinity.places = list;
+    _lfortran_affinity.n_places = n_places;
+    for (int i = 0; i < n; i++) {
+        int p;
+        if (_lfortran_affinity.policy == LFORTRAN_BIND_MASTER) {
+            p = 0;
+        } else if (_lfortran_affinity.policy == LFORTRAN_BIND_CLOSE && n <= n_places) {
+            p = i;
+        } else {
+            p = (int) ((int64_t) i * n_places / n);
+        }
+        _lfortran_affinity.place[i] = p;
+    }
+    _lfortran_pool_pin(0);
+}
+
+#else
+
+static void _lfortran_pool_bind(int n)
+{
+    for (int i = 0; i < n; i++) {
+        _lfortran_affinity.place[i] = -1;
+    }
+}
+
+static void _lfortran_pool_pin(int self) { }
+
+#endif
+
+static void* _lfortran_pool_worker(void *arg)
+{
+    int self = (int) (intptr_t) arg;
+    uint64_t seen = 0;
+    _lfortran_pool_worker_id = self;
+    _lfortran_pool_pin(self);
+    pthread_mutex_lock(&_lfortran_pool.lock);
+    for (;;) {
+        if (_lfortran_pool.generation != seen && _lfortran_pool.job != NULL) {
+            seen = _lfortran_pool.generation;
+            struct _lfortran_pool_job *job = _lfortran_pool.job;
+            __atomic_add_fetch(&_lfortran_pool.active, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&_lfortran_pool.lock);
+            _lfortran_pool_work(self, job);
+            __atomic_sub_fetch(&_lfortran_pool.active, 1, __ATOMIC_RELEASE);
+            pthread_mutex_lock(&_lfortran_pool.lock);
+            continue;
+        }
+        // a loop that is already over
+        seen = _lfortran_pool.generation;
+        if (__atomic_load_n(&_lfortran_pool.queued_tasks, __ATOMIC_SEQ_CST) > 0) {
+            pthread_mutex_unlock(&_lfortran_pool.lock);
+            while (_lfortran_task_run_one()) { }
+            pthread_mutex_lock(&_lfortran_pool.lock);
+            continue;
+        }
+        // A spawner increments queued_tasks before it looks at sleeping,
+        // so either it sees this worker asleep and signals it or the
+        // worker sees the task here
+        __atomic_add_fetch(&_lfortran_pool.sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&_lfortran_pool.queued_tasks, __ATOMIC_SEQ_CST) == 0) {
+            pthread_cond_wait(&_lfortran_pool.wake, &_lfortran_pool.lock);
+        }
+        __atomic_sub_fetch(&_lfortran_pool.sleeping, 1, __ATOMIC_SEQ_CST);
+    }
+    return NULL;
+}
+
+// Workers are only started once a loop or a task is actually run in
+// parallel, the caller holds _lfortran_pool.lock
+static void _lfortran_pool_start()
+{
+    if (_lfortran_pool.started) return;
+    int n = 0;
+    const char *env = _lfortran_pool_getenv("LFORTRAN_NUM_THREADS", "OMP_NUM_THREADS");
+    if (env) n = atoi(env);
+    if (n <= 0) n = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (n <= 0) n = 1;
+    if (n > LFORTRAN_POOL_MAX_WORKERS) n = LFORTRAN_POOL_MAX_WORKERS;
+    for (int i = 0; i < n; i++) {
+        pthread_mutex_init(&_lfortran_pool.deques[i].lock, NULL);
+        pthread_mutex_init(&_lfortran_pool.task_queues[i].lock, NULL);
+    }
+    _lfortran_pool_bind(n);
+    _lfortran_pool.n_workers = 1;
+    for (int i = 1; i < n; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, _lfortran_pool_worker, (void*) (intptr_t) i) != 0) break;
+        pthread_detach(thread);
+        _lfortran_pool.n_workers++;
+    }
+    // tasks check this without the lock
+    __atomic_store_n(&_lfortran_pool.started, 1, __ATOMIC_RELEASE);
+}
+
+// Runs fn over [0, n) on the workers, returns false without calling fn if
+// there is a single worker or n is not above the grain size
+static bool _lfortran_pool_run(_lfortran_range_fn fn, void *data,
+    int64_t n, int64_t grain, bool steal)
+{
+    pthread_mutex_lock(&_lfortran_pool.job_lock);
+    pthread_mutex_lock(&_lfortran_pool.lock);
+    _lfortran_pool_start();
+    pthread_mutex_unlock(&_lfortran_pool.lock);
+    int n_workers = _lfortran_pool.n_workers;
+    if (grain <= 0) {
+        // about eight ranges per worker leave room for balancing the load
+        grain = n / (8 * (int64_t) n_workers);
+        if (grain < 1) grain = 1;
+    }
+    if (n_workers == 1 || n <= grain) {
+        pthread_mutex_unlock(&_lfortran_pool.job_lock);
+        return false;
+    }
+
+    struct _lfortran_pool_job job = {fn, data, grain, n, steal};
+    _lfortran_pool_worker_id = 0;
+    // the workers are idle, so their deques can be filled from here
+    for (int i = 0; i < n_workers; i++) {
+        int64_t lo = n * i / n_workers, hi = n * (i + 1) / n_workers;
+        if (lo < hi) _lfortran_pool_push(i, lo, hi);
+    }
+    pthread_mutex_lock(&_lfortran_pool.lock);
+    _lfortran_pool.job = &job;
+    _lfortran_pool.generation++;
+    pthread_cond_broadcast(&_lfortran_pool.wake);
+    pthread_mutex_unlock(&_lfortran_pool.lock);
+
+    _lfortran_pool_work(0, &job);
+
+    // wait for the workers that joined to leave before `job` goes away
+    pthread_mutex_lock(&_lfortran_pool.lock);
+    _lfortran_pool.job = NULL;
+    pthread_mutex_unlock(&_lfortran_pool.lock);
+    while (__atomic_load_n(&_lfortran_pool.active, __ATOMIC_ACQUIRE) > 0) {
+        sched_yield();
+    }
+    _lfortran_pool_worker_id = -1;
+    pthread_mutex_unlock(&_lfortran_pool.job_lock);
+    return true;
+}
+
+LFORTRAN_API void _lfortran_parallel_for(_lfortran_range_fn fn, void *data,
+    int64_t n, int64_t grain)
+{
+    if (n <= 0) return;
+    // Loops nested in a parallel one run on the calling worker
+    if (_lfortran_pool_worker_id >= 0 ||
+            !_lfortran_pool_run(fn, data, n, grain, true)) {
+        fn(data, 0, n);
+    }
+}
+
+LFORTRAN_API void _lfortran_pool_lock()
+{
+    pthread_mutex_lock(&_lfortran_pool.reduction_lock);
+}
+
+LFORTRAN_API void _lfortran_pool_unlock()
+{
+    pthread_mutex_unlock(&_lfortran_pool.reduction_lock);
+}
+
+// Threads outside of the pool share the queue of worker 0
+static int _lfortran_task_queue_id()
+{
+    return _lfortran_pool_worker_id > 0 ? _lfortran_pool_worker_id : 0;
+}
+
+static void _lfortran_task_push(int self, struct _lfortran_task *t)
+{
+    struct _lfortran_task_queue *q = &_lfortran_pool.task_queues[self];
+    pthread_mutex_lock(&q->lock);
+    t->prev = NULL;
+    t->next = q->head;
+    if (q->head) {
+        q->head->prev = t;
+    } else {
+        q->tail = t;
+    }
+    // head is peeked at by thieves without the lock
+    __atomic_store_n(&q->head, t, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// The owner takes the newest task, thieves the oldest one
+static struct _lfortran_task* _lfortran_task_take(int victim, bool steal)
+{
+    struct _lfortran_task_queue *q = &_lfortran_pool.task_queues[victim];
+    if (__atomic_load_n(&q->head, __ATOMIC_RELAXED) == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(&q->lock);
+    struct _lfortran_task *t = steal ? q->tail : q->head;
+    if (t) {
+        if (t->prev) {
+            t->prev->next = t->next;
+        } else {
+            __atomic_store_n(&q->head, t->next, __ATOMIC_RELAXED);
+        }
+        if (t->next) {
+            t->next->prev = t->prev;
+        } else {
+            q->tail = t->prev;
+        }
+    }
+    pthread_mutex_unlock(&q->lock);
+    if (t) {
+        __atomic_sub_fetch(&_lfortran_pool.queued_tasks, 1, __ATOMIC_SEQ_CST);
+    }
+    return t;
+}
+
+static void _lfortran_task_run(struct _lfortran_task *t)
+{
+    struct _lfortran_task *outer_task = _lfortran_current_task;
+    struct _lfortran_taskgroup *outer_group = _lfortran_current_taskgroup;
+    _lfortran_current_task = t;
+    _lfortran_current_taskgroup = t->group;
+    t->fn((char*) t + LFORTRAN_TASK_HEADER_SIZE);
+    _lfortran_taskwait();
+    _lfortran_current_task = outer_task;
+    _lfortran_current_taskgroup = outer_group;
+
+    struct _lfortran_task *parent = t->parent;
+    struct _lfortran_taskgroup *group = t->group;
+    free(t);
+    if (group) {
+        __atomic_sub_fetch(&group->pending, 1, __ATOMIC_RELEASE);
+    }
+    __atomic_sub_fetch(&parent->children, 1, __ATOMIC_RELEASE);
+}
+
+static bool _lfortran_task_run_one()
+{
+    int n_workers = _lfortran_pool.n_workers;
+    int self = _lfortran_task_queue_id();
+    struct _lfortran_task *t = _lfortran_task_take(self, false);
+    for (int i = 1; t == NULL && i < n_workers; i++) {
+        t = _lfortran_task_take((self + i) % n_workers, true);
+    }
+    if (t == NULL) return false;
+    _lfortran_task_run(t);
+    return true;
+}
+
+LFORTRAN_API void _lfortran_task_spawn(_lfortran_task_fn fn, void *data,
+    int64_t size)
+{
+    if (!__atomic_load_n(&_lfortran_pool.started, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&_lfortran_pool.lock);
+        _lfortran_pool_start();
+        pthread_mutex_unlock(&_lfortran_pool.lock);
+    }
+    struct _lfortran_task *parent = _lfortran_current_task
+        ? _lfortran_current_task : &_lfortran_implicit_task;
+    struct _lfortran_task *t = (struct _lfortran_task*) malloc(
+        LFORTRAN_TASK_HEADER_SIZE + size);
+    if (t == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for a task\n");
+        exit(1);
+    }
+    t->fn = fn;
+    t->parent = parent;
+    t->group = _lfortran_current_taskgroup;
+    t->children = 0;
+    memcpy((char*) t + LFORTRAN_TASK_HEADER_SIZE, data, size);
+    __atomic_add_fetch(&parent->children, 1, __ATOMIC_RELAXED);
+    if (t->group) {
+        __atomic_add_fetch(&t->group->pending, 1, __ATOMIC_RELAXED);
+    }
+
+    int n_workers = _lfortran_pool.n_workers;
+    if (n_workers == 1 || __atomic_load_n(&_lfortran_pool.queued_tasks,
+            __ATOMIC_RELAXED) >= LFORTRAN_TASK_MAX_QUEUED * n_workers) {
+        _lfortran_task_run(t);
+        return;
+    }
+    __atomic_add_fetch(&_lfortran_pool.queued_tasks, 1, __ATOMIC_SEQ_CST);
+    _lfortran_task_push(_lfortran_task_queue_id(), t);
+    if (__atomic_load_n(&_lfortran_pool.sleeping, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&_lfortran_pool.lock);
+        pthread_cond_signal(&_lfortran_pool.wake);
+        pthread_mutex_unlock(&_lfortran_pool.lock);
+    }
+}
+
+LFORTRAN_API void _lfortran_taskwait()
+{
+    struct _lfortran_task *self = _lfortran_current_task
+        ? _lfortran_current_task : &_lfortran_implicit_task;
+    while (__atomic_load_n(&self->children, __ATOMIC_ACQUIRE) > 0) {
+        if (!_lfortran_task_run_one()) sched_yield();
+    }
+}
+
+LFORTRAN_API void _lfortran_taskgroup_start()
+{
+    struct _lfortran_taskgroup *group = (struct _lfortran_taskgroup*) malloc(
+        sizeof(struct _lfortran_taskgroup));
+    if (group == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for a taskgroup\n");
+        exit(1);
+    }
+    group->pending = 0;
+    group->outer = _lfortran_current_taskgroup;
+    _lfortran_current_taskgroup = group;
+}
+
+// Waits for all the tasks of the group and their descendants
+LFORTRAN_API void _lfortran_taskgroup_end()
+{
+    struct _lfortran_taskgroup *group = _lfortran_current_taskgroup;
+    if (group == NULL) return;
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        if (!_lfortran_task_run_one()) sched_yield();
+    }
+    _lfortran_current_taskgroup = group->outer;
+    free(group);
+}
+
+/*
+ * First touch.
+ *
+ * Linux places a page on the node of the thread that first writes to it,
+ * so an array allocated and initialized by the main thread ends up on a
+ * single node and the workers on the other nodes read it remotely. With
+ * LFORTRAN_FIRST_TOUCH set to a nonzero value, the fresh blocks of at least
+ * LFORTRAN_FIRST_TOUCH_MIN_BYTES that the main thread allocates are touched
+ * on the pool instead. Worker i writes to the i-th of n equal parts of the
+ * pages, which is the part of the iterations it starts every parallel loop
+ * with, so bound workers find their part of an array on their own node.
+ * OpenMP threads bound to the same places see the same pages for loops with
+ * schedule(static) if their number is the same.
+ *
+ * With --numa-report the program prints at exit how many large blocks were
+ * allocated and touched in parallel, where the workers are bound and on
+ * which nodes a sample of the pages of every large block is placed.
+ */
+
+#define LFORTRAN_FIRST_TOUCH_MIN_BYTES (1024 * 1024)
+// Large blocks whose pages are sampled for the report
+#define LFORTRAN_NUMA_MAX_BLOCKS 64
+#define LFORTRAN_NUMA_SAMPLE_PAGES 32
+
+static struct {
+    pthread_mutex_t lock;
+    // -1 until LFORTRAN_FIRST_TOUCH was read
+    int first_touch;
+    bool report;
+    int64_t allocations, bytes;
+    int64_t touched_allocations, touched_bytes;
+    // sampled pages per node, and those not touched yet
+    int64_t pages[LFORTRAN_MAX_NUMA_NODES];
+    int64_t untouched_pages;
+    void *blocks[LFORTRAN_NUMA_MAX_BLOCKS];
+    size_t block_sizes[LFORTRAN_NUMA_MAX_BLOCKS];
+    int n_blocks;
+} _lfortran_numa = {PTHREAD_MUTEX_INITIALIZER, -1};
+
+struct _lfortran_first_touch_block {
+    uintptr_t first_page;
+    char *base;
+    size_t page_size;
+};
+
+static void _lfortran_first_touch_pages(void *data, int64_t lo, int64_t hi)
+{
+    struct _lfortran_first_touch_block *b = (struct _lfortran_first_touch_block*) data;
+    for (int64_t i = lo; i < hi; i++) {
+        volatile char *p = (volatile char*) (b->first_page + i * b->page_size);
+        // the first page starts before the block
+        if ((char*) p < b->base) p = b->base;
+        *p = 0;
+    }
+}
+
+// Counts the nodes of pages spread evenly over the block
+static void _lfortran_numa_sample(char *base, size_t size)
+{
+#if defined(__linux__) && defined(SYS_move_pages)
+    void *pages[LFORTRAN_NUMA_SAMPLE_PAGES];
+    int status[LFORTRAN_NUMA_SAMPLE_PAGES];
+    for (int i = 0; i < LFORTRAN_NUMA_SAMPLE_PAGES; i++) {
+        pages[i] = base + size / LFORTRAN_NUMA_SAMPLE_PAGES * i;
+    }
+    // without target nodes move_pages only reports where the pages are
+    if (syscall(SYS_move_pages, 0, (unsigned long) LFORTRAN_NUMA_SAMPLE_PAGES,
+            pages, NULL, status, 0) != 0) {
+        return;
+    }
+    for (int i = 0; i < LFORTRAN_NUMA_SAMPLE_PAGES; i++) {
+        if (status[i] >= 0 && status[i] < LFORTRAN_MAX_NUMA_NODES) {
+            _lfortran_numa.pages[status[i]]++;
+        } else {
+            _lfortran_numa.untouched_pages++;
+        }
+    }
+#endif
+}
+
+static bool _lfortran_is_main_thread()
+{
+#if defined(__linux__)
+    return syscall(SYS_gettid) == getpid();
+#else
+    return true;
+#endif
+}
+
+// Called for every fresh block, which nothing has written to yet
+static void _lfortran_first_touch(void *ptr, size_t size)
+{
+    if (ptr == NULL || size < LFORTRAN_FIRST_TOUCH_MIN_BYTES) return;
+    __atomic_add_fetch(&_lfortran_numa.allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&_lfortran_numa.bytes, (int64_t) size, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&_lfortran_numa.report, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&_lfortran_numa.lock);
+        if (_lfortran_numa.n_blocks < LFORTRAN_NUMA_MAX_BLOCKS) {
+            _lfortran_numa.blocks[_lfortran_numa.n_blocks] = ptr;
+            _lfortran_numa.block_sizes[_lfortran_numa.n_blocks] = size;
+            _lfortran_numa.n_blocks++;
+        }
+        pthread_mutex_unlock(&_lfortran_numa.lock);
+    }
+    int first_touch = __atomic_load_n(&_lfortran_numa.first_touch, __ATOMIC_RELAXED);
+    if (first_touch < 0) {
+        const char *env = getenv("LFORTRAN_FIRST_TOUCH");
+        first_touch = env != NULL && atoi(env) != 0;
+        __atomic_store_n(&_lfortran_numa.first_touch, first_touch, __ATOMIC_RELAXED);
+    }
+    // Blocks allocated by a worker or by an OpenMP thread are used by it
+    if (!first_touch || _lfortran_pool_worker_id >= 0 || !_lfortran_is_main_thread()) {
+        return;
+    }
+    uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    struct _lfortran_first_touch_block b = {
+        (uintptr_t) ptr & ~(page_size - 1), (char*) ptr, page_size};
+    int64_t n_pages = ((uintptr_t) ptr + size - 1 - b.first_page) / page_size + 1;
+    if (_lfortran_pool_run(_lfortran_first_touch_pages, &b, n_pages, 0, false)) {
+        __atomic_add_fetch(&_lfortran_numa.touched_allocations, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&_lfortran_numa.touched_bytes, (int64_t) size, __ATOMIC_RELAXED);
+    }
+}
+
+// Samples a large block before it is freed
+static void _lfortran_numa_release(void *ptr)
+{
+    if (!__atomic_load_n(&_lfortran_numa.report, __ATOMIC_RELAXED)) return;
+    pthread_mutex_lock(&_lfortran_numa.lock);
+    for (int i = 0; i < _lfortran_numa.n_blocks; i++) {
+        if (_lfortran_numa.blocks[i] == ptr) {
+            _lfortran_numa_sample((char*) ptr, _lfortran_numa.block_sizes[i]);
+            _lfortran_numa.n_blocks--;
+            _lfortran_numa.blocks[i] = _lfortran_numa.blocks[_lfortran_numa.n_blocks];
+            _lfortran_numa.block_sizes[i] = _lfortran_numa.block_sizes[_lfortran_numa.n_blocks];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_lfortran_numa.lock);
+}
+
+static void _lfortran_numa_report()
+{
+    const double mib = 1024.0 * 1024.0;
+    pthread_mutex_lock(&_lfortran_numa.lock);
+    for (int i = 0; i < _lfortran_numa.n_blocks; i++) {
+        _lfortran_numa_sample((char*) _lfortran_numa.blocks[i],
+            _lfortran_numa.block_sizes[i]);
+    }
+    _lfortran_numa.n_blocks = 0;
+    fprintf(stderr, "NUMA report\n");
+    if (__atomic_load_n(&_lfortran_pool.started, __ATOMIC_ACQUIRE)) {
+        static const char *policies[] = {"false", "close", "spread", "master"};
+        fprintf(stderr, "  workers: %d, proc_bind: %s, places: %d\n",
+            _lfortran_pool.n_workers, policies[_lfortran_affinity.policy],
+            _lfortran_affinity.n_places);
+#if defined(__linux__)
+        for (int i = 0; i < _lfortran_pool.n_workers; i++) {
+            int p = _lfortran_affinity.place[i];
+            if (p < 0) continue;
+            fprintf(stderr, "  worker %d: place %d, cpus", i, p);
+            int node = -1;
+            for (long c = 0; c < LFORTRAN_MAX_CPUS; c++) {
+                if (_lfortran_cpu_mask_has(&_lfortran_affinity.places[p], c)) {
+                    fprintf(stderr, " %ld", c);
+                    if (node < 0) node = _lfortran_cpu_node(c);
+                }
+            }
+            fprintf(stderr, ", node %d\n", node);
+        }
+#endif
+    } else {
+        fprintf(stderr, "  workers: the pool was not started\n");
+    }
+    fprintf(stderr, "  large allocations: %" PRId64 " (%.1f MiB)\n",
+        _lfortran_numa.allocations, _lfortran_numa.bytes / mib);
+    fprintf(stderr, "  first touched in parallel: %" PRId64 " (%.1f MiB)\n",
+        _lfortran_numa.touched_allocations, _lfortran_numa.touched_bytes / mib);
+    fprintf(stderr, "  sampled pages:");
+    for (int k = 0; k < LFORTRAN_MAX_NUMA_NODES; k++) {
+        if (_lfortran_numa.pages[k] > 0) {
+            fprintf(stderr, " node %d: %" PRId64 ",", k, _lfortran_numa.pages[k]);
+        }
+    }
+    fprintf(stderr, " not touched: %" PRId64 "\n", _lfortran_numa.untouched_pages);
+    pthread_mutex_unlock(&_lfortran_numa.lock);
+}
+
+LFORTRAN_API void _lfortran_numa_report_enable()
+{
+    if (!__atomic_exchange_n(&_lfortran_numa.report, true, __ATOMIC_RELAXED)) {
+        atexit(_lfortran_numa_report);
+    }
+}
+
+#else
+
+// No threads on this target, the loop runs on the calling thread
+LFORTRAN_API void _lfortran_parallel_for(_lfortran_range_fn fn, void *data,
+    int64_t n, int64_t grain)
+{
+    (void) grain;
+    if (n > 0) fn(data, 0, n);
+}
+
+LFORTRAN_API void _lfortran_pool_lock()
+{
+}
+
+LFORTRAN_API void _lfortran_pool_unlock()
+{
+}
+
+// Tasks are executed as soon as they are spawned
+LFORTRAN_API void _lfortran_task_spawn(_lfortran_task_fn fn, void *data,
+    int64_t size)
+{
+    (void) size;
+    fn(data);
+}
+
+LFORTRAN_API void _lfortran_taskwait()
+{
+}
+
+LFORTRAN_API void _lfortran_taskgroup_start()
+{
+}
+
+LFORTRAN_API void _lfortran_taskgroup_end()
+{
+}
+
+static void _lfortran_first_touch(void *ptr, size_t size) { }
+
+static void _lfortran_numa_release(void *ptr) { }
 
-#ifdef HAVE_RUNTIME_STACKTRACE
+LFORTRAN_API void _lfortran_numa_report_enable()
+{
+}
 
-#ifdef COMPILE_TO_WASM
-    #undef HAVE_LFORTRAN_MACHO
-    #undef HAVE_LFORTRAN_LINK
 #endif
 
-#ifdef HAVE_LFORTRAN_LINK
-// For dl_iterate_phdr() functionality
-#  include <link.h>
-struct dl_phdr_info {
-    ElfW(Addr) dlpi_addr;
-    const char *dlpi_name;
-    const ElfW(Phdr) *dlpi_phdr;
-    ElfW(Half) dlpi_phnum;
+// Array reductions ------------------------------------------------------------
+
+/*
+ * SUM, PRODUCT, MAXVAL, MINVAL, COUNT, ANY and ALL of a whole contiguous
+ * array, called instead of the generated loops with --parallel-intrinsics and
+ * --openmp. The kernels keep LFORTRAN_REDUCE_LANES independent accumulators,
+ * so the loop is not bound by the latency of a single dependency chain and
+ * vectorizes without fast-math; the lanes are combined pairwise at the end.
+ *
+ * Arrays of at least LFORTRAN_REDUCE_PARALLEL_SIZE elements are cut into
+ * blocks of LFORTRAN_REDUCE_BLOCK elements that are reduced on the thread
+ * pool. Every block writes its own partial result and the partials are
+ * combined in block order on the calling thread, so the result does not
+ * depend on the number of threads or on which worker ran which block.
+ */
+
+#define LFORTRAN_REDUCE_LANES 8
+#define LFORTRAN_REDUCE_BLOCK ((int64_t) 1 << 15)
+#define LFORTRAN_REDUCE_PARALLEL_SIZE ((int64_t) 1 << 18)
+// ANY and ALL stop after the first chunk of this many elements that decides
+#define LFORTRAN_REDUCE_EXIT_CHUNK 1024
+
+typedef void (*_lfortran_reduce_fn)(const void *a, int64_t n, void *result);
+
+struct _lfortran_reduce_job {
+    _lfortran_reduce_fn kernel;
+    const char *a;
+    int64_t n;
+    size_t element_size;
+    char *partials;
+    size_t partial_size;
+    // ANY and ALL: the value that decides the result, -1 otherwise
+    int decisive;
+    int32_t decided;
 };
-extern int dl_iterate_phdr (int (*__callback) (struct dl_phdr_info *,
-    size_t, void *), void *__data);
-#endif
 
-#ifdef HAVE_LFORTRAN_UNWIND
-// For _Unwind_Backtrace() function
-#  include <unwind.h>
-#endif
+static void _lfortran_reduce_range(void *data, int64_t lo, int64_t hi)
+{
+    struct _lfortran_reduce_job *job = (struct _lfortran_reduce_job*) data;
+    for (int64_t i = lo; i < hi; i++) {
+        if (job->decisive >= 0 && _lfortran_load32(&job->decided)) return;
+        int64_t start = i*LFORTRAN_REDUCE_BLOCK;
+        int64_t n = job->n - start;
+        if (n > LFORTRAN_REDUCE_BLOCK) n = LFORTRAN_REDUCE_BLOCK;
+        char *partial = job->partials + i*job->partial_size;
+        job->kernel(job->a + start*job->element_size, n, partial);
+        if (job->decisive >= 0 && *(bool*) partial == (bool) job->decisive) {
+            _lfortran_cas32(&job->decided, 0, 1);
+        }
+    }
+}
 
-#ifdef HAVE_LFORTRAN_MACHO
-#  include <mach-o/dyld.h>
-#endif
+// Reduces the blocks of a[0:n] on the thread pool and returns their partial
+// results, or NULL if the array is reduced on the calling thread instead
+static void* _lfortran_reduce_blocks(_lfortran_reduce_fn kernel, const void *a,
+    int64_t n, size_t element_size, size_t partial_size, int decisive,
+    bool parallel, int64_t *n_blocks)
+{
+    if (!parallel || n < LFORTRAN_REDUCE_PARALLEL_SIZE) return NULL;
+    *n_blocks = (n + LFORTRAN_REDUCE_BLOCK - 1) / LFORTRAN_REDUCE_BLOCK;
+    char *partials = (char*) malloc(*n_blocks * partial_size);
+    if (partials == NULL) return NULL;
+    if (decisive >= 0) {
+        // blocks skipped after the decision keep the neutral value
+        memset(partials, !decisive, *n_blocks * partial_size);
+    }
+    struct _lfortran_reduce_job job = {kernel, (const char*) a, n,
+        element_size, partials, partial_size, decisive, 0};
+    _lfortran_parallel_for(_lfortran_reduce_range, &job, *n_blocks, 1);
+    return partials;
+}
 
-// Runtime Stacktrace
-#define LCOMPILERS_MAX_STACKTRACE_LENGTH 200
-char *source_filename;
-char *binary_executable_path = "/proc/self/exe";
+/*
+ * Defines _lfortran_<name>(a, n, parallel). `combine` computes the reduction
+ * of the accumulators `x` and `y`. Integer sums and products accumulate in
+ * unsigned types, where overflow wraps instead of being undefined.
+ */
+#define LFORTRAN_ARRAY_REDUCTION(name, type, acc_type, ret_type, init, combine) \
+static void _lfortran_##name##_kernel(const void *data, int64_t n, void *result) \
+{                                                                               \
+    const type *a = (const type*) data;                                         \
+    acc_type acc[LFORTRAN_REDUCE_LANES], x, y;                                  \
+    for (int k = 0; k < LFORTRAN_REDUCE_LANES; k++) acc[k] = init;              \
+    int64_t i = 0;                                                              \
+    for (; i + LFORTRAN_REDUCE_LANES <= n; i += LFORTRAN_REDUCE_LANES) {        \
+        for (int k = 0; k < LFORTRAN_REDUCE_LANES; k++) {                       \
+            x = acc[k];                                                         \
+            y = (acc_type) a[i + k];                                            \
+            acc[k] = combine;                                                   \
+        }                                                                       \
+    }                                                                           \
+    for (; i < n; i++) {                                                        \
+        x = acc[0];                                                             \
+        y = (acc_type) a[i];                                                    \
+        acc[0] = combine;                                                       \
+    }                                                                           \
+    for (int w = LFORTRAN_REDUCE_LANES / 2; w > 0; w /= 2) {                    \
+        for (int k = 0; k < w; k++) {                                           \
+            x = acc[k];                                                         \
+            y = acc[k + w];                                                     \
+            acc[k] = combine;                                                   \
+        }                                                                       \
+    }                                                                           \
+    *(acc_type*) result = acc[0];                                               \
+}                                                                               \
+                                                                                \
+LFORTRAN_API ret_type _lfortran_##name(const type *a, int64_t n, bool parallel) \
+{                                                                               \
+    int64_t n_blocks = 0;                                                       \
+    acc_type *partials = (acc_type*) _lfortran_reduce_blocks(                   \
+        _lfortran_##name##_kernel, a, n, sizeof(type), sizeof(acc_type), -1,    \
+        parallel, &n_blocks);                                                   \
+    acc_type r, x, y;                                                           \
+    if (partials == NULL) {                                                     \
+        _lfortran_##name##_kernel(a, n, &r);                                    \
+        return (ret_type) r;                                                    \
+    }                                                                           \
+    r = partials[0];                                                            \
+    for (int64_t b = 1; b < n_blocks; b++) {                                    \
+        x = r;                                                                  \
+        y = partials[b];                                                        \
+        r = combine;                                                            \
+    }                                                                           \
+    free(partials);                                                             \
+    return (ret_type) r;                                                        \
+}
+
+LFORTRAN_ARRAY_REDUCTION(sum_i32, int32_t, uint32_t, int32_t, 0, x + y)
+LFORTRAN_ARRAY_REDUCTION(sum_i64, int64_t, uint64_t, int64_t, 0, x + y)
+LFORTRAN_ARRAY_REDUCTION(sum_r32, float, float, float, 0, x + y)
+LFORTRAN_ARRAY_REDUCTION(sum_r64, double, double, double, 0, x + y)
+LFORTRAN_ARRAY_REDUCTION(product_i32, int32_t, uint32_t, int32_t, 1, x * y)
+LFORTRAN_ARRAY_REDUCTION(product_i64, int64_t, uint64_t, int64_t, 1, x * y)
+LFORTRAN_ARRAY_REDUCTION(product_r32, float, float, float, 1, x * y)
+LFORTRAN_ARRAY_REDUCTION(product_r64, double, double, double, 1, x * y)
+// The initial values are the ones of the generated loops: -huge for integers
+LFORTRAN_ARRAY_REDUCTION(maxval_i32, int32_t, int32_t, int32_t, -INT32_MAX, y > x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(maxval_i64, int64_t, int64_t, int64_t, -INT64_MAX, y > x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(maxval_r32, float, float, float, -FLT_MAX, y > x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(maxval_r64, double, double, double, -DBL_MAX, y > x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(minval_i32, int32_t, int32_t, int32_t, INT32_MAX, y < x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(minval_i64, int64_t, int64_t, int64_t, INT64_MAX, y < x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(minval_r32, float, float, float, FLT_MAX, y < x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(minval_r64, double, double, double, DBL_MAX, y < x ? y : x)
+LFORTRAN_ARRAY_REDUCTION(count, bool, int64_t, int64_t, 0, x + y)
+
+#undef LFORTRAN_ARRAY_REDUCTION
+
+static void _lfortran_any_kernel(const void *data, int64_t n, void *result)
+{
+    const bool *a = (const bool*) data;
+    bool r = false;
+    for (int64_t i = 0; i < n && !r; i += LFORTRAN_REDUCE_EXIT_CHUNK) {
+        int64_t m = n - i < LFORTRAN_REDUCE_EXIT_CHUNK ? n - i : LFORTRAN_REDUCE_EXIT_CHUNK;
+        for (int64_t j = 0; j < m; j++) r |= a[i + j];
+    }
+    *(bool*) result = r;
+}
+
+static void _lfortran_all_kernel(const void *data, int64_t n, void *result)
+{
+    const bool *a = (const bool*) data;
+    bool r = true;
+    for (int64_t i = 0; i < n && r; i += LFORTRAN_REDUCE_EXIT_CHUNK) {
+        int64_t m = n - i < LFORTRAN_REDUCE_EXIT_CHUNK ? n - i : LFORTRAN_REDUCE_EXIT_CHUNK;
+        for (int64_t j = 0; j < m; j++) r &= a[i + j];
+    }
+    *(bool*) result = r;
+}
+
+static bool _lfortran_any_all(_lfortran_reduce_fn kernel, const bool *a,
+    int64_t n, bool decisive, bool parallel)
+{
+    int64_t n_blocks = 0;
+    bool *partials = (bool*) _lfortran_reduce_blocks(kernel, a, n,
+        sizeof(bool), sizeof(bool), decisive, parallel, &n_blocks);
+    bool r;
+    if (partials == NULL) {
+        kernel(a, n, &r);
+        return r;
+    }
+    r = !decisive;
+    for (int64_t b = 0; b < n_blocks; b++) {
+        if (partials[b] == decisive) r = decisive;
+    }
+    free(partials);
+    return r;
+}
 
-struct Stacktrace {
-    uintptr_t pc[LCOMPILERS_MAX_STACKTRACE_LENGTH];
-    uint64_t pc_size;
-    uintptr_t current_pc;
+LFORTRAN_API bool _lfortran_any(const bool *a, int64_t n, bool parallel)
+{
+    return _lfortran_any_all(_lfortran_any_kernel, a, n, true, parallel);
+}
 
-    uintptr_t local_pc[LCOMPILERS_MAX_STACKTRACE_LENGTH];
-    char *binary_filename[LCOMPILERS_MAX_STACKTRACE_LENGTH];
-    uint64_t local_pc_size;
+LFORTRAN_API bool _lfortran_all(const bool *a, int64_t n, bool parallel)
+{
+    return _lfortran_any_all(_lfortran_all_kernel, a, n, false, parallel);
+}
 
-    uint64_t addresses[LCOMPILERS_MAX_STACKTRACE_LENGTH];
-    uint64_t line_numbers[LCOMPILERS_MAX_STACKTRACE_LENGTH];
-    uint64_t stack_size;
+// Coarrays -------------------------------------------------------------------
+
+/*
+ * Coarray images on a single node.
+ *
+ * With LFORTRAN_NUM_IMAGES set to n > 1, _lfortran_caf_init starts n images
+ * before any user code runs. The initial process becomes image 1 and forks
+ * the others. All images share one anonymous MAP_SHARED mapping, created
+ * before the fork so it has the same address in every image. The mapping
+ * holds a control block, two collective buffers per image and one coarray
+ * heap per image.
+ *
+ * Every image registers its coarrays in the same order, so a coarray has the
+ * same offset in every heap. Its copy on image j is therefore at the local
+ * address plus (j - this_image()) heap sizes, and coindexed references are
+ * plain loads and stores through that address.
+ *
+ * A collective step gathers the images along a binomial tree rooted at the
+ * result image. A reduction combines the values of a subtree in the buffer
+ * of its root. The root then publishes the step, and the images that need
+ * the result read it from its buffer. `sync all` is a step without data.
+ * Every image waits for the root before it starts the next step, so the
+ * buffers alternate between two halves and are never overwritten while an
+ * image still reads them. `sync images` counts the syncs between every
+ * ordered pair of images.
+ *
+ * An image that terminates marks itself as stopped. An image that waits for
+ * it in a later synchronization stops with an error instead of hanging, and
+ * so do the images waiting for that one in turn.
+ */
+
+#define LFORTRAN_CAF_MAX_IMAGES 256
+#define LFORTRAN_CAF_HEAP_SIZE ((size_t) 256 * 1024 * 1024)
+#define LFORTRAN_CAF_BUFFER_SIZE (64 * 1024)
+
+typedef void (*_lfortran_caf_combine_fn)(void *acc, const void *x, int64_t n);
+
+struct _lfortran_caf_image {
+    int64_t arrived;
+    int64_t done;
+    int64_t stopped;
+    char padding[40];
 };
 
-// Styles and Colors
-#define DIM "\033[2m"
-#define BOLD "\033[1m"
-#define S_RESET "\033[0m"
-#define MAGENTA "\033[35m"
-#define C_RESET "\033[39m"
+struct _lfortran_caf_control {
+    struct _lfortran_caf_image images[LFORTRAN_CAF_MAX_IMAGES];
+};
 
-#endif // HAVE_RUNTIME_STACKTRACE
+static struct {
+    int32_t this_image;
+    int32_t num_images;
+    struct _lfortran_caf_control *control;
+    // syncs[i * num_images + j] counts the syncs of image i + 1 with j + 1
+    int64_t *syncs;
+    char *buffers;
+    char *heaps;
+    size_t heap_size;
+    size_t heap_used;
+    // collective steps so far, the same on every image
+    int64_t steps;
+    int64_t synced[LFORTRAN_CAF_MAX_IMAGES];
+#if defined(LFORTRAN_HAVE_IMAGES)
+    pid_t pids[LFORTRAN_CAF_MAX_IMAGES];
+#endif
+} _lfortran_caf = {1, 1};
 
-#ifdef HAVE_LFORTRAN_MACHO
-    #define INT64 "%lld"
-#elif HAVE_BUILD_TO_WASM
-    #define INT64 "%lld"
-#else
-    #define INT64 "%ld"
+static void _lfortran_caf_error(const char *msg, int32_t image)
+{
+    fprintf(stderr, "Image %d: %s", _lfortran_caf.this_image, msg);
+    if (image != 0) fprintf(stderr, " %d", image);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+#if defined(LFORTRAN_HAVE_IMAGES)
+
+static char* _lfortran_caf_buffer(int image, int64_t step)
+{
+    return _lfortran_caf.buffers + ((size_t) image * 2 + step % 2) * LFORTRAN_CAF_BUFFER_SIZE;
+}
+
+// Waits until `image` (0-based) has set `flag` to at least `value`
+static void _lfortran_caf_wait(int image, int64_t *flag, int64_t value)
+{
+    int64_t *stopped = &_lfortran_caf.control->images[image].stopped;
+    while (__atomic_load_n(flag, __ATOMIC_ACQUIRE) < value) {
+        if (__atomic_load_n(stopped, __ATOMIC_ACQUIRE) > 0) {
+            // the image may have set the flag just before it stopped
+            if (__atomic_load_n(flag, __ATOMIC_ACQUIRE) >= value) break;
+            _lfortran_caf_error("waits for stopped image", image + 1);
+        }
+        sched_yield();
+    }
+}
+
+static void _lfortran_caf_finalize()
+{
+    __atomic_store_n(&_lfortran_caf.control->images[_lfortran_caf.this_image - 1].stopped,
+        1, __ATOMIC_RELEASE);
+    if (_lfortran_caf.this_image != 1) return;
+    int failed = 0;
+    for (int i = 1; i < _lfortran_caf.num_images; i++) {
+        int status;
+        if (waitpid(_lfortran_caf.pids[i], &status, 0) < 0 ||
+                !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = 1;
+        }
+    }
+    if (failed) {
+        fflush(NULL);
+        _exit(1);
+    }
+}
+
+LFORTRAN_API void _lfortran_caf_init()
+{
+    const char *env = getenv("LFORTRAN_NUM_IMAGES");
+    int n = env ? atoi(env) : 1;
+    if (n <= 1 || _lfortran_caf.control != NULL) return;
+    if (n > LFORTRAN_CAF_MAX_IMAGES) n = LFORTRAN_CAF_MAX_IMAGES;
+    size_t heap_size = LFORTRAN_CAF_HEAP_SIZE;
+    env = getenv("LFORTRAN_CAF_HEAP_SIZE");
+    if (env && atoll(env) > 0) heap_size = (size_t) atoll(env);
+    heap_size = (heap_size + 4095) & ~(size_t) 4095;
+    size_t control_size = (sizeof(struct _lfortran_caf_control) +
+        (size_t) n * n * sizeof(int64_t) + 4095) & ~(size_t) 4095;
+    size_t buffers_size = (size_t) n * 2 * LFORTRAN_CAF_BUFFER_SIZE;
+    int flags = MAP_SHARED | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+    flags |= MAP_NORESERVE;
 #endif
+    char *base = (char*) mmap(NULL, control_size + buffers_size + n * heap_size,
+        PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (base == (char*) MAP_FAILED) {
+        _lfortran_caf_error("cannot map the shared memory of the images", 0);
+    }
+    _lfortran_caf.control = (struct _lfortran_caf_control*) base;
+    _lfortran_caf.syncs = (int64_t*) (base + sizeof(struct _lfortran_caf_control));
+    _lfortran_caf.buffers = base + control_size;
+    _lfortran_caf.heaps = base + control_size + buffers_size;
+    _lfortran_caf.heap_size = heap_size;
+    _lfortran_caf.num_images = n;
+    fflush(NULL);
+    for (int i = 1; i < n; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            _lfortran_caf_error("cannot start image", i + 1);
+        }
+        if (pid == 0) {
+            _lfortran_caf.this_image = i + 1;
+            break;
+        }
+        _lfortran_caf.pids[i] = pid;
+    }
+    atexit(_lfortran_caf_finalize);
+}
+
+LFORTRAN_API void* _lfortran_caf_register(int64_t size)
+{
+    if (_lfortran_caf.num_images == 1) {
+        return calloc(1, size > 0 ? size : 1);
+    }
+    size_t offset = _lfortran_caf.heap_used;
+    if (size < 0 || offset + size > _lfortran_caf.heap_size) {
+        _lfortran_caf_error("the coarrays do not fit into LFORTRAN_CAF_HEAP_SIZE", 0);
+    }
+    _lfortran_caf.heap_used = (offset + size + 15) & ~(size_t) 15;
+    return _lfortran_caf.heaps +
+        (size_t) (_lfortran_caf.this_image - 1) * _lfortran_caf.heap_size + offset;
+}
+
+// One collective step on at most LFORTRAN_CAF_BUFFER_SIZE bytes of `a`
+static void _lfortran_caf_step(char *a, int64_t n, int64_t elem_size,
+    _lfortran_caf_combine_fn combine, int root, bool copy_out)
+{
+    int n_images = _lfortran_caf.num_images;
+    int me = _lfortran_caf.this_image - 1;
+    int rank = (me - root + n_images) % n_images;
+    int64_t step = ++_lfortran_caf.steps;
+    struct _lfortran_caf_image *images = _lfortran_caf.control->images;
+    char *buffer = _lfortran_caf_buffer(me, step);
+    if (n > 0 && (combine || rank == 0)) {
+        memcpy(buffer, a, n * elem_size);
+    }
+    for (int d = 1; d < n_images; d *= 2) {
+        if (rank % (2 * d) != 0) break;
+        if (rank + d < n_images) {
+            int child = (rank + d + root) % n_images;
+            _lfortran_caf_wait(child, &images[child].arrived, step);
+            if (combine) combine(buffer, _lfortran_caf_buffer(child, step), n);
+        }
+    }
+    __atomic_store_n(&images[me].arrived, step, __ATOMIC_RELEASE);
+    if (rank == 0) {
+        if (combine && n > 0) memcpy(a, buffer, n * elem_size);
+        __atomic_store_n(&images[me].done, step, __ATOMIC_RELEASE);
+    } else {
+        _lfortran_caf_wait(root, &images[root].done, step);
+        if (copy_out && n > 0) {
+            memcpy(a, _lfortran_caf_buffer(root, step), n * elem_size);
+        }
+    }
+}
+
+static void _lfortran_caf_collective(void *a, int64_t n, int64_t elem_size,
+    _lfortran_caf_combine_fn combine, int32_t image, bool copy_out)
+{
+    if (_lfortran_caf.num_images == 1) return;
+    if (image < 1 || image > _lfortran_caf.num_images) {
+        _lfortran_caf_error("invalid image index", image);
+    }
+    int64_t chunk = LFORTRAN_CAF_BUFFER_SIZE / elem_size;
+    for (int64_t i = 0; i < n; i += chunk) {
+        _lfortran_caf_step((char*) a + i * elem_size, n - i < chunk ? n - i : chunk,
+            elem_size, combine, image - 1, copy_out);
+    }
+}
+
+LFORTRAN_API void _lfortran_caf_sync_all()
+{
+    if (_lfortran_caf.num_images == 1) return;
+    _lfortran_caf_step(NULL, 0, 1, NULL, 0, false);
+}
+
+// n < 0 is `sync images(*)`
+LFORTRAN_API void _lfortran_caf_sync_images(int32_t *images, int64_t n)
+{
+    int n_images = _lfortran_caf.num_images;
+    int me = _lfortran_caf.this_image - 1;
+    int64_t count = n < 0 ? n_images : n;
+    for (int64_t i = 0; i < count; i++) {
+        int32_t image = n < 0 ? (int32_t) i + 1 : images[i];
+        if (image < 1 || image > n_images) {
+            _lfortran_caf_error("invalid image index", image);
+        }
+        if (image - 1 == me) continue;
+        __atomic_add_fetch(&_lfortran_caf.syncs[(size_t) me * n_images + image - 1],
+            1, __ATOMIC_RELEASE);
+    }
+    for (int64_t i = 0; i < count; i++) {
+        int32_t image = n < 0 ? (int32_t) i + 1 : images[i];
+        if (image - 1 == me) continue;
+        _lfortran_caf_wait(image - 1, &_lfortran_caf.syncs[(size_t) (image - 1) * n_images + me],
+            ++_lfortran_caf.synced[image - 1]);
+    }
+}
 
-// This function performs case insensitive string comparison
-bool streql(const char *s1, const char* s2) {
-#if defined(_MSC_VER)
-    return _stricmp(s1, s2) == 0;
 #else
-    return strcasecmp(s1, s2) == 0;
+
+// No processes on this target, the program is a single image
+LFORTRAN_API void _lfortran_caf_init()
+{
+}
+
+LFORTRAN_API void* _lfortran_caf_register(int64_t size)
+{
+    return calloc(1, size > 0 ? size : 1);
+}
+
+static void _lfortran_caf_collective(void *a, int64_t n, int64_t elem_size,
+    _lfortran_caf_combine_fn combine, int32_t image, bool copy_out)
+{
+    if (image != 1) {
+        _lfortran_caf_error("invalid image index", image);
+    }
+}
+
+LFORTRAN_API void _lfortran_caf_sync_all()
+{
+}
+
+LFORTRAN_API void _lfortran_caf_sync_images(int32_t *images, int64_t n)
+{
+    for (int64_t i = 0; i < n; i++) {
+        if (images[i] != 1) {
+            _lfortran_caf_error("invalid image index", images[i]);
+        }
+    }
+}
+
 #endif
+
+LFORTRAN_API int32_t _lfortran_caf_this_image()
+{
+    return _lfortran_caf.this_image;
 }
 
-LFORTRAN_API double _lfortran_sum(int n, double *v)
+LFORTRAN_API int32_t _lfortran_caf_num_images()
 {
-    int i, r;
-    r = 0;
-    for (i=0; i < n; i++) {
-        r += v[i];
+    return _lfortran_caf.num_images;
+}
+
+LFORTRAN_API void* _lfortran_caf_remote(void *local, int32_t image)
+{
+    if (image < 1 || image > _lfortran_caf.num_images) {
+        _lfortran_caf_error("invalid image index", image);
     }
-    return r;
+    return (char*) local + ((int64_t) image - _lfortran_caf.this_image) *
+        (int64_t) _lfortran_caf.heap_size;
+}
+
+// result_image 0 stands for all images
+#define LFORTRAN_CAF_REDUCTION(name, type, combined)                           \
+static void _lfortran_caf_combine_##name(void *acc, const void *x, int64_t n)  \
+{                                                                              \
+    type *a = (type*) acc;                                                     \
+    const type *b = (const type*) x;                                           \
+    for (int64_t i = 0; i < n; i++) {                                          \
+        a[i] = combined;                                                       \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+LFORTRAN_API void _lfortran_caf_##name(type *a, int64_t n, int32_t result_image) \
+{                                                                              \
+    _lfortran_caf_collective(a, n, sizeof(type), _lfortran_caf_combine_##name, \
+        result_image == 0 ? 1 : result_image, result_image == 0);              \
+}
+
+LFORTRAN_CAF_REDUCTION(co_sum_i32, int32_t, a[i] + b[i])
+LFORTRAN_CAF_REDUCTION(co_sum_i64, int64_t, a[i] + b[i])
+LFORTRAN_CAF_REDUCTION(co_sum_r32, float, a[i] + b[i])
+LFORTRAN_CAF_REDUCTION(co_sum_r64, double, a[i] + b[i])
+LFORTRAN_CAF_REDUCTION(co_max_i32, int32_t, a[i] < b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_max_i64, int64_t, a[i] < b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_max_r32, float, a[i] < b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_max_r64, double, a[i] < b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_min_i32, int32_t, a[i] > b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_min_i64, int64_t, a[i] > b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_min_r32, float, a[i] > b[i] ? b[i] : a[i])
+LFORTRAN_CAF_REDUCTION(co_min_r64, double, a[i] > b[i] ? b[i] : a[i])
+
+#undef LFORTRAN_CAF_REDUCTION
+
+LFORTRAN_API void _lfortran_caf_co_broadcast(void *a, int64_t size, int32_t source_image)
+{
+    _lfortran_caf_collective(a, size, 1, NULL, source_image, true);
+}
+
+// << Coarrays << -------------------------------------------------------------
+
+// Random numbers --------------------------------------------------------------
+
+/*
+ * libc's rand() keeps one hidden state that every thread races on. Instead
+ * each thread runs its own splitmix64 generator. Seeding only publishes the
+ * seed together with a generation count in one 64-bit word; a thread that
+ * sees a new word re-derives its state from the seed and its stream number,
+ * so concurrent threads draw from distinct sequences and a single-threaded
+ * program still gets a repeatable sequence for a given seed.
+ */
+
+// (generation << 32) | seed, generation 0 with seed 1 like an unseeded rand()
+static int64_t _lfortran_rng_seed_word = 1;
+static int32_t _lfortran_rng_streams = 0;
+
+struct lfortran_rng {
+    uint64_t state;
+    int64_t word;
+    uint64_t stream;
+};
+
+static LFORTRAN_THREAD_LOCAL struct lfortran_rng _lfortran_rng;
+
+static inline uint64_t _lfortran_rng_mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static void _lfortran_rng_seed(unsigned seed)
+{
+    int64_t old_word, new_word;
+    do {
+        old_word = _lfortran_load64(&_lfortran_rng_seed_word);
+        new_word = (int64_t)((((uint64_t) old_word >> 32) + 1) << 32 | seed);
+    } while (!_lfortran_cas64(&_lfortran_rng_seed_word, old_word, new_word));
+}
+
+static uint64_t _lfortran_rng_next()
+{
+    struct lfortran_rng *rng = &_lfortran_rng;
+    int64_t word = _lfortran_load64(&_lfortran_rng_seed_word);
+    if (rng->word != word) {
+        if (rng->stream == 0) {
+            int32_t n;
+            do {
+                n = _lfortran_load32(&_lfortran_rng_streams);
+            } while (!_lfortran_cas32(&_lfortran_rng_streams, n, n + 1));
+            rng->stream = (uint64_t) n + 1;
+        }
+        rng->state = (uint32_t) word ^ _lfortran_rng_mix(rng->stream);
+        rng->word = word;
+    }
+    rng->state += 0x9e3779b97f4a7c15ull;
+    return _lfortran_rng_mix(rng->state);
+}
+
+// Same range as rand(): [0, 2^31 - 1]
+static inline int32_t _lfortran_rng_int31()
+{
+    return (int32_t)(_lfortran_rng_next() >> 33);
+}
+
+// [0, 1)
+static inline double _lfortran_rng_double()
+{
+    return (double)(_lfortran_rng_next() >> 11) * 0x1.0p-53;
+}
+
+static inline float _lfortran_rng_float()
+{
+    return (float)(_lfortran_rng_next() >> 40) * 0x1.0p-24f;
 }
 
 LFORTRAN_API void _lfortran_random_number(int n, double *v)
 {
     int i;
     for (i=0; i < n; i++) {
-        v[i] = rand() / (double) RAND_MAX;
+        v[i] = _lfortran_rng_double();
     }
 }
 
 LFORTRAN_API int _lfortran_init_random_seed(unsigned seed)
 {
-    srand(seed);
+    _lfortran_rng_seed(seed);
     return seed;
 }
 
@@ -137,23 +1862,24 @@ LFORTRAN_API void _lfortran_init_random_clock()
         count = (unsigned int)clock();
     }
 #endif
-    srand(count);
+    // images started at the same time still get different numbers
+    _lfortran_rng_seed(count + 2654435761u * (unsigned int)(_lfortran_caf.this_image - 1));
 }
 
 LFORTRAN_API double _lfortran_random()
 {
-    return (rand() / (double) RAND_MAX);
+    return _lfortran_rng_double();
 }
 
 LFORTRAN_API int _lfortran_randrange(int lower, int upper)
 {
-    int rr = lower + (rand() % (upper - lower));
+    int rr = lower + (_lfortran_rng_int31() % (upper - lower));
     return rr;
 }
 
 LFORTRAN_API int _lfortran_random_int(int lower, int upper)
 {
-    int randint = lower + (rand() % (upper - lower + 1));
+    int randint = lower + (_lfortran_rng_int31() % (upper - lower + 1));
     return randint;
 }
 
@@ -2487,8 +4213,110 @@ LFORTRAN_API void _lfortran_memset(void* s, int32_t c, int32_t size) {
     memset(s, c, size);
 }
 
+/*
+ * Per-thread cache of freed heap blocks.
+ *
+ * Array temporaries are allocated and freed with the same size in every
+ * iteration of a loop. Large blocks are served by mmap and munmap in most
+ * malloc implementations, so each iteration pays for the system calls and
+ * the page faults of touching the fresh pages again. _lfortran_free keeps
+ * up to LFORTRAN_ALLOC_CACHE_DEPTH blocks of every power of two size class
+ * per thread instead, and _lfortran_malloc hands them out again. The blocks
+ * are ordinary malloc blocks, so memory from either function may still be
+ * passed to free and realloc. Small blocks are left to malloc, which caches
+ * them itself, and a thread caches at most LFORTRAN_ALLOC_CACHE_MAX_BYTES.
+ * The blocks of a thread are freed when it exits.
+ */
+#if defined(__GLIBC__) || defined(__EMSCRIPTEN__)
+#  include <malloc.h>
+#  define lfortran_usable_size(ptr) malloc_usable_size(ptr)
+#elif defined(__APPLE__)
+#  include <malloc/malloc.h>
+#  define lfortran_usable_size(ptr) malloc_size(ptr)
+#elif defined(_WIN32)
+#  include <malloc.h>
+#  define lfortran_usable_size(ptr) _msize(ptr)
+#endif
+
+#if defined(lfortran_usable_size)
+#define LFORTRAN_ALLOC_CACHE_MIN_BLOCK (16 * 1024)
+#define LFORTRAN_ALLOC_CACHE_MAX_BLOCK (64 * 1024 * 1024)
+#define LFORTRAN_ALLOC_CACHE_MAX_BYTES (128 * 1024 * 1024)
+#define LFORTRAN_ALLOC_CACHE_CLASSES 32
+#define LFORTRAN_ALLOC_CACHE_DEPTH 4
+
+struct lfortran_alloc_cache {
+    void* blocks[LFORTRAN_ALLOC_CACHE_CLASSES][LFORTRAN_ALLOC_CACHE_DEPTH];
+    size_t sizes[LFORTRAN_ALLOC_CACHE_CLASSES][LFORTRAN_ALLOC_CACHE_DEPTH];
+    int count[LFORTRAN_ALLOC_CACHE_CLASSES];
+    size_t bytes;
+};
+
+static LFORTRAN_THREAD_LOCAL struct lfortran_alloc_cache _lfortran_alloc_cache;
+
+#if defined(LFORTRAN_HAVE_THREADS)
+// Its destructor drains the cache of an exiting thread, it is set to the
+// cache of a thread whenever the cache stops being empty
+static pthread_key_t _lfortran_alloc_cache_key;
+static pthread_once_t _lfortran_alloc_cache_key_once = PTHREAD_ONCE_INIT;
+
+static void _lfortran_alloc_cache_drain(void* arg) {
+    struct lfortran_alloc_cache* cache = (struct lfortran_alloc_cache*) arg;
+    for (int c = 0; c < LFORTRAN_ALLOC_CACHE_CLASSES; c++) {
+        for (int i = 0; i < cache->count[c]; i++) {
+            free(cache->blocks[c][i]);
+        }
+        cache->count[c] = 0;
+    }
+    cache->bytes = 0;
+}
+
+static void _lfortran_alloc_cache_key_create(void) {
+    pthread_key_create(&_lfortran_alloc_cache_key, _lfortran_alloc_cache_drain);
+}
+#endif
+
+static int _lfortran_alloc_cache_class(size_t size) {
+    int c = 0;
+    while (size >>= 1) c++;
+    return c;
+}
+
+static void* _lfortran_alloc_cache_take(int c, size_t size) {
+    struct lfortran_alloc_cache* cache = &_lfortran_alloc_cache;
+    for (int i = cache->count[c] - 1; i >= 0; i--) {
+        if (cache->sizes[c][i] >= size) {
+            void* ptr = cache->blocks[c][i];
+            cache->bytes -= cache->sizes[c][i];
+            cache->count[c]--;
+            cache->blocks[c][i] = cache->blocks[c][cache->count[c]];
+            cache->sizes[c][i] = cache->sizes[c][cache->count[c]];
+            return ptr;
+        }
+    }
+    return NULL;
+}
+#endif
+
 LFORTRAN_API void* _lfortran_malloc(int32_t size) {
-    return malloc(size);
+#if defined(lfortran_usable_size)
+    if (size >= LFORTRAN_ALLOC_CACHE_MIN_BLOCK &&
+            size <= LFORTRAN_ALLOC_CACHE_MAX_BLOCK) {
+        // Blocks of the next class are always large enough, those of the
+        // same class only if they are at least `size` bytes
+        int c = _lfortran_alloc_cache_class(size);
+        void* ptr = _lfortran_alloc_cache_take(c, size);
+        if (ptr == NULL && c + 1 < LFORTRAN_ALLOC_CACHE_CLASSES) {
+            ptr = _lfortran_alloc_cache_take(c + 1, size);
+        }
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+#endif
+    void* ptr = malloc(size);
+    _lfortran_first_touch(ptr, size);
+    return ptr;
 }
 
 LFORTRAN_API int8_t* _lfortran_realloc(int8_t* ptr, int32_t size) {
@@ -2496,10 +4324,38 @@ LFORTRAN_API int8_t* _lfortran_realloc(int8_t* ptr, int32_t size) {
 }
 
 LFORTRAN_API int8_t* _lfortran_calloc(int32_t count, int32_t size) {
-    return (int8_t*) calloc(count, size);
+    int8_t* ptr = (int8_t*) calloc(count, size);
+    _lfortran_first_touch(ptr, (size_t) count * size);
+    return ptr;
 }
 
 LFORTRAN_API void _lfortran_free(char* ptr) {
+    _lfortran_numa_release(ptr);
+#if defined(lfortran_usable_size)
+    if (ptr != NULL) {
+        struct lfortran_alloc_cache* cache = &_lfortran_alloc_cache;
+        size_t size = lfortran_usable_size(ptr);
+        if (size >= LFORTRAN_ALLOC_CACHE_MIN_BLOCK &&
+                size <= LFORTRAN_ALLOC_CACHE_MAX_BLOCK &&
+                cache->bytes + size <= LFORTRAN_ALLOC_CACHE_MAX_BYTES) {
+            int c = _lfortran_alloc_cache_class(size);
+            if (cache->count[c] < LFORTRAN_ALLOC_CACHE_DEPTH) {
+#if defined(LFORTRAN_HAVE_THREADS)
+                if (cache->bytes == 0) {
+                    pthread_once(&_lfortran_alloc_cache_key_once,
+                        _lfortran_alloc_cache_key_create);
+                    pthread_setspecific(_lfortran_alloc_cache_key, cache);
+                }
+#endif
+                cache->blocks[c][cache->count[c]] = ptr;
+                cache->sizes[c][cache->count[c]] = size;
+                cache->count[c]++;
+                cache->bytes += size;
+                return;
+            }
+        }
+    }
+#endif
     free((void*)ptr);
 }
 
@@ -2695,7 +4551,8 @@ LFORTRAN_API char* _lfortran_zone() {
 #elif defined(__APPLE__) && !defined(__aarch64__)
     // For non-ARM-based Apple platforms
     time_t t = time(NULL);
-    struct tm* ptm = localtime(&t);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&t, &tm_buf);
 
     // The tm_gmtoff field holds the time zone offset in seconds
     long offset_seconds = ptm->tm_gmtoff;
@@ -2704,7 +4561,8 @@ LFORTRAN_API char* _lfortran_zone() {
 #else
     // For Linux and other platforms
     time_t t = time(NULL);
-    struct tm* ptm = localtime(&t);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&t, &tm_buf);
 
     // The tm_gmtoff field holds the time zone offset in seconds
     long offset_seconds = ptm->tm_gmtoff;
@@ -2732,14 +4590,16 @@ LFORTRAN_API char* _lfortran_time() {
     // For non-ARM-based Apple platforms, use current time functions
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    struct tm* ptm = localtime(&tv.tv_sec);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&tv.tv_sec, &tm_buf);
     int milliseconds = tv.tv_usec / 1000;
     sprintf(result, "%02d%02d%02d.%03d", ptm->tm_hour, ptm->tm_min, ptm->tm_sec, milliseconds);
 #else
     // For Linux and other platforms
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
-    struct tm* ptm = localtime(&ts.tv_sec);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&ts.tv_sec, &tm_buf);
     int milliseconds = ts.tv_nsec / 1000000;
     sprintf(result, "%02d%02d%02d.%03d", ptm->tm_hour, ptm->tm_min, ptm->tm_sec, milliseconds);
 #endif
@@ -2761,12 +4621,14 @@ LFORTRAN_API char* _lfortran_date() {
 #elif defined(__APPLE__) && !defined(__aarch64__)
     // For non-ARM-based Apple platforms
     time_t t = time(NULL);
-    struct tm* ptm = localtime(&t);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&t, &tm_buf);
     sprintf(result, "%04d%02d%02d", ptm->tm_year + 1900, ptm->tm_mon + 1, ptm->tm_mday);
 #else
     // For Linux and other platforms
     time_t t = time(NULL);
-    struct tm* ptm = localtime(&t);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&t, &tm_buf);
     snprintf(result, 32, "%04d%02d%02d", ptm->tm_year + 1900, ptm->tm_mon + 1, ptm->tm_mday);
 #endif
 
@@ -2790,7 +4652,8 @@ LFORTRAN_API int32_t _lfortran_values(int32_t n)
     // For non-ARM-based Apple platforms
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    struct tm* ptm = localtime(&tv.tv_sec);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&tv.tv_sec, &tm_buf);
     int milliseconds = tv.tv_usec / 1000;
     if (n == 1) result = ptm->tm_year + 1900;
     else if (n == 2) result = ptm->tm_mon + 1;
@@ -2803,7 +4666,8 @@ LFORTRAN_API int32_t _lfortran_values(int32_t n)
 #else
     // For Linux and other platforms
     time_t t = time(NULL);
-    struct tm* ptm = localtime(&t);
+    struct tm tm_buf;
+    struct tm* ptm = localtime_r(&t, &tm_buf);
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
     if (n == 1) result = ptm->tm_year + 1900;
@@ -2819,33 +4683,32 @@ LFORTRAN_API int32_t _lfortran_values(int32_t n)
 }
 
 LFORTRAN_API float _lfortran_sp_rand_num() {
-    return rand() / (float) RAND_MAX;
+    return _lfortran_rng_float();
 }
 
 LFORTRAN_API double _lfortran_dp_rand_num() {
-    return rand() / (double) RAND_MAX;
+    return _lfortran_rng_double();
 }
 
 LFORTRAN_API int32_t _lfortran_int32_rand_num() {
-    return rand();
+    return _lfortran_rng_int31();
 }
 
 LFORTRAN_API int64_t _lfortran_int64_rand_num() {
-    return rand();
+    return _lfortran_rng_int31();
 }
 
-LFORTRAN_API bool _lfortran_random_init(bool repeatable, bool image_distinct) {
-    if (repeatable) {
-            srand(0);
-    } else {
-        srand(time(NULL));
+LFORTRAN_API void _lfortran_random_init(bool repeatable, bool image_distinct) {
+    unsigned int seed = repeatable ? 0 : (unsigned int)time(NULL);
+    if (image_distinct) {
+        seed += 2654435761u * (unsigned int)(_lfortran_caf.this_image - 1);
     }
-    return false;
+    _lfortran_rng_seed(seed);
 }
 
 LFORTRAN_API int64_t _lfortran_random_seed(unsigned seed)
 {
-    srand(seed);
+    _lfortran_rng_seed(seed);
     // The seed array size is typically 8 elements because Fortran's RNG often uses a seed with a fixed length of 8 integers to ensure sufficient randomness and repeatability in generating sequences of random numbers.
     return 8;
 
@@ -2877,7 +4740,29 @@ int32_t last_index_used = -1;
 
 struct UNIT_FILE unit_to_file[MAXUNITS];
 
+/*
+ * `unit_to_file` is guarded by one lock that is only held while the table is
+ * searched or changed, never during a transfer. A transfer that takes several
+ * stdio calls holds the lock of its own unit instead, which is the lock of the
+ * FILE stream, so threads writing to different units never wait on each other
+ * and the records of one unit are not interleaved.
+ */
+#ifdef LFORTRAN_HAVE_THREADS
+static pthread_mutex_t _lfortran_units_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline void _lfortran_lock_units() { pthread_mutex_lock(&_lfortran_units_mutex); }
+static inline void _lfortran_unlock_units() { pthread_mutex_unlock(&_lfortran_units_mutex); }
+static inline void _lfortran_lock_unit(FILE *filep) { flockfile(filep); }
+static inline void _lfortran_unlock_unit(FILE *filep) { funlockfile(filep); }
+#else
+static inline void _lfortran_lock_units() {}
+static inline void _lfortran_unlock_units() {}
+static inline void _lfortran_lock_unit(FILE *filep) { (void) filep; }
+static inline void _lfortran_unlock_unit(FILE *filep) { (void) filep; }
+#endif
+
 void store_unit_file(int32_t unit_num, char* filename, FILE* filep, bool unit_file_bin) {
+    _lfortran_lock_units();
     for( int i = 0; i <= last_index_used; i++ ) {
         if( unit_to_file[i].unit == unit_num ) {
             unit_to_file[i].unit = unit_num;
@@ -2894,32 +4779,42 @@ void store_unit_file(int32_t unit_num, char* filename, FILE* filep, bool unit_fi
     unit_to_file[last_index_used].filename = filename;
     unit_to_file[last_index_used].filep = filep;
     unit_to_file[last_index_used].unit_file_bin = unit_file_bin;
+    _lfortran_unlock_units();
 }
 
 FILE* get_file_pointer_from_unit(int32_t unit_num, bool *unit_file_bin) {
+    FILE* filep = NULL;
     *unit_file_bin = false;
+    _lfortran_lock_units();
     for( int i = 0; i <= last_index_used; i++ ) {
         if( unit_to_file[i].unit == unit_num ) {
             *unit_file_bin = unit_to_file[i].unit_file_bin;
-            return unit_to_file[i].filep;
+            filep = unit_to_file[i].filep;
+            break;
         }
     }
-    return NULL;
+    _lfortran_unlock_units();
+    return filep;
 }
 
 char* get_file_name_from_unit(int32_t unit_num, bool *unit_file_bin) {
+    char* filename = NULL;
     *unit_file_bin = false;
+    _lfortran_lock_units();
     for (int i = 0; i <= last_index_used; i++) {
         if (unit_to_file[i].unit == unit_num) {
             *unit_file_bin = unit_to_file[i].unit_file_bin;
-            return unit_to_file[i].filename;
+            filename = unit_to_file[i].filename;
+            break;
         }
     }
-    return NULL;
+    _lfortran_unlock_units();
+    return filename;
 }
 
 void remove_from_unit_to_file(int32_t unit_num) {
     int index = -1;
+    _lfortran_lock_units();
     for( int i = 0; i <= last_index_used; i++ ) {
         if( unit_to_file[i].unit == unit_num ) {
             index = i;
@@ -2927,6 +4822,7 @@ void remove_from_unit_to_file(int32_t unit_num) {
         }
     }
     if( index == -1 ) {
+        _lfortran_unlock_units();
         return ;
     }
     for( int i = index; i < last_index_used; i++ ) {
@@ -2936,6 +4832,7 @@ void remove_from_unit_to_file(int32_t unit_num) {
         unit_to_file[i].unit_file_bin = unit_to_file[i + 1].unit_file_bin;
     }
     last_index_used -= 1;
+    _lfortran_unlock_units();
 }
 
 LFORTRAN_API int64_t _lfortran_open(int32_t unit_num, char *f_name, char *status, char *form)
@@ -3033,11 +4930,13 @@ LFORTRAN_API void _lfortran_flush(int32_t unit_num)
 {
     // special case: flush all open units
     if (unit_num == -1) {
+        _lfortran_lock_units();
         for (int i = 0; i <= last_index_used; i++) {
             if (unit_to_file[i].filep != NULL) {
                 fflush(unit_to_file[i].filep);
             }
         }
+        _lfortran_unlock_units();
     } else {
         bool unit_file_bin;
         FILE* filep = get_file_pointer_from_unit(unit_num, &unit_file_bin);
@@ -3110,6 +5009,7 @@ LFORTRAN_API void _lfortran_backspace(int32_t unit_num)
             unit_num);
         exit(1);
     }
+    _lfortran_lock_unit(fd);
     int n = ftell(fd);
     for(int i = n; i >= 0; i --) {
         char c = fgetc(fd);
@@ -3123,6 +5023,7 @@ LFORTRAN_API void _lfortran_backspace(int32_t unit_num)
             fseek(fd, -2, SEEK_CUR);
         }
     }
+    _lfortran_unlock_unit(fd);
 }
 
 LFORTRAN_API void _lfortran_read_int32(int32_t *p, int32_t unit_num)
@@ -3173,9 +5074,11 @@ LFORTRAN_API void _lfortran_read_array_int8(int8_t *p, int array_size, int32_t u
 {
     if (unit_num == -1) {
         // Read from stdin
+        _lfortran_lock_unit(stdin);
         for (int i = 0; i < array_size; i++) {
             (void)!scanf("%s", &p[i]);
         }
+        _lfortran_unlock_unit(stdin);
         return;
     }
 
@@ -3189,9 +5092,11 @@ LFORTRAN_API void _lfortran_read_array_int8(int8_t *p, int array_size, int32_t u
     if (unit_file_bin) {
         (void)!fread(p, sizeof(int8_t), array_size, filep);
     } else {
+        _lfortran_lock_unit(filep);
         for (int i = 0; i < array_size; i++) {
             (void)!fscanf(filep, "%s", &p[i]);
         }
+        _lfortran_unlock_unit(filep);
     }
 }
 
@@ -3199,9 +5104,11 @@ LFORTRAN_API void _lfortran_read_array_int32(int32_t *p, int array_size, int32_t
 {
     if (unit_num == -1) {
         // Read from stdin
+        _lfortran_lock_unit(stdin);
         for (int i = 0; i < array_size; i++) {
             (void)!scanf("%d", &p[i]);
         }
+        _lfortran_unlock_unit(stdin);
         return;
     }
 
@@ -3215,9 +5122,11 @@ LFORTRAN_API void _lfortran_read_array_int32(int32_t *p, int array_size, int32_t
     if (unit_file_bin) {
         (void)!fread(p, sizeof(int32_t), array_size, filep);
     } else {
+        _lfortran_lock_unit(filep);
         for (int i = 0; i < array_size; i++) {
             (void)!fscanf(filep, "%d", &p[i]);
         }
+        _lfortran_unlock_unit(filep);
     }
 }
 
@@ -3247,6 +5156,7 @@ LFORTRAN_API void _lfortran_read_char(char **p, int32_t unit_num)
     }
 
     if (unit_file_bin) {
+        _lfortran_lock_unit(filep);
         // read the record marker for data length
         int32_t data_length;
         if (fread(&data_length, sizeof(int32_t), 1, filep) != 1) {
@@ -3283,6 +5193,7 @@ LFORTRAN_API void _lfortran_read_char(char **p, int32_t unit_num)
             free(*p);
             exit(1);
         }
+        _lfortran_unlock_unit(filep);
     } else {
         char *tmp_buffer = (char*)malloc((n + 1) * sizeof(char));
         (void)!fscanf(filep, "%s", tmp_buffer);
@@ -3327,9 +5238,11 @@ LFORTRAN_API void _lfortran_read_array_float(float *p, int array_size, int32_t u
 {
     if (unit_num == -1) {
         // Read from stdin
+        _lfortran_lock_unit(stdin);
         for (int i = 0; i < array_size; i++) {
             (void)!scanf("%f", &p[i]);
         }
+        _lfortran_unlock_unit(stdin);
         return;
     }
 
@@ -3343,9 +5256,11 @@ LFORTRAN_API void _lfortran_read_array_float(float *p, int array_size, int32_t u
     if (unit_file_bin) {
         (void)!fread(p, sizeof(float), array_size, filep);
     } else {
+        _lfortran_lock_unit(filep);
         for (int i = 0; i < array_size; i++) {
             (void)!fscanf(filep, "%f", &p[i]);
         }
+        _lfortran_unlock_unit(filep);
     }
 }
 
@@ -3353,9 +5268,11 @@ LFORTRAN_API void _lfortran_read_array_double(double *p, int array_size, int32_t
 {
     if (unit_num == -1) {
         // Read from stdin
+        _lfortran_lock_unit(stdin);
         for (int i = 0; i < array_size; i++) {
             (void)!scanf("%lf", &p[i]);
         }
+        _lfortran_unlock_unit(stdin);
         return;
     }
 
@@ -3369,9 +5286,11 @@ LFORTRAN_API void _lfortran_read_array_double(double *p, int array_size, int32_t
     if (unit_file_bin) {
         (void)!fread(p, sizeof(double), array_size, filep);
     } else {
+        _lfortran_lock_unit(filep);
         for (int i = 0; i < array_size; i++) {
             (void)!fscanf(filep, "%lf", &p[i]);
         }
+        _lfortran_unlock_unit(filep);
     }
 }
 
@@ -3382,6 +5301,7 @@ LFORTRAN_API void _lfortran_read_array_char(char **p, int array_size, int32_t un
     const char SPACE = ' ';
     if (unit_num == -1) {
         // Read from stdin
+        _lfortran_lock_unit(stdin);
         for (int i = 0; i < array_size; i++) {
             p[i] = (char*) malloc((n + 1) * sizeof(char));
             char *tmp_buffer = (char*)malloc((n + 1) * sizeof(char));
@@ -3395,6 +5315,7 @@ LFORTRAN_API void _lfortran_read_array_char(char **p, int array_size, int32_t un
             }
             p[i][n] = '\0';
         }
+        _lfortran_unlock_unit(stdin);
         return;
     }
 
@@ -3405,6 +5326,7 @@ LFORTRAN_API void _lfortran_read_array_char(char **p, int array_size, int32_t un
         exit(1);
     }
 
+    _lfortran_lock_unit(filep);
     for (int i = 0; i < array_size; i++) {
         p[i] = (char*) malloc((n + 1) * sizeof(char));
         if (unit_file_bin) {
@@ -3423,6 +5345,7 @@ LFORTRAN_API void _lfortran_read_array_char(char **p, int array_size, int32_t un
             p[i][n] = '\0';
         }
     }
+    _lfortran_unlock_unit(filep);
 }
 
 LFORTRAN_API void _lfortran_read_double(double *p, int32_t unit_num)
@@ -3541,6 +5464,7 @@ LFORTRAN_API void _lfortran_empty_read(int32_t unit_num, int32_t* iostat) {
     }
 
     if (!unit_file_bin) {
+        _lfortran_lock_unit(fp);
         // The contents of `c` are ignored
         char c = fgetc(fp);
         while (c != '\n' && c != EOF) {
@@ -3554,6 +5478,7 @@ LFORTRAN_API void _lfortran_empty_read(int32_t unit_num, int32_t* iostat) {
         } else {
             *iostat = 0;
         }
+        _lfortran_unlock_unit(fp);
     }
 }
 
@@ -3591,6 +5516,8 @@ LFORTRAN_API void _lfortran_file_write(int32_t unit_num, int32_t* iostat, const
             return;
         }
     }
+    // One record per call, also when several threads write to this unit
+    _lfortran_lock_unit(filep);
     if (unit_file_bin) {
         // size the size of `str_len` to bytes
         size_t str_len = strlen(str);
@@ -3628,6 +5555,7 @@ LFORTRAN_API void _lfortran_file_write(int32_t unit_num, int32_t* iostat, const
     }
     va_end(args);
     (void)!ftruncate(fileno(filep), ftell(filep));
+    _lfortran_unlock_unit(filep);
 }
 
 LFORTRAN_API void _lfortran_string_write(char **str_holder, int64_t* size, int64_t* capacity, int32_t* iostat, const char *format, ...) {
@@ -3785,7 +5713,8 @@ LFORTRAN_API int32_t _lfortran_iachar(char *c) {
     return (int32_t) (uint8_t)(c[0]);
 }
 
-// Command line arguments
+// Command line arguments, set by `_lpython_call_initial_functions` before any
+// user code runs and only read afterwards, so threads can share them freely
 int32_t _argc;
 char **_argv;
 
@@ -3866,6 +5795,7 @@ LFORTRAN_API int32_t _lfortran_get_command_status() {
 // Initial setup
 LFORTRAN_API void _lpython_call_initial_functions(int32_t argc_1, char *argv_1[]) {
     _lpython_set_argv(argc_1, argv_1);
+    _lfortran_caf_init();
     _lfortran_init_random_clock();
 }
 
@@ -69,6 +69,7 @@ LFORTRAN_API double _lfortran_sum(int n, double *v);
 LFORTRAN_API void _lfortran_random_number(int n, double *v);
 LFORTRAN_API void _lfortran_init_random_clock();
 LFORTRAN_API int _lfortran_init_random_seed(unsigned seed);
+LFORTRAN_API void _lfortran_random_init(bool repeatable, bool image_distinct);
 LFORTRAN_API double _lfortran_random();
 LFORTRAN_API int _lfortran_randrange(int lower, int upper);
 LFORTRAN_API int _lfortran_random_int(int lower, int upper);
@@ -279,6 +280,86 @@ LFORTRAN_API int _lfortran_exec_command(char *cmd);
 
 LFORTRAN_API char* _lcompilers_string_format_fortran(int count, const char* format, ...);
 
+// Lock-free combine of OpenMP reduction partials: *x = *x <op> v
+LFORTRAN_API void _lfortran_atomic_add_i32(int32_t *x, int32_t v);
+LFORTRAN_API void _lfortran_atomic_add_i64(int64_t *x, int64_t v);
+LFORTRAN_API void _lfortran_atomic_add_r32(float *x, float v);
+LFORTRAN_API void _lfortran_atomic_add_r64(double *x, double v);
+LFORTRAN_API void _lfortran_atomic_mul_i32(int32_t *x, int32_t v);
+LFORTRAN_API void _lfortran_atomic_mul_i64(int64_t *x, int64_t v);
+LFORTRAN_API void _lfortran_atomic_mul_r32(float *x, float v);
+LFORTRAN_API void _lfortran_atomic_mul_r64(double *x, double v);
+LFORTRAN_API void _lfortran_atomic_max_i32(int32_t *x, int32_t v);
+LFORTRAN_API void _lfortran_atomic_max_i64(int64_t *x, int64_t v);
+LFORTRAN_API void _lfortran_atomic_max_r32(float *x, float v);
+LFORTRAN_API void _lfortran_atomic_max_r64(double *x, double v);
+LFORTRAN_API void _lfortran_atomic_min_i32(int32_t *x, int32_t v);
+LFORTRAN_API void _lfortran_atomic_min_i64(int64_t *x, int64_t v);
+LFORTRAN_API void _lfortran_atomic_min_r32(float *x, float v);
+LFORTRAN_API void _lfortran_atomic_min_r64(double *x, double v);
+
+// Runs fn(data, lo, hi) over the ranges of [0, n) on the runtime thread pool
+typedef void (*_lfortran_range_fn)(void *data, int64_t lo, int64_t hi);
+LFORTRAN_API void _lfortran_parallel_for(_lfortran_range_fn fn, void *data,
+    int64_t n, int64_t grain);
+LFORTRAN_API void _lfortran_pool_lock();
+LFORTRAN_API void _lfortran_pool_unlock();
+
+// Explicit tasks, fn receives a copy of the `size` bytes at data
+typedef void (*_lfortran_task_fn)(void *data);
+LFORTRAN_API void _lfortran_task_spawn(_lfortran_task_fn fn, void *data,
+    int64_t size);
+LFORTRAN_API void _lfortran_taskwait();
+LFORTRAN_API void _lfortran_taskgroup_start();
+LFORTRAN_API void _lfortran_taskgroup_end();
+
+// Prints the NUMA report of --numa-report when the program exits
+LFORTRAN_API void _lfortran_numa_report_enable();
+
+// Whole array reductions of a contiguous a[0:n], split over the thread pool
+// if parallel is true and the array is large
+LFORTRAN_API int32_t _lfortran_sum_i32(const int32_t *a, int64_t n, bool parallel);
+LFORTRAN_API int64_t _lfortran_sum_i64(const int64_t *a, int64_t n, bool parallel);
+LFORTRAN_API float _lfortran_sum_r32(const float *a, int64_t n, bool parallel);
+LFORTRAN_API double _lfortran_sum_r64(const double *a, int64_t n, bool parallel);
+LFORTRAN_API int32_t _lfortran_product_i32(const int32_t *a, int64_t n, bool parallel);
+LFORTRAN_API int64_t _lfortran_product_i64(const int64_t *a, int64_t n, bool parallel);
+LFORTRAN_API float _lfortran_product_r32(const float *a, int64_t n, bool parallel);
+LFORTRAN_API double _lfortran_product_r64(const double *a, int64_t n, bool parallel);
+LFORTRAN_API int32_t _lfortran_maxval_i32(const int32_t *a, int64_t n, bool parallel);
+LFORTRAN_API int64_t _lfortran_maxval_i64(const int64_t *a, int64_t n, bool parallel);
+LFORTRAN_API float _lfortran_maxval_r32(const float *a, int64_t n, bool parallel);
+LFORTRAN_API double _lfortran_maxval_r64(const double *a, int64_t n, bool parallel);
+LFORTRAN_API int32_t _lfortran_minval_i32(const int32_t *a, int64_t n, bool parallel);
+LFORTRAN_API int64_t _lfortran_minval_i64(const int64_t *a, int64_t n, bool parallel);
+LFORTRAN_API float _lfortran_minval_r32(const float *a, int64_t n, bool parallel);
+LFORTRAN_API double _lfortran_minval_r64(const double *a, int64_t n, bool parallel);
+LFORTRAN_API int64_t _lfortran_count(const bool *a, int64_t n, bool parallel);
+LFORTRAN_API bool _lfortran_any(const bool *a, int64_t n, bool parallel);
+LFORTRAN_API bool _lfortran_all(const bool *a, int64_t n, bool parallel);
+
+// Coarray images, LFORTRAN_NUM_IMAGES sets their number
+LFORTRAN_API void _lfortran_caf_init();
+LFORTRAN_API int32_t _lfortran_caf_this_image();
+LFORTRAN_API int32_t _lfortran_caf_num_images();
+LFORTRAN_API void* _lfortran_caf_register(int64_t size);
+LFORTRAN_API void* _lfortran_caf_remote(void *local, int32_t image);
+LFORTRAN_API void _lfortran_caf_sync_all();
+LFORTRAN_API void _lfortran_caf_sync_images(int32_t *images, int64_t n);
+LFORTRAN_API void _lfortran_caf_co_sum_i32(int32_t *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_sum_i64(int64_t *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_sum_r32(float *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_sum_r64(double *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_max_i32(int32_t *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_max_i64(int64_t *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_max_r32(float *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_max_r64(double *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_min_i32(int32_t *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_min_i64(int64_t *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_min_r32(float *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_min_r64(double *a, int64_t n, int32_t result_image);
+LFORTRAN_API void _lfortran_caf_co_broadcast(void *a, int64_t size, int32_t source_image);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,7 @@
 #ifndef LFORTRAN_STRING_UTILS_H
 #define LFORTRAN_STRING_UTILS_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <cctype>
@@ -51,6 +52,15 @@ char* str_unescape_fortran(Allocator &al, LCompilers::Str &s, char ch);
 bool str_compare(const unsigned char *pos, std::string s);
 void rtrim(std::string& str);
 
+// Returns the 64-bit FNV-1a hash of `s`, which (unlike std::hash) is stable
+// across runs and platforms and can be used in file names of on-disk caches
+uint64_t fnv1a_hash(const std::string &s);
+// Returns the hash as a string of 16 hexadecimal digits
+std::string fnv1a_hash_hex(const std::string &s);
+// Returns the SHA-256 digest of `s` as a string of 64 hexadecimal digits,
+// for content hashes that must not collide
+std::string sha256_hex(const std::string &s);
+
 } // namespace LCompilers
 
 #endif // LFORTRAN_STRING_UTILS_H
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 #include <filesystem>
 #include <libasr/containers.h>
 
@@ -24,6 +25,10 @@ std::string get_unique_ID();
 int visualize_json(std::string &astr_data_json, LCompilers::Platform os);
 std::string generate_visualize_html(std::string &astr_data_json);
 
+namespace diag {
+    struct Diagnostics;
+}
+
 struct PassOptions {
     std::filesystem::path mod_files_dir;
     std::vector<std::filesystem::path> include_dirs;
@@ -44,7 +49,15 @@ struct PassOptions {
     bool disable_main = false;
     bool use_loop_variable_after_loop = false;
     bool realloc_lhs = false;
+    bool stack_arrays = false; // Allocate every automatic array on the stack
+    int64_t stack_arrays_limit = 65536; // Bytes of an automatic array on the stack with --fast
+    bool array_storage_report = false; // For promote_allocatable_to_nonallocatable pass
+    int64_t tile_size = 0; // Iterations per tile in loop_interchange pass, 0 disables tiling
+    bool loop_transform_report = false; // For loop_interchange pass
+    diag::Diagnostics* diagnostics = nullptr; // Where passes add the notes of their reports, set by the PassManager
+    std::vector<std::pair<std::string, std::string>>* loaded_mod_files = nullptr; // (path, SHA-256) of the .mod files read by find_and_load_module, set for the compilation cache
     std::vector<int64_t> skip_optimization_func_instantiation;
+    bool select_case_to_switch = false; // Backend lowers select case with constant integer labels to a switch
     bool module_name_mangling = false;
     bool global_symbols_mangling = false;
     bool intrinsic_symbols_mangling = false;
@@ -59,6 +72,8 @@ struct PassOptions {
     bool with_intrinsic_mods = false;
     bool c_mangling = false;
     bool openmp = false;
+    bool auto_parallel = false;
+    bool parallel_intrinsics = false;
     bool enable_gpu_offloading = false;
 };
 
@@ -84,6 +99,7 @@ struct CompilerOptions {
     bool fast = false;
     bool openmp = false;
     std::string openmp_lib_dir = "";
+    bool numa_report = false;
     bool lookup_name = false;
     bool rename_symbol = false;
     std::string line = "";
@@ -105,6 +121,7 @@ struct CompilerOptions {
     bool rtlib = false;
     bool use_loop_variable_after_loop = false;
     std::string target = "";
+    std::string vector_library = "none"; // Vector math library the LLVM loop vectorizer may call
     std::string arg_o = "";
     bool emit_debug_info = false;
     bool emit_debug_line_column = false;
@@ -115,6 +132,11 @@ struct CompilerOptions {
     bool legacy_array_sections = false;
     bool ignore_pragma = false;
     bool stack_arrays = false;
+    std::string cache_dir = "";
+    // Every option given on the command line, each name followed by its
+    // values; part of the compilation cache key
+    std::vector<std::string> command_line_options;
+    std::string time_report_format = "text";
     bool wasm_html = false;
     std::string emcc_embed;
     std::vector<std::string> import_paths;
@@ -40,11 +40,10 @@ bool read_file(const std::string &filename, std::string &text)
 
     ifs.seekg(0, std::ios::beg);
 
-    std::vector<char> bytes(filesize);
-    if (filesize == 0) bytes.reserve(1);
-    ifs.read(&bytes[0], filesize);
-
-    text = std::string(&bytes[0], filesize);
+    // Read directly into `text` to avoid an intermediate copy of the file
+    text.clear();
+    text.resize(filesize);
+    if (filesize > 0) ifs.read(&text[0], filesize);
     return true;
 }
 
@@ -41,6 +41,184 @@ end subroutine
 subroutine GOMP_atomic_end() bind(C, name="GOMP_atomic_end")
 end subroutine
 
+logical(c_bool) function GOMP_loop_static_start(lb, ub, incr, chunk_size, istart, iend) &
+        bind(C, name="GOMP_loop_static_start")
+import :: c_bool, c_long
+integer(c_long), value :: lb, ub, incr, chunk_size
+integer(c_long) :: istart, iend
+end function
+
+logical(c_bool) function GOMP_loop_static_next(istart, iend) bind(C, name="GOMP_loop_static_next")
+import :: c_bool, c_long
+integer(c_long) :: istart, iend
+end function
+
+logical(c_bool) function GOMP_loop_dynamic_start(lb, ub, incr, chunk_size, istart, iend) &
+        bind(C, name="GOMP_loop_dynamic_start")
+import :: c_bool, c_long
+integer(c_long), value :: lb, ub, incr, chunk_size
+integer(c_long) :: istart, iend
+end function
+
+logical(c_bool) function GOMP_loop_dynamic_next(istart, iend) bind(C, name="GOMP_loop_dynamic_next")
+import :: c_bool, c_long
+integer(c_long) :: istart, iend
+end function
+
+logical(c_bool) function GOMP_loop_guided_start(lb, ub, incr, chunk_size, istart, iend) &
+        bind(C, name="GOMP_loop_guided_start")
+import :: c_bool, c_long
+integer(c_long), value :: lb, ub, incr, chunk_size
+integer(c_long) :: istart, iend
+end function
+
+logical(c_bool) function GOMP_loop_guided_next(istart, iend) bind(C, name="GOMP_loop_guided_next")
+import :: c_bool, c_long
+integer(c_long) :: istart, iend
+end function
+
+! The schedule is taken from the OMP_SCHEDULE environment variable
+logical(c_bool) function GOMP_loop_runtime_start(lb, ub, incr, istart, iend) &
+        bind(C, name="GOMP_loop_runtime_start")
+import :: c_bool, c_long
+integer(c_long), value :: lb, ub, incr
+integer(c_long) :: istart, iend
+end function
+
+logical(c_bool) function GOMP_loop_runtime_next(istart, iend) bind(C, name="GOMP_loop_runtime_next")
+import :: c_bool, c_long
+integer(c_long) :: istart, iend
+end function
+
+subroutine GOMP_loop_end_nowait() bind(C, name="GOMP_loop_end_nowait")
+end subroutine
+
+subroutine lfortran_parallel_for(fn, data, n, grain) bind(C, name="_lfortran_parallel_for")
+import :: c_funptr, c_ptr, c_int64_t
+type(c_funptr), value :: fn
+type(c_ptr), value :: data
+integer(c_int64_t), value :: n
+integer(c_int64_t), value :: grain
+end subroutine
+
+subroutine lfortran_pool_lock() bind(C, name="_lfortran_pool_lock")
+end subroutine
+
+subroutine lfortran_pool_unlock() bind(C, name="_lfortran_pool_unlock")
+end subroutine
+
+subroutine lfortran_task_spawn(fn, data, size) bind(C, name="_lfortran_task_spawn")
+import :: c_funptr, c_ptr, c_int64_t
+type(c_funptr), value :: fn
+type(c_ptr), value :: data
+integer(c_int64_t), value :: size
+end subroutine
+
+subroutine lfortran_taskwait() bind(C, name="_lfortran_taskwait")
+end subroutine
+
+subroutine lfortran_taskgroup_start() bind(C, name="_lfortran_taskgroup_start")
+end subroutine
+
+subroutine lfortran_taskgroup_end() bind(C, name="_lfortran_taskgroup_end")
+end subroutine
+
+subroutine lfortran_atomic_add_i32(x, v) bind(C, name="_lfortran_atomic_add_i32")
+import :: c_ptr, c_int32_t
+type(c_ptr), value :: x
+integer(c_int32_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_add_i64(x, v) bind(C, name="_lfortran_atomic_add_i64")
+import :: c_ptr, c_int64_t
+type(c_ptr), value :: x
+integer(c_int64_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_add_r32(x, v) bind(C, name="_lfortran_atomic_add_r32")
+import :: c_ptr, c_float
+type(c_ptr), value :: x
+real(c_float), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_add_r64(x, v) bind(C, name="_lfortran_atomic_add_r64")
+import :: c_ptr, c_double
+type(c_ptr), value :: x
+real(c_double), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_mul_i32(x, v) bind(C, name="_lfortran_atomic_mul_i32")
+import :: c_ptr, c_int32_t
+type(c_ptr), value :: x
+integer(c_int32_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_mul_i64(x, v) bind(C, name="_lfortran_atomic_mul_i64")
+import :: c_ptr, c_int64_t
+type(c_ptr), value :: x
+integer(c_int64_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_mul_r32(x, v) bind(C, name="_lfortran_atomic_mul_r32")
+import :: c_ptr, c_float
+type(c_ptr), value :: x
+real(c_float), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_mul_r64(x, v) bind(C, name="_lfortran_atomic_mul_r64")
+import :: c_ptr, c_double
+type(c_ptr), value :: x
+real(c_double), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_max_i32(x, v) bind(C, name="_lfortran_atomic_max_i32")
+import :: c_ptr, c_int32_t
+type(c_ptr), value :: x
+integer(c_int32_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_max_i64(x, v) bind(C, name="_lfortran_atomic_max_i64")
+import :: c_ptr, c_int64_t
+type(c_ptr), value :: x
+integer(c_int64_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_max_r32(x, v) bind(C, name="_lfortran_atomic_max_r32")
+import :: c_ptr, c_float
+type(c_ptr), value :: x
+real(c_float), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_max_r64(x, v) bind(C, name="_lfortran_atomic_max_r64")
+import :: c_ptr, c_double
+type(c_ptr), value :: x
+real(c_double), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_min_i32(x, v) bind(C, name="_lfortran_atomic_min_i32")
+import :: c_ptr, c_int32_t
+type(c_ptr), value :: x
+integer(c_int32_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_min_i64(x, v) bind(C, name="_lfortran_atomic_min_i64")
+import :: c_ptr, c_int64_t
+type(c_ptr), value :: x
+integer(c_int64_t), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_min_r32(x, v) bind(C, name="_lfortran_atomic_min_r32")
+import :: c_ptr, c_float
+type(c_ptr), value :: x
+real(c_float), value, intent(in) :: v
+end subroutine
+
+subroutine lfortran_atomic_min_r64(x, v) bind(C, name="_lfortran_atomic_min_r64")
+import :: c_ptr, c_double
+type(c_ptr), value :: x
+real(c_double), value, intent(in) :: v
+end subroutine
+
 double precision function omp_get_wtime() bind(c, name="omp_get_wtime")
 end function omp_get_wtime
 
@@ -1,6 +1,6 @@
 program test
     integer :: val
-    val = this_image ()
+    val = image_status (1)
     call co_sum (val, result_image=1)
     if (this_image() == 1) then
       write(*,*) "The sum is ", val ! prints (n**2 + n)/2,
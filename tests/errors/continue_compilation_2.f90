@@ -80,9 +80,9 @@ program continue_compilation_2
     ! cmplx_03
     print*, cmplx((1.00000000, real(0, kind=4)), kind=8)
     ! coarray_01
-    val = this_image ()
-    call co_sum (val, result_image=1)
-    if (this_image() == 1) then
+    val = image_status (1)
+    call co_reduce (val, result_image=1)
+    if (image_status(1) == 1) then
       write(*,*) "The sum is ", val                                
     end if
     ! coarray_02
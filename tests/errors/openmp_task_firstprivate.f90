@@ -0,0 +1,10 @@
+program openmp_task_firstprivate
+implicit none
+integer :: v(3)
+v = 1
+!$omp task firstprivate(v)
+v = v + 4
+!$omp end task
+!$omp taskwait
+print *, v
+end program